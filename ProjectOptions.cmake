@@ -142,6 +142,7 @@ macro(Jaxie_setup_options)
   endif()
 
   option(Jaxie_BUILD_FUZZ_TESTS "Enable fuzz testing executable" ${DEFAULT_FUZZER})
+  option(Jaxie_BUILD_BENCHMARKS "Build the jaxie_bench benchmark executable" OFF)
 
 endmacro()
 
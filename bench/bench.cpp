@@ -0,0 +1,112 @@
+#include "bench.hpp"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <numeric>
+#include <thread>
+
+namespace jaxie::bench {
+namespace {
+
+double percentile(const std::vector<double>& sorted, double fraction) noexcept {
+  // Nearest rank: the smallest sample with at least `fraction` of the samples at or below it.
+  const auto rank = static_cast<size_t>(std::ceil(fraction * static_cast<double>(sorted.size())));
+  return sorted[(std::clamp)(rank, size_t{ 1 }, sorted.size()) - 1];
+}
+
+void write_string(std::ostream& out, std::string_view text) {
+  out << '"';
+  for (const char c : text) {
+    if (c == '"' || c == '\\') {
+      out << '\\';
+    }
+    out << c;
+  }
+  out << '"';
+}
+
+void write_number(std::ostream& out, double value) {
+  out << (std::isfinite(value) ? fmt::format("{:.6g}", value) : std::string("null"));
+}
+
+} // namespace
+
+void summarize(std::vector<double>& samples, result& out) {
+  out.iterations = samples.size();
+  if (samples.empty()) {
+    return;
+  }
+  std::sort(samples.begin(), samples.end());
+  out.mean = std::accumulate(samples.begin(), samples.end(), 0.0) / static_cast<double>(samples.size());
+  out.p50 = percentile(samples, 0.50);
+  out.p95 = percentile(samples, 0.95);
+  out.p99 = percentile(samples, 0.99);
+  out.min = samples.front();
+  out.max = samples.back();
+}
+
+void write_json(std::ostream& out, const std::vector<result>& results) {
+  out << "{\n  \"context\": {\"hardware_threads\": " << std::thread::hardware_concurrency()
+#if defined(JAXIE_USE_ONNXRUNTIME)
+      << ", \"onnxruntime\": true"
+#else
+      << ", \"onnxruntime\": false"
+#endif
+      << "},\n  \"benchmarks\": [";
+  for (size_t i = 0; i < results.size(); ++i) {
+    const result& entry = results[i];
+    out << (i == 0 ? "\n" : ",\n") << "    {\"name\": ";
+    write_string(out, entry.name);
+    out << ", \"unit\": ";
+    write_string(out, entry.unit);
+    out << ", \"iterations\": " << entry.iterations;
+    const std::pair<const char*, double> stats[] = { // NOLINT(*-avoid-c-arrays)
+      { "mean", entry.mean }, { "p50", entry.p50 }, { "p95", entry.p95 },
+      { "p99", entry.p99 },   { "min", entry.min }, { "max", entry.max },
+    };
+    for (const auto& [key, value] : stats) {
+      out << ", \"" << key << "\": ";
+      write_number(out, value);
+    }
+    out << ", \"counters\": {";
+    for (size_t c = 0; c < entry.counters.size(); ++c) {
+      out << (c == 0 ? "" : ", ");
+      write_string(out, entry.counters[c].first);
+      out << ": ";
+      write_number(out, entry.counters[c].second);
+    }
+    out << "}}";
+  }
+  out << "\n  ]\n}\n";
+}
+
+void print_table(std::ostream& out, const std::vector<result>& results) {
+  out << fmt::format("{:<44} {:>8} {:>12} {:>12} {:>12} {:>12}\n", "benchmark", "iters", "p50", "p95", "p99", "mean");
+  for (const result& entry : results) {
+    out << fmt::format(
+      "{:<44} {:>8} {:>9.1f} {:<2} {:>9.1f} {:<2} {:>9.1f} {:<2} {:>9.1f} {:<2}",
+      entry.name,
+      entry.iterations,
+      entry.p50,
+      entry.unit,
+      entry.p95,
+      entry.unit,
+      entry.p99,
+      entry.unit,
+      entry.mean,
+      entry.unit);
+    for (const auto& [key, value] : entry.counters) {
+      out << fmt::format("  {}={:.4g}", key, value);
+    }
+    out << '\n';
+  }
+}
+
+bool selected(const bench_options& options, std::string_view name) noexcept {
+  return options.filter.empty() || name.find(options.filter) != std::string_view::npos;
+}
+
+} // namespace jaxie::bench
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace jaxie::bench {
+
+struct bench_options {
+  bool quick{false};         // few iterations: a smoke run, not a measurement
+  std::string filter;        // only benchmarks whose name contains this
+  std::string model_dir;     // tiny RNNT graphs, see make_tiny_rnnt
+  std::vector<std::string> providers;
+};
+
+// One benchmark's samples reduced to order statistics. Samples are per iteration, in `unit` (ns unless noted);
+// counters carry derived figures such as throughput or real-time factor.
+struct result {
+  std::string name;
+  std::string unit{"ns"};
+  uint64_t iterations{0};
+  double mean{0.0};
+  double p50{0.0};
+  double p95{0.0};
+  double p99{0.0};
+  double min{0.0};
+  double max{0.0};
+  std::vector<std::pair<std::string, double>> counters;
+};
+
+// Fills the order statistics of `out` from `samples`, which it sorts.
+void summarize(std::vector<double>& samples, result& out);
+
+// {"context": {...}, "benchmarks": [...]}; scripts/bench_compare.py reads this.
+void write_json(std::ostream& out, const std::vector<result>& results);
+void print_table(std::ostream& out, const std::vector<result>& results);
+
+bool selected(const bench_options& options, std::string_view name) noexcept;
+
+inline uint64_t now_ns() noexcept {
+  return static_cast<uint64_t>(
+    std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+      .count());
+}
+
+// Each suite appends its results; a suite whose prerequisites are missing (no ONNX Runtime, no model) appends
+// nothing and says why on `log`.
+void run_ring_benchmarks(const bench_options& options, std::vector<result>& results);
+void run_capture_benchmarks(const bench_options& options, std::vector<result>& results, std::ostream& log);
+void run_trace_benchmarks(const bench_options& options, std::vector<result>& results);
+void run_rnnt_benchmarks(const bench_options& options, std::vector<result>& results, std::ostream& log);
+
+} // namespace jaxie::bench
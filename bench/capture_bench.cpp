@@ -0,0 +1,107 @@
+#include "bench.hpp"
+
+#include <Jaxie/audio/capture.hpp>
+
+#include <fmt/format.h>
+
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <numbers>
+#include <span>
+#include <thread>
+#include <vector>
+
+namespace jaxie::bench {
+namespace {
+
+constexpr uint32_t sample_rate_hz = 16000;
+constexpr std::array<uint32_t, 2> period_sizes{ 64, 160 };
+constexpr uint32_t spin_iterations = 20000;
+
+// Headerless float32, which file replay reads at capture_config's rate and channel count.
+bool write_tone(const std::filesystem::path& path, size_t frames) {
+  std::vector<float> tone(frames);
+  for (size_t i = 0; i < frames; ++i) {
+    tone[i] = 0.25F * std::sin(2.0F * std::numbers::pi_v<float> * 440.0F * static_cast<float>(i) / sample_rate_hz);
+  }
+  std::ofstream out(path, std::ios::binary);
+  const auto bytes = std::as_bytes(std::span<const float>(tone));
+  // NOLINTNEXTLINE(*-reinterpret-cast)
+  out.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+  return static_cast<bool>(out);
+}
+
+// Ring commit -> capture_callback entry through consume_loop, with the producer paced like a device. The pipeline
+// stamps each commit and measures the wakeup itself; the callback reads that measurement for its own period.
+void handoff(
+  const bench_options& options,
+  const std::filesystem::path& tone,
+  uint32_t frames,
+  size_t tone_frames,
+  bool spin,
+  std::vector<result>& results) {
+  const auto name = fmt::format("capture/handoff/{}/{}", frames, spin ? "spin" : "block");
+  if (!selected(options, name)) {
+    return;
+  }
+  audio::capture_config config{};
+  config.sample_rate_hz = sample_rate_hz;
+  config.period_frames = frames;
+  config.spin_iterations = spin ? spin_iterations : 0;
+  config.source = audio::capture_source::file;
+  config.replay_path = tone.string();
+  config.pacing = audio::replay_pacing::realtime;
+
+  std::vector<double> samples;
+  samples.reserve(tone_frames / frames);
+  audio::audio_capture capture;
+  const bool ok = capture.init(config, [&](std::span<const float>) {
+    if (samples.size() < samples.capacity()) {
+      samples.push_back(static_cast<double>(capture.stats().wakeup_latency_last_ns));
+    }
+  });
+  if (!ok || !capture.start()) {
+    return;
+  }
+  const auto deadline = std::chrono::steady_clock::now()
+                        + std::chrono::milliseconds(1000 + ((tone_frames * 2000) / sample_rate_hz));
+  while (!capture.stats().end_of_stream && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  const audio::capture_stats stats = capture.stats();
+  capture.shutdown();
+
+  result out;
+  out.name = name;
+  summarize(samples, out);
+  out.counters.emplace_back("period_us", static_cast<double>(frames) * 1e6 / sample_rate_hz);
+  const auto delivered = static_cast<double>(stats.periods_delivered);
+  out.counters.emplace_back(
+    "wakeups_per_period", delivered == 0.0 ? 0.0 : static_cast<double>(stats.wakeups) / delivered);
+  out.counters.emplace_back("overruns", static_cast<double>(stats.ring.overruns));
+  results.push_back(std::move(out));
+}
+
+} // namespace
+
+void run_capture_benchmarks(const bench_options& options, std::vector<result>& results, std::ostream& log) {
+  const size_t tone_frames = (options.quick ? 4U : 48U) * sample_rate_hz / 16U; // 0.25 s or 3 s
+  const auto tone = std::filesystem::temp_directory_path() / fmt::format("jaxie_bench_{}.f32", now_ns());
+  if (!write_tone(tone, tone_frames)) {
+    log << "capture: cannot write " << tone.string() << ", skipped\n";
+    return;
+  }
+  for (const uint32_t frames : period_sizes) {
+    for (const bool spin : { false, true }) {
+      handoff(options, tone, frames, tone_frames, spin, results);
+    }
+  }
+  std::error_code ignored;
+  std::filesystem::remove(tone, ignored);
+}
+
+} // namespace jaxie::bench
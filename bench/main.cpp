@@ -0,0 +1,71 @@
+#include "bench.hpp"
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#if !defined(JAXIE_BENCH_MODEL_DIR)
+#define JAXIE_BENCH_MODEL_DIR "tiny_rnnt"
+#endif
+
+using std::string_view;
+
+static void print_help() {
+  std::cout << "Usage: jaxie_bench [options]\n"
+               "  --json FILE     also write the results as JSON (compare with scripts/bench_compare.py)\n"
+               "  --filter TEXT   only run benchmarks whose name contains TEXT\n"
+               "  --quick         a few iterations of each: checks that everything runs, measures nothing\n"
+               "  --models DIR    tiny RNNT graphs (default: the ones generated at build time)\n"
+               "  --ep NAME       execution provider for the RNNT benchmarks, repeatable (default: CPU)\n";
+}
+
+int main(int argc, char** argv) {
+  const std::span<char*> args(argv, static_cast<size_t>(argc));
+  jaxie::bench::bench_options options;
+  options.model_dir = JAXIE_BENCH_MODEL_DIR;
+  std::string json_path;
+  for (size_t i = 1; i < args.size(); ++i) {
+    const string_view arg{ args[i] != nullptr ? args[i] : "" };
+    const bool has_value = (i + 1) < args.size() && args[i + 1] != nullptr;
+    if (arg == "--help" || arg == "-h") {
+      print_help();
+      return EXIT_SUCCESS;
+    }
+    if (arg == "--quick") {
+      options.quick = true;
+    } else if (has_value && arg == "--json") {
+      json_path = args[++i];
+    } else if (has_value && arg == "--filter") {
+      options.filter = args[++i];
+    } else if (has_value && arg == "--models") {
+      options.model_dir = args[++i];
+    } else if (has_value && arg == "--ep") {
+      options.providers.emplace_back(args[++i]);
+    } else {
+      std::cerr << "Unknown or incomplete option: " << arg << "\n";
+      print_help();
+      return EXIT_FAILURE;
+    }
+  }
+
+  std::vector<jaxie::bench::result> results;
+  jaxie::bench::run_ring_benchmarks(options, results);
+  jaxie::bench::run_capture_benchmarks(options, results, std::cerr);
+  jaxie::bench::run_trace_benchmarks(options, results);
+  jaxie::bench::run_rnnt_benchmarks(options, results, std::cerr);
+  jaxie::bench::print_table(std::cout, results);
+
+  if (!json_path.empty()) {
+    std::ofstream out(json_path);
+    jaxie::bench::write_json(out, results);
+    if (!out) {
+      std::cerr << "Cannot write " << json_path << "\n";
+      return EXIT_FAILURE;
+    }
+  }
+  return results.empty() ? EXIT_FAILURE : EXIT_SUCCESS;
+}
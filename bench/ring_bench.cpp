@@ -0,0 +1,134 @@
+#include "bench.hpp"
+
+#include <Jaxie/audio/pcm_ring.hpp>
+
+#include <fmt/format.h>
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <span>
+#include <thread>
+#include <vector>
+
+namespace jaxie::bench {
+namespace {
+
+using audio::pcm_ring;
+
+constexpr std::array<uint32_t, 4> period_sizes{ 64, 160, 480, 1024 };
+constexpr uint32_t ring_periods = 24; // capture_config's default ring: period_count * 8
+
+std::vector<float> make_period(uint32_t frames) {
+  std::vector<float> period(frames);
+  for (uint32_t i = 0; i < frames; ++i) {
+    period[i] = static_cast<float>(i % 64U) / 64.0F;
+  }
+  return period;
+}
+
+// One write and one zero-copy acquire/commit of a period on the same thread: the ring's own cost with no
+// cross-core traffic.
+void push_pull(const bench_options& options, audio::ring_memory memory, uint32_t frames, std::vector<result>& results) {
+  const auto name =
+    fmt::format("ring/push_pull/{}/{}", memory == audio::ring_memory::mirrored ? "mirrored" : "heap", frames);
+  if (!selected(options, name)) {
+    return;
+  }
+  pcm_ring ring;
+  if (!ring.init(frames * ring_periods, 1, audio::overrun_policy::drop_newest, memory)) {
+    return;
+  }
+  const std::vector<float> period = make_period(frames);
+  const size_t iterations = options.quick ? 500 : 50000;
+  std::vector<double> samples;
+  samples.reserve(iterations);
+  float sink = 0.0F;
+  for (size_t i = 0; i < iterations + (iterations / 10); ++i) {
+    const uint64_t start = now_ns();
+    static_cast<void>(ring.write(period));
+    pcm_ring::read_view view{};
+    if (ring.acquire_read(frames, view)) {
+      sink += view.samples.back();
+      static_cast<void>(ring.commit_read(view));
+    }
+    const uint64_t elapsed = now_ns() - start;
+    if (i >= iterations / 10) { // the first tenth warms caches and faults the pages in
+      samples.push_back(static_cast<double>(elapsed));
+    }
+  }
+  volatile float keep = sink; // the reads must not be optimized away
+  static_cast<void>(keep);
+  result out;
+  out.name = name;
+  summarize(samples, out);
+  out.counters.emplace_back("frames_per_s", static_cast<double>(frames) * 1e9 / out.mean);
+  results.push_back(std::move(out));
+}
+
+// A producer and a consumer thread moving periods through the ring as fast as it lets them, as the capture
+// callback and consume_loop do. Each sample is the mean time per period over one batch.
+void spsc(const bench_options& options, uint32_t frames, std::vector<result>& results) {
+  const auto name = fmt::format("ring/spsc/{}", frames);
+  if (!selected(options, name)) {
+    return;
+  }
+  pcm_ring ring;
+  if (!ring.init(frames * ring_periods, 1, audio::overrun_policy::drop_newest, audio::ring_memory::mirrored)) {
+    return;
+  }
+  const std::vector<float> period = make_period(frames);
+  const size_t batches = options.quick ? 3 : 20;
+  const size_t periods_per_batch = options.quick ? 256 : 8192;
+  std::vector<double> samples;
+  samples.reserve(batches);
+  for (size_t batch = 0; batch <= batches; ++batch) {
+    std::atomic<bool> go{ false };
+    std::thread producer([&]() {
+      while (!go.load(std::memory_order_acquire)) {
+      }
+      for (size_t i = 0; i < periods_per_batch; ++i) {
+        while (ring.writable_frames() < frames) {
+          std::this_thread::yield();
+        }
+        static_cast<void>(ring.write(period));
+      }
+    });
+    const uint64_t start = now_ns();
+    go.store(true, std::memory_order_release);
+    for (size_t received = 0; received < periods_per_batch;) {
+      pcm_ring::read_view view{};
+      if (ring.acquire_read(frames, view)) {
+        received += ring.commit_read(view) ? 1U : 0U;
+      } else {
+        std::this_thread::yield();
+      }
+    }
+    const uint64_t elapsed = now_ns() - start;
+    producer.join();
+    if (batch > 0) { // batch 0 is warm-up
+      samples.push_back(static_cast<double>(elapsed) / static_cast<double>(periods_per_batch));
+    }
+  }
+  const uint64_t dropped = ring.stats().dropped_frames;
+  result out;
+  out.name = name;
+  summarize(samples, out);
+  out.counters.emplace_back("frames_per_s", static_cast<double>(frames) * 1e9 / out.mean);
+  out.counters.emplace_back("dropped_frames", static_cast<double>(dropped));
+  results.push_back(std::move(out));
+}
+
+} // namespace
+
+void run_ring_benchmarks(const bench_options& options, std::vector<result>& results) {
+  for (const uint32_t frames : period_sizes) {
+    push_pull(options, audio::ring_memory::heap, frames, results);
+    push_pull(options, audio::ring_memory::mirrored, frames, results);
+  }
+  for (const uint32_t frames : period_sizes) {
+    spsc(options, frames, results);
+  }
+}
+
+} // namespace jaxie::bench
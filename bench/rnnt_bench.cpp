@@ -0,0 +1,333 @@
+#include "bench.hpp"
+
+#include <Jaxie/onnx/rnnt_engine.hpp>
+#include <Jaxie/onnx/streaming_rnnt.hpp>
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <filesystem>
+#include <numbers>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace jaxie::bench {
+namespace {
+
+constexpr uint32_t sample_rate_hz = 16000;
+constexpr std::array<uint32_t, 2> chunk_sizes{ 160, 1600 }; // one capture period, and a typical 100 ms step
+constexpr std::array<uint32_t, 3> engine_streams{ 1, 4, 8 };
+constexpr uint32_t beam_chunk = 1600;
+
+// Speech-like enough for the frontend: two drifting tones. The tiny model's tokens are meaningless anyway.
+std::vector<float> make_audio(size_t frames) {
+  std::vector<float> audio(frames);
+  for (size_t i = 0; i < frames; ++i) {
+    const float t = static_cast<float>(i) / sample_rate_hz;
+    audio[i] = (0.2F * std::sin(2.0F * std::numbers::pi_v<float> * (220.0F + (40.0F * t)) * t))
+               + (0.1F * std::sin(2.0F * std::numbers::pi_v<float> * 1350.0F * t));
+  }
+  return audio;
+}
+
+// Wall time of streaming_rnnt::step on one chunk, frontend and encoder calls included: most steps only extend the
+// log-mel buffer, every options.encoder_chunk_frames of features one also runs the encoder and the decoder.
+// tokens_per_s counts what finish() releases too, since beam search holds its undecided tail until then.
+void step(
+  const bench_options& options,
+  onnx::streaming_rnnt& rnnt,
+  uint32_t chunk,
+  const std::string& name,
+  std::vector<result>& results) {
+  if (!selected(options, name)) {
+    return;
+  }
+  const size_t steps = (options.quick ? 2U : 60U) * sample_rate_hz / chunk; // 2 s or 60 s of audio
+  const std::vector<float> audio = make_audio(steps * chunk);
+  std::vector<int32_t> tokens;
+  tokens.reserve(4096);
+  std::vector<double> samples;
+  samples.reserve(steps);
+
+  // One untimed step sizes the token and feature buffers for this chunk length.
+  if (!rnnt.step(std::span<const float>(audio.data(), chunk), tokens)) {
+    return;
+  }
+  rnnt.reset_state();
+  const onnx::rnnt_stats before = rnnt.stats();
+  uint64_t emitted = 0;
+  for (size_t i = 0; i < steps; ++i) {
+    const std::span<const float> input(audio.data() + (i * chunk), chunk);
+    tokens.clear();
+    const uint64_t start = now_ns();
+    const bool ok = rnnt.step(input, tokens);
+    const uint64_t elapsed = now_ns() - start;
+    if (!ok) {
+      return;
+    }
+    emitted += tokens.size();
+    samples.push_back(static_cast<double>(elapsed));
+  }
+  const onnx::rnnt_stats after = rnnt.stats();
+  tokens.clear();
+  const uint64_t finishing = now_ns();
+  if (!rnnt.finish(tokens)) {
+    return;
+  }
+  const uint64_t finish_ns = now_ns() - finishing;
+  emitted += tokens.size();
+  double total_ns = static_cast<double>(finish_ns);
+  for (const double sample : samples) {
+    total_ns += sample;
+  }
+
+  result out;
+  out.name = name;
+  summarize(samples, out);
+  const double chunk_ns = static_cast<double>(chunk) * 1e9 / sample_rate_hz;
+  out.counters.emplace_back("rtf", out.mean / chunk_ns);
+  out.counters.emplace_back("encoder_runs_per_step",
+    static_cast<double>(after.encoder_runs - before.encoder_runs) / static_cast<double>(steps));
+  out.counters.emplace_back("tokens", static_cast<double>(emitted));
+  out.counters.emplace_back("tokens_per_s", total_ns > 0.0 ? static_cast<double>(emitted) * 1e9 / total_ns : 0.0);
+  // Steady state allocates nothing; anything here is a regression on its own.
+  out.counters.emplace_back("bytes_allocated", static_cast<double>(after.bytes_allocated - before.bytes_allocated));
+  results.push_back(std::move(out));
+}
+
+// rnnt/step/{beam_chunk} again with a width-4 modified beam search; greedy_time is its mean step time over the
+// greedy one's, when that ran too. Compare tokens_per_s between the two for the cost per emitted token.
+void beam(
+  const bench_options& options,
+  const onnx::rnnt_model_paths& paths,
+  const onnx::ep_prefs& prefs,
+  std::vector<result>& results,
+  std::ostream& log) {
+  const std::string name = "rnnt/step/beam4";
+  if (!selected(options, name)) {
+    return;
+  }
+  onnx::rnnt_options beam_options{};
+  beam_options.decoding = onnx::decode_mode::modified_beam;
+  beam_options.beam_size = 4;
+  onnx::streaming_rnnt rnnt;
+  if (!rnnt.load(paths, prefs, beam_options)) {
+    log << name << ": cannot load the beam search decoder, skipped\n";
+    return;
+  }
+  step(options, rnnt, beam_chunk, name, results);
+  const auto greedy = std::find_if(results.begin(), results.end(), [](const result& r) {
+    return r.name == fmt::format("rnnt/step/{}", beam_chunk);
+  });
+  if (!results.empty() && results.back().name == name && greedy != results.end() && greedy->mean > 0.0) {
+    results.back().counters.emplace_back("greedy_time", results.back().mean / greedy->mean);
+  }
+}
+
+// rnnt/step/{beam_chunk}'s audio through the two-stage pipeline instead of step(): every iteration submits the
+// clip in chunks as fast as the queues take them and drains it with stop_pipeline(). The time is per chunk, as
+// for step(); step_time is it over the rnnt/step/{beam_chunk} mean when that ran, so the overlap of encoding one
+// chunk while the previous one decodes shows as a figure below 1. encoder_busy and decoder_busy are each
+// stage's share of the wall time.
+void pipeline(
+  const bench_options& options,
+  onnx::streaming_rnnt& rnnt,
+  uint32_t chunk,
+  std::vector<result>& results,
+  std::ostream& log) {
+  const auto name = fmt::format("rnnt/pipeline/{}", chunk);
+  if (!selected(options, name)) {
+    return;
+  }
+  const size_t iterations = options.quick ? 1U : 5U;
+  const size_t steps = (options.quick ? 2U : 20U) * sample_rate_hz / chunk; // 2 s or 20 s of audio
+  const std::vector<float> audio = make_audio(steps * chunk);
+  uint64_t emitted = 0; // decoder stage; read after stop_pipeline()
+  const auto on_tokens = [&emitted](std::span<const int32_t> tokens) { emitted += tokens.size(); };
+
+  std::vector<double> samples;
+  samples.reserve(iterations);
+  uint64_t encoder_busy = 0;
+  uint64_t decoder_busy = 0;
+  for (size_t i = 0; i < iterations; ++i) {
+    if (!rnnt.start_pipeline(on_tokens)) {
+      log << name << ": cannot start the pipeline, skipped\n";
+      return;
+    }
+    const uint64_t start = now_ns();
+    for (size_t at = 0; at < audio.size(); at += chunk) {
+      while (!rnnt.submit(std::span<const float>(audio.data() + at, chunk))) {
+        std::this_thread::yield();
+      }
+    }
+    while (!rnnt.submit_boundary()) {
+      std::this_thread::yield();
+    }
+    rnnt.stop_pipeline();
+    samples.push_back(static_cast<double>(now_ns() - start) / static_cast<double>(steps));
+    const onnx::rnnt_pipeline_stats stats = rnnt.pipeline_stats();
+    if (stats.failed) {
+      log << name << ": a pipeline stage failed, skipped\n";
+      return;
+    }
+    encoder_busy += stats.encoder_busy_ns;
+    decoder_busy += stats.decoder_busy_ns;
+  }
+
+  result out;
+  out.name = name;
+  summarize(samples, out);
+  const double chunk_ns = static_cast<double>(chunk) * 1e9 / sample_rate_hz;
+  out.counters.emplace_back("rtf", out.mean / chunk_ns);
+  const double wall_ns = out.mean * static_cast<double>(steps * iterations);
+  out.counters.emplace_back("encoder_busy", static_cast<double>(encoder_busy) / wall_ns);
+  out.counters.emplace_back("decoder_busy", static_cast<double>(decoder_busy) / wall_ns);
+  out.counters.emplace_back("tokens", static_cast<double>(emitted) / static_cast<double>(iterations));
+  const auto synchronous = std::find_if(results.begin(), results.end(), [&](const result& r) {
+    return r.name == fmt::format("rnnt/step/{}", chunk);
+  });
+  if (synchronous != results.end() && synchronous->mean > 0.0) {
+    out.counters.emplace_back("step_time", out.mean / synchronous->mean);
+  }
+  results.push_back(std::move(out));
+}
+
+// Wall time for rnnt_engine to decode the same audio on `streams` streams at once, batched up to `streams` wide:
+// every stream pushes its whole clip, and the iteration ends when the engine has encoded all of their chunks.
+// Compare rtf across rnnt/engine/{1,4,8}: the gain from batching is how far it falls below the 1-stream figure.
+void engine(
+  const bench_options& options,
+  onnx::streaming_rnnt& rnnt,
+  const onnx::rnnt_model_paths& paths,
+  const onnx::ep_prefs& prefs,
+  uint32_t streams,
+  std::vector<result>& results,
+  std::ostream& log) {
+  const auto name = fmt::format("rnnt/engine/{}", streams);
+  if (!selected(options, name)) {
+    return;
+  }
+  const size_t iterations = options.quick ? 1U : 5U;
+  const std::vector<float> audio = make_audio(size_t{ options.quick ? 2U : 10U } * sample_rate_hz);
+
+  // The stepping model gives the chunk count each stream's clip encodes to.
+  std::vector<int32_t> tokens;
+  rnnt.reset_state();
+  const uint64_t runs = rnnt.stats().encoder_runs;
+  if (!rnnt.step(audio, tokens)) {
+    return;
+  }
+  const uint64_t clip_chunks = rnnt.stats().encoder_runs - runs;
+  rnnt.reset_state();
+
+  onnx::engine_options engine_options{};
+  engine_options.max_streams = streams;
+  engine_options.max_batch = streams;
+  engine_options.max_backlog_chunks = static_cast<uint32_t>(clip_chunks + 1); // a whole clip queues undropped
+  uint64_t emitted = 0; // engine thread; read after shutdown()
+  onnx::rnnt_engine engine;
+  if (!engine.load(paths, prefs, engine_options, [&emitted](uint32_t, std::span<const int32_t> out) {
+        emitted += out.size();
+      })) {
+    log << name << ": cannot load the engine, skipped\n";
+    return;
+  }
+  std::vector<uint32_t> ids(streams);
+  for (uint32_t& id : ids) {
+    if (!engine.open_stream(id)) {
+      return;
+    }
+  }
+
+  std::vector<double> samples;
+  samples.reserve(iterations);
+  uint64_t target = 0;
+  for (size_t i = 0; i < iterations; ++i) {
+    for (const uint32_t id : ids) {
+      engine.reset_stream(id);
+    }
+    target += clip_chunks * streams;
+    const uint64_t start = now_ns();
+    for (const uint32_t id : ids) {
+      if (!engine.push(id, audio)) {
+        return;
+      }
+    }
+    for (onnx::engine_stats progress = engine.stats(); progress.chunks < target; progress = engine.stats()) {
+      if (progress.failed_batches > 0 || progress.dropped_frames > 0) {
+        log << name << ": the engine failed a batch or dropped frames, skipped\n";
+        return;
+      }
+      std::this_thread::yield();
+    }
+    samples.push_back(static_cast<double>(now_ns() - start));
+  }
+  const onnx::engine_stats stats = engine.stats();
+  engine.shutdown();
+
+  result out;
+  out.name = name;
+  summarize(samples, out);
+  const double audio_ns = static_cast<double>(audio.size()) * 1e9 / sample_rate_hz;
+  out.counters.emplace_back("rtf", out.mean / (audio_ns * streams)); // wall time per second of audio, all streams
+  out.counters.emplace_back("mean_batch",
+    stats.batches > 0 ? static_cast<double>(stats.chunks) / static_cast<double>(stats.batches) : 0.0);
+  out.counters.emplace_back("tokens", static_cast<double>(emitted));
+  results.push_back(std::move(out));
+}
+
+} // namespace
+
+void run_rnnt_benchmarks(const bench_options& options, std::vector<result>& results, std::ostream& log) {
+  bool wanted = selected(options, "rnnt/load");
+  for (const uint32_t chunk : chunk_sizes) {
+    wanted = wanted || selected(options, fmt::format("rnnt/step/{}", chunk));
+  }
+  wanted = wanted || selected(options, "rnnt/step/beam4");
+  wanted = wanted || selected(options, fmt::format("rnnt/pipeline/{}", beam_chunk));
+  for (const uint32_t streams : engine_streams) {
+    wanted = wanted || selected(options, fmt::format("rnnt/engine/{}", streams));
+  }
+  if (!wanted) {
+    return;
+  }
+  const std::filesystem::path dir(options.model_dir);
+  onnx::streaming_rnnt rnnt;
+  const onnx::rnnt_model_paths paths{
+    .encoder = (dir / "encoder.onnx").string(),
+    .predictor = (dir / "predictor.onnx").string(),
+    .joint = (dir / "joint.onnx").string(),
+  };
+  onnx::ep_prefs prefs{ .providers = options.providers };
+  if (prefs.providers.empty()) {
+    prefs.providers = { "CPU" };
+  }
+  if (!rnnt.load(paths, prefs)) {
+#if defined(JAXIE_USE_ONNXRUNTIME)
+    log << "rnnt: cannot load the tiny model from " << dir.string() << ", skipped\n";
+#else
+    log << "rnnt: built without ONNX Runtime, skipped\n";
+#endif
+    return;
+  }
+  if (selected(options, "rnnt/load")) {
+    std::vector<double> load_ns{ static_cast<double>(rnnt.stats().load_ns) };
+    result load;
+    load.name = "rnnt/load";
+    summarize(load_ns, load);
+    results.push_back(std::move(load));
+  }
+  for (const uint32_t chunk : chunk_sizes) {
+    step(options, rnnt, chunk, fmt::format("rnnt/step/{}", chunk), results);
+  }
+  beam(options, paths, prefs, results, log);
+  pipeline(options, rnnt, beam_chunk, results, log);
+  for (const uint32_t streams : engine_streams) {
+    engine(options, rnnt, paths, prefs, streams, results, log);
+  }
+}
+
+} // namespace jaxie::bench
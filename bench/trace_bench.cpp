@@ -0,0 +1,59 @@
+#include "bench.hpp"
+
+#include <Jaxie/realtime/latency_trace.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace jaxie::bench {
+namespace {
+
+constexpr uint32_t calls_per_batch = 1000;
+
+// The cost of one trace point, off (the check every instrumented path pays) and on (clock read plus a store
+// into the thread's buffer). Each sample is the mean over a batch; the buffer is drained between batches,
+// untimed, so no event is dropped.
+void trace_point_cost(const bench_options& options, bool on, std::vector<result>& results) {
+  const char* name = on ? "trace/point/on" : "trace/point/off";
+  if (!selected(options, name)) {
+    return;
+  }
+  std::vector<realtime::trace_event> events;
+  events.reserve(calls_per_batch);
+  const uint64_t dropped_before = realtime::dropped_trace_events();
+  if (on) {
+    realtime::enable_tracing();
+  }
+  const size_t batches = options.quick ? 20 : 2000;
+  std::vector<double> samples;
+  samples.reserve(batches);
+  for (size_t batch = 0; batch < batches + (batches / 10); ++batch) {
+    const uint64_t start = now_ns();
+    for (uint32_t i = 0; i < calls_per_batch; ++i) {
+      realtime::trace(realtime::trace_point::token_emit, realtime::trace_phase::instant, i, i);
+    }
+    const uint64_t elapsed = now_ns() - start;
+    if (batch >= batches / 10) {
+      samples.push_back(static_cast<double>(elapsed) / calls_per_batch);
+    }
+    events.clear();
+    realtime::drain_trace(events);
+  }
+  realtime::disable_tracing();
+  result out;
+  out.name = name;
+  summarize(samples, out);
+  out.counters.emplace_back("dropped_events", static_cast<double>(realtime::dropped_trace_events() - dropped_before));
+  results.push_back(std::move(out));
+}
+
+} // namespace
+
+void run_trace_benchmarks(const bench_options& options, std::vector<result>& results) {
+  trace_point_cost(options, false, results);
+  trace_point_cost(options, true, results);
+}
+
+} // namespace jaxie::bench
@@ -1,5 +1,9 @@
 #pragma once
 
+#include <Jaxie/audio/pcm_ring.hpp>
+#include <Jaxie/dsp/resampler.hpp>
+#include <Jaxie/realtime/thread_tuning.hpp>
+
 #include <cstdint>
 #include <functional>
 #include <mutex>
@@ -11,16 +15,78 @@
 
 namespace jaxie::audio {
 
+enum class capture_source : uint8_t {
+  device, // live microphone through miniaudio (stubbed when JAXIE_USE_MINIAUDIO is OFF)
+  file,   // replay of capture_config::replay_path
+  none,   // initializes but never produces audio
+};
+
+enum class replay_pacing : uint8_t {
+  realtime,            // one period per period duration, like a device
+  as_fast_as_possible, // bounded only by the consumer; never overruns the ring
+};
+
+enum class sample_format : uint8_t { f32, s16 };
+
 struct capture_config {
+  // Format delivered to capture_callback.
   uint32_t sample_rate_hz{16000};
   uint32_t channels{1};
   uint32_t period_frames{160}; // ~10 ms at 16 kHz
   uint32_t period_count{3};
+
+  // Native device format; 0 means "same as the delivered format". When it differs, the capture path converts
+  // (int16 -> float, downmix to mono, polyphase resample) before the ring so every reader sees the final stream.
+  // File replay takes its native format from the file instead.
+  uint32_t device_sample_rate_hz{0};
+  uint32_t device_channels{0};
+  sample_format device_format{sample_format::f32};
+  dsp::resample_quality resampler_quality{dsp::resample_quality::balanced};
+  // Busy-wait this many iterations for new audio before blocking the consumer thread. 0 blocks immediately.
+  uint32_t spin_iterations{0};
+  // Ring capacity in frames; 0 sizes it as period_frames * period_count * 8. Raised to hold at least one
+  // converted source period below the overrun policy's fill limit.
+  uint32_t ring_frames{0};
+  overrun_policy on_overrun{overrun_policy::drop_oldest};
+  // Mirrored rings hand capture_callback a span straight into ring memory, even across the wrap point.
+  ring_memory ring_storage{ring_memory::mirrored};
+
+  // Scheduling policy/priority, CPU pinning and stack prefault for the consumer thread, and for the replay
+  // producer when it is paced in real time. A real-time policy also asks miniaudio for a real-time device thread.
+  // Applied by start(); missing permissions are reported in capture_stats::tuning and never fail start().
+  realtime::thread_tuning consumer_thread{};
+  bool lock_memory{false}; // mlockall() in start(); process-wide and left in place after stop()
+
+  capture_source source{capture_source::device};
+  // WAV file, or headerless interleaved float32 at sample_rate_hz / channels for any other extension.
+  std::string replay_path;
+  replay_pacing pacing{replay_pacing::realtime};
+  bool replay_loop{false};
+};
+
+// Consumer-side health snapshot. Latencies measure ring commit -> capture_callback entry.
+struct capture_stats {
+  uint64_t periods_delivered{0};
+  uint64_t wakeups{0};
+  uint64_t wakeup_latency_last_ns{0};
+  uint64_t wakeup_latency_max_ns{0};
+  uint64_t wakeup_latency_total_ns{0};
+  ring_stats ring{};
+  bool end_of_stream{false}; // file replay has delivered every period
+  realtime::tuning_report tuning{}; // outcome of capture_config::consumer_thread / lock_memory
 };
 
+// Health of one additional reader of the capture stream.
+struct subscriber_stats {
+  uint64_t periods_delivered{0};
+  reader_stats ring{};
+};
+
+// The span points into the capture ring and is only valid for the duration of the call.
 using capture_callback = std::function<void(std::span<const float>)>;
 
-// Simple audio capture wrapper. If JAXIE_USE_MINIAUDIO is ON, impl uses miniaudio; otherwise stubs.
+// Simple audio capture wrapper. The backend is chosen at init() from capture_config::source; the device source
+// uses miniaudio when JAXIE_USE_MINIAUDIO is ON and is stubbed otherwise.
 class audio_capture {
 public:
   audio_capture();
@@ -38,6 +104,19 @@ public:
 
   bool is_started() const noexcept { return started_; }
   capture_config current_config() const noexcept { return cfg_; }
+  capture_stats stats() const noexcept;
+
+  // Additional readers of the same stream, each with its own cursor into the ring (up to
+  // pcm_ring::max_readers). They read the samples in place, never delay capture_callback, and are charged
+  // their own overruns when they fall a whole ring behind. Available after init(); shutdown() removes them.
+  bool add_subscriber(capture_callback on_frames, uint32_t& id) noexcept; // delivered on its own thread
+  bool add_reader(uint32_t& id) noexcept; // pulled with acquire_period() / commit_period() from one thread
+  bool acquire_period(uint32_t id, pcm_ring::read_view& view) noexcept;
+  bool acquire_frames(uint32_t id, uint32_t frames, pcm_ring::read_view& view) noexcept;
+  // Advances the reader by view.frames, which may be fewer than were acquired (overlapping windows).
+  bool commit_period(uint32_t id, const pcm_ring::read_view& view) noexcept;
+  void remove_subscriber(uint32_t id) noexcept;
+  subscriber_stats stats(uint32_t id) const noexcept;
 
 private:
   capture_config cfg_{};
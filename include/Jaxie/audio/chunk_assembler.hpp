@@ -0,0 +1,74 @@
+#pragma once
+
+#include <Jaxie/audio/capture.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+
+namespace jaxie::audio {
+
+// Window geometry in delivered frames; defaults are 0.5 s | 0.2 s | 0.08 s at 16 kHz.
+struct chunk_config {
+  uint32_t left_frames{8000};
+  uint32_t chunk_frames{3200};
+  uint32_t right_frames{1280};
+};
+
+// left | chunk | right, as one view into the capture ring. Valid until the matching release().
+struct chunk_window {
+  std::span<const float> samples; // interleaved
+  uint64_t first_frame{0};        // stream position of samples[0]
+  uint32_t left_frames{0};        // shorter than configured until enough history exists
+  uint32_t chunk_frames{0};
+  uint32_t right_frames{0};
+  uint32_t channels{1};
+
+  std::span<const float> chunk() const noexcept {
+    return samples.subspan(static_cast<size_t>(left_frames) * channels, static_cast<size_t>(chunk_frames) * channels);
+  }
+};
+
+using window_callback = std::function<void(const chunk_window&)>;
+
+// Turns the capture stream into overlapping encoder windows at chunk cadence. It is a pull reader on the capture
+// ring whose cursor sits at the start of the next window: release() advances it by one chunk, so the left
+// context stays in ring memory and is never copied. init() refuses a ring smaller than twice a window (set
+// capture_config::ring_frames to at least 2 * (left + chunk + right)); a reader that falls a full ring behind
+// restarts with empty left context.
+class chunk_assembler {
+public:
+  chunk_assembler() = default;
+  ~chunk_assembler() { shutdown(); }
+
+  chunk_assembler(const chunk_assembler&) = delete;
+  chunk_assembler& operator=(const chunk_assembler&) = delete;
+  chunk_assembler(chunk_assembler&&) = delete;
+  chunk_assembler& operator=(chunk_assembler&&) = delete;
+
+  // capture must be initialized and outlive the assembler.
+  bool init(audio_capture& capture, const chunk_config& config) noexcept;
+  void shutdown() noexcept;
+
+  // Pull form: acquire() succeeds once chunk + right frames past the current chunk start are captured.
+  bool acquire(chunk_window& window) noexcept;
+  bool release(const chunk_window& window) noexcept;
+
+  // Delivers every window that is ready; call it from the capture callback or any single thread.
+  size_t pump(const window_callback& on_window) noexcept;
+
+  const chunk_config& config() const noexcept { return config_; }
+  subscriber_stats stats() const noexcept;
+
+private:
+  audio_capture* capture_{nullptr};
+  chunk_config config_{};
+  uint32_t reader_{0};
+  uint32_t channels_{1};
+  uint64_t window_start_{0}; // where the reader cursor should be
+  uint64_t chunk_start_{0};
+  bool synced_{false};       // false until the first acquire, and again after being lapped
+};
+
+} // namespace jaxie::audio
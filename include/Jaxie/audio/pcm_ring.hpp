@@ -0,0 +1,151 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace jaxie::audio {
+
+enum class overrun_policy : uint8_t {
+  drop_newest, // producer discards incoming frames that do not fit
+  drop_oldest, // consumer skips its oldest unread frames once the ring crosses a soft fill limit
+  overwrite,   // producer never waits; the reader detects being lapped through frame sequence numbers
+};
+
+enum class ring_memory : uint8_t {
+  heap,     // plain allocation; views that straddle the wrap point are stitched into a scratch buffer
+  mirrored, // same pages mapped twice back to back, so every view is contiguous in ring memory
+};
+
+struct ring_stats {
+  uint64_t overruns{0};       // overrun events (producer drops, consumer skips, or reader lapped)
+  uint64_t underruns{0};      // reads that asked for more frames than were available (capture: per period of lateness)
+  uint64_t dropped_frames{0}; // frames lost to any overrun
+  uint64_t high_water_frames{0};
+  uint64_t capacity_frames{0};
+};
+
+// Per-reader health for secondary readers (see pcm_ring::attach_reader).
+struct reader_stats {
+  uint64_t delivered_frames{0};
+  uint64_t overruns{0};       // times the reader was lapped by the producer
+  uint64_t dropped_frames{0}; // frames it lost that way
+  uint64_t lag_frames{0};     // frames behind the producer at the last acquire
+  uint64_t max_lag_frames{0};
+};
+
+// Single-producer / single-consumer interleaved float ring. Read and write positions are monotonically
+// increasing frame sequence numbers: only the producer moves the write cursor, only the consumer moves the
+// read cursor, so no policy ever touches the other side's state.
+//
+// Up to max_readers secondary readers can follow the same stream through their own cursors. They read the
+// shared ring memory in place and never hold the producer back: a reader that falls a whole ring behind is
+// lapped, resynchronized to the oldest intact frame and charged the loss in its own stats.
+class pcm_ring {
+public:
+  static constexpr uint32_t max_readers = 8;
+
+  // Zero-copy window into ring memory, valid until the matching commit_read().
+  struct read_view {
+    std::span<const float> samples;
+    uint64_t first_frame{0};
+    uint32_t frames{0};
+  };
+
+  pcm_ring() = default;
+  ~pcm_ring() { release(); }
+
+  pcm_ring(const pcm_ring&) = delete;
+  pcm_ring& operator=(const pcm_ring&) = delete;
+  pcm_ring(pcm_ring&&) = delete;
+  pcm_ring& operator=(pcm_ring&&) = delete;
+
+  // Mirrored rings round capacity up to whole pages and fall back to heap memory where unsupported.
+  bool init(
+    uint32_t capacity_frames,
+    uint32_t channels,
+    overrun_policy policy,
+    ring_memory memory = ring_memory::heap) noexcept;
+  void reset() noexcept;
+  void release() noexcept;
+  bool is_ready() const noexcept { return capacity_frames_ != 0; }
+
+  // Producer side; safe to call from a real-time callback. Returns the number of frames stored.
+  uint32_t write(std::span<const float> interleaved) noexcept;
+  // Frames the producer can add before the primary reader's policy would drop anything.
+  uint32_t writable_frames() const noexcept;
+
+  // Consumer side. read() fills exactly out.size() / channels frames or returns false without consuming.
+  bool read(std::span<float> out) noexcept;
+  uint32_t readable_frames() const noexcept;
+
+  // Zero-copy consumer access: acquire a view of `frames` frames, use it, then commit. commit_read() returns
+  // false when an overwrite-policy producer lapped the view while it was in use; the frames are dropped.
+  bool acquire_read(uint32_t frames, read_view& view) noexcept;
+  bool commit_read(const read_view& view) noexcept;
+
+  // Secondary readers. attach/detach are control-plane calls and must not race each other; each reader's
+  // acquire/commit pair must be used from one thread at a time. A new reader starts at the write position.
+  bool attach_reader(uint32_t& reader) noexcept;
+  void detach_reader(uint32_t reader) noexcept;
+  bool acquire_read(uint32_t reader, uint32_t frames, read_view& view) noexcept;
+  bool commit_read(uint32_t reader, const read_view& view) noexcept;
+  uint32_t readable_frames(uint32_t reader) const noexcept;
+  reader_stats stats(uint32_t reader) const noexcept;
+
+  uint64_t write_position() const noexcept { return write_pos_.load(std::memory_order_acquire); }
+  uint64_t read_position() const noexcept { return read_pos_.load(std::memory_order_acquire); }
+  uint32_t capacity_frames() const noexcept { return capacity_frames_; }
+  uint32_t channels() const noexcept { return channels_; }
+  overrun_policy policy() const noexcept { return policy_; }
+  ring_memory memory() const noexcept { return memory_; }
+
+  ring_stats stats() const noexcept;
+
+private:
+  bool map_mirrored(size_t bytes) noexcept;
+  void unmap_mirrored() noexcept;
+  void copy_in(uint64_t frame_pos, std::span<const float> samples) noexcept;
+  uint64_t resync_reader(uint64_t read_pos, uint64_t write_pos) noexcept;
+  void note_drop(uint64_t frames) noexcept;
+  std::span<const float> view_at(uint64_t frame_pos, uint32_t frames, std::vector<float>& scratch) const noexcept;
+  bool lapped(uint64_t first_frame, uint64_t& valid_from) const noexcept;
+
+  struct reader_slot {
+    alignas(64) std::atomic<uint64_t> read_pos{0};
+    std::atomic<bool> attached{false};
+    std::atomic<uint64_t> delivered_frames{0};
+    std::atomic<uint64_t> overruns{0};
+    std::atomic<uint64_t> dropped_frames{0};
+    std::atomic<uint64_t> lag_frames{0};
+    std::atomic<uint64_t> max_lag_frames{0};
+    std::vector<float> scratch; // heap storage only: stitched views that straddle the wrap point
+  };
+
+  float* data_{nullptr};
+  size_t data_samples_{0};
+  std::vector<float> heap_;
+  std::vector<float> scratch_;
+  void* mapping_{nullptr};
+  size_t mapping_bytes_{0};
+  ring_memory memory_{ring_memory::heap};
+  uint32_t capacity_frames_{0};
+  uint32_t channels_{0};
+  uint32_t soft_limit_frames_{0};
+  overrun_policy policy_{overrun_policy::drop_oldest};
+
+  alignas(64) std::atomic<uint64_t> write_pos_{0};
+  std::atomic<uint64_t> claim_pos_{0}; // highest frame the producer may be touching; lets lapped readers notice
+  alignas(64) std::atomic<uint64_t> read_pos_{0};
+
+  alignas(64) std::atomic<uint64_t> overruns_{0};
+  std::atomic<uint64_t> underruns_{0};
+  std::atomic<uint64_t> dropped_frames_{0};
+  std::atomic<uint64_t> high_water_frames_{0};
+
+  std::array<reader_slot, max_readers> readers_{};
+};
+
+} // namespace jaxie::audio
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace jaxie::audio {
+
+// Interleaved float32 audio decoded from disk.
+struct pcm_clip {
+  uint32_t sample_rate_hz{0};
+  uint32_t channels{0};
+  std::vector<float> samples;
+
+  uint64_t frames() const noexcept { return channels == 0 ? 0 : samples.size() / channels; }
+};
+
+// RIFF/WAVE with 16/24/32-bit integer or 32-bit float PCM (including WAVE_FORMAT_EXTENSIBLE).
+bool load_wav(const std::string& path, pcm_clip& out) noexcept;
+
+// Headerless interleaved little-endian float32; the caller supplies the stream format.
+bool load_raw_f32(const std::string& path, uint32_t sample_rate_hz, uint32_t channels, pcm_clip& out) noexcept;
+
+// Picks load_wav for ".wav" files and load_raw_f32 for anything else.
+bool load_pcm_file(const std::string& path, uint32_t raw_sample_rate_hz, uint32_t raw_channels, pcm_clip& out) noexcept;
+
+} // namespace jaxie::audio
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace jaxie::dsp {
+
+// Forward FFT of a real signal whose length is a power of two, computed as a half-length complex FFT plus
+// a split step. Tables and scratch are built in init(); forward() does not allocate.
+class real_fft {
+public:
+  bool init(size_t size) noexcept;
+
+  size_t size() const noexcept { return size_; }
+  size_t bins() const noexcept { return size_ / 2 + 1; }
+
+  // in holds size() samples; re and im receive bins() values each (DC through Nyquist).
+  void forward(std::span<const float> in, std::span<float> re, std::span<float> im) noexcept;
+
+private:
+  size_t size_{0};
+  std::vector<size_t> bit_reverse_;
+  std::vector<float> twiddle_re_; // e^{-2 pi i k / size}, k < size / 2; the half-length FFT uses every other one
+  std::vector<float> twiddle_im_;
+  std::vector<float> work_re_;
+  std::vector<float> work_im_;
+};
+
+} // namespace jaxie::dsp
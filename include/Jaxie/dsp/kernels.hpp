@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+namespace jaxie::dsp {
+
+// Vectorized inner loops shared by the capture converter and feature frontends. Each kernel dispatches to
+// AVX2/FMA (picked at runtime on x86), NEON (aarch64) or a scalar fallback.
+
+// Name of the instruction set the kernels dispatched to: "avx2", "neon" or "scalar".
+std::string_view simd_backend() noexcept;
+
+float dot(std::span<const float> lhs, std::span<const float> rhs) noexcept;
+
+// out[i] = in[i] / 32768
+void s16_to_f32(std::span<const int16_t> in, std::span<float> out) noexcept;
+
+// Averages `channels` interleaved channels into out; out.size() frames are produced.
+void downmix_to_mono(std::span<const float> interleaved, uint32_t channels, std::span<float> out) noexcept;
+
+// out[i] = lhs[i] * rhs[i]; out may alias lhs.
+void multiply(std::span<const float> lhs, std::span<const float> rhs, std::span<float> out) noexcept;
+
+// out[i] = in[i] - coeff * in[i - 1], with in[-1] = previous. Returns in.back() to carry into the next call;
+// out must not alias in.
+float preemphasis(std::span<const float> in, float coeff, float previous, std::span<float> out) noexcept;
+
+// out[i] = re[i]^2 + im[i]^2
+void power_spectrum(std::span<const float> re, std::span<const float> im, std::span<float> out) noexcept;
+
+} // namespace jaxie::dsp
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <Jaxie/dsp/fft.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace jaxie::dsp {
+
+struct log_mel_config {
+  uint32_t sample_rate_hz{16000};
+  uint32_t window_frames{400}; // 25 ms
+  uint32_t hop_frames{160};    // 10 ms
+  uint32_t fft_size{512};      // power of two >= window_frames
+  uint32_t mel_bins{80};
+  float low_freq_hz{0.0F};
+  float high_freq_hz{0.0F};    // 0 selects Nyquist
+  float preemphasis{0.97F};    // 0 disables
+  float log_floor{1e-10F};     // energies are clamped here before the log
+};
+
+// Incremental log-mel filterbank: periodic Hann window, real FFT power spectrum and HTK-scale triangular
+// filters. Pre-emphasis and the window overlap are carried between push() calls, so feeding 10 ms periods
+// yields exactly the frames the whole signal would. All buffers are sized in init(); push() does not allocate.
+class log_mel_frontend {
+public:
+  bool init(const log_mel_config& config) noexcept;
+  void reset() noexcept;
+
+  const log_mel_config& config() const noexcept { return config_; }
+  bool is_ready() const noexcept { return fft_.size() != 0; }
+
+  // Number of frames the next push() of `samples` samples will produce.
+  size_t frames_for(size_t samples) const noexcept;
+
+  // Appends audio and writes each completed frame as mel_bins floats, row after row, into features. Frames
+  // that do not fit are dropped and counted; size features with frames_for(). Returns frames written.
+  size_t push(std::span<const float> audio, std::span<float> features) noexcept;
+
+  uint64_t frames_emitted() const noexcept { return frames_emitted_; }
+  uint64_t frames_dropped() const noexcept { return frames_dropped_; }
+
+private:
+  void compute_frame(std::span<float> out) noexcept;
+
+  struct mel_filter {
+    uint32_t first_bin;
+    uint32_t weight_offset;
+    uint32_t weight_count;
+  };
+
+  log_mel_config config_{};
+  real_fft fft_{};
+  std::vector<float> window_;     // Hann coefficients, window_frames long
+  std::vector<float> pending_;    // pre-emphasized samples not yet covered by a full window
+  std::vector<float> frame_;      // windowed, zero-padded FFT input
+  std::vector<float> spectrum_re_;
+  std::vector<float> spectrum_im_;
+  std::vector<float> power_;
+  std::vector<mel_filter> filters_;
+  std::vector<float> weights_;    // nonzero weights of every filter, packed back to back
+  size_t pending_count_{0};
+  float last_sample_{0.0F};
+  uint64_t frames_emitted_{0};
+  uint64_t frames_dropped_{0};
+};
+
+} // namespace jaxie::dsp
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace jaxie::dsp {
+
+// Cost/quality tradeoff: taps per polyphase branch and passband width of the anti-alias filter.
+enum class resample_quality : uint8_t {
+  fast,     // 16 taps, ~85% passband
+  balanced, // 32 taps, ~90% passband
+  high,     // 64 taps, ~95% passband
+};
+
+// Streaming rational-ratio (L/M) polyphase resampler for a single channel. History is carried across
+// process() calls so arbitrary block sizes produce one continuous output stream.
+class polyphase_resampler {
+public:
+  bool init(uint32_t in_rate_hz, uint32_t out_rate_hz, resample_quality quality, size_t max_block_frames) noexcept;
+  void reset() noexcept;
+
+  // Returns the number of samples written; out must hold at least max_output_frames(in.size()).
+  size_t process(std::span<const float> in, std::span<float> out) noexcept;
+  size_t max_output_frames(size_t in_frames) const noexcept;
+
+  uint32_t up_factor() const noexcept { return up_; }
+  uint32_t down_factor() const noexcept { return down_; }
+  uint32_t taps_per_phase() const noexcept { return taps_; }
+
+private:
+  std::vector<float> coeffs_; // up_ branches of taps_ coefficients, time-reversed for a forward dot product
+  std::vector<float> buffer_; // taps_ - 1 history samples followed by the current block
+  size_t max_block_frames_{0};
+  uint32_t up_{1};
+  uint32_t down_{1};
+  uint32_t taps_{0};
+  uint32_t phase_{0};
+  size_t next_input_{0}; // index into the current block of the next output's newest input sample
+};
+
+struct converter_config {
+  uint32_t in_rate_hz{16000};
+  uint32_t in_channels{1};
+  uint32_t out_rate_hz{16000};
+  uint32_t out_channels{1};
+  resample_quality quality{resample_quality::balanced};
+  uint32_t max_block_frames{1024}; // larger inputs are processed in blocks of this size
+};
+
+// int16/float -> float, N channels -> mono and sample-rate conversion as one streaming stage. Channel count
+// is either preserved (no resampling) or reduced to mono. All buffers are sized in init().
+class stream_converter {
+public:
+  bool init(const converter_config& config) noexcept;
+  void reset() noexcept;
+
+  bool is_passthrough() const noexcept { return passthrough_; }
+  size_t max_output_frames(size_t in_frames) const noexcept;
+  const converter_config& config() const noexcept { return config_; }
+
+  // Return the number of output frames written to out.
+  size_t process(std::span<const float> interleaved, std::span<float> out) noexcept;
+  size_t process(std::span<const int16_t> interleaved, std::span<float> out) noexcept;
+
+  // End of stream: pushes a filter length of silence through, so the last input frames reach the output.
+  // out must hold flush_frames(); reset() before the next stream. Writes nothing when not resampling.
+  size_t flush(std::span<float> out) noexcept;
+  size_t flush_frames() const noexcept;
+
+private:
+  size_t process_block(std::span<const float> interleaved, std::span<float> out) noexcept;
+
+  converter_config config_{};
+  polyphase_resampler resampler_{};
+  std::vector<float> s16_scratch_;
+  std::vector<float> mono_scratch_;
+  bool resample_{false};
+  bool passthrough_{true};
+};
+
+} // namespace jaxie::dsp
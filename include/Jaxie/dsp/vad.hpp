@@ -0,0 +1,55 @@
+#pragma once
+
+#include <Jaxie/dsp/fft.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace jaxie::dsp {
+
+struct energy_vad_config {
+  uint32_t sample_rate_hz{16000};
+  uint32_t max_period_frames{512};   // spectral analysis covers at most this many trailing samples
+  float threshold_db{9.0F};          // speech must be this far above the tracked noise floor
+  float absolute_floor_db{-60.0F};   // and above this level (dBFS) regardless of the floor
+  float max_flatness{0.5F};          // geometric / arithmetic mean of the speech-band spectrum; noise is ~1
+  float noise_fall{0.2F};            // fraction of the gap closed per period when the level drops below the floor
+  float noise_rise_db_per_s{3.0F};   // how fast the floor creeps up through non-speech
+  float band_low_hz{300.0F};
+  float band_high_hz{4000.0F};
+};
+
+struct vad_decision {
+  float energy_db{0.0F};
+  float noise_floor_db{0.0F};
+  float flatness{1.0F};
+  bool speech{false};
+};
+
+// Per-period speech/non-speech detector: level against an adaptive noise floor plus spectral flatness in
+// the speech band. Cheap enough to run on every capture period; temporal smoothing is left to the caller.
+class energy_vad {
+public:
+  bool init(const energy_vad_config& config) noexcept;
+  void reset() noexcept;
+
+  vad_decision process(std::span<const float> period) noexcept;
+
+  const energy_vad_config& config() const noexcept { return config_; }
+
+private:
+  energy_vad_config config_{};
+  real_fft fft_{};
+  std::vector<float> frame_;
+  std::vector<float> spectrum_re_;
+  std::vector<float> spectrum_im_;
+  std::vector<float> power_;
+  size_t band_first_{0};
+  size_t band_last_{0};
+  float noise_floor_db_{0.0F};
+  bool primed_{false};
+};
+
+} // namespace jaxie::dsp
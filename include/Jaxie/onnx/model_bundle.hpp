@@ -0,0 +1,97 @@
+#pragma once
+
+#include <Jaxie/onnx/streaming_rnnt.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace jaxie::onnx {
+
+enum class bundle_section : uint32_t {
+  encoder = 1,
+  predictor = 2,
+  joint = 3,
+  io = 4,    // IO names, element types and shapes of the three graphs
+  vocab = 5, // tokenizer pieces, one per line, in token id order
+};
+
+struct bundle_port {
+  std::string name;
+  int32_t element_type{0};    // ONNXTensorElementDataType value
+  std::vector<int64_t> shape; // dynamic dims are negative
+};
+
+struct bundle_io {
+  std::vector<bundle_port> inputs;
+  std::vector<bundle_port> outputs;
+};
+
+// One file holding an RNNT model: the encoder, predictor and joint graphs (ONNX or ORT format), their IO
+// description, the tokenizer vocabulary and a checksum. Little-endian layout:
+//   header   "JXBUNDLE", version u32, section count u32, checksum u64 (of the section table), file size u64
+//   table    per section: kind u32, flags u32, offset u64, size u64, content hash u64 (of the section's bytes)
+//   sections each starting on a 4 KiB boundary, so a graph maps page-aligned
+// open() maps the file read-only: sessions are built from the mapped bytes, the pages belong to the page cache
+// and are shared by every process using the same bundle. Load with rnnt_model_paths::bundle.
+class model_bundle {
+public:
+  model_bundle() = default;
+  ~model_bundle();
+
+  model_bundle(const model_bundle&) = delete;
+  model_bundle& operator=(const model_bundle&) = delete;
+  model_bundle(model_bundle&& other) noexcept;
+  model_bundle& operator=(model_bundle&& other) noexcept;
+
+  // verify: check the table checksum and recompute every section's hash, which reads every page once. Off by
+  // default, so opening a bundle touches only the pages sessions are built from.
+  bool open(const std::string& path, bool verify = false) noexcept;
+  void close() noexcept;
+  bool is_open() const noexcept { return data_ != nullptr; }
+  bool is_mapped() const noexcept { return mapping_ != nullptr; } // false: read into memory (no mmap here)
+
+  std::span<const std::byte> section(bundle_section kind) const noexcept; // empty when absent
+  uint64_t section_hash(bundle_section kind) const noexcept;
+  bool is_ort_format(bundle_section kind) const noexcept;
+  const bundle_io& io(bundle_section graph) const noexcept;
+  std::span<const std::string_view> vocab() const noexcept { return vocab_; }
+  uint64_t checksum() const noexcept { return checksum_; }
+  const std::string& path() const noexcept { return path_; }
+
+  // The caller is done reading a section (ORT copied it into its own tensors): its pages leave this process's
+  // resident set, the page cache keeps them.
+  void release_pages(bundle_section kind) const noexcept;
+
+private:
+  struct entry {
+    bundle_section kind{};
+    uint32_t flags{0};
+    uint64_t offset{0};
+    uint64_t size{0};
+    uint64_t hash{0};
+  };
+
+  bool parse(bool verify);
+  bool parse_io(std::string_view text);
+  const entry* find(bundle_section kind) const noexcept;
+
+  std::string path_;
+  void* mapping_{nullptr};
+  std::vector<std::byte> heap_; // without mmap
+  const std::byte* data_{nullptr};
+  size_t size_{0};
+  uint64_t checksum_{0};
+  std::vector<entry> entries_;
+  std::vector<bundle_io> io_; // [encoder, predictor, joint]
+  std::vector<std::string_view> vocab_;
+};
+
+// Packs three ONNX or ORT-format graphs and an optional vocabulary (one piece per line; a SentencePiece .vocab
+// file's scores after a tab are dropped) into `path`. The IO section is filled when ONNX Runtime is available.
+bool write_model_bundle(const std::string& path, const rnnt_model_paths& graphs, const std::string& vocab_path) noexcept;
+
+} // namespace jaxie::onnx
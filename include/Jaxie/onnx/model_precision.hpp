@@ -0,0 +1,67 @@
+#pragma once
+
+#include <Jaxie/onnx/streaming_rnnt.hpp>
+
+#include <cstdint>
+#include <string>
+
+namespace jaxie::onnx {
+
+enum class model_precision : uint8_t { fp32, fp16, int8 };
+
+const char* precision_name(model_precision precision) noexcept;
+
+// One component's files by precision; empty: no such variant. Every variant keeps float32 inputs and outputs
+// and the same port names: FP16 exported with float32 IO (keep_io_types), INT8 dynamic or QDQ quantized.
+struct precision_variants {
+  std::string fp32;
+  std::string fp16;
+  std::string int8;
+
+  const std::string& path(model_precision precision) const noexcept;
+};
+
+struct rnnt_model_variants {
+  precision_variants encoder;
+  precision_variants predictor;
+  precision_variants joint;
+};
+
+// "<component>.onnx", "<component>.fp16.onnx" and "<component>.int8.onnx" for encoder, predictor and joint.
+rnnt_model_variants find_model_variants(const std::string& dir);
+
+struct component_precision {
+  model_precision gpu{model_precision::fp16}; // CUDA or TensorRT
+  model_precision cpu{model_precision::int8};
+};
+
+struct precision_policy {
+  component_precision encoder{};
+  component_precision predictor{};
+  component_precision joint{};
+};
+
+struct precision_choice {
+  model_precision encoder{model_precision::fp32};
+  model_precision predictor{model_precision::fp32};
+  model_precision joint{model_precision::fp32};
+  bool gpu{false};
+  std::string provider; // the first of prefs.providers this ORT build offers; "CPU" when none
+
+  bool all_fp32() const noexcept;
+};
+
+// "encoder fp16, predictor fp16, joint int8".
+std::string describe_precision(const precision_choice& choice);
+
+// Resolves `variants` to files for the execution provider the load will use: the first provider in prefs that
+// the ONNX Runtime build offers, CPU otherwise. Each component takes the policy's precision for that kind of
+// provider, falling back to fp32 and then to any variant it has. Fails only when a component has no file.
+bool select_precision(
+  const rnnt_model_variants& variants,
+  const ep_prefs& prefs,
+  const precision_policy& policy,
+  rnnt_model_paths& out,
+  precision_choice* choice = nullptr) noexcept;
+
+} // namespace jaxie::onnx
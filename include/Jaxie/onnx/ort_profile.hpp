@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace jaxie::onnx {
+
+struct ep_node_count {
+  std::string provider; // ORT's name, e.g. "CUDAExecutionProvider"
+  uint32_t nodes{0};    // a subgraph a provider compiled (TensorRT) counts as one node
+};
+
+struct op_timing {
+  std::string op;       // operator type, e.g. "MatMul"
+  std::string provider;
+  uint64_t calls{0};
+  uint64_t total_us{0}; // kernel time; for GPU providers the host-side launch unless ORT synchronizes
+};
+
+// One session's ONNX Runtime profile (a Chrome trace, see session_config::profiling) reduced to what a
+// per-step breakdown needs.
+struct session_profile {
+  uint64_t runs{0};                 // Run() calls
+  uint64_t run_us{0};               // their wall time
+  uint64_t kernel_us{0};            // the part spent in kernels
+  std::vector<op_timing> ops;       // per operator type and provider, by total_us, largest first
+  std::vector<ep_node_count> nodes; // distinct nodes that ran, per provider, most first
+};
+
+// Reads the trace ORT writes when profiling ends. Returns false, leaving out empty, when it is not a JSON
+// array of trace events.
+bool summarize_profile(std::string_view trace, session_profile& out) noexcept;
+bool load_profile(const std::string& path, session_profile& out) noexcept;
+
+} // namespace jaxie::onnx
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <Jaxie/onnx/streaming_rnnt.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <span>
+
+namespace jaxie::onnx {
+
+struct engine_options {
+  rnnt_options rnnt{};               // per-stream frontend, encoder chunking and decode settings (greedy only)
+  uint32_t max_streams{16};          // state slots, allocated by load()
+  uint32_t max_batch{8};             // streams per encoder call; 1 when the export has a static batch dim
+  uint32_t max_wait_us{20000};       // a ready chunk waits at most this long for others to fill its batch
+  uint32_t max_backlog_chunks{8};    // feature chunks a stream may queue before its oldest are dropped
+};
+
+struct engine_stats {
+  uint32_t open_streams{0};
+  uint32_t batch_limit{0};           // effective max_batch for the loaded models
+  uint64_t batches{0};
+  uint64_t chunks{0};                // stream chunks encoded; chunks / batches is the mean batch size
+  uint64_t full_batches{0};          // dispatched at batch_limit rather than on max_wait_us
+  uint64_t failed_batches{0};
+  uint64_t wait_last_ns{0};          // oldest chunk in a batch: ready -> encoder call
+  uint64_t wait_max_ns{0};
+  uint64_t wait_total_ns{0};
+  uint64_t dropped_frames{0};        // feature frames lost to full backlogs
+  uint64_t encoder_runs{0};
+  uint64_t predictor_runs{0};
+  uint64_t joint_runs{0};
+};
+
+// Tokens decoded for one stream from one batch, delivered on the engine's thread.
+using stream_tokens_callback = std::function<void(uint32_t stream, std::span<const int32_t> tokens)>;
+
+// Serves several audio streams from one set of encoder/predictor/joint sessions. Each stream owns a state slot
+// (frontend, encoder caches, predictor state); push() turns its audio into log-mel frames on the caller's
+// thread, and the engine thread batches whole encoder chunks from up to max_batch streams into one encoder
+// call, then decodes them with batched joint and predictor calls. A batch is dispatched when it is full or
+// when its oldest chunk has waited max_wait_us. Models follow the streaming_rnnt conventions with a dynamic
+// batch dim (the first dynamic dim of every input).
+class rnnt_engine {
+public:
+  rnnt_engine();
+  ~rnnt_engine();
+
+  rnnt_engine(const rnnt_engine&) = delete;
+  rnnt_engine& operator=(const rnnt_engine&) = delete;
+  rnnt_engine(rnnt_engine&&) noexcept;
+  rnnt_engine& operator=(rnnt_engine&&) noexcept;
+
+  // Loads the sessions once and starts the engine thread.
+  bool load(
+    const rnnt_model_paths& paths,
+    const ep_prefs& prefs,
+    const engine_options& options,
+    stream_tokens_callback on_tokens) noexcept;
+  void shutdown() noexcept;
+
+  // push(), reset_stream() and close_stream() for one stream must come from one thread at a time; different
+  // streams may be fed from different threads.
+  bool open_stream(uint32_t& id) noexcept;
+  void close_stream(uint32_t id) noexcept;
+  void reset_stream(uint32_t id) noexcept; // utterance boundary: drops queued frames and decoder state
+  bool push(uint32_t id, std::span<const float> audio) noexcept;
+
+  bool is_loaded() const noexcept { return loaded_; }
+  engine_stats stats() const noexcept;
+
+private:
+  struct impl;
+  std::unique_ptr<impl> pimpl_{};
+  bool loaded_{false};
+};
+
+} // namespace jaxie::onnx
@@ -1,6 +1,10 @@
 #pragma once
 
+#include <Jaxie/dsp/log_mel.hpp>
+#include <Jaxie/onnx/ort_profile.hpp>
+
 #include <cstdint>
+#include <functional>
 #include <memory>
 #include <optional>
 #include <span>
@@ -9,17 +13,161 @@
 
 namespace jaxie::onnx {
 
+enum class graph_optimization : uint8_t { none, basic, extended, all };
+
+// Process-wide ONNX Runtime state: every loader shares one Env, whose global intra/inter-op thread pools are sized
+// here, and one prepacked-weights container. Zero thread counts keep ORT's defaults.
+struct runtime_config {
+  uint32_t intra_op_threads{0};
+  uint32_t inter_op_threads{0};
+  bool allow_spinning{true};
+};
+
+// Only takes effect before the first model load of the process creates the Env; returns false afterwards (or
+// when ORT is disabled).
+bool configure_runtime(const runtime_config& config) noexcept;
+
+// ONNX Runtime settings for every session a loader opens. Zero thread counts keep ORT's defaults.
+struct session_config {
+  // Run on the process-wide thread pools (see runtime_config) instead of creating pools per session, so loaded
+  // models do not multiply threads. The three settings below only apply when this is off.
+  bool global_thread_pools{true};
+  uint32_t intra_op_threads{0};
+  uint32_t inter_op_threads{0};   // only used with parallel_execution
+  bool allow_spinning{true};      // idle worker threads spin: lower latency per Run(), busier cores
+  bool parallel_execution{false}; // run independent graph branches concurrently
+  // Sessions of the same weights share prepacked (kernel-layout) copies instead of each packing their own.
+  bool share_prepacked_weights{true};
+  graph_optimization optimization{graph_optimization::all};
+  // Optimized-model cache. The first load writes each optimized graph here and later loads skip graph
+  // optimization; an entry is keyed by the source model's content hash, the EP order and the optimization
+  // level, and stale entries for the same model are removed. TensorRT keeps its engine and timing caches here
+  // instead (its compiled graphs cannot be serialized). Empty: no cache.
+  std::string cache_dir;
+  // ORT's profiler records every Run() until the profile is collected (streaming_rnnt::collect_profile()), which
+  // also counts the nodes each execution provider ran. Costs a few percent per call. Traces are written to
+  // profile_dir and kept there (Chrome trace format); empty: the temporary directory, removed once read.
+  bool profiling{false};
+  std::string profile_dir;
+};
+
 struct ep_prefs {
   // Order preference: e.g., {"Tensorrt", "CUDA", "CPU"}
   std::vector<std::string> providers;
+  session_config session{};
 };
 
+class model_bundle;
+
 struct rnnt_model_paths {
   std::string encoder;
   std::string predictor;
   std::string joint;
+  // Set: the three graphs come from this mapped bundle (see model_bundle) and the paths are ignored. Loaders
+  // keep a reference for as long as their sessions live.
+  std::shared_ptr<const model_bundle> bundle{};
+};
+
+enum class decode_mode : uint8_t {
+  greedy,        // argmax, up to max_symbols_per_frame tokens per encoder frame
+  modified_beam, // beam_size hypotheses, at most one token per hypothesis per encoder frame
+};
+
+struct rnnt_options {
+  dsp::log_mel_config features{}; // frontend that turns step() audio into encoder input
+  uint32_t max_step_frames{1600}; // feature buffers are sized for this much audio; longer chunks are sliced
+  uint32_t max_window_frames{16000}; // longest step_window() input
+  // Feature frames per encoder call when the encoder's time axis is dynamic (a static axis wins).
+  uint32_t encoder_chunk_frames{20};
+  uint32_t max_symbols_per_frame{5}; // greedy decode emits at most this many tokens per encoder frame
+  int32_t blank_id{-1};              // -1: the joint's last output
+  decode_mode decoding{decode_mode::greedy};
+  uint32_t beam_size{4};
+  // Greedy step_window(): also decode the right-context frames from a copy of the decoder state into partial().
+  // Those tokens show up a window early and are replaced when the next window decodes the same audio as its
+  // chunk. Needs an encoder that sees the right context (not cache-aware or fixed-size ones).
+  bool decode_lookahead{false};
+};
+
+// Tokens that may still change, with the log-mel frame of each (see streaming_rnnt::token_frames()). Valid until
+// the next call on the model.
+struct rnnt_partial {
+  std::span<const int32_t> tokens;
+  std::span<const uint32_t> frames;
+};
+
+// Hot-path accounting. "Allocated" is tensor memory the backend reserves (load, or the first encoder call of a
+// new frame count); "copied" is tensor data moved between the backend's own buffers (state hand-off, adopting
+// probe outputs, beam search filling its predictor cache, the lookahead's decoder snapshot). Staging features
+// and encoder frames into model inputs is not counted. Both are zero per step once warmed up, except for the
+// cache misses of beam search and the lookahead snapshot.
+struct rnnt_stats {
+  uint64_t steps{0};
+  uint64_t encoder_runs{0};
+  uint64_t predictor_runs{0};
+  uint64_t joint_runs{0};
+  uint64_t predictor_cache_hits{0};   // beam search: hypotheses whose prefix already had a prediction
+  uint64_t predictor_cache_misses{0};
+  uint64_t arena_bytes{0}; // tensor memory currently reserved
+  uint64_t bytes_allocated{0};
+  uint64_t bytes_copied{0};
+  uint64_t last_step_bytes_allocated{0};
+  uint64_t last_step_bytes_copied{0};
+  uint64_t load_ns{0};          // last load(): session creation (the three in parallel) and probing
+  uint32_t cached_sessions{0};  // sessions of the last load() opened from the optimized-model cache
+};
+
+// Where one session runs. registered holds the providers appended for ep_prefs::providers, in priority order
+// and by ORT's names, then CPUExecutionProvider, which ORT always adds last to take whatever the others do not;
+// rejected the ones ORT refused, as "<provider>: <reason>". nodes (how many each provider ran) needs
+// session_config::profiling and is filled in by collect_profile().
+struct session_placement {
+  std::vector<std::string> registered;
+  std::vector<std::string> rejected;
+  std::vector<ep_node_count> nodes;
+};
+
+struct rnnt_placement {
+  session_placement encoder;
+  session_placement predictor;
+  session_placement joint;
+};
+
+struct rnnt_profile {
+  uint64_t steps{0}; // step() and step_window() calls since load(), which the profile covers
+  session_profile encoder;
+  session_profile predictor;
+  session_profile joint;
+  std::vector<std::string> files; // traces kept in session_config::profile_dir
+};
+
+struct rnnt_pipeline_options {
+  uint32_t audio_slots{16}; // submit() blocks of up to max_step_frames samples queued for the encoder stage
+  uint32_t frame_slots{4};  // encoded blocks queued for the decoder stage; a full queue stalls the encoder
 };
 
+struct rnnt_pipeline_stats {
+  uint64_t blocks{0};           // audio blocks encoded and decoded
+  uint64_t rejected_submits{0}; // submit() calls refused because the audio queue was full
+  uint64_t latency_last_ns{0};  // submit() -> tokens delivered, for blocks that produced encoder frames
+  uint64_t latency_max_ns{0};
+  uint64_t latency_total_ns{0};
+  uint64_t latency_blocks{0};
+  uint64_t encoder_busy_ns{0}; // frontend + encoder time on the encoder stage
+  uint64_t decoder_busy_ns{0}; // predictor + joint time on the decoder stage
+  bool failed{false};          // a stage failed; submit() refuses audio until the pipeline is restarted
+};
+
+enum class swap_state : uint8_t {
+  idle,    // no replacement prepared (or the last one was committed)
+  loading, // the replacement is loading in the background
+  ready,   // commit_swap() will switch to it
+  failed,  // the replacement did not load; the serving model is untouched
+};
+
+// Tokens from one decoded block (or an utterance boundary), delivered on the decoder stage's thread.
+using rnnt_tokens_callback = std::function<void(std::span<const int32_t> tokens)>;
+
 class streaming_rnnt {
 public:
   streaming_rnnt();
@@ -30,18 +178,87 @@ public:
   streaming_rnnt(streaming_rnnt&&) noexcept;
   streaming_rnnt& operator=(streaming_rnnt&&) noexcept;
 
-  bool load(const rnnt_model_paths& paths, const ep_prefs& prefs) noexcept;
+  bool load(const rnnt_model_paths& paths, const ep_prefs& prefs, const rnnt_options& options = {}) noexcept;
 
-  // Run one streaming step. Interfaces will evolve once IO names and shapes are finalized.
+  // Another stream over the sessions of a loaded `source`: no session is created, only this stream's frontend,
+  // tensors, bindings and decoder state, so N streams cost one model's weights. The two may then step on
+  // different threads; ORT runs one session's calls concurrently. The sessions live until every stream holding
+  // them unloads, also across source's hot swaps. Must not race a load() or swap of source itself. Shared
+  // streams do not profile.
+  bool load_shared(const streaming_rnnt& source, const rnnt_options& options = {}) noexcept;
+
+  // Run one streaming step on raw audio at options.features.sample_rate_hz. Log-mel frames are computed
+  // incrementally and the encoder runs on every full options.encoder_chunk_frames; audio and frames that do
+  // not complete one are carried into the next call, as are encoder caches and the greedy decoder's state.
+  // After the first call nothing is allocated, provided emitted_tokens has reserved room for the tokens.
   bool step(
     std::span<const float> audio_chunk,
     std::vector<int32_t>& emitted_tokens) const noexcept;
 
-  void reset_state() noexcept; // clear caches/hidden states between utterances
+  // Run the encoder on one self-contained left | chunk | right window (see audio::chunk_assembler). The window
+  // gets its own frontend pass; only the chunk's frames advance the decoder, the context frames are encoder
+  // lookback and lookahead. Decoder state carries over between windows as in step().
+  bool step_window(
+    std::span<const float> window,
+    uint32_t left_frames,
+    uint32_t right_frames,
+    std::vector<int32_t>& emitted_tokens) const noexcept;
+
+  // Beam search only emits the tokens all hypotheses agree on; at the end of an utterance finish() appends the
+  // rest of the best hypothesis and keeps only that one. Greedy decoding has nothing held back.
+  bool finish(std::vector<int32_t>& emitted_tokens) const noexcept;
+
+  // The log-mel frame (options.features.hop_frames samples, counted from the last reset_state()) each token of
+  // the last step(), step_window() or finish() was emitted at, parallel to its emitted_tokens.
+  std::span<const uint32_t> token_frames() const noexcept;
+  // What the last call held back: beam search's best hypothesis past the tokens all hypotheses agree on, or
+  // greedy decoding's lookahead (rnnt_options::decode_lookahead). Empty for plain greedy decoding, whose tokens
+  // are final once emitted. Neither this nor token_frames() is kept for the pipeline.
+  rnnt_partial partial() const noexcept;
+
+  void reset_state() noexcept; // clear caches/hidden states and frontend overlap between utterances
+
+  rnnt_stats stats() const noexcept; // read from the stepping thread, or after stop_pipeline()
+
+  // Providers of the last successful load(); empty before one.
+  const rnnt_placement& placement() const noexcept;
+  // Ends profiling (ORT cannot restart it before the next load) and summarizes the three sessions' traces,
+  // counting nodes per provider into placement(). Returns false without session_config::profiling, after the
+  // first call, or while the pipeline runs.
+  bool collect_profile(rnnt_profile& out) noexcept;
+
+  // Pipelined streaming. An encoder stage (frontend + encoder) and a decoder stage (predictor + joint) run on
+  // two threads linked by single-producer/single-consumer slot queues, so the next block is encoded while the
+  // previous one is decoded. submit() queues audio without waiting and returns false, consuming nothing, when
+  // the queue is full; the capture side keeps the audio and retries. Blocks are decoded in submission order.
+  // submit_boundary() ends an utterance in order: beam search is flushed through on_tokens and the state
+  // is reset. stop_pipeline() drains everything queued. While the pipeline runs, step(), step_window(),
+  // finish() and reset_state() are refused; the control calls and submit() come from one thread.
+  bool start_pipeline(rnnt_tokens_callback on_tokens, const rnnt_pipeline_options& options = {}) noexcept;
+  bool submit(std::span<const float> audio) noexcept;
+  bool submit_boundary() noexcept;
+  void stop_pipeline() noexcept;
+  rnnt_pipeline_stats pipeline_stats() const noexcept;
+
+  // Hot swap. prepare_swap() loads a replacement (other models, EP order, precision or options) on a background
+  // thread while this model keeps serving step(). commit_swap(), called from the stepping thread at an utterance
+  // boundary, switches to the replacement once it is ready: a pointer exchange that neither waits nor allocates,
+  // after which the background thread destroys the old sessions. It returns false and changes nothing when no
+  // replacement is ready or the pipeline is running. cancel_swap() never waits: a replacement still loading is
+  // discarded by the background thread when its load returns. prepare_swap() drops a prepared swap that was not
+  // committed and waits for the previous background thread to finish (a load in progress, or the release of the
+  // retired model), as does destroying the stream. prepare_swap(), cancel_swap() and commit_swap() may be called
+  // from different threads, swap_status() from any.
+  bool prepare_swap(const rnnt_model_paths& paths, const ep_prefs& prefs, const rnnt_options& options = {}) noexcept;
+  bool commit_swap() noexcept;
+  void cancel_swap() noexcept;
+  swap_state swap_status() const noexcept;
 
 private:
   struct impl;
+  struct swapper;
   std::unique_ptr<impl> pimpl_{};
+  std::unique_ptr<swapper> swap_{};
   bool loaded_{false};
 };
 
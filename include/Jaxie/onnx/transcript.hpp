@@ -0,0 +1,117 @@
+#pragma once
+
+#include <Jaxie/dsp/log_mel.hpp>
+#include <Jaxie/onnx/streaming_rnnt.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace jaxie::onnx {
+
+// SentencePiece-style token ids to text. "▁" (U+2581) marks the start of a word and renders as a space,
+// "<0xNN>" byte-fallback pieces as that byte, and other "<...>" pieces (<unk>, <s>, <blk>, ...) as nothing.
+// Every piece is rendered once at load, so turning tokens into text only copies bytes.
+class detokenizer {
+public:
+  bool load(std::span<const std::string_view> pieces) noexcept; // in token id order, e.g. model_bundle::vocab()
+  // One piece per line; a tab-separated score (SentencePiece .vocab) is ignored.
+  bool load_file(const std::string& path) noexcept;
+
+  size_t size() const noexcept { return offsets_.empty() ? 0 : offsets_.size() - 1; }
+  // The rendered piece, with its leading space if it starts a word; empty for ids outside the vocabulary.
+  std::string_view piece(int32_t id) const noexcept;
+  // Appends the text of tokens to out, without a leading space when out is empty.
+  void append(std::span<const int32_t> tokens, std::string& out) const;
+
+private:
+  std::string text_;              // rendered pieces back to back
+  std::vector<uint32_t> offsets_; // piece i is text_[offsets_[i], offsets_[i + 1])
+};
+
+struct transcript_options {
+  dsp::log_mel_config features{}; // the recognizer's frontend: token frames are hop_frames samples at its rate
+  uint32_t reserve_bytes{4096};   // text buffers reserved at init, so updates of typical utterances never allocate
+  uint32_t reserve_tokens{1024};
+};
+
+struct timed_token {
+  int32_t id{0};
+  uint32_t frame{0};   // log-mel frame the token was emitted at, from the start of the utterance
+  uint32_t time_ms{0}; // the same, in milliseconds
+};
+
+// One incremental change to the displayed transcript: drop the last `erase` bytes of the previous text, then
+// append `append`. The first stable_bytes bytes of the result will not change again before reset(). Both edges
+// fall on UTF-8 character boundaries.
+struct transcript_update {
+  size_t erase{0};
+  std::string_view append;
+  size_t stable_bytes{0};
+  std::span<const timed_token> stabilized; // tokens that became final with this update
+  std::span<const timed_token> pending;    // the whole volatile suffix, replacing the previous one
+  bool final{false};                       // the utterance ended: nothing is pending
+};
+
+struct transcript_stats {
+  uint64_t updates{0};
+  uint64_t stable_tokens{0};
+  uint64_t withdrawn_tokens{0};     // pending tokens an update took back instead of confirming
+  uint64_t first_partial_ns{0};     // reset() (or init()) -> the first update that displayed text; 0 before it
+  uint64_t allocations{0};          // buffer growths inside update() and finish()
+  uint64_t last_update_allocations{0};
+};
+
+// Turns the recognizer's per-step output into a transcript that only ever grows at the front: tokens a step
+// emitted are appended to the stable prefix, and the tokens it still holds back (streaming_rnnt::partial():
+// the greedy lookahead over a window's right context, or beam search's undecided tail) form a volatile suffix
+// that the next update replaces. With left | chunk | right windows this is the middle-token merge: each
+// window's chunk tokens are kept, its right-context tokens are shown early and then superseded by the next
+// window's chunk. Updates come as byte diffs, so the display never re-renders the whole string.
+// Not thread-safe; the returned update is valid until the next call.
+class transcript_stabilizer {
+public:
+  // vocab must outlive the stabilizer.
+  bool init(const detokenizer& vocab, const transcript_options& options = {}) noexcept;
+
+  // tokens and frames are what one step()/step_window() emitted, partial what it held back.
+  const transcript_update& update(
+    std::span<const int32_t> tokens,
+    std::span<const uint32_t> frames,
+    const rnnt_partial& partial) noexcept;
+  const transcript_update& update(const streaming_rnnt& rnnt, std::span<const int32_t> tokens) noexcept;
+  // End of utterance: tokens (from streaming_rnnt::finish()) are appended and the pending suffix dropped.
+  const transcript_update& finish(std::span<const int32_t> tokens, std::span<const uint32_t> frames) noexcept;
+
+  void reset() noexcept; // next utterance; restarts the first-partial clock
+
+  std::string_view text() const noexcept { return display_; }
+  std::span<const timed_token> stable_tokens() const noexcept { return stable_; }
+  const transcript_stats& stats() const noexcept { return stats_; }
+
+private:
+  const transcript_update& apply(
+    std::span<const int32_t> tokens,
+    std::span<const uint32_t> frames,
+    const rnnt_partial& partial,
+    bool final) noexcept;
+  void render(std::span<const timed_token> tokens, bool at_start);
+  timed_token timed(int32_t id, uint32_t frame) const noexcept;
+
+  const detokenizer* vocab_{nullptr};
+  transcript_options options_{};
+  std::vector<timed_token> stable_;
+  std::vector<timed_token> pending_;
+  std::string display_; // stable text, then pending text
+  std::string tail_;    // scratch: the new text past the old stable prefix
+  size_t stable_bytes_{0};
+  transcript_update update_{};
+  transcript_stats stats_{};
+  std::chrono::steady_clock::time_point started_{};
+};
+
+} // namespace jaxie::onnx
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <Jaxie/dsp/vad.hpp>
+#include <Jaxie/onnx/streaming_rnnt.hpp>
+#include <Jaxie/onnx/vad_model.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace jaxie::onnx {
+
+struct vad_gate_config {
+  dsp::energy_vad_config detector{};
+  uint32_t onset_ms{30};            // consecutive speech needed to open the gate
+  uint32_t hangover_ms{300};        // non-speech tolerated before the utterance is closed
+  uint32_t pre_roll_ms{250};        // audio from before the onset replayed when the gate opens
+  std::string model_path{};         // optional ONNX VAD that must agree with the energy detector
+  ep_prefs model_prefs{};
+  float model_threshold{0.5F};
+  uint32_t model_window_frames{512}; // samples per model call (Silero expects 512 at 16 kHz)
+};
+
+struct vad_gate_stats {
+  uint64_t periods{0};
+  uint64_t speech_periods{0};
+  uint64_t total_frames{0};
+  uint64_t forwarded_frames{0}; // includes replayed pre-roll and hangover tails
+  uint64_t utterances{0};
+  uint64_t model_calls{0};
+};
+
+// Sits between audio_capture's callback and the recognizer. Audio is forwarded only from shortly before a
+// detected onset until hangover_ms of non-speech; the boundary callback fires when each utterance closes.
+// Not thread-safe: call process() from the capture consumer thread only.
+class vad_gate {
+public:
+  using speech_callback = std::function<void(std::span<const float> audio)>;
+  using boundary_callback = std::function<void()>;
+  using token_callback = std::function<void(std::span<const int32_t> tokens)>;
+
+  bool init(const vad_gate_config& config, speech_callback on_speech, boundary_callback on_utterance_end) noexcept;
+  // Forwards speech to rnnt.step(), hands non-empty token batches to on_tokens and, when an utterance closes,
+  // flushes rnnt.finish() the same way before rnnt.reset_state() and rnnt.commit_swap(). rnnt must outlive the
+  // gate.
+  bool init(const vad_gate_config& config, streaming_rnnt& rnnt, token_callback on_tokens) noexcept;
+
+  void process(std::span<const float> period) noexcept;
+  void reset() noexcept;
+
+  bool in_speech() const noexcept { return active_; }
+  const vad_gate_stats& stats() const noexcept { return stats_; }
+
+private:
+  bool is_speech(std::span<const float> period) noexcept;
+  void push_pre_roll(std::span<const float> period) noexcept;
+  void flush_pre_roll(size_t period_frames) noexcept;
+  void forward(std::span<const float> audio) noexcept;
+  void close_utterance() noexcept;
+
+  vad_gate_config config_{};
+  dsp::energy_vad detector_{};
+  vad_model model_{};
+  speech_callback on_speech_{};
+  boundary_callback on_utterance_end_{};
+  std::vector<int32_t> tokens_;
+  std::vector<float> pre_roll_; // ring of the most recent suppressed audio
+  size_t pre_roll_head_{0};
+  size_t pre_roll_count_{0};
+  std::vector<float> model_window_;
+  size_t model_fill_{0};
+  bool model_window_voiced_{false};
+  float model_probability_{0.0F};
+  uint64_t onset_samples_{0};
+  uint64_t hangover_samples_{0};
+  uint64_t onset_run_{0};
+  uint64_t silence_run_{0};
+  bool active_{false};
+  vad_gate_stats stats_{};
+};
+
+} // namespace jaxie::onnx
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <Jaxie/onnx/streaming_rnnt.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+
+namespace jaxie::onnx {
+
+// Small recurrent ONNX VAD (Silero-style): input 0 is audio [1, N]; an int64 input, if present, receives the
+// sample rate; any further float inputs are recurrent states fed back from the outputs in the same order.
+// Output 0 is the speech probability.
+class vad_model {
+public:
+  vad_model();
+  ~vad_model();
+
+  vad_model(const vad_model&) = delete;
+  vad_model& operator=(const vad_model&) = delete;
+  vad_model(vad_model&&) noexcept;
+  vad_model& operator=(vad_model&&) noexcept;
+
+  bool load(const std::string& path, const ep_prefs& prefs, uint32_t sample_rate_hz) noexcept;
+  bool is_loaded() const noexcept { return loaded_; }
+
+  // Speech probability in [0, 1] for one window of audio, or a negative value on failure.
+  float score(std::span<const float> window) noexcept;
+
+  void reset_state() noexcept;
+
+private:
+  struct impl;
+  std::unique_ptr<impl> pimpl_{};
+  bool loaded_{false};
+};
+
+} // namespace jaxie::onnx
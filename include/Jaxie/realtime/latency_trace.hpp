@@ -0,0 +1,139 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace jaxie::realtime {
+
+// Points on the way from the microphone to a token. An event's sample is the capture stream frame it concerns
+// (the pcm_ring frame sequence number), which is how a token is traced back to the audio that produced it.
+enum class trace_point : uint8_t {
+  device_callback, // audio arrived (ma_capture_callback, or the file replay producer); value = device frames
+  ring_commit,     // that audio, converted, is published to the capture ring; value = frames
+  consumer_wakeup, // the consumer thread acquired a period; value = frames
+  user_callback,   // capture_callback on that period (span)
+  encoder,         // one encoder Run() (span); sample = first frame of the audio being encoded
+  decode,          // decoding of the encoder's output frames (span)
+  token_emit,      // value = token id; sample = last frame of the audio it was emitted at
+};
+inline constexpr size_t trace_point_count = 7;
+
+std::string_view trace_point_name(trace_point point) noexcept;
+
+enum class trace_phase : uint8_t { instant, begin, end };
+
+struct trace_event {
+  uint64_t time_ns{0}; // trace_clock_ns()
+  uint64_t sample{0};
+  uint32_t value{0};
+  uint32_t thread{0}; // recording thread, numbered by the buffer it records into
+  trace_point point{trace_point::device_callback};
+  trace_phase phase{trace_phase::instant};
+};
+
+inline constexpr uint64_t no_trace_sample = ~uint64_t{ 0 };
+inline constexpr uint32_t default_trace_events = 1U << 16U; // per thread, ~2 MB
+inline constexpr uint32_t default_trace_threads = 4;         // device callback, consumer, decoder, caller
+
+namespace detail {
+  extern std::atomic<bool> tracing_on;
+  void record(trace_point point, trace_phase phase, uint64_t sample, uint32_t value, uint64_t time_ns) noexcept;
+} // namespace detail
+
+// Process-wide switch. While on, each thread that reaches a trace point records into its own single-writer ring
+// of events_per_thread events; events that find it full are dropped and counted. While off, a trace point is
+// one relaxed load and a branch. enable_tracing() starts a session: rings bound in earlier ones are reused once
+// drained, and rings are reserved for `threads` threads (reserve_trace_buffers).
+void enable_tracing(
+  uint32_t events_per_thread = default_trace_events, uint32_t threads = default_trace_threads) noexcept;
+void disable_tracing() noexcept;
+
+// Sets rings aside until `threads` (at most 16) wait for threads that have not traced in this session. A
+// thread's first event takes one without locking or allocating; a thread that finds none left drops its events
+// (counted in dropped_trace_events()). audio_capture::start() reserves for its device, consumer and subscriber
+// threads while tracing is on.
+void reserve_trace_buffers(uint32_t threads) noexcept;
+inline bool tracing() noexcept { return detail::tracing_on.load(std::memory_order_relaxed); }
+
+uint64_t trace_clock_ns() noexcept; // steady_clock
+
+inline void trace(trace_point point, trace_phase phase, uint64_t sample, uint32_t value = 0) noexcept {
+  if (tracing()) {
+    detail::record(point, phase, sample, value, trace_clock_ns());
+  }
+}
+
+// For callers that already read the clock.
+inline void trace_at(
+  uint64_t time_ns, trace_point point, trace_phase phase, uint64_t sample, uint32_t value = 0) noexcept {
+  if (tracing()) {
+    detail::record(point, phase, sample, value, time_ns);
+  }
+}
+
+// Begin on construction, end on destruction; nothing if tracing was off at construction.
+class trace_span {
+public:
+  trace_span(trace_point point, uint64_t sample, uint32_t value = 0) noexcept
+    : point_(point), sample_(sample), value_(value), on_(tracing()) {
+    if (on_) {
+      detail::record(point_, trace_phase::begin, sample_, value_, trace_clock_ns());
+    }
+  }
+  ~trace_span() {
+    if (on_) {
+      detail::record(point_, trace_phase::end, sample_, value_, trace_clock_ns());
+    }
+  }
+
+  trace_span(const trace_span&) = delete;
+  trace_span& operator=(const trace_span&) = delete;
+  trace_span(trace_span&&) = delete;
+  trace_span& operator=(trace_span&&) = delete;
+
+private:
+  trace_point point_;
+  uint64_t sample_;
+  uint32_t value_;
+  bool on_;
+};
+
+// Provenance for code handed audio it did not read from the ring itself: the capture frame of the first sample
+// the current thread is working on, or no_trace_sample. The capture consumer sets it around capture_callback and
+// chunk_assembler::pump around each window; streaming_rnnt reads it to stamp its events and tokens.
+void set_trace_origin(uint64_t sample) noexcept;
+uint64_t trace_origin() noexcept;
+
+// Moves every event recorded so far, from all threads, into `out` in time order. Safe while threads record.
+size_t drain_trace(std::vector<trace_event>& out);
+uint64_t dropped_trace_events() noexcept;
+
+// Latency of one stage over a trace, with a power-of-two histogram: bucket 0 counts [0, 1) us, bucket i
+// [2^(i-1), 2^i) us, the last bucket everything longer.
+struct stage_latency {
+  std::string name;
+  uint64_t count{0};
+  uint64_t p50_ns{0};
+  uint64_t p95_ns{0};
+  uint64_t p99_ns{0};
+  uint64_t max_ns{0};
+  std::array<uint64_t, 24> histogram{};
+};
+
+// Stages, each present once it has samples: "device->commit", "commit->wakeup" (ring commit of a period's last
+// frame to its acquisition), "callback", "encoder", "decode" (span lengths), and "audio->token": token_emit
+// after the device callback that delivered the token's sample, the mouth-to-token latency less what the
+// device buffers before calling back.
+std::vector<stage_latency> summarize_trace(std::span<const trace_event> events);
+
+// Chrome trace event format, which chrome://tracing and ui.perfetto.dev open: spans as B/E pairs, the other
+// points as instants, the sample and value in args.
+bool write_chrome_trace(const std::string& path, std::span<const trace_event> events) noexcept;
+
+} // namespace jaxie::realtime
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+namespace jaxie::realtime {
+
+enum class sched_policy : uint8_t {
+  inherit,     // leave the thread on the default time-sharing scheduler
+  fifo,        // SCHED_FIFO
+  round_robin, // SCHED_RR
+};
+
+// Scheduling for one latency-critical thread. Everything defaults to "leave it alone".
+struct thread_tuning {
+  sched_policy policy{sched_policy::inherit};
+  int priority{0};     // clamped to the policy's range; 0 picks its minimum
+  uint64_t cpu_mask{0}; // bit N allows CPU N; 0 keeps the inherited affinity
+  bool prefault_stack{false}; // touch stack_prefault_bytes of stack when the thread starts
+
+  bool requested() const noexcept { return policy != sched_policy::inherit || cpu_mask != 0 || prefault_stack; }
+};
+
+inline constexpr size_t stack_prefault_bytes = 256U * 1024U;
+
+// What was applied. Errors are errno values (EPERM without CAP_SYS_NICE or an RLIMIT_RTPRIO/RLIMIT_MEMLOCK
+// allowance, ENOTSUP off Linux); 0 means applied or not requested. Failures never stop the caller.
+struct tuning_report {
+  int scheduling_error{0};
+  int affinity_error{0};
+  int memory_lock_error{0};
+  bool scheduling_applied{false};
+  bool affinity_applied{false};
+  bool memory_locked{false};
+
+  bool ok() const noexcept { return scheduling_error == 0 && affinity_error == 0 && memory_lock_error == 0; }
+};
+
+// Scheduling and affinity can be set on another thread; stack prefaulting has to run on the thread itself.
+tuning_report apply(std::thread& thread, const thread_tuning& tuning) noexcept;
+tuning_report apply_to_current_thread(const thread_tuning& tuning) noexcept;
+void prefault_stack() noexcept;
+
+// mlockall(MCL_CURRENT | MCL_FUTURE): faults in and pins every current and future mapping so the audio path
+// never waits on a page fault. Process-wide and never undone by this library.
+bool lock_process_memory(tuning_report& report) noexcept;
+
+// Keeps the first error of each kind and ORs the applied flags.
+void merge(tuning_report& into, const tuning_report& from) noexcept;
+
+// One line per failure, e.g. "scheduling: Operation not permitted"; empty when report.ok().
+std::string describe(const tuning_report& report);
+
+} // namespace jaxie::realtime
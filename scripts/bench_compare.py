@@ -0,0 +1,94 @@
+#!/usr/bin/env python3
+"""Compare jaxie_bench JSON results against a baseline and flag regressions.
+
+    jaxie_bench --json current.json
+    scripts/bench_compare.py baseline.json current.json [--metric p50] [--threshold 0.10]
+
+A benchmark regresses when its metric (time per iteration, lower is better) grows by more than the threshold,
+or when one of the counters that must not grow (allocations, drops, overruns) does. Benchmarks missing from
+either side are listed but only fail the comparison with --strict. Exit status: 0 clean, 1 regressions,
+2 unreadable input.
+
+Baselines are per machine, so none is committed: capture one on the machine that will run the comparison with
+    jaxie_bench --json baseline.json
+from a Release build without sanitizers, on the commit to compare against. A baseline captured without ONNX
+Runtime (context "onnxruntime": false) has no rnnt/ entries, so those are reported as new and not compared.
+"""
+
+import argparse
+import json
+import sys
+
+# Counters where any increase over the baseline is a regression regardless of timing.
+MUST_NOT_GROW = ("bytes_allocated", "dropped_frames", "dropped_events", "overruns")
+
+
+def load(path):
+    try:
+        with open(path, encoding="utf-8") as f:
+            data = json.load(f)
+        return data.get("context", {}), {b["name"]: b for b in data["benchmarks"]}
+    except (OSError, ValueError, KeyError, TypeError) as error:
+        print(f"cannot read {path}: {error}", file=sys.stderr)
+        sys.exit(2)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("baseline", help="jaxie_bench --json output from the same machine")
+    parser.add_argument("current")
+    parser.add_argument("--metric", default="p50", choices=("mean", "p50", "p95", "p99", "min", "max"))
+    parser.add_argument("--threshold", type=float, default=0.10, help="allowed relative slowdown (0.10 = 10%%)")
+    parser.add_argument("--strict", action="store_true", help="benchmarks missing from current also fail")
+    args = parser.parse_args()
+
+    base_context, baseline = load(args.baseline)
+    context, current = load(args.current)
+    for key in sorted(set(base_context) | set(context)):
+        if base_context.get(key) != context.get(key):
+            print(f"warning: context {key} differs: baseline {base_context.get(key)}, current {context.get(key)}")
+
+    if not base_context.get("onnxruntime", True) and context.get("onnxruntime", False):
+        print("warning: the baseline was captured without ONNX Runtime; rnnt/ benchmarks are not compared")
+
+    regressions = []
+    print(f"{'benchmark':<44} {'baseline':>12} {'current':>12} {'change':>8}")
+    for name, now in current.items():
+        before = baseline.get(name)
+        if before is None:
+            print(f"{name:<44} {'-':>12} {now[args.metric]:>12.1f}      new")
+            continue
+        old, new = before[args.metric], now[args.metric]
+        change = (new - old) / old if old else 0.0
+        verdict = ""
+        if change > args.threshold:
+            verdict = "  REGRESSION"
+            regressions.append(name)
+        elif change < -args.threshold:
+            verdict = "  improved"
+        print(f"{name:<44} {old:>12.1f} {new:>12.1f} {change:>+7.1%}{verdict}")
+
+        for counter in MUST_NOT_GROW:
+            was = before.get("counters", {}).get(counter)
+            is_now = now.get("counters", {}).get(counter)
+            if was is not None and is_now is not None and is_now > was:
+                print(f"{'':<44} {counter} {was:g} -> {is_now:g}  REGRESSION")
+                regressions.append(f"{name} ({counter})")
+
+    missing = sorted(set(baseline) - set(current))
+    for name in missing:
+        print(f"{name:<44} {baseline[name][args.metric]:>12.1f} {'-':>12}  missing")
+    if args.strict:
+        regressions.extend(f"{name} (missing)" for name in missing)
+
+    if regressions:
+        print(f"\n{len(regressions)} regression(s) in {args.metric} beyond {args.threshold:.0%}:")
+        for name in regressions:
+            print(f"  {name}")
+        return 1
+    print(f"\nno regressions in {args.metric} beyond {args.threshold:.0%}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
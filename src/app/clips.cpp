@@ -0,0 +1,55 @@
+#include "clips.hpp"
+
+#include <Jaxie/audio/wav_file.hpp>
+#include <Jaxie/dsp/resampler.hpp>
+
+#include <algorithm>
+#include <filesystem>
+#include <span>
+#include <string_view>
+#include <system_error>
+
+namespace jaxie::app {
+
+bool load_clip(const std::string& path, audio_clip& out) {
+  audio::pcm_clip clip;
+  if (!audio::load_wav(path, clip)) {
+    return false;
+  }
+  dsp::stream_converter converter;
+  if (!converter.init({ .in_rate_hz = clip.sample_rate_hz,
+                        .in_channels = clip.channels,
+                        .out_rate_hz = model_rate_hz,
+                        .out_channels = 1,
+                        .quality = dsp::resample_quality::high,
+                        .max_block_frames = 4096 })) {
+    return false;
+  }
+  out.name = path;
+  out.samples.resize(converter.max_output_frames(clip.frames()) + converter.flush_frames());
+  size_t produced = converter.process(clip.samples, out.samples);
+  // Without the resampler's tail the clip would lose its last few milliseconds.
+  produced += converter.flush(std::span(out.samples).subspan(produced));
+  out.samples.resize(produced);
+  return !out.samples.empty();
+}
+
+std::vector<std::string> collect_clip_paths(std::span<char*> args, size_t first) {
+  std::vector<std::string> files;
+  for (size_t i = first; i < args.size() && args[i] != nullptr && !std::string_view(args[i]).starts_with("--"); ++i) {
+    std::error_code error;
+    if (std::filesystem::is_directory(args[i], error)) {
+      for (const auto& entry : std::filesystem::directory_iterator(args[i], error)) {
+        if (entry.path().extension() == ".wav") {
+          files.push_back(entry.path().string());
+        }
+      }
+    } else {
+      files.emplace_back(args[i]);
+    }
+  }
+  std::sort(files.begin(), files.end());
+  return files;
+}
+
+} // namespace jaxie::app
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace jaxie::app {
+
+inline constexpr uint32_t model_rate_hz = 16000;
+
+struct audio_clip {
+  std::string name;
+  std::vector<float> samples; // mono at model_rate_hz
+};
+
+// A WAV file converted to what the recognizer takes.
+bool load_clip(const std::string& path, audio_clip& out);
+
+// Arguments from `first` up to the next flag: WAV files, or directories whose .wav files are taken. Sorted.
+std::vector<std::string> collect_clip_paths(std::span<char*> args, size_t first);
+
+} // namespace jaxie::app
@@ -0,0 +1,115 @@
+#include "latency_report.hpp"
+
+#include "clips.hpp"
+
+#include <Jaxie/audio/capture.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace jaxie::app {
+namespace {
+
+constexpr uint32_t period_samples = 1600; // 100 ms, as run_profile() steps
+
+double to_ms(uint64_t ns) { return static_cast<double>(ns) / 1e6; }
+
+// Bucket i of stage_latency::histogram ends at 2^i us.
+void print_histogram(const realtime::stage_latency& stage, std::ostream& out) {
+  const auto& buckets = stage.histogram;
+  const auto busiest = *std::max_element(buckets.begin(), buckets.end());
+  constexpr uint64_t bar_width = 40;
+  for (size_t i = 0; i < buckets.size(); ++i) {
+    if (buckets[i] == 0) {
+      continue;
+    }
+    const uint64_t upper_us = uint64_t{ 1 } << i;
+    out << "    < " << std::setw(9) << upper_us << " us " << std::setw(7) << buckets[i] << ' '
+        << std::string(static_cast<size_t>((std::max)(buckets[i] * bar_width / busiest, uint64_t{ 1 })), '#')
+        << '\n';
+  }
+}
+
+} // namespace
+
+void print_latency(std::span<const realtime::stage_latency> stages, std::ostream& out) {
+  out << std::fixed << std::setprecision(3) << std::left << std::setw(16) << "stage" << std::right << std::setw(8)
+      << "count" << std::setw(10) << "p50 ms" << std::setw(10) << "p95 ms" << std::setw(10) << "p99 ms"
+      << std::setw(10) << "max ms" << '\n';
+  for (const auto& stage : stages) {
+    out << std::left << std::setw(16) << stage.name << std::right << std::setw(8) << stage.count << std::setw(10)
+        << to_ms(stage.p50_ns) << std::setw(10) << to_ms(stage.p95_ns) << std::setw(10) << to_ms(stage.p99_ns)
+        << std::setw(10) << to_ms(stage.max_ns) << '\n';
+    print_histogram(stage, out);
+  }
+}
+
+int run_latency_trace(onnx::streaming_rnnt& rnnt, const std::string& wav, const std::string& trace_out) {
+  audio::capture_config config{};
+  config.sample_rate_hz = model_rate_hz;
+  config.channels = 1;
+  config.period_frames = period_samples;
+  config.source = audio::capture_source::file;
+  config.replay_path = wav;
+  config.pacing = audio::replay_pacing::realtime;
+
+  std::vector<int32_t> emitted;
+  emitted.reserve(256);
+  std::atomic<bool> failed{false};
+  audio::audio_capture capture;
+  const bool ready = capture.init(config, [&](std::span<const float> period) {
+    if (!rnnt.step(period, emitted)) {
+      failed.store(true, std::memory_order_relaxed);
+    }
+  });
+  if (!ready) {
+    std::cerr << "cannot replay " << wav << '\n';
+    return EXIT_FAILURE;
+  }
+
+  realtime::enable_tracing();
+  if (!capture.start()) {
+    realtime::disable_tracing();
+    std::cerr << "cannot start the replay of " << wav << '\n';
+    return EXIT_FAILURE;
+  }
+  while (!capture.stats().end_of_stream && !failed.load(std::memory_order_relaxed)) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  capture.stop();
+  realtime::disable_tracing();
+  static_cast<void>(rnnt.finish(emitted));
+  if (failed.load(std::memory_order_relaxed)) {
+    std::cerr << "decoding failed\n";
+    return EXIT_FAILURE;
+  }
+
+  std::vector<realtime::trace_event> events;
+  realtime::drain_trace(events);
+  const auto stages = realtime::summarize_trace(events);
+  std::cout << events.size() << " events";
+  if (const uint64_t dropped = realtime::dropped_trace_events(); dropped != 0) {
+    std::cout << " (" << dropped << " dropped: the per-thread buffers were full)";
+  }
+  std::cout << ", " << (period_samples * 1000 / model_rate_hz) << " ms periods\n";
+  print_latency(stages, std::cout);
+  if (!trace_out.empty()) {
+    if (!realtime::write_chrome_trace(trace_out, events)) {
+      std::cerr << "cannot write " << trace_out << '\n';
+      return EXIT_FAILURE;
+    }
+    std::cout << "trace: " << trace_out << '\n';
+  }
+  return EXIT_SUCCESS;
+}
+
+} // namespace jaxie::app
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <Jaxie/onnx/streaming_rnnt.hpp>
+#include <Jaxie/realtime/latency_trace.hpp>
+
+#include <ostream>
+#include <span>
+#include <string>
+
+namespace jaxie::app {
+
+// One line per stage (count, p50/p95/p99/max in ms) followed by its histogram over the non-empty buckets.
+void print_latency(std::span<const realtime::stage_latency> stages, std::ostream& out);
+
+// --trace-latency <wav> [--trace-out FILE]: replays the clip through the capture path in real time, as a
+// microphone would deliver it, into rnnt.step() with tracing on, then prints each stage's latency and writes the
+// Chrome trace to trace_out when given.
+int run_latency_trace(onnx::streaming_rnnt& rnnt, const std::string& wav, const std::string& trace_out);
+
+} // namespace jaxie::app
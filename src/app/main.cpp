@@ -3,11 +3,23 @@
 #include <string>
 #include <vector>
 #include <internal_use_only/config.hpp>
+#include <Jaxie/onnx/model_bundle.hpp>
+#include <Jaxie/onnx/model_precision.hpp>
 #include <Jaxie/onnx/streaming_rnnt.hpp>
 #include <cstdlib>
+#include <fstream>
 #include <iostream>
 #include <span>
 #include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+#include "latency_report.hpp"
+#include "precision_bench.hpp"
+#include "profile_report.hpp"
+#include "transcribe.hpp"
 
 using std::string;
 using std::string_view;
@@ -36,34 +48,280 @@ static std::vector<string> collect_ep_order(std::span<char*> args) {
   return order;
 }
 
-static int run_rnnt_load(std::span<char*> args, const std::vector<string>& ep_order) {
-  for (size_t i = 1; i + 3 < args.size(); ++i) {
+static bool parse_count(string_view text, uint32_t& value) {
+  const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+  return error == std::errc{} && end == text.data() + text.size();
+}
+
+// --threads N, --inter-threads N, --parallel, --no-spin, --opt-level <none|basic|extended|all>, --model-cache DIR,
+// --isolated (per-session thread pools and prepacked weights, as separate processes would have), --profile-dir DIR
+static bool collect_session_config(std::span<char*> args, jaxie::onnx::session_config& config) {
+  for (size_t i = 1; i < args.size(); ++i) {
     const string_view arg_sv{args[i] != nullptr ? args[i] : ""};
-    if (arg_sv == "--rnnt-load") {
-      const char* enc = args[i + 1];
-      const char* pred = args[i + 2];
-      const char* joint = args[i + 3];
-      jaxie::onnx::streaming_rnnt rnnt; // NOLINT(misc-const-correctness)
-      const jaxie::onnx::rnnt_model_paths paths{
-        .encoder = string(enc),
-        .predictor = string(pred),
-        .joint = string(joint)};
-      const jaxie::onnx::ep_prefs prefs{ep_order};
+    const bool has_value = (i + 1) < args.size() && args[i + 1] != nullptr;
+    const string_view value{has_value ? args[i + 1] : ""};
+    if (arg_sv == "--parallel") {
+      config.parallel_execution = true;
+    } else if (arg_sv == "--no-spin") {
+      config.allow_spinning = false;
+    } else if (arg_sv == "--isolated") {
+      config.global_thread_pools = false;
+      config.share_prepacked_weights = false;
+    } else if (arg_sv == "--threads" || arg_sv == "--inter-threads") {
+      if (!parse_count(value, arg_sv == "--threads" ? config.intra_op_threads : config.inter_op_threads)) {
+        std::cerr << arg_sv << " needs a thread count\n";
+        return false;
+      }
+      ++i;
+    } else if (arg_sv == "--opt-level") {
+      if (value == "none") {
+        config.optimization = jaxie::onnx::graph_optimization::none;
+      } else if (value == "basic") {
+        config.optimization = jaxie::onnx::graph_optimization::basic;
+      } else if (value == "extended") {
+        config.optimization = jaxie::onnx::graph_optimization::extended;
+      } else if (value == "all") {
+        config.optimization = jaxie::onnx::graph_optimization::all;
+      } else {
+        std::cerr << "--opt-level takes none, basic, extended or all\n";
+        return false;
+      }
+      ++i;
+    } else if (arg_sv == "--model-cache") {
+      if (value.empty()) {
+        std::cerr << "--model-cache needs a directory\n";
+        return false;
+      }
+      config.cache_dir = string(value);
+      ++i;
+    } else if (arg_sv == "--profile-dir") {
+      if (value.empty()) {
+        std::cerr << "--profile-dir needs a directory\n";
+        return false;
+      }
+      config.profile_dir = string(value);
+      ++i;
+    }
+  }
+  return true;
+}
+
 #if defined(JAXIE_USE_ONNXRUNTIME)
-      const bool ok = rnnt.load(paths, prefs);
-      if (!ok) {
-        std::cerr << "Failed to load RNNT ONNX sessions\n";
+// Resident set size ("VmRSS") or its peak ("VmHWM") in KiB; 0 where /proc is unavailable.
+static uint64_t read_memory_kib(string_view field) {
+  std::ifstream status("/proc/self/status");
+  string line;
+  while (std::getline(status, line)) {
+    if (line.starts_with(field) && line.size() > field.size() && line[field.size()] == ':') {
+      uint64_t kib = 0;
+      const string_view value = string_view(line).substr(field.size() + 1);
+      const auto start = value.find_first_not_of(" \t");
+      if (start != string_view::npos) {
+        std::from_chars(value.data() + start, value.data() + value.size(), kib);
+      }
+      return kib;
+    }
+  }
+  return 0;
+}
+
+static uint64_t grown_mib(uint64_t after_kib, uint64_t before_kib) {
+  return ((std::max)(after_kib, before_kib) - before_kib) / 1024;
+}
+#endif
+
+static string flag_value(std::span<char*> args, string_view flag) {
+  for (size_t i = 1; i + 1 < args.size(); ++i) {
+    if (string_view{args[i] != nullptr ? args[i] : ""} == flag && args[i + 1] != nullptr) {
+      return args[i + 1];
+    }
+  }
+  return {};
+}
+
+// --pack-bundle <out> <encoder> <predictor> <joint> [--vocab FILE]
+static int run_pack_bundle(std::span<char*> args) {
+  for (size_t i = 1; i + 4 < args.size(); ++i) {
+    const string_view arg_sv{args[i] != nullptr ? args[i] : ""};
+    if (arg_sv == "--pack-bundle") {
+      const jaxie::onnx::rnnt_model_paths graphs{
+        .encoder = string(args[i + 2]),
+        .predictor = string(args[i + 3]),
+        .joint = string(args[i + 4])};
+      if (!jaxie::onnx::write_model_bundle(args[i + 1], graphs, flag_value(args, "--vocab"))) {
+        std::cerr << "Failed to write model bundle " << args[i + 1] << '\n';
         return EXIT_FAILURE;
       }
-      std::cout << "RNNT sessions loaded\n";
+      std::cout << "wrote " << args[i + 1] << '\n';
       return EXIT_SUCCESS;
-#else
-      std::cerr << "ONNX Runtime disabled at build time\n";
+    }
+  }
+  return EXIT_SUCCESS;
+}
+
+// --rnnt-load <encoder> <predictor> <joint>, or --rnnt-dir DIR: the precision variants in DIR resolved for the first
+// provider of the EP order this build offers (onnx::select_precision with the default policy). The choice goes to
+// `log`; when DIR holds no complete model the paths stay empty, so the load that follows fails.
+static bool collect_model_paths(std::span<char*> args,
+                                const std::vector<string>& ep_order,
+                                jaxie::onnx::rnnt_model_paths& paths,
+                                std::ostream& log) {
+  for (size_t i = 1; i + 3 < args.size(); ++i) {
+    if (string_view{args[i] != nullptr ? args[i] : ""} == "--rnnt-load") {
+      paths.encoder = string(args[i + 1]);
+      paths.predictor = string(args[i + 2]);
+      paths.joint = string(args[i + 3]);
+      return true;
+    }
+  }
+  const string dir = flag_value(args, "--rnnt-dir");
+  if (dir.empty()) {
+    return false;
+  }
+  jaxie::onnx::precision_choice choice{};
+  const jaxie::onnx::ep_prefs prefs{.providers = ep_order, .session = {}};
+  if (!jaxie::onnx::select_precision(jaxie::onnx::find_model_variants(dir), prefs, {}, paths, &choice)) {
+    std::cerr << "no encoder/predictor/joint models in " << dir << '\n';
+    return true;
+  }
+  log << "models from " << dir << " for " << choice.provider << ": " << jaxie::onnx::describe_precision(choice) << '\n';
+  return true;
+}
+
+static int run_rnnt_load(std::span<char*> args, const std::vector<string>& ep_order) {
+  jaxie::onnx::rnnt_model_paths paths{};
+  const string bundle_path = flag_value(args, "--rnnt-bundle");
+  if (!collect_model_paths(args, ep_order, paths, std::cout) && bundle_path.empty()) {
+    return EXIT_SUCCESS;
+  }
+  jaxie::onnx::ep_prefs prefs{.providers = ep_order, .session = {}};
+  if (!collect_session_config(args, prefs.session)) {
+    return EXIT_FAILURE;
+  }
+  const string profile_wav = flag_value(args, "--profile");
+  prefs.session.profiling = !profile_wav.empty();
+  uint32_t instances = 1;
+  const string instances_text = flag_value(args, "--instances");
+  if (!instances_text.empty() && (!parse_count(instances_text, instances) || instances == 0)) {
+    std::cerr << "--instances needs a positive count\n";
+    return EXIT_FAILURE;
+  }
+  // Per-session settings also size the shared pools when those are used.
+  static_cast<void>(jaxie::onnx::configure_runtime({.intra_op_threads = prefs.session.intra_op_threads,
+                                                    .inter_op_threads = prefs.session.inter_op_threads,
+                                                    .allow_spinning = prefs.session.allow_spinning}));
+#if defined(JAXIE_USE_ONNXRUNTIME)
+  const uint64_t rss_before = read_memory_kib("VmRSS");
+  const auto opened = std::chrono::steady_clock::now();
+  if (!bundle_path.empty()) {
+    auto bundle = std::make_shared<jaxie::onnx::model_bundle>();
+    if (!bundle->open(bundle_path, has_flag(args, "--verify", "--verify"))) {
+      std::cerr << "Failed to open model bundle " << bundle_path << '\n';
       return EXIT_FAILURE;
-#endif
     }
+    std::cout << "bundle " << (bundle->is_mapped() ? "mapped" : "read") << ", " << bundle->vocab().size()
+              << " vocabulary pieces, opened in "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - opened).count()
+              << " ms\n";
+    paths.bundle = std::move(bundle);
+  }
+
+  // Several instances of one model show what each extra stream costs in startup time and resident memory.
+  std::vector<jaxie::onnx::streaming_rnnt> models(instances);
+  uint64_t rss_first = 0;
+  uint64_t later_load_ns = 0;
+  for (size_t n = 0; n < models.size(); ++n) {
+    if (!models[n].load(paths, prefs)) {
+      std::cerr << "Failed to load RNNT ONNX sessions\n";
+      return EXIT_FAILURE;
+    }
+    if (n == 0) {
+      rss_first = read_memory_kib("VmRSS");
+    } else {
+      later_load_ns += models[n].stats().load_ns;
+    }
+  }
+  const auto stats = models.front().stats();
+  std::cout << "RNNT sessions loaded in " << (stats.load_ns / 1000000) << " ms (" << stats.cached_sessions
+            << " of 3 from the model cache)\n";
+  if (rss_before != 0) {
+    std::cout << "resident: +" << grown_mib(rss_first, rss_before) << " MiB for the first instance, peak "
+              << (read_memory_kib("VmHWM") / 1024) << " MiB\n";
+  }
+  if (instances > 1) {
+    const uint64_t extra = instances - 1U;
+    std::cout << "each further instance: " << (later_load_ns / extra / 1000000) << " ms";
+    if (rss_before != 0) {
+      std::cout << ", +" << (grown_mib(read_memory_kib("VmRSS"), rss_first) / extra) << " MiB resident";
+    }
+    std::cout << '\n';
   }
+  if (!profile_wav.empty()) {
+    return jaxie::app::run_profile(models.front(), profile_wav);
+  }
+  const string trace_wav = flag_value(args, "--trace-latency");
+  if (!trace_wav.empty()) {
+    return jaxie::app::run_latency_trace(models.front(), trace_wav, flag_value(args, "--trace-out"));
+  }
+  jaxie::app::print_placement(models.front().placement(), std::cout);
   return EXIT_SUCCESS;
+#else
+  std::cerr << "ONNX Runtime disabled at build time\n";
+  return EXIT_FAILURE;
+#endif
+}
+
+static int run_precision_bench(std::span<char*> args, const std::vector<string>& ep_order) {
+#if defined(JAXIE_USE_ONNXRUNTIME)
+  jaxie::onnx::ep_prefs prefs{.providers = ep_order, .session = {}};
+  if (!collect_session_config(args, prefs.session)) {
+    return EXIT_FAILURE;
+  }
+  return jaxie::app::run_precision_bench(args, prefs);
+#else
+  static_cast<void>(args);
+  static_cast<void>(ep_order);
+  std::cerr << "ONNX Runtime disabled at build time\n";
+  return EXIT_FAILURE;
+#endif
+}
+
+static int run_transcribe(std::span<char*> args, const std::vector<string>& ep_order) {
+#if defined(JAXIE_USE_ONNXRUNTIME)
+  jaxie::onnx::rnnt_model_paths paths{};
+  const string bundle_path = flag_value(args, "--rnnt-bundle");
+  // The JSON lines may go to stdout, so the precision choice is logged with the summary on stderr.
+  if (!collect_model_paths(args, ep_order, paths, std::cerr) && bundle_path.empty()) {
+    std::cerr << "--transcribe needs --rnnt-load <encoder> <predictor> <joint>, --rnnt-dir DIR or --rnnt-bundle FILE\n";
+    return EXIT_FAILURE;
+  }
+  jaxie::onnx::ep_prefs prefs{.providers = ep_order, .session = {}};
+  if (!collect_session_config(args, prefs.session)) {
+    return EXIT_FAILURE;
+  }
+  // The workers are the parallelism: unless --threads says otherwise, each Run() stays on its caller's thread
+  // rather than every stream fanning out over one intra-op pool.
+  if (prefs.session.intra_op_threads == 0) {
+    prefs.session.intra_op_threads = 1;
+  }
+  static_cast<void>(jaxie::onnx::configure_runtime({.intra_op_threads = prefs.session.intra_op_threads,
+                                                    .inter_op_threads = prefs.session.inter_op_threads,
+                                                    .allow_spinning = prefs.session.allow_spinning}));
+  if (!bundle_path.empty()) {
+    auto bundle = std::make_shared<jaxie::onnx::model_bundle>();
+    if (!bundle->open(bundle_path, has_flag(args, "--verify", "--verify"))) {
+      std::cerr << "Failed to open model bundle " << bundle_path << '\n';
+      return EXIT_FAILURE;
+    }
+    paths.bundle = std::move(bundle);
+  }
+  return jaxie::app::run_transcribe(args, paths, prefs);
+#else
+  static_cast<void>(args);
+  static_cast<void>(ep_order);
+  std::cerr << "ONNX Runtime disabled at build time\n";
+  return EXIT_FAILURE;
+#endif
 }
 
 int main(int argc, char** argv) noexcept
@@ -76,10 +334,28 @@ int main(int argc, char** argv) noexcept
     }
     if (has_flag(args, "--help", "-h")) {
       std::cout << "jaxie agent CLI\n";
-      std::cout << "Usage: jaxie [--help] [--version] [--ep <CPU|CUDA|TensorRT>] --rnnt-load <encoder> <predictor> <joint>\n";
+      std::cout << "Usage: jaxie [--help] [--version] [--ep <CPU|CUDA|TensorRT>] [--threads N] [--inter-threads N] "
+                   "[--parallel] [--no-spin] [--opt-level <none|basic|extended|all>] [--model-cache DIR] [--isolated] "
+                   "[--instances N] [--verify] [--profile <wav> [--profile-dir DIR]] "
+                   "[--trace-latency <wav> [--trace-out FILE]] "
+                   "(--rnnt-load <encoder> <predictor> <joint> | --rnnt-dir DIR | --rnnt-bundle FILE)\n";
+      std::cout << "       jaxie --pack-bundle <out> <encoder> <predictor> <joint> [--vocab FILE]\n";
+      std::cout << "       jaxie [--ep ...] [--threads N] --precision-bench <model dir> <wav|dir>...\n";
+      std::cout << "       jaxie [--ep ...] [--threads N] (--rnnt-load ... | --rnnt-dir DIR | --rnnt-bundle FILE) "
+                   "--transcribe <wav|dir>... [--workers N] [--out FILE] [--vocab FILE]\n";
       return EXIT_SUCCESS;
     }
+    const int pack_rc = run_pack_bundle(args);
+    if (pack_rc != EXIT_SUCCESS) {
+      return pack_rc;
+    }
     const auto ep_order = collect_ep_order(args);
+    if (has_flag(args, "--precision-bench", "--precision-bench")) {
+      return run_precision_bench(args, ep_order);
+    }
+    if (has_flag(args, "--transcribe", "--transcribe")) {
+      return run_transcribe(args, ep_order);
+    }
     const int rnnt_rc = run_rnnt_load(args, ep_order);
     if (rnnt_rc != EXIT_SUCCESS) {
       return rnnt_rc;
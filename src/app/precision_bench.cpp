@@ -0,0 +1,187 @@
+#include "precision_bench.hpp"
+
+#include "clips.hpp"
+
+#include <Jaxie/onnx/model_precision.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace jaxie::app {
+namespace {
+
+constexpr size_t step_samples = 1600; // 100 ms, as the capture path delivers it
+
+struct bench_config {
+  std::string label;
+  onnx::rnnt_model_paths paths;
+  onnx::precision_choice choice;
+};
+
+struct bench_run {
+  std::vector<std::vector<int32_t>> tokens; // per clip
+  double decode_seconds{0.0};
+  uint64_t load_ns{0};
+};
+
+bool collect_clips(std::span<char*> args, size_t first, std::vector<audio_clip>& clips) {
+  for (const auto& file : collect_clip_paths(args, first)) {
+    audio_clip clip;
+    if (!load_clip(file, clip)) {
+      std::cerr << "cannot read " << file << '\n';
+      return false;
+    }
+    clips.push_back(std::move(clip));
+  }
+  return !clips.empty();
+}
+
+bool decode_clips(
+  const bench_config& config,
+  const onnx::ep_prefs& prefs,
+  const std::vector<audio_clip>& clips,
+  bench_run& out) {
+  onnx::streaming_rnnt rnnt;
+  if (!rnnt.load(config.paths, prefs)) {
+    return false;
+  }
+  out.load_ns = rnnt.stats().load_ns;
+  std::vector<int32_t> emitted;
+  emitted.reserve(256);
+  const auto started = std::chrono::steady_clock::now();
+  for (const auto& clip : clips) {
+    auto& tokens = out.tokens.emplace_back();
+    rnnt.reset_state();
+    for (size_t at = 0; at < clip.samples.size(); at += step_samples) {
+      const size_t count = (std::min)(step_samples, clip.samples.size() - at);
+      emitted.clear();
+      if (!rnnt.step(std::span(clip.samples).subspan(at, count), emitted)) {
+        return false;
+      }
+      tokens.insert(tokens.end(), emitted.begin(), emitted.end());
+    }
+    emitted.clear();
+    if (!rnnt.finish(emitted)) {
+      return false;
+    }
+    tokens.insert(tokens.end(), emitted.begin(), emitted.end());
+  }
+  out.decode_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+  return true;
+}
+
+size_t edit_distance(std::span<const int32_t> a, std::span<const int32_t> b) {
+  std::vector<size_t> previous(b.size() + 1);
+  std::vector<size_t> current(b.size() + 1);
+  for (size_t j = 0; j <= b.size(); ++j) {
+    previous[j] = j;
+  }
+  for (size_t i = 1; i <= a.size(); ++i) {
+    current[0] = i;
+    for (size_t j = 1; j <= b.size(); ++j) {
+      const size_t substitute = previous[j - 1] + (a[i - 1] == b[j - 1] ? 0U : 1U);
+      current[j] = (std::min)({ previous[j] + 1, current[j - 1] + 1, substitute });
+    }
+    std::swap(previous, current);
+  }
+  return previous[b.size()];
+}
+
+// 1 - token edit distance / reference tokens, over all clips.
+double agreement(const bench_run& reference, const bench_run& run) {
+  size_t distance = 0;
+  size_t total = 0;
+  for (size_t c = 0; c < reference.tokens.size(); ++c) {
+    distance += edit_distance(reference.tokens[c], run.tokens[c]);
+    total += reference.tokens[c].size();
+  }
+  if (total == 0) {
+    return distance == 0 ? 1.0 : 0.0;
+  }
+  return (std::max)(0.0, 1.0 - (static_cast<double>(distance) / static_cast<double>(total)));
+}
+
+} // namespace
+
+int run_precision_bench(std::span<char*> args, const onnx::ep_prefs& prefs) {
+  size_t at = 1;
+  while (at + 1 < args.size() && std::string_view(args[at] != nullptr ? args[at] : "") != "--precision-bench") {
+    ++at;
+  }
+  if (at + 2 >= args.size() || args[at + 1] == nullptr) {
+    std::cerr << "--precision-bench needs a model directory and at least one WAV file or directory\n";
+    return EXIT_FAILURE;
+  }
+  const auto variants = onnx::find_model_variants(args[at + 1]);
+  std::vector<audio_clip> clips;
+  if (!collect_clips(args, at + 2, clips)) {
+    std::cerr << "no clips to decode\n";
+    return EXIT_FAILURE;
+  }
+  double audio_seconds = 0.0;
+  for (const auto& clip : clips) {
+    audio_seconds += static_cast<double>(clip.samples.size()) / model_rate_hz;
+  }
+
+  // Uniform fp32 / fp16 / int8, then what the default policy picks for this EP order; duplicates are skipped.
+  std::vector<bench_config> configs;
+  const auto add = [&](std::string label, const onnx::precision_policy& policy) {
+    bench_config config{ .label = std::move(label), .paths = {}, .choice = {} };
+    if (!onnx::select_precision(variants, prefs, policy, config.paths, &config.choice)) {
+      return;
+    }
+    const bool seen = std::any_of(configs.begin(), configs.end(), [&](const bench_config& other) {
+      return other.paths.encoder == config.paths.encoder && other.paths.predictor == config.paths.predictor
+             && other.paths.joint == config.paths.joint;
+    });
+    if (!seen) {
+      configs.push_back(std::move(config));
+    }
+  };
+  using onnx::model_precision;
+  for (const auto precision : { model_precision::fp32, model_precision::fp16, model_precision::int8 }) {
+    const onnx::component_precision uniform{ .gpu = precision, .cpu = precision };
+    add(onnx::precision_name(precision), { .encoder = uniform, .predictor = uniform, .joint = uniform });
+  }
+  add("policy", {});
+  if (configs.empty()) {
+    std::cerr << "no encoder/predictor/joint models in " << args[at + 1] << '\n';
+    return EXIT_FAILURE;
+  }
+
+  // Agreement is measured against the uniform fp32 run, which comes first. Without an fp32 file for every
+  // component it falls back to other variants and is no reference.
+  const bool has_reference = configs.front().choice.all_fp32();
+  std::cout << clips.size() << " clips, " << std::fixed << std::setprecision(1) << audio_seconds << " s of audio, on "
+            << configs.front().choice.provider << '\n';
+  if (!has_reference) {
+    std::cout << "no fp32 variant of every component: token agreement is not reported\n";
+  }
+  std::vector<bench_run> runs(configs.size());
+  for (size_t c = 0; c < configs.size(); ++c) {
+    if (!decode_clips(configs[c], prefs, clips, runs[c])) {
+      std::cerr << configs[c].label << ": failed to load or decode (" << onnx::describe_precision(configs[c].choice)
+                << ")\n";
+      return EXIT_FAILURE;
+    }
+    std::cout << std::left << std::setw(7) << configs[c].label << std::right << "  load " << std::setw(6)
+              << (runs[c].load_ns / 1000000) << " ms  RTF " << std::setprecision(4)
+              << (runs[c].decode_seconds / audio_seconds);
+    if (has_reference) {
+      std::cout << "  agreement " << std::setprecision(2) << (100.0 * agreement(runs.front(), runs[c])) << '%';
+    }
+    std::cout << "  (" << onnx::describe_precision(configs[c].choice) << ")\n";
+    std::cout << std::setprecision(1);
+  }
+  return EXIT_SUCCESS;
+}
+
+} // namespace jaxie::app
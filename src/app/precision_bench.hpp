@@ -0,0 +1,15 @@
+#pragma once
+
+#include <Jaxie/onnx/streaming_rnnt.hpp>
+
+#include <span>
+
+namespace jaxie::app {
+
+// --precision-bench <model dir> <wav | dir of wavs>...: decodes the clips with the fp32, fp16 and int8 variants
+// found in the model directory (see onnx::find_model_variants) and with the precisions select_precision() picks
+// for the EP order, through the same streaming step() path used live. Reports load time, real-time factor and
+// token agreement with fp32 for each; agreement is left out when some component has no fp32 file.
+int run_precision_bench(std::span<char*> args, const onnx::ep_prefs& prefs);
+
+} // namespace jaxie::app
@@ -0,0 +1,108 @@
+#include "profile_report.hpp"
+
+#include "clips.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace jaxie::app {
+namespace {
+
+constexpr size_t step_samples = 1600; // 100 ms, as the capture path delivers it
+constexpr size_t top_ops = 8;
+
+// "CUDAExecutionProvider" -> "CUDA"
+std::string_view short_name(std::string_view provider) {
+  constexpr std::string_view suffix = "ExecutionProvider";
+  return provider.ends_with(suffix) ? provider.substr(0, provider.size() - suffix.size()) : provider;
+}
+
+double per_step_ms(uint64_t us, uint64_t steps) {
+  return static_cast<double>(us) / 1000.0 / static_cast<double>((std::max)(steps, uint64_t{ 1 }));
+}
+
+void print_component(std::string_view name, const onnx::session_profile& profile, uint64_t steps, std::ostream& out) {
+  out << "  " << std::left << std::setw(10) << name << std::right << std::setw(6) << std::setprecision(2)
+      << (static_cast<double>(profile.runs) / static_cast<double>((std::max)(steps, uint64_t{ 1 }))) << " runs  "
+      << std::setw(8) << std::setprecision(3) << per_step_ms(profile.run_us, steps) << " ms  (kernels "
+      << per_step_ms(profile.kernel_us, steps) << " ms)\n";
+  for (size_t i = 0; i < profile.ops.size() && i < top_ops; ++i) {
+    const auto& op = profile.ops[i];
+    const double share = profile.kernel_us == 0 ? 0.0 : 100.0 * static_cast<double>(op.total_us)
+                                                           / static_cast<double>(profile.kernel_us);
+    out << "    " << std::left << std::setw(22) << op.op << std::setw(10) << short_name(op.provider) << std::right
+        << std::setw(8) << std::setprecision(3) << per_step_ms(op.total_us, steps) << " ms " << std::setw(5)
+        << std::setprecision(1) << share << "%\n";
+  }
+}
+
+} // namespace
+
+void print_placement(const onnx::rnnt_placement& placement, std::ostream& out) {
+  const std::array<std::pair<std::string_view, const onnx::session_placement*>, 3> components{
+    std::pair{ std::string_view("encoder"), &placement.encoder },
+    std::pair{ std::string_view("predictor"), &placement.predictor },
+    std::pair{ std::string_view("joint"), &placement.joint }
+  };
+  out << "placement:\n";
+  for (const auto& [name, session] : components) {
+    out << "  " << std::left << std::setw(10) << name << std::right << " providers";
+    for (size_t i = 0; i < session->registered.size(); ++i) {
+      out << (i == 0 ? " " : ", ") << short_name(session->registered[i]);
+    }
+    for (const auto& rejected : session->rejected) {
+      out << "; rejected " << rejected;
+    }
+    if (!session->nodes.empty()) {
+      out << "; nodes";
+      for (size_t i = 0; i < session->nodes.size(); ++i) {
+        out << (i == 0 ? " " : ", ") << short_name(session->nodes[i].provider) << ' ' << session->nodes[i].nodes;
+      }
+    }
+    out << '\n';
+  }
+}
+
+int run_profile(onnx::streaming_rnnt& rnnt, const std::string& wav) {
+  audio_clip clip;
+  if (!load_clip(wav, clip)) {
+    std::cerr << "cannot read " << wav << '\n';
+    return EXIT_FAILURE;
+  }
+  std::vector<int32_t> emitted;
+  emitted.reserve(256);
+  for (size_t at = 0; at < clip.samples.size(); at += step_samples) {
+    const size_t count = (std::min)(step_samples, clip.samples.size() - at);
+    if (!rnnt.step(std::span(clip.samples).subspan(at, count), emitted)) {
+      std::cerr << "decoding failed\n";
+      return EXIT_FAILURE;
+    }
+  }
+  static_cast<void>(rnnt.finish(emitted));
+
+  onnx::rnnt_profile profile;
+  if (!rnnt.collect_profile(profile)) {
+    std::cerr << "no profile: ONNX Runtime did not write the traces\n";
+    return EXIT_FAILURE;
+  }
+  std::cout << std::fixed << "profile over " << profile.steps << " steps of " << (step_samples * 1000 / model_rate_hz)
+            << " ms, per step:\n";
+  print_component("encoder", profile.encoder, profile.steps, std::cout);
+  print_component("predictor", profile.predictor, profile.steps, std::cout);
+  print_component("joint", profile.joint, profile.steps, std::cout);
+  print_placement(rnnt.placement(), std::cout);
+  for (const auto& file : profile.files) {
+    std::cout << "trace: " << file << '\n';
+  }
+  return EXIT_SUCCESS;
+}
+
+} // namespace jaxie::app
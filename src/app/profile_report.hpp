@@ -0,0 +1,17 @@
+#pragma once
+
+#include <Jaxie/onnx/streaming_rnnt.hpp>
+
+#include <ostream>
+#include <string>
+
+namespace jaxie::app {
+
+// Per component: the providers ORT took and refused and, once profiled, how many nodes each ran.
+void print_placement(const onnx::rnnt_placement& placement, std::ostream& out);
+
+// --profile <wav>: streams the clip through rnnt.step() in 100 ms blocks (rnnt loaded with
+// session_config::profiling), then prints each component's Run() time per step and its costliest operators.
+int run_profile(onnx::streaming_rnnt& rnnt, const std::string& wav);
+
+} // namespace jaxie::app
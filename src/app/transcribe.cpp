@@ -0,0 +1,284 @@
+#include "transcribe.hpp"
+
+#include "clips.hpp"
+
+#include <Jaxie/onnx/model_bundle.hpp>
+#include <Jaxie/onnx/transcript.hpp>
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace jaxie::app {
+namespace {
+
+constexpr size_t step_samples = 1600; // 100 ms, as the capture path delivers it
+
+struct worker_totals {
+  double audio_seconds{0.0};
+  double decode_seconds{0.0};
+  size_t files{0};
+  size_t failed{0};
+};
+
+// Lines arrive from the workers in completion order and leave in input order, as soon as every earlier line has.
+class ordered_writer {
+public:
+  ordered_writer(std::ostream& out, size_t count) : out_(out), lines_(count), ready_(count, false) {}
+
+  void put(size_t index, std::string line) {
+    const std::scoped_lock lock(mutex_);
+    lines_[index] = std::move(line);
+    ready_[index] = true;
+    for (; next_ < lines_.size() && ready_[next_]; ++next_) {
+      out_ << lines_[next_] << '\n';
+      lines_[next_] = {};
+    }
+    out_.flush();
+  }
+
+private:
+  std::ostream& out_;
+  std::mutex mutex_;
+  std::vector<std::string> lines_;
+  std::vector<bool> ready_;
+  size_t next_{0};
+};
+
+void append_json_string(std::string& out, std::string_view text) {
+  out += '"';
+  for (const char c : text) {
+    if (c == '"' || c == '\\') {
+      out += '\\';
+      out += c;
+    } else if (static_cast<unsigned char>(c) < 0x20U) {
+      fmt::format_to(std::back_inserter(out), "\\u{:04x}", static_cast<unsigned>(c));
+    } else {
+      out += c;
+    }
+  }
+  out += '"';
+}
+
+std::string error_line(const std::string& file, std::string_view error) {
+  std::string line = "{\"file\":";
+  append_json_string(line, file);
+  line += ",\"error\":";
+  append_json_string(line, error);
+  line += '}';
+  return line;
+}
+
+// One clip through step() and finish(), from a fresh stream state. Tokens and the log-mel frame of each.
+bool decode_clip(const onnx::streaming_rnnt& rnnt,
+  const audio_clip& clip,
+  std::vector<int32_t>& tokens,
+  std::vector<uint32_t>& frames,
+  std::vector<int32_t>& emitted) {
+  const auto keep = [&]() {
+    const auto emitted_frames = rnnt.token_frames();
+    tokens.insert(tokens.end(), emitted.begin(), emitted.end());
+    frames.insert(frames.end(), emitted_frames.begin(), emitted_frames.end());
+  };
+  for (size_t at = 0; at < clip.samples.size(); at += step_samples) {
+    const size_t count = (std::min)(step_samples, clip.samples.size() - at);
+    if (!rnnt.step(std::span(clip.samples).subspan(at, count), emitted)) {
+      return false;
+    }
+    keep();
+  }
+  if (!rnnt.finish(emitted)) {
+    return false;
+  }
+  keep();
+  return true;
+}
+
+void transcribe_worker(onnx::streaming_rnnt& rnnt,
+  const std::vector<std::string>& files,
+  std::atomic<size_t>& next_file,
+  const onnx::detokenizer* vocab,
+  ordered_writer& writer,
+  worker_totals& totals) {
+  const onnx::rnnt_options defaults{};
+  const double ms_per_frame = 1000.0 * defaults.features.hop_frames / defaults.features.sample_rate_hz;
+  std::vector<int32_t> emitted;
+  emitted.reserve(256);
+  std::vector<int32_t> tokens;
+  std::vector<uint32_t> frames;
+  std::string text;
+  for (size_t index = next_file.fetch_add(1); index < files.size(); index = next_file.fetch_add(1)) {
+    const std::string& file = files[index];
+    ++totals.files;
+    audio_clip clip;
+    if (!load_clip(file, clip)) {
+      ++totals.failed;
+      writer.put(index, error_line(file, "cannot read"));
+      continue;
+    }
+    tokens.clear();
+    frames.clear();
+    rnnt.reset_state();
+    const auto started = std::chrono::steady_clock::now();
+    const bool decoded = decode_clip(rnnt, clip, tokens, frames, emitted);
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    if (!decoded) {
+      ++totals.failed;
+      writer.put(index, error_line(file, "decoding failed"));
+      continue;
+    }
+    const double duration = static_cast<double>(clip.samples.size()) / model_rate_hz;
+    totals.audio_seconds += duration;
+    totals.decode_seconds += seconds;
+
+    std::string line = "{\"file\":";
+    append_json_string(line, file);
+    fmt::format_to(std::back_inserter(line),
+      ",\"duration_s\":{:.3f},\"decode_s\":{:.4f},\"rtf\":{:.4f},\"tokens\":[",
+      duration,
+      seconds,
+      duration > 0.0 ? seconds / duration : 0.0);
+    for (size_t i = 0; i < tokens.size(); ++i) {
+      fmt::format_to(std::back_inserter(line), "{}{}", i == 0 ? "" : ",", tokens[i]);
+    }
+    line += "],\"token_ms\":[";
+    for (size_t i = 0; i < frames.size(); ++i) {
+      fmt::format_to(std::back_inserter(line), "{}{:.0f}", i == 0 ? "" : ",", frames[i] * ms_per_frame);
+    }
+    line += ']';
+    if (vocab != nullptr) {
+      text.clear();
+      vocab->append(tokens, text);
+      line += ",\"text\":";
+      append_json_string(line, text);
+    }
+    line += '}';
+    writer.put(index, std::move(line));
+  }
+}
+
+} // namespace
+
+int run_transcribe(std::span<char*> args, const onnx::rnnt_model_paths& paths, const onnx::ep_prefs& prefs) {
+  size_t at = 1;
+  while (at < args.size() && std::string_view(args[at] != nullptr ? args[at] : "") != "--transcribe") {
+    ++at;
+  }
+  const auto files = collect_clip_paths(args, at + 1);
+  if (files.empty()) {
+    std::cerr << "--transcribe needs at least one WAV file or directory\n";
+    return EXIT_FAILURE;
+  }
+
+  std::string out_path;
+  std::string vocab_path;
+  uint32_t workers = (std::max)(std::thread::hardware_concurrency(), 1U);
+  for (size_t i = 1; i + 1 < args.size(); ++i) {
+    const std::string_view arg{ args[i] != nullptr ? args[i] : "" };
+    const std::string_view value{ args[i + 1] != nullptr ? args[i + 1] : "" };
+    if (arg == "--out") {
+      out_path = value;
+    } else if (arg == "--vocab") {
+      vocab_path = value;
+    } else if (arg == "--workers") {
+      const auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), workers);
+      if (error != std::errc{} || end != value.data() + value.size() || workers == 0) {
+        std::cerr << "--workers needs a positive count\n";
+        return EXIT_FAILURE;
+      }
+    }
+  }
+  workers = static_cast<uint32_t>((std::min)(size_t{ workers }, files.size()));
+
+  onnx::detokenizer vocab;
+  const onnx::detokenizer* detokenize = nullptr;
+  if (!vocab_path.empty()) {
+    if (!vocab.load_file(vocab_path)) {
+      std::cerr << "cannot read vocabulary " << vocab_path << '\n';
+      return EXIT_FAILURE;
+    }
+    detokenize = &vocab;
+  } else if (paths.bundle != nullptr && !paths.bundle->vocab().empty() && vocab.load(paths.bundle->vocab())) {
+    detokenize = &vocab;
+  }
+
+  std::ofstream out_file;
+  if (!out_path.empty()) {
+    out_file.open(out_path, std::ios::binary);
+    if (!out_file) {
+      std::cerr << "cannot write " << out_path << '\n';
+      return EXIT_FAILURE;
+    }
+  }
+  std::ostream& out = out_path.empty() ? std::cout : out_file;
+
+  // One set of sessions; every further worker only adds its stream state.
+  const auto loading = std::chrono::steady_clock::now();
+  std::vector<onnx::streaming_rnnt> models(workers);
+  if (!models.front().load(paths, prefs)) {
+    std::cerr << "Failed to load RNNT ONNX sessions\n";
+    return EXIT_FAILURE;
+  }
+  for (size_t w = 1; w < models.size(); ++w) {
+    if (!models[w].load_shared(models.front())) {
+      std::cerr << "Failed to open stream " << w << " over the shared sessions\n";
+      return EXIT_FAILURE;
+    }
+  }
+  const double load_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - loading).count();
+
+  ordered_writer writer(out, files.size());
+  std::atomic<size_t> next_file{0};
+  std::vector<worker_totals> totals(workers);
+  const auto started = std::chrono::steady_clock::now();
+  {
+    std::vector<std::jthread> pool;
+    pool.reserve(workers);
+    for (size_t w = 0; w < workers; ++w) {
+      pool.emplace_back([&, w]() { transcribe_worker(models[w], files, next_file, detokenize, writer, totals[w]); });
+    }
+  }
+  const double wall_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+  worker_totals sum{};
+  for (const auto& worker : totals) {
+    sum.audio_seconds += worker.audio_seconds;
+    sum.decode_seconds += worker.decode_seconds;
+    sum.files += worker.files;
+    sum.failed += worker.failed;
+  }
+  // The aggregate RTF is wall time over audio; the per-stream one what each worker's decoding alone would give.
+  std::cerr << fmt::format(
+    "{} files ({} failed), {:.1f} s of audio on {} workers (sessions loaded in {:.2f} s): {:.1f} s wall, "
+    "RTF {:.4f} aggregate / {:.4f} per stream, {:.2f} files/s\n",
+    sum.files,
+    sum.failed,
+    sum.audio_seconds,
+    workers,
+    load_seconds,
+    wall_seconds,
+    sum.audio_seconds > 0.0 ? wall_seconds / sum.audio_seconds : 0.0,
+    sum.audio_seconds > 0.0 ? sum.decode_seconds / sum.audio_seconds : 0.0,
+    wall_seconds > 0.0 ? static_cast<double>(sum.files) / wall_seconds : 0.0);
+  if (!out) {
+    std::cerr << "cannot write " << (out_path.empty() ? std::string("stdout") : out_path) << '\n';
+    return EXIT_FAILURE;
+  }
+  return sum.failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+} // namespace jaxie::app
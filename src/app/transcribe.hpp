@@ -0,0 +1,16 @@
+#pragma once
+
+#include <Jaxie/onnx/streaming_rnnt.hpp>
+
+#include <span>
+
+namespace jaxie::app {
+
+// --transcribe <wav | dir of wavs>... [--workers N] [--out FILE] [--vocab FILE]: decodes every clip through the
+// same streaming step() path used live, in 100 ms chunks, on a pool of workers. The first worker loads the
+// sessions and the others share them (streaming_rnnt::load_shared()), each keeping its own stream state, and
+// they take clips off a common queue. One JSON object per clip goes to --out or stdout in path order, whichever
+// worker finishes first; the aggregate real-time factor and files per second go to stderr.
+int run_transcribe(std::span<char*> args, const onnx::rnnt_model_paths& paths, const onnx::ep_prefs& prefs);
+
+} // namespace jaxie::app
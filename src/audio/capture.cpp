@@ -1,15 +1,26 @@
 #include <Jaxie/audio/capture.hpp>
+#include <Jaxie/audio/pcm_ring.hpp>
+#include <Jaxie/audio/wav_file.hpp>
+#include <Jaxie/dsp/resampler.hpp>
+#include <Jaxie/realtime/latency_trace.hpp>
 
 #include <algorithm>
+#include <array>
 #include <atomic>
 #include <chrono>
-#include <cstring>
 #include <memory>
+#include <mutex>
 #include <span>
 #include <thread>
+#include <type_traits>
 #include <utility>
+#include <variant>
 #include <vector>
 
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
 #if defined(JAXIE_USE_MINIAUDIO)
 #define MINIAUDIO_IMPLEMENTATION
 #include <miniaudio.h>
@@ -18,6 +29,31 @@
 namespace jaxie::audio {
 namespace detail {
 
+inline void cpu_relax() noexcept {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+  _mm_pause();
+#elif defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+  asm volatile("yield");
+#else
+  std::this_thread::yield();
+#endif
+}
+
+// Device-side frames covering one delivered period, rounded up.
+inline uint32_t source_period_frames(const capture_config& config, uint32_t source_rate_hz) noexcept {
+  const uint64_t scaled = (static_cast<uint64_t>(config.period_frames) * source_rate_hz) + config.sample_rate_hz - 1;
+  return static_cast<uint32_t>(scaled / (std::max)(config.sample_rate_hz, 1U));
+}
+
+inline uint64_t monotonic_ns() noexcept {
+  return static_cast<uint64_t>(
+    std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+class ring_pipeline;
+
 template <typename Backend>
 class capture_impl {
 public:
@@ -35,6 +71,11 @@ public:
 
   void shutdown(audio_capture& owner) noexcept { backend_.shutdown(owner); }
 
+  capture_stats stats() const noexcept { return backend_.stats(); }
+
+  ring_pipeline* pipeline() noexcept { return backend_.pipeline(); }
+  const ring_pipeline* pipeline() const noexcept { return backend_.pipeline(); }
+
 private:
   Backend backend_{};
 };
@@ -60,12 +101,620 @@ struct null_capture_backend {
     callback_ptr_ = nullptr;
   }
 
+  capture_stats stats() const noexcept { return {}; }
+
+  ring_pipeline* pipeline() noexcept { return nullptr; }
+  const ring_pipeline* pipeline() const noexcept { return nullptr; }
+
 private:
   audio_capture* last_owner_{nullptr};
   capture_config last_config_{};
   capture_callback* callback_ptr_{nullptr};
 };
 
+// Ring buffer plus consumer thread shared by every backend that produces samples. The producer side (device
+// callback or replay thread) calls push() with source-format audio, which is converted to the delivered format
+// before it enters the ring; the consumer thread hands period-sized views to capture_callback. Subscribers
+// follow the same ring through secondary reader cursors, each on its own thread or pulled by the caller.
+class ring_pipeline {
+public:
+  ring_pipeline() = default;
+  ~ring_pipeline() { release(); }
+
+  ring_pipeline(const ring_pipeline&) = delete;
+  ring_pipeline& operator=(const ring_pipeline&) = delete;
+  ring_pipeline(ring_pipeline&&) = delete;
+  ring_pipeline& operator=(ring_pipeline&&) = delete;
+
+  bool init(
+    const capture_config& config,
+    uint32_t source_rate_hz,
+    uint32_t source_channels,
+    capture_callback& callback) noexcept {
+    release();
+    config_ = config;
+    callback_ = &callback;
+    reset_stats();
+
+    dsp::converter_config conversion{};
+    conversion.in_rate_hz = source_rate_hz;
+    conversion.in_channels = source_channels;
+    conversion.out_rate_hz = config.sample_rate_hz;
+    conversion.out_channels = config.channels;
+    conversion.quality = config.resampler_quality;
+    conversion.max_block_frames = (std::max)(source_period_frames(config, source_rate_hz), 256U);
+    if (!converter_.init(conversion)) {
+      release();
+      return false;
+    }
+    try {
+      converted_.assign(converter_.max_output_frames(conversion.max_block_frames) * config.channels, 0.0F);
+    } catch (...) {
+      release();
+      return false;
+    }
+
+    const uint32_t rb_frames =
+      config.ring_frames != 0 ? config.ring_frames : config.period_frames * config.period_count * 8U;
+    // A blocking producer waits until one converted block fits below the policy's fill limit (three quarters of
+    // the ring under drop_oldest) on top of the partial period the consumer leaves behind; a smaller ring would
+    // leave both sides waiting on each other.
+    const uint32_t wait_frames = max_push_frames(source_period_frames(config, source_rate_hz)) + config.period_frames;
+    const uint32_t min_frames =
+      config.on_overrun == overrun_policy::drop_oldest ? wait_frames + (wait_frames / 3U) + 1U : wait_frames;
+    if (config.period_frames == 0
+        || !ring_.init((std::max)(rb_frames, min_frames), config.channels, config.on_overrun, config.ring_storage)) {
+      release();
+      return false;
+    }
+    return true;
+  }
+
+  bool start() noexcept {
+    if (!ring_.is_ready()) {
+      return false;
+    }
+    {
+      const std::scoped_lock lock(tuning_mutex_);
+      tuning_ = {};
+      if (config_.lock_memory) {
+        // Before any thread starts, so the ring and every stack are resident from the first period.
+        realtime::lock_process_memory(tuning_);
+      }
+    }
+    if (realtime::tracing()) {
+      // The device (or replay) thread, the consumer and each subscriber thread trace from their first period,
+      // where taking a reserved buffer is all their first event does.
+      uint32_t threads = 2;
+      const std::scoped_lock lock(subscribers_mutex_);
+      for (const auto& sub : subscribers_) {
+        threads += sub.in_use && sub.threaded.load(std::memory_order_relaxed) ? 1U : 0U;
+      }
+      realtime::reserve_trace_buffers(threads);
+    }
+    consumer_running_.store(true, std::memory_order_release);
+    try {
+      consumer_ = std::thread([this]() { consume_loop(); });
+    } catch (...) {
+      consumer_running_.store(false, std::memory_order_release);
+      return false;
+    }
+    tune_thread(consumer_);
+
+    const std::scoped_lock lock(subscribers_mutex_);
+    for (uint32_t id = 0; id < pcm_ring::max_readers; ++id) {
+      if (subscribers_[id].in_use && subscribers_[id].threaded.load(std::memory_order_relaxed)
+          && !start_subscriber(id)) {
+        clear_subscriber(id);
+      }
+    }
+    return true;
+  }
+
+  bool add_subscriber(capture_callback* callback, uint32_t& id) noexcept {
+    const std::scoped_lock lock(subscribers_mutex_);
+    uint32_t reader = 0;
+    if (!ring_.attach_reader(reader)) {
+      return false;
+    }
+    subscriber& sub = subscribers_[reader];
+    try {
+      sub.callback = callback != nullptr ? std::move(*callback) : capture_callback{};
+    } catch (...) {
+      ring_.detach_reader(reader);
+      return false;
+    }
+    sub.in_use = true;
+    sub.periods.store(0, std::memory_order_relaxed);
+    sub.threaded.store(static_cast<bool>(sub.callback), std::memory_order_release);
+    if (sub.threaded.load(std::memory_order_relaxed) && consumer_running_.load(std::memory_order_acquire)
+        && !start_subscriber(reader)) {
+      clear_subscriber(reader);
+      return false;
+    }
+    id = reader;
+    return true;
+  }
+
+  void remove_subscriber(uint32_t id) noexcept {
+    if (id >= pcm_ring::max_readers) {
+      return;
+    }
+    const std::scoped_lock lock(subscribers_mutex_);
+    clear_subscriber(id);
+  }
+
+  // Pull-mode subscribers only; threaded ones are served by their own loop.
+  bool acquire_frames(uint32_t id, uint32_t frames, pcm_ring::read_view& view) noexcept {
+    if (id >= pcm_ring::max_readers || subscribers_[id].threaded.load(std::memory_order_acquire)) {
+      view = {};
+      return false;
+    }
+    return ring_.acquire_read(id, frames, view);
+  }
+
+  bool commit_period(uint32_t id, const pcm_ring::read_view& view) noexcept {
+    if (id >= pcm_ring::max_readers || !ring_.commit_read(id, view)) {
+      return false;
+    }
+    subscribers_[id].periods.fetch_add(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  subscriber_stats stats(uint32_t id) const noexcept {
+    subscriber_stats out{};
+    if (id < pcm_ring::max_readers) {
+      out.periods_delivered = subscribers_[id].periods.load(std::memory_order_relaxed);
+      out.ring = ring_.stats(id);
+    }
+    return out;
+  }
+
+  void stop() noexcept {
+    consumer_running_.store(false, std::memory_order_release);
+    signal_consumer();
+    wake_producer();
+    if (consumer_.joinable()) {
+      consumer_.join();
+    }
+    const std::scoped_lock lock(subscribers_mutex_);
+    for (uint32_t id = 0; id < pcm_ring::max_readers; ++id) {
+      stop_subscriber(id);
+    }
+  }
+
+  void release() noexcept {
+    stop();
+    {
+      const std::scoped_lock lock(subscribers_mutex_);
+      for (uint32_t id = 0; id < pcm_ring::max_readers; ++id) {
+        clear_subscriber(id);
+      }
+    }
+    ring_.release();
+    converted_.clear();
+    callback_ = nullptr;
+    config_ = {};
+  }
+
+  bool is_ready() const noexcept { return ring_.is_ready(); }
+
+  // Producer side; safe to call from a real-time callback (all conversion buffers are sized in init()).
+  template <typename Sample>
+  void push(std::span<const Sample> interleaved) noexcept {
+    // Frames the device delivered are stamped with the ring position they will be written at.
+    const uint64_t first_frame = realtime::tracing() ? ring_.write_position() : realtime::no_trace_sample;
+    if (first_frame != realtime::no_trace_sample) {
+      realtime::trace(realtime::trace_point::device_callback,
+        realtime::trace_phase::instant,
+        first_frame,
+        static_cast<uint32_t>(interleaved.size() / (std::max)(converter_.config().in_channels, 1U)));
+    }
+    if constexpr (std::is_same_v<Sample, float>) {
+      if (converter_.is_passthrough()) {
+        // Overrun handling lives in the ring; the producer never moves the consumer's cursor.
+        ring_.write(interleaved);
+        publish(first_frame);
+        return;
+      }
+    }
+
+    const size_t block = static_cast<size_t>(converter_.config().max_block_frames) * converter_.config().in_channels;
+    while (!interleaved.empty()) {
+      const size_t take = (std::min)(interleaved.size(), block);
+      const size_t frames = converter_.process(interleaved.first(take), std::span<float>(converted_));
+      ring_.write(std::span<const float>(converted_.data(), frames * config_.channels));
+      interleaved = interleaved.subspan(take);
+    }
+    publish(first_frame);
+  }
+
+  // Ring frames that pushing `source_frames` source frames can write; resampling may produce more than a period.
+  uint32_t max_push_frames(uint32_t source_frames) const noexcept {
+    return static_cast<uint32_t>(converter_.max_output_frames(source_frames));
+  }
+
+  // Blocks a non-real-time producer until `frames` fit without overrunning, or until keep_waiting clears.
+  bool wait_for_space(uint32_t frames, const std::atomic<bool>& keep_waiting) noexcept {
+    while (keep_waiting.load(std::memory_order_acquire)) {
+      const uint32_t seen = space_seq_.load();
+      if (ring_.writable_frames() >= frames) {
+        return true;
+      }
+      space_waiters_.fetch_add(1);
+      space_seq_.wait(seen);
+      space_waiters_.fetch_sub(1);
+    }
+    return false;
+  }
+
+  void wake_producer() noexcept {
+    space_seq_.fetch_add(1);
+    space_seq_.notify_all();
+  }
+
+  // Applies capture_config::consumer_thread to a thread that feeds or drains the ring.
+  void tune_thread(std::thread& thread) noexcept {
+    if (!config_.consumer_thread.requested()) {
+      return;
+    }
+    const realtime::tuning_report report = realtime::apply(thread, config_.consumer_thread);
+    const std::scoped_lock lock(tuning_mutex_);
+    realtime::merge(tuning_, report);
+  }
+
+  void set_end_of_stream(bool ended) noexcept { end_of_stream_.store(ended, std::memory_order_release); }
+
+  capture_stats stats() const noexcept {
+    capture_stats out{};
+    out.periods_delivered = periods_delivered_.load(std::memory_order_relaxed);
+    out.wakeups = wakeups_.load(std::memory_order_relaxed);
+    out.wakeup_latency_last_ns = latency_last_ns_.load(std::memory_order_relaxed);
+    out.wakeup_latency_max_ns = latency_max_ns_.load(std::memory_order_relaxed);
+    out.wakeup_latency_total_ns = latency_total_ns_.load(std::memory_order_relaxed);
+    out.ring = ring_.stats();
+    out.end_of_stream =
+      end_of_stream_.load(std::memory_order_acquire) && ring_.readable_frames() < config_.period_frames;
+    const std::scoped_lock lock(tuning_mutex_);
+    out.tuning = tuning_;
+    return out;
+  }
+
+private:
+  void consume_loop() {
+    if (config_.consumer_thread.prefault_stack) {
+      realtime::prefault_stack();
+    }
+    const uint32_t frames_per_pull = config_.period_frames;
+    const uint32_t spin_limit = config_.spin_iterations;
+    using clock = std::chrono::steady_clock;
+    const auto period = std::chrono::duration_cast<clock::duration>(
+      std::chrono::duration<double>(static_cast<double>(frames_per_pull) / config_.sample_rate_hz));
+    // When the next period is overdue: a period after the consumer last caught up with the producer, plus a
+    // period of grace for delivery jitter. No deadline before the first period, whose arrival is device start-up.
+    auto deadline = clock::time_point::max();
+    while (consumer_running_.load(std::memory_order_acquire)) {
+      // Sample the sequence before inspecting the ring so a push racing with us is never missed.
+      const uint32_t seen = data_seq_.load(std::memory_order_acquire);
+      pcm_ring::read_view view{};
+      if (ring_.readable_frames() >= frames_per_pull && ring_.acquire_read(frames_per_pull, view)) {
+        record_wakeup_latency(view);
+        if (callback_ != nullptr && *callback_) {
+          const realtime::trace_span span(realtime::trace_point::user_callback, view.first_frame, view.frames);
+          realtime::set_trace_origin(view.first_frame);
+          (*callback_)(view.samples);
+          realtime::set_trace_origin(realtime::no_trace_sample);
+        }
+        // The read is committed only after the callback so the producer cannot reuse the span under it.
+        if (ring_.commit_read(view)) {
+          periods_delivered_.fetch_add(1, std::memory_order_relaxed);
+        }
+        notify_space();
+        if (ring_.readable_frames() < frames_per_pull) {
+          deadline = clock::now() + (2 * period);
+        }
+        continue;
+      }
+      wait_for_data(seen, spin_limit);
+      if (!consumer_running_.load(std::memory_order_acquire)) {
+        break; // stop()'s wakeup, not a late period
+      }
+      // A partial push before the deadline is just how the producer delivers. Past it, acquire_read() fails
+      // for want of a period and counts the underrun, once per period of lateness.
+      const auto now = clock::now();
+      if (now > deadline && ring_.readable_frames() < frames_per_pull) {
+        static_cast<void>(ring_.acquire_read(frames_per_pull, view));
+        deadline = now + period;
+      }
+    }
+  }
+
+  void subscriber_loop(uint32_t id) {
+    subscriber& sub = subscribers_[id];
+    const uint32_t frames_per_pull = config_.period_frames;
+    while (sub.running.load(std::memory_order_acquire)) {
+      const uint32_t seen = data_seq_.load(std::memory_order_acquire);
+      pcm_ring::read_view view{};
+      if (ring_.acquire_read(id, frames_per_pull, view)) {
+        realtime::set_trace_origin(view.first_frame);
+        sub.callback(view.samples);
+        realtime::set_trace_origin(realtime::no_trace_sample);
+        if (ring_.commit_read(id, view)) {
+          sub.periods.fetch_add(1, std::memory_order_relaxed);
+        }
+        continue;
+      }
+      data_seq_.wait(seen, std::memory_order_acquire);
+    }
+  }
+
+  // Callers hold subscribers_mutex_.
+  bool start_subscriber(uint32_t id) noexcept {
+    subscriber& sub = subscribers_[id];
+    sub.running.store(true, std::memory_order_release);
+    try {
+      sub.thread = std::thread([this, id]() { subscriber_loop(id); });
+    } catch (...) {
+      sub.running.store(false, std::memory_order_release);
+      return false;
+    }
+    return true;
+  }
+
+  void stop_subscriber(uint32_t id) noexcept {
+    subscriber& sub = subscribers_[id];
+    sub.running.store(false, std::memory_order_release);
+    if (sub.thread.joinable()) {
+      signal_consumer();
+      sub.thread.join();
+    }
+  }
+
+  void clear_subscriber(uint32_t id) noexcept {
+    subscriber& sub = subscribers_[id];
+    if (!sub.in_use) {
+      return;
+    }
+    stop_subscriber(id);
+    ring_.detach_reader(id);
+    sub.threaded.store(false, std::memory_order_release);
+    sub.callback = {};
+    sub.in_use = false;
+  }
+
+  void wait_for_data(uint32_t seen, uint32_t spin_limit) noexcept {
+    for (uint32_t i = 0; i < spin_limit; ++i) {
+      if (data_seq_.load(std::memory_order_acquire) != seen) {
+        wakeups_.fetch_add(1, std::memory_order_relaxed);
+        return;
+      }
+      cpu_relax();
+    }
+    data_seq_.wait(seen, std::memory_order_acquire);
+    wakeups_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void reset_stats() noexcept {
+    periods_delivered_.store(0, std::memory_order_relaxed);
+    wakeups_.store(0, std::memory_order_relaxed);
+    latency_last_ns_.store(0, std::memory_order_relaxed);
+    latency_max_ns_.store(0, std::memory_order_relaxed);
+    latency_total_ns_.store(0, std::memory_order_relaxed);
+    end_of_stream_.store(false, std::memory_order_relaxed);
+  }
+
+  void record_wakeup_latency(const pcm_ring::read_view& view) noexcept {
+    const uint64_t committed = last_commit_ns_.load(std::memory_order_acquire);
+    const uint64_t now = monotonic_ns();
+    realtime::trace_at(
+      now, realtime::trace_point::consumer_wakeup, realtime::trace_phase::instant, view.first_frame, view.frames);
+    const uint64_t latency = now > committed ? now - committed : 0;
+    latency_last_ns_.store(latency, std::memory_order_relaxed);
+    latency_total_ns_.fetch_add(latency, std::memory_order_relaxed);
+    if (latency > latency_max_ns_.load(std::memory_order_relaxed)) {
+      latency_max_ns_.store(latency, std::memory_order_relaxed);
+    }
+  }
+
+  // first_frame is where this push started writing, or no_trace_sample when it is not traced.
+  void publish(uint64_t first_frame) noexcept {
+    const uint64_t now = monotonic_ns();
+    if (first_frame != realtime::no_trace_sample) {
+      const auto frames = static_cast<uint32_t>(ring_.write_position() - first_frame);
+      realtime::trace_at(now, realtime::trace_point::ring_commit, realtime::trace_phase::instant, first_frame, frames);
+    }
+    last_commit_ns_.store(now, std::memory_order_release);
+    signal_consumer();
+  }
+
+  void signal_consumer() noexcept {
+    // Subscriber threads park on the same sequence as the primary consumer.
+    data_seq_.fetch_add(1, std::memory_order_release);
+    data_seq_.notify_all();
+  }
+
+  void notify_space() noexcept {
+    // Always bump the sequence; only pay for the wake-up syscall when a producer is actually parked.
+    space_seq_.fetch_add(1);
+    if (space_waiters_.load() != 0) {
+      space_seq_.notify_all();
+    }
+  }
+
+  struct subscriber {
+    capture_callback callback;
+    std::thread thread;
+    std::atomic<bool> running{false};
+    std::atomic<bool> threaded{false};
+    std::atomic<uint64_t> periods{0};
+    bool in_use{false}; // guarded by subscribers_mutex_
+  };
+
+  pcm_ring ring_{};
+  std::array<subscriber, pcm_ring::max_readers> subscribers_{};
+  std::mutex subscribers_mutex_;
+  dsp::stream_converter converter_{};
+  std::vector<float> converted_;
+  std::thread consumer_;
+  std::atomic<bool> consumer_running_{false};
+  mutable std::mutex tuning_mutex_;
+  realtime::tuning_report tuning_{};
+  std::atomic<bool> end_of_stream_{false};
+  std::atomic<uint32_t> data_seq_{0};
+  std::atomic<uint32_t> space_seq_{0};
+  std::atomic<uint32_t> space_waiters_{0};
+  std::atomic<uint64_t> last_commit_ns_{0};
+  std::atomic<uint64_t> periods_delivered_{0};
+  std::atomic<uint64_t> wakeups_{0};
+  std::atomic<uint64_t> latency_last_ns_{0};
+  std::atomic<uint64_t> latency_max_ns_{0};
+  std::atomic<uint64_t> latency_total_ns_{0};
+  capture_callback* callback_{nullptr};
+  capture_config config_{};
+};
+
+// Streams a WAV or raw float32 file through the same ring and consumer path as a live device.
+class file_replay_capture_backend {
+public:
+  file_replay_capture_backend() = default;
+  ~file_replay_capture_backend() { shutdown_internal(); }
+
+  file_replay_capture_backend(const file_replay_capture_backend&) = delete;
+  file_replay_capture_backend& operator=(const file_replay_capture_backend&) = delete;
+  file_replay_capture_backend(file_replay_capture_backend&&) = delete;
+  file_replay_capture_backend& operator=(file_replay_capture_backend&&) = delete;
+
+  bool init(audio_capture& owner, const capture_config& config, capture_callback& callback) noexcept {
+    shutdown_internal();
+    owner_ = &owner;
+    if (!load_pcm_file(config.replay_path, config.sample_rate_hz, config.channels, clip_)) {
+      return false;
+    }
+    if (clip_.samples.empty()) {
+      shutdown_internal();
+      return false;
+    }
+
+    // The file's own format is the source format; push blocks worth one delivered period each.
+    block_frames_ = source_period_frames(config, clip_.sample_rate_hz);
+    const size_t block = static_cast<size_t>(block_frames_) * clip_.channels;
+    try {
+      if (block != 0 && (clip_.samples.size() % block) != 0) {
+        clip_.samples.resize(((clip_.samples.size() / block) + 1) * block, 0.0F);
+      }
+    } catch (...) {
+      shutdown_internal();
+      return false;
+    }
+
+    config_ = config;
+    if (!pipeline_.init(config, clip_.sample_rate_hz, clip_.channels, callback)) {
+      shutdown_internal();
+      return false;
+    }
+    return true;
+  }
+
+  bool start(audio_capture& owner, capture_callback& callback) noexcept {
+    static_cast<void>(callback);
+    owner_ = &owner;
+    if (!pipeline_.is_ready() || !pipeline_.start()) {
+      return false;
+    }
+
+    producer_running_.store(true, std::memory_order_release);
+    try {
+      producer_ = std::thread([this]() { produce_loop(); });
+    } catch (...) {
+      producer_running_.store(false, std::memory_order_release);
+      pipeline_.stop();
+      return false;
+    }
+    if (config_.pacing == replay_pacing::realtime) {
+      // Paced replay stands in for the device thread; unpaced replay is a batch job and stays unprivileged.
+      pipeline_.tune_thread(producer_);
+    }
+    return true;
+  }
+
+  void stop(audio_capture& owner) noexcept {
+    owner_ = &owner;
+    stop_internal();
+  }
+
+  void shutdown(audio_capture& owner) noexcept {
+    owner_ = &owner;
+    shutdown_internal();
+  }
+
+  capture_stats stats() const noexcept { return pipeline_.stats(); }
+
+  ring_pipeline* pipeline() noexcept { return &pipeline_; }
+  const ring_pipeline* pipeline() const noexcept { return &pipeline_; }
+
+private:
+  void produce_loop() {
+    const size_t block = static_cast<size_t>(block_frames_) * clip_.channels;
+    const auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+      std::chrono::duration<double>(static_cast<double>(config_.period_frames) / config_.sample_rate_hz));
+    const bool paced = config_.pacing == replay_pacing::realtime;
+    if (paced && config_.consumer_thread.prefault_stack) {
+      realtime::prefault_stack();
+    }
+    const std::span<const float> samples(clip_.samples);
+    auto next_deadline = std::chrono::steady_clock::now();
+
+    while (producer_running_.load(std::memory_order_acquire)) {
+      if (cursor_ >= samples.size()) {
+        if (!config_.replay_loop) {
+          pipeline_.set_end_of_stream(true);
+          return;
+        }
+        cursor_ = 0;
+      }
+
+      if (paced) {
+        // Like a device, a period becomes available only once it has been "recorded".
+        next_deadline += period;
+        std::this_thread::sleep_until(next_deadline);
+      } else if (!pipeline_.wait_for_space(pipeline_.max_push_frames(block_frames_), producer_running_)) {
+        return;
+      }
+
+      pipeline_.push(samples.subspan(cursor_, block));
+      cursor_ += block;
+    }
+  }
+
+  void stop_internal() noexcept {
+    producer_running_.store(false, std::memory_order_release);
+    pipeline_.wake_producer();
+    if (producer_.joinable()) {
+      producer_.join();
+    }
+    pipeline_.stop();
+  }
+
+  void shutdown_internal() noexcept {
+    stop_internal();
+    pipeline_.release();
+    clip_ = {};
+    cursor_ = 0;
+    block_frames_ = 0;
+    config_ = {};
+    owner_ = nullptr;
+  }
+
+  ring_pipeline pipeline_{};
+  std::thread producer_;
+  std::atomic<bool> producer_running_{false};
+  pcm_clip clip_{};
+  size_t cursor_{0};
+  uint32_t block_frames_{0};
+  capture_config config_{};
+  audio_capture* owner_{nullptr};
+};
+
 #if defined(JAXIE_USE_MINIAUDIO)
 
 class miniaudio_capture_backend {
@@ -81,20 +730,25 @@ public:
   bool init(audio_capture& owner, const capture_config& config, capture_callback& callback) noexcept {
     shutdown_internal();
     owner_ = &owner;
-    callback_ = &callback;
-    config_ = config;
-    channels_ = static_cast<ma_uint32>(config.channels);
+    const uint32_t device_rate = config.device_sample_rate_hz != 0 ? config.device_sample_rate_hz : config.sample_rate_hz;
+    channels_ = static_cast<ma_uint32>(config.device_channels != 0 ? config.device_channels : config.channels);
+    format_ = config.device_format;
 
-    if (ma_context_init(nullptr, 0, nullptr, &ctx_) != MA_SUCCESS) {
+    ma_context_config context_config = ma_context_config_init();
+    if (config.consumer_thread.policy != realtime::sched_policy::inherit) {
+      context_config.threadPriority = ma_thread_priority_realtime;
+    }
+    if (ma_context_init(nullptr, 0, &context_config, &ctx_) != MA_SUCCESS) {
       return false;
     }
     context_ready_ = true;
 
     ma_device_config dcfg = ma_device_config_init(ma_device_type_capture);
-    dcfg.capture.format = ma_format_f32;
+    // Request the native format so miniaudio's generic converter stays out of the real-time callback.
+    dcfg.capture.format = format_ == sample_format::s16 ? ma_format_s16 : ma_format_f32;
     dcfg.capture.channels = channels_;
-    dcfg.sampleRate = static_cast<ma_uint32>(config.sample_rate_hz);
-    dcfg.periodSizeInFrames = static_cast<ma_uint32>(config.period_frames);
+    dcfg.sampleRate = device_rate;
+    dcfg.periodSizeInFrames = source_period_frames(config, device_rate);
     dcfg.periods = static_cast<ma_uint32>(config.period_count);
     dcfg.dataCallback = &miniaudio_capture_backend::ma_capture_callback;
     dcfg.pUserData = this;
@@ -105,16 +759,7 @@ public:
     }
     device_ready_ = true;
 
-    const auto rb_frames = static_cast<ma_uint32>(config.period_frames * config.period_count * 8U);
-    if (ma_pcm_rb_init(ma_format_f32, channels_, rb_frames, nullptr, nullptr, &rb_) != MA_SUCCESS) {
-      shutdown_internal();
-      return false;
-    }
-    rb_ready_ = true;
-
-    try {
-      consumer_buf_.resize(static_cast<size_t>(config.period_frames) * static_cast<size_t>(config.channels));
-    } catch (...) {
+    if (!pipeline_.init(config, device_rate, channels_, callback)) {
       shutdown_internal();
       return false;
     }
@@ -123,8 +768,8 @@ public:
   }
 
   bool start(audio_capture& owner, capture_callback& callback) noexcept {
+    static_cast<void>(callback);
     owner_ = &owner;
-    callback_ = &callback;
     if (!device_ready_) {
       return false;
     }
@@ -134,11 +779,7 @@ public:
     }
     device_running_ = true;
 
-    consumer_running_.store(true, std::memory_order_release);
-    try {
-      consumer_ = std::thread([this]() { consume_loop(); });
-    } catch (...) {
-      consumer_running_.store(false, std::memory_order_release);
+    if (!pipeline_.start()) {
       ma_device_stop(&device_);
       device_running_ = false;
       return false;
@@ -157,6 +798,11 @@ public:
     shutdown_internal();
   }
 
+  capture_stats stats() const noexcept { return pipeline_.stats(); }
+
+  ring_pipeline* pipeline() noexcept { return &pipeline_; }
+  const ring_pipeline* pipeline() const noexcept { return &pipeline_; }
+
 private:
   static void ma_capture_callback(ma_device* device, void* output, const void* input, ma_uint32 frame_count) { // NOLINT(*-easily-swappable-parameters)
     static_cast<void>(output);
@@ -167,67 +813,23 @@ private:
     if (self == nullptr) {
       return;
     }
-    self->push_samples(static_cast<const float*>(input), frame_count);
-  }
-
-  void consume_loop() {
-    const auto frames_per_pull = static_cast<ma_uint32>(config_.period_frames);
-    while (consumer_running_.load(std::memory_order_acquire)) {
-      void* src = nullptr;
-      ma_uint32 available = 0;
-      if (ma_pcm_rb_acquire_read(&rb_, &available, &src) != MA_SUCCESS) {
-        available = 0;
-      }
-      if (available >= frames_per_pull) {
-        const size_t sample_count = static_cast<size_t>(frames_per_pull) * static_cast<size_t>(channels_);
-        const size_t bytes = sample_count * sizeof(float);
-        std::memcpy(consumer_buf_.data(), src, bytes);
-        ma_pcm_rb_commit_read(&rb_, frames_per_pull);
-        if (callback_ != nullptr && *callback_) {
-          (*callback_)(std::span<const float>(consumer_buf_.data(), consumer_buf_.size()));
-        }
-      } else {
-        if (available > 0) {
-          ma_pcm_rb_commit_read(&rb_, 0);
-        }
-        std::this_thread::sleep_for(std::chrono::milliseconds(1));
-      }
-    }
+    self->push_samples(input, frame_count);
   }
 
-  void push_samples(const float* samples, ma_uint32 frame_count) {
-    if (samples == nullptr || !rb_ready_) {
+  void push_samples(const void* samples, ma_uint32 frame_count) {
+    if (samples == nullptr || !pipeline_.is_ready()) {
       return;
     }
-
-    const std::span<const float> in_span(samples, static_cast<size_t>(frame_count) * static_cast<size_t>(channels_));
-    ma_uint32 frames_to_write = frame_count;
-    size_t consumed_frames = 0;
-    while (frames_to_write > 0) {
-      void* dst = nullptr;
-      ma_uint32 writable = 0;
-      if (ma_pcm_rb_acquire_write(&rb_, &writable, &dst) != MA_SUCCESS) {
-        break;
-      }
-      writable = (std::min)(writable, frames_to_write);
-      if (writable == 0) {
-        ma_pcm_rb_seek_read(&rb_, frames_to_write);
-        continue;
-      }
-      const size_t sample_count = static_cast<size_t>(writable) * static_cast<size_t>(channels_);
-      const size_t offset = consumed_frames * static_cast<size_t>(channels_);
-      std::memcpy(dst, in_span.subspan(offset, sample_count).data(), sample_count * sizeof(float));
-      frames_to_write -= writable;
-      consumed_frames += writable;
-      ma_pcm_rb_commit_write(&rb_, writable);
+    const size_t count = static_cast<size_t>(frame_count) * static_cast<size_t>(channels_);
+    if (format_ == sample_format::s16) {
+      pipeline_.push(std::span<const int16_t>(static_cast<const int16_t*>(samples), count));
+    } else {
+      pipeline_.push(std::span<const float>(static_cast<const float*>(samples), count));
     }
   }
 
   void stop_internal() noexcept {
-    consumer_running_.store(false, std::memory_order_release);
-    if (consumer_.joinable()) {
-      consumer_.join();
-    }
+    pipeline_.stop();
     if (device_ready_ && device_running_) {
       ma_device_stop(&device_);
       device_running_ = false;
@@ -236,48 +838,140 @@ private:
 
   void shutdown_internal() noexcept {
     stop_internal();
-    if (rb_ready_) {
-      ma_pcm_rb_uninit(&rb_);
-      rb_ready_ = false;
-    }
     if (device_ready_) {
       ma_device_uninit(&device_);
       device_ready_ = false;
     }
+    pipeline_.release();
     if (context_ready_) {
       ma_context_uninit(&ctx_);
       context_ready_ = false;
     }
-    callback_ = nullptr;
     owner_ = nullptr;
-    consumer_buf_.clear();
-    config_ = {};
     channels_ = 0;
+    format_ = sample_format::f32;
   }
 
   ma_context ctx_{};
   ma_device device_{};
-  ma_pcm_rb rb_{};
-  std::thread consumer_;
-  std::atomic<bool> consumer_running_{false};
-  std::vector<float> consumer_buf_;
-  capture_callback* callback_{nullptr};
-  capture_config config_{};
+  ring_pipeline pipeline_{};
   audio_capture* owner_{nullptr};
   ma_uint32 channels_{0};
+  sample_format format_{sample_format::f32};
   bool context_ready_{false};
   bool device_ready_{false};
   bool device_running_{false};
-  bool rb_ready_{false};
 };
 
 #endif // defined(JAXIE_USE_MINIAUDIO)
 
 #if defined(JAXIE_USE_MINIAUDIO)
-using selected_backend = miniaudio_capture_backend;
+using device_backend = miniaudio_capture_backend;
 #else
-using selected_backend = null_capture_backend;
+using device_backend = null_capture_backend;
+#endif
+
+// Picks the concrete backend from capture_config::source at init() time.
+class runtime_capture_backend {
+public:
+  bool init(audio_capture& owner, const capture_config& config, capture_callback& callback) noexcept {
+    backend_.emplace<std::monostate>();
+    switch (config.source) {
+    case capture_source::device:
+      return backend_.emplace<device_backend>().init(owner, config, callback);
+    case capture_source::file:
+      return backend_.emplace<file_replay_capture_backend>().init(owner, config, callback);
+    case capture_source::none:
+    default:
+      return backend_.emplace<null_capture_backend>().init(owner, config, callback);
+    }
+  }
+
+  bool start(audio_capture& owner, capture_callback& callback) noexcept {
+    return std::visit(
+      [&](auto& backend) -> bool {
+        if constexpr (is_empty_slot_v<decltype(backend)>) {
+          return false;
+        } else {
+          return backend.start(owner, callback);
+        }
+      },
+      backend_);
+  }
+
+  void stop(audio_capture& owner) noexcept {
+    std::visit(
+      [&](auto& backend) {
+        if constexpr (!is_empty_slot_v<decltype(backend)>) {
+          backend.stop(owner);
+        }
+      },
+      backend_);
+  }
+
+  void shutdown(audio_capture& owner) noexcept {
+    std::visit(
+      [&](auto& backend) {
+        if constexpr (!is_empty_slot_v<decltype(backend)>) {
+          backend.shutdown(owner);
+        }
+      },
+      backend_);
+    backend_.emplace<std::monostate>();
+  }
+
+  capture_stats stats() const noexcept {
+    return std::visit(
+      [](const auto& backend) -> capture_stats {
+        if constexpr (is_empty_slot_v<decltype(backend)>) {
+          return {};
+        } else {
+          return backend.stats();
+        }
+      },
+      backend_);
+  }
+
+  ring_pipeline* pipeline() noexcept {
+    return std::visit(
+      [](auto& backend) -> ring_pipeline* {
+        if constexpr (is_empty_slot_v<decltype(backend)>) {
+          return nullptr;
+        } else {
+          return backend.pipeline();
+        }
+      },
+      backend_);
+  }
+
+  const ring_pipeline* pipeline() const noexcept {
+    return std::visit(
+      [](const auto& backend) -> const ring_pipeline* {
+        if constexpr (is_empty_slot_v<decltype(backend)>) {
+          return nullptr;
+        } else {
+          return backend.pipeline();
+        }
+      },
+      backend_);
+  }
+
+private:
+  template <typename T>
+  static constexpr bool is_empty_slot_v = std::is_same_v<std::remove_cvref_t<T>, std::monostate>;
+
+  std::variant<std::monostate,
+    null_capture_backend,
+    file_replay_capture_backend
+#if defined(JAXIE_USE_MINIAUDIO)
+    ,
+    miniaudio_capture_backend
 #endif
+    >
+    backend_;
+};
+
+using selected_backend = runtime_capture_backend;
 
 } // namespace detail
 
@@ -371,6 +1065,59 @@ bool audio_capture::start() noexcept {
   return true;
 }
 
+capture_stats audio_capture::stats() const noexcept {
+  if (!pimpl_) {
+    return {};
+  }
+  return pimpl_->stats();
+}
+
+bool audio_capture::add_subscriber(capture_callback on_frames, uint32_t& id) noexcept {
+  if (!on_frames || !initialized_ || !pimpl_ || pimpl_->pipeline() == nullptr) {
+    return false;
+  }
+  return pimpl_->pipeline()->add_subscriber(&on_frames, id);
+}
+
+bool audio_capture::add_reader(uint32_t& id) noexcept {
+  if (!initialized_ || !pimpl_ || pimpl_->pipeline() == nullptr) {
+    return false;
+  }
+  return pimpl_->pipeline()->add_subscriber(nullptr, id);
+}
+
+bool audio_capture::acquire_period(uint32_t id, pcm_ring::read_view& view) noexcept {
+  return acquire_frames(id, cfg_.period_frames, view);
+}
+
+bool audio_capture::acquire_frames(uint32_t id, uint32_t frames, pcm_ring::read_view& view) noexcept {
+  if (!pimpl_ || pimpl_->pipeline() == nullptr) {
+    view = {};
+    return false;
+  }
+  return pimpl_->pipeline()->acquire_frames(id, frames, view);
+}
+
+bool audio_capture::commit_period(uint32_t id, const pcm_ring::read_view& view) noexcept {
+  if (!pimpl_ || pimpl_->pipeline() == nullptr) {
+    return false;
+  }
+  return pimpl_->pipeline()->commit_period(id, view);
+}
+
+void audio_capture::remove_subscriber(uint32_t id) noexcept {
+  if (pimpl_ && pimpl_->pipeline() != nullptr) {
+    pimpl_->pipeline()->remove_subscriber(id);
+  }
+}
+
+subscriber_stats audio_capture::stats(uint32_t id) const noexcept {
+  if (!pimpl_ || pimpl_->pipeline() == nullptr) {
+    return {};
+  }
+  return pimpl_->pipeline()->stats(id);
+}
+
 void audio_capture::stop() noexcept {
   if (!started_) {
     return;
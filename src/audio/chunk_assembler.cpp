@@ -0,0 +1,117 @@
+#include <Jaxie/audio/chunk_assembler.hpp>
+#include <Jaxie/realtime/latency_trace.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+namespace jaxie::audio {
+
+bool chunk_assembler::init(audio_capture& capture, const chunk_config& config) noexcept {
+  shutdown();
+  if (config.chunk_frames == 0) {
+    return false;
+  }
+  // Twice a window, so the producer can write a whole window ahead while the current one is still held.
+  const uint64_t window = static_cast<uint64_t>(config.left_frames) + config.chunk_frames + config.right_frames;
+  if (2 * window > capture.stats().ring.capacity_frames || !capture.add_reader(reader_)) {
+    return false;
+  }
+
+  capture_ = &capture;
+  config_ = config;
+  channels_ = capture.current_config().channels;
+  window_start_ = 0;
+  chunk_start_ = 0;
+  synced_ = false;
+  return true;
+}
+
+void chunk_assembler::shutdown() noexcept {
+  if (capture_ != nullptr) {
+    capture_->remove_subscriber(reader_);
+  }
+  capture_ = nullptr;
+  synced_ = false;
+}
+
+bool chunk_assembler::acquire(chunk_window& window) noexcept {
+  window = {};
+  if (capture_ == nullptr) {
+    return false;
+  }
+
+  const auto left = static_cast<uint32_t>(synced_ ? chunk_start_ - window_start_ : 0);
+  const uint32_t frames = left + config_.chunk_frames + config_.right_frames;
+  pcm_ring::read_view view{};
+  if (!capture_->acquire_frames(reader_, frames, view)) {
+    return false;
+  }
+
+  window.left_frames = left;
+  if (!synced_ || view.first_frame != window_start_) {
+    // First window, or the ring resynchronized a lapped cursor: start over without left context.
+    window_start_ = view.first_frame;
+    chunk_start_ = view.first_frame;
+    synced_ = true;
+    window.left_frames = 0;
+  }
+
+  window.chunk_frames = config_.chunk_frames;
+  window.right_frames = config_.right_frames;
+  window.channels = channels_;
+  window.first_frame = view.first_frame;
+  const uint32_t used = window.left_frames + window.chunk_frames + window.right_frames;
+  window.samples = view.samples.first(static_cast<size_t>(used) * channels_);
+  return true;
+}
+
+bool chunk_assembler::release(const chunk_window& window) noexcept {
+  if (capture_ == nullptr || !synced_ || window.first_frame != window_start_) {
+    return false;
+  }
+
+  // Keep up to left_frames before the next chunk readable; only what falls out of the context is consumed.
+  const uint64_t next_chunk = chunk_start_ + config_.chunk_frames;
+  const uint64_t next_start = (std::max)(window_start_, next_chunk - (std::min)(next_chunk, uint64_t{ config_.left_frames }));
+  chunk_start_ = next_chunk;
+  if (next_start == window_start_) {
+    return true;
+  }
+
+  pcm_ring::read_view consumed{};
+  consumed.first_frame = window_start_;
+  consumed.frames = static_cast<uint32_t>(next_start - window_start_);
+  window_start_ = next_start;
+  if (!capture_->commit_period(reader_, consumed)) {
+    synced_ = false;
+    return false;
+  }
+  return true;
+}
+
+size_t chunk_assembler::pump(const window_callback& on_window) noexcept {
+  size_t delivered = 0;
+  chunk_window window{};
+  while (acquire(window)) {
+    if (on_window) {
+      realtime::set_trace_origin(window.first_frame);
+      on_window(window);
+      realtime::set_trace_origin(realtime::no_trace_sample);
+    }
+    if (!release(window)) {
+      break;
+    }
+    ++delivered;
+  }
+  return delivered;
+}
+
+subscriber_stats chunk_assembler::stats() const noexcept {
+  if (capture_ == nullptr) {
+    return {};
+  }
+  return capture_->stats(reader_);
+}
+
+} // namespace jaxie::audio
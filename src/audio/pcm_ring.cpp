@@ -0,0 +1,425 @@
+#include <Jaxie/audio/pcm_ring.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <numeric>
+#include <span>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace jaxie::audio {
+
+bool pcm_ring::init(uint32_t capacity_frames, uint32_t channels, overrun_policy policy, ring_memory memory) noexcept {
+  release();
+  if (capacity_frames == 0 || channels == 0) {
+    return false;
+  }
+
+  const size_t frame_bytes = static_cast<size_t>(channels) * sizeof(float);
+  bool mapped = false;
+#if defined(__linux__)
+  if (memory == ring_memory::mirrored) {
+    // Round up to the smallest frame count whose byte size is a whole number of pages.
+    const auto page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    const size_t frames_per_unit = page / std::gcd(page, frame_bytes);
+    const size_t frames = ((capacity_frames + frames_per_unit - 1) / frames_per_unit) * frames_per_unit;
+    if (frames <= UINT32_MAX && map_mirrored(frames * frame_bytes)) {
+      capacity_frames = static_cast<uint32_t>(frames);
+      mapped = true;
+    }
+  }
+#endif
+
+  const size_t samples = static_cast<size_t>(capacity_frames) * channels;
+  try {
+    if (mapped) {
+      scratch_.clear();
+    } else {
+      heap_.assign(samples, 0.0F);
+      scratch_.assign(samples, 0.0F);
+      data_ = heap_.data();
+    }
+  } catch (...) {
+    release();
+    return false;
+  }
+
+  memory_ = mapped ? ring_memory::mirrored : ring_memory::heap;
+  data_samples_ = samples;
+  capacity_frames_ = capacity_frames;
+  channels_ = channels;
+  soft_limit_frames_ = capacity_frames - (capacity_frames / 4U);
+  policy_ = policy;
+  reset();
+  return true;
+}
+
+void pcm_ring::reset() noexcept {
+  write_pos_.store(0, std::memory_order_relaxed);
+  claim_pos_.store(0, std::memory_order_relaxed);
+  read_pos_.store(0, std::memory_order_relaxed);
+  overruns_.store(0, std::memory_order_relaxed);
+  underruns_.store(0, std::memory_order_relaxed);
+  dropped_frames_.store(0, std::memory_order_relaxed);
+  high_water_frames_.store(0, std::memory_order_relaxed);
+  for (auto& slot : readers_) {
+    slot.read_pos.store(0, std::memory_order_relaxed);
+  }
+}
+
+void pcm_ring::release() noexcept {
+  for (auto& slot : readers_) {
+    slot.attached.store(false, std::memory_order_relaxed);
+    slot.scratch.clear();
+    slot.scratch.shrink_to_fit();
+  }
+  unmap_mirrored();
+  capacity_frames_ = 0;
+  channels_ = 0;
+  data_ = nullptr;
+  data_samples_ = 0;
+  memory_ = ring_memory::heap;
+  heap_.clear();
+  heap_.shrink_to_fit();
+  scratch_.clear();
+  scratch_.shrink_to_fit();
+  reset();
+}
+
+uint32_t pcm_ring::write(std::span<const float> interleaved) noexcept {
+  if (!is_ready() || interleaved.empty()) {
+    return 0;
+  }
+
+  const uint64_t frames = interleaved.size() / channels_;
+  const uint64_t write_pos = write_pos_.load(std::memory_order_relaxed);
+  uint64_t accepted = 0;
+
+  if (policy_ == overrun_policy::overwrite) {
+    // Only the newest capacity_frames_ of an oversized burst can survive; skip the rest up front.
+    const uint64_t skipped = frames > capacity_frames_ ? frames - capacity_frames_ : 0;
+    if (skipped > 0) {
+      note_drop(skipped);
+    }
+    accepted = frames - skipped;
+    interleaved = interleaved.subspan(skipped * channels_);
+  } else {
+    const uint64_t read_pos = read_pos_.load(std::memory_order_acquire);
+    const uint64_t free_frames = capacity_frames_ - (write_pos - read_pos);
+    accepted = (std::min)(free_frames, frames);
+    if (accepted < frames) {
+      // drop_oldest only reaches here when the consumer has stalled past the hard limit.
+      note_drop(frames - accepted);
+    }
+  }
+
+  // Publish the claim before touching memory so a concurrent reader can tell its view was torn. Secondary
+  // readers never hold the producer back, so this is needed under every policy.
+  claim_pos_.store(write_pos + accepted, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  copy_in(write_pos, interleaved.first(accepted * channels_));
+
+  const uint64_t new_write = write_pos + accepted;
+  write_pos_.store(new_write, std::memory_order_release);
+
+  const uint64_t fill = (std::min)(new_write - read_pos_.load(std::memory_order_relaxed), uint64_t{ capacity_frames_ });
+  if (fill > high_water_frames_.load(std::memory_order_relaxed)) {
+    high_water_frames_.store(fill, std::memory_order_relaxed);
+  }
+  return static_cast<uint32_t>(accepted);
+}
+
+uint32_t pcm_ring::writable_frames() const noexcept {
+  const uint64_t fill = (std::min)(
+    write_pos_.load(std::memory_order_relaxed) - read_pos_.load(std::memory_order_acquire), uint64_t{ capacity_frames_ });
+  const uint64_t limit = policy_ == overrun_policy::drop_oldest ? soft_limit_frames_ : capacity_frames_;
+  return static_cast<uint32_t>(fill < limit ? limit - fill : 0);
+}
+
+bool pcm_ring::read(std::span<float> out) noexcept {
+  if (!is_ready() || out.empty() || (out.size() % channels_) != 0) {
+    return false;
+  }
+
+  read_view view{};
+  if (!acquire_read(static_cast<uint32_t>(out.size() / channels_), view)) {
+    return false;
+  }
+  std::memcpy(out.data(), view.samples.data(), out.size() * sizeof(float));
+  return commit_read(view);
+}
+
+bool pcm_ring::acquire_read(uint32_t frames, read_view& view) noexcept {
+  view = {};
+  if (!is_ready() || frames == 0 || frames > capacity_frames_) {
+    return false;
+  }
+
+  const uint64_t write_pos = write_pos_.load(std::memory_order_acquire);
+  const uint64_t read_pos = resync_reader(read_pos_.load(std::memory_order_relaxed), write_pos);
+  read_pos_.store(read_pos, std::memory_order_release);
+
+  if (write_pos - read_pos < frames) {
+    underruns_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  view.samples = view_at(read_pos, frames, scratch_);
+  view.first_frame = read_pos;
+  view.frames = frames;
+  return true;
+}
+
+bool pcm_ring::commit_read(const read_view& view) noexcept {
+  if (!is_ready() || view.frames == 0) {
+    return false;
+  }
+
+  uint64_t valid_from = 0;
+  if (policy_ == overrun_policy::overwrite && lapped(view.first_frame, valid_from)) {
+    // The producer lapped the view while it was in use; discard everything it may have overwritten.
+    note_drop(valid_from - view.first_frame);
+    read_pos_.store(valid_from, std::memory_order_release);
+    return false;
+  }
+
+  read_pos_.store(view.first_frame + view.frames, std::memory_order_release);
+  return true;
+}
+
+uint32_t pcm_ring::readable_frames() const noexcept {
+  const uint64_t write_pos = write_pos_.load(std::memory_order_acquire);
+  const uint64_t read_pos = read_pos_.load(std::memory_order_relaxed);
+  return static_cast<uint32_t>((std::min)(write_pos - read_pos, uint64_t{ capacity_frames_ }));
+}
+
+bool pcm_ring::attach_reader(uint32_t& reader) noexcept {
+  if (!is_ready()) {
+    return false;
+  }
+  for (uint32_t i = 0; i < max_readers; ++i) {
+    reader_slot& slot = readers_[i];
+    if (slot.attached.load(std::memory_order_acquire)) {
+      continue;
+    }
+    try {
+      slot.scratch.assign(memory_ == ring_memory::mirrored ? 0 : data_samples_, 0.0F);
+    } catch (...) {
+      return false;
+    }
+    slot.delivered_frames.store(0, std::memory_order_relaxed);
+    slot.overruns.store(0, std::memory_order_relaxed);
+    slot.dropped_frames.store(0, std::memory_order_relaxed);
+    slot.lag_frames.store(0, std::memory_order_relaxed);
+    slot.max_lag_frames.store(0, std::memory_order_relaxed);
+    slot.read_pos.store(write_pos_.load(std::memory_order_acquire), std::memory_order_relaxed);
+    slot.attached.store(true, std::memory_order_release);
+    reader = i;
+    return true;
+  }
+  return false;
+}
+
+void pcm_ring::detach_reader(uint32_t reader) noexcept {
+  if (reader < max_readers) {
+    readers_[reader].attached.store(false, std::memory_order_release);
+  }
+}
+
+bool pcm_ring::acquire_read(uint32_t reader, uint32_t frames, read_view& view) noexcept {
+  view = {};
+  if (!is_ready() || reader >= max_readers || frames == 0 || frames > capacity_frames_) {
+    return false;
+  }
+  reader_slot& slot = readers_[reader];
+  if (!slot.attached.load(std::memory_order_acquire)) {
+    return false;
+  }
+
+  const uint64_t write_pos = write_pos_.load(std::memory_order_acquire);
+  uint64_t read_pos = slot.read_pos.load(std::memory_order_relaxed);
+  // Lag is measured before any resync so it shows how far behind the reader really fell.
+  const uint64_t lag = write_pos - read_pos;
+  slot.lag_frames.store(lag, std::memory_order_relaxed);
+  if (lag > slot.max_lag_frames.load(std::memory_order_relaxed)) {
+    slot.max_lag_frames.store(lag, std::memory_order_relaxed);
+  }
+  if (lag > capacity_frames_) {
+    const uint64_t valid_from = write_pos - capacity_frames_;
+    slot.overruns.fetch_add(1, std::memory_order_relaxed);
+    slot.dropped_frames.fetch_add(valid_from - read_pos, std::memory_order_relaxed);
+    read_pos = valid_from;
+    slot.read_pos.store(read_pos, std::memory_order_release);
+  }
+
+  if (write_pos - read_pos < frames) {
+    return false;
+  }
+
+  view.samples = view_at(read_pos, frames, slot.scratch);
+  view.first_frame = read_pos;
+  view.frames = frames;
+  return true;
+}
+
+bool pcm_ring::commit_read(uint32_t reader, const read_view& view) noexcept {
+  if (!is_ready() || reader >= max_readers || view.frames == 0) {
+    return false;
+  }
+  reader_slot& slot = readers_[reader];
+
+  uint64_t valid_from = 0;
+  if (lapped(view.first_frame, valid_from)) {
+    slot.overruns.fetch_add(1, std::memory_order_relaxed);
+    slot.dropped_frames.fetch_add(valid_from - view.first_frame, std::memory_order_relaxed);
+    slot.read_pos.store(valid_from, std::memory_order_release);
+    return false;
+  }
+
+  slot.delivered_frames.fetch_add(view.frames, std::memory_order_relaxed);
+  slot.read_pos.store(view.first_frame + view.frames, std::memory_order_release);
+  return true;
+}
+
+uint32_t pcm_ring::readable_frames(uint32_t reader) const noexcept {
+  if (reader >= max_readers || !readers_[reader].attached.load(std::memory_order_acquire)) {
+    return 0;
+  }
+  const uint64_t write_pos = write_pos_.load(std::memory_order_acquire);
+  const uint64_t read_pos = readers_[reader].read_pos.load(std::memory_order_relaxed);
+  return static_cast<uint32_t>((std::min)(write_pos - read_pos, uint64_t{ capacity_frames_ }));
+}
+
+reader_stats pcm_ring::stats(uint32_t reader) const noexcept {
+  reader_stats out{};
+  if (reader >= max_readers) {
+    return out;
+  }
+  const reader_slot& slot = readers_[reader];
+  out.delivered_frames = slot.delivered_frames.load(std::memory_order_relaxed);
+  out.overruns = slot.overruns.load(std::memory_order_relaxed);
+  out.dropped_frames = slot.dropped_frames.load(std::memory_order_relaxed);
+  out.lag_frames = slot.lag_frames.load(std::memory_order_relaxed);
+  out.max_lag_frames = slot.max_lag_frames.load(std::memory_order_relaxed);
+  return out;
+}
+
+ring_stats pcm_ring::stats() const noexcept {
+  ring_stats out{};
+  out.overruns = overruns_.load(std::memory_order_relaxed);
+  out.underruns = underruns_.load(std::memory_order_relaxed);
+  out.dropped_frames = dropped_frames_.load(std::memory_order_relaxed);
+  out.high_water_frames = high_water_frames_.load(std::memory_order_relaxed);
+  out.capacity_frames = capacity_frames_;
+  return out;
+}
+
+bool pcm_ring::map_mirrored(size_t bytes) noexcept {
+#if defined(__linux__) && defined(MFD_CLOEXEC)
+  const int fd = memfd_create("jaxie_pcm_ring", MFD_CLOEXEC);
+  if (fd < 0) {
+    return false;
+  }
+  if (ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+    close(fd);
+    return false;
+  }
+
+  // Reserve twice the span, then map the same file over both halves.
+  void* base = mmap(nullptr, bytes * 2, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (base == MAP_FAILED) {
+    close(fd);
+    return false;
+  }
+  auto* lower = static_cast<unsigned char*>(base);
+  const bool ok = mmap(lower, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) != MAP_FAILED
+                  && mmap(lower + bytes, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) != MAP_FAILED;
+  close(fd);
+  if (!ok) {
+    munmap(base, bytes * 2);
+    return false;
+  }
+
+  mapping_ = base;
+  mapping_bytes_ = bytes * 2;
+  data_ = static_cast<float*>(base);
+  return true;
+#else
+  static_cast<void>(bytes);
+  return false;
+#endif
+}
+
+void pcm_ring::unmap_mirrored() noexcept {
+#if defined(__linux__)
+  if (mapping_ != nullptr) {
+    munmap(mapping_, mapping_bytes_);
+  }
+#endif
+  mapping_ = nullptr;
+  mapping_bytes_ = 0;
+}
+
+void pcm_ring::copy_in(uint64_t frame_pos, std::span<const float> samples) noexcept {
+  const size_t offset = static_cast<size_t>(static_cast<uint32_t>(frame_pos % capacity_frames_)) * channels_;
+  if (memory_ == ring_memory::mirrored) {
+    std::memcpy(data_ + offset, samples.data(), samples.size_bytes());
+    return;
+  }
+  const size_t first = (std::min)(samples.size(), data_samples_ - offset);
+  std::memcpy(data_ + offset, samples.data(), first * sizeof(float));
+  if (first < samples.size()) {
+    std::memcpy(data_, samples.subspan(first).data(), (samples.size() - first) * sizeof(float));
+  }
+}
+
+std::span<const float> pcm_ring::view_at(uint64_t frame_pos, uint32_t frames, std::vector<float>& scratch) const noexcept {
+  const size_t offset = static_cast<size_t>(static_cast<uint32_t>(frame_pos % capacity_frames_)) * channels_;
+  const size_t count = static_cast<size_t>(frames) * channels_;
+  if (memory_ == ring_memory::mirrored || offset + count <= data_samples_) {
+    return { data_ + offset, count };
+  }
+  // Heap fallback: stitch the two halves of a wrapped view together.
+  const size_t first = data_samples_ - offset;
+  std::memcpy(scratch.data(), data_ + offset, first * sizeof(float));
+  std::memcpy(scratch.data() + first, data_, (count - first) * sizeof(float));
+  return { scratch.data(), count };
+}
+
+bool pcm_ring::lapped(uint64_t first_frame, uint64_t& valid_from) const noexcept {
+  // Pairs with the release fence in write(): a claim that covers the view means its memory may be torn.
+  std::atomic_thread_fence(std::memory_order_acquire);
+  const uint64_t claim = claim_pos_.load(std::memory_order_relaxed);
+  if (claim <= first_frame + capacity_frames_) {
+    return false;
+  }
+  valid_from = claim - capacity_frames_;
+  return true;
+}
+
+uint64_t pcm_ring::resync_reader(uint64_t read_pos, uint64_t write_pos) noexcept {
+  const uint64_t fill = write_pos - read_pos;
+  if (policy_ == overrun_policy::overwrite && fill > capacity_frames_) {
+    note_drop(fill - capacity_frames_);
+    return write_pos - capacity_frames_;
+  }
+  if (policy_ == overrun_policy::drop_oldest && fill > soft_limit_frames_) {
+    // Skip down to half the soft limit so a consumer hovering at the limit does not drop every period.
+    const uint64_t skip = fill - (soft_limit_frames_ / 2U);
+    note_drop(skip);
+    return read_pos + skip;
+  }
+  return read_pos;
+}
+
+void pcm_ring::note_drop(uint64_t frames) noexcept {
+  overruns_.fetch_add(1, std::memory_order_relaxed);
+  dropped_frames_.fetch_add(frames, std::memory_order_relaxed);
+}
+
+} // namespace jaxie::audio
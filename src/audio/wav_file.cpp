@@ -0,0 +1,161 @@
+#include <Jaxie/audio/wav_file.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace jaxie::audio {
+namespace {
+
+constexpr uint16_t wave_format_pcm = 1;
+constexpr uint16_t wave_format_float = 3;
+constexpr uint16_t wave_format_extensible = 0xFFFE;
+
+bool read_file(const std::string& path, std::vector<unsigned char>& bytes) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in) {
+    return false;
+  }
+  bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+  return !in.bad();
+}
+
+uint32_t read_le(std::span<const unsigned char> bytes, size_t offset, size_t width) noexcept {
+  uint32_t value = 0;
+  for (size_t i = 0; i < width; ++i) {
+    value |= static_cast<uint32_t>(bytes[offset + i]) << (8U * i);
+  }
+  return value;
+}
+
+float read_sample(std::span<const unsigned char> bytes, size_t offset, uint16_t format, uint16_t bits) noexcept {
+  if (format == wave_format_float) {
+    return std::bit_cast<float>(read_le(bytes, offset, 4));
+  }
+  switch (bits) {
+  case 16:
+    return static_cast<float>(static_cast<int16_t>(read_le(bytes, offset, 2))) / 32768.0F;
+  case 24: {
+    // Sign-extend from bit 23.
+    const auto raw = static_cast<int32_t>(read_le(bytes, offset, 3) << 8U) >> 8;
+    return static_cast<float>(raw) / 8388608.0F;
+  }
+  case 32:
+    return static_cast<float>(static_cast<double>(static_cast<int32_t>(read_le(bytes, offset, 4))) / 2147483648.0);
+  default:
+    return 0.0F;
+  }
+}
+
+bool decode_wav(std::span<const unsigned char> bytes, pcm_clip& out) {
+  constexpr size_t riff_header = 12;
+  if (bytes.size() < riff_header || std::memcmp(bytes.data(), "RIFF", 4) != 0
+      || std::memcmp(bytes.subspan(8).data(), "WAVE", 4) != 0) {
+    return false;
+  }
+
+  uint16_t format = 0;
+  uint16_t channels = 0;
+  uint32_t sample_rate = 0;
+  uint16_t bits = 0;
+  std::span<const unsigned char> data{};
+
+  size_t pos = riff_header;
+  while (pos + 8 <= bytes.size()) {
+    const auto chunk_id = bytes.subspan(pos, 4);
+    const size_t chunk_size = read_le(bytes, pos + 4, 4);
+    const size_t body = pos + 8;
+    const size_t body_size = (std::min)(chunk_size, bytes.size() - body);
+    if (std::memcmp(chunk_id.data(), "fmt ", 4) == 0 && body_size >= 16) {
+      format = static_cast<uint16_t>(read_le(bytes, body, 2));
+      channels = static_cast<uint16_t>(read_le(bytes, body + 2, 2));
+      sample_rate = read_le(bytes, body + 4, 4);
+      bits = static_cast<uint16_t>(read_le(bytes, body + 14, 2));
+      if (format == wave_format_extensible && body_size >= 26) {
+        // The first two bytes of the SubFormat GUID carry the real format tag.
+        format = static_cast<uint16_t>(read_le(bytes, body + 24, 2));
+      }
+    } else if (std::memcmp(chunk_id.data(), "data", 4) == 0) {
+      data = bytes.subspan(body, body_size);
+    }
+    pos = body + chunk_size + (chunk_size & 1U); // chunks are word aligned
+  }
+
+  const bool supported = (format == wave_format_pcm && (bits == 16 || bits == 24 || bits == 32))
+                         || (format == wave_format_float && bits == 32);
+  if (!supported || channels == 0 || sample_rate == 0 || data.empty()) {
+    return false;
+  }
+
+  const size_t width = bits / 8U;
+  const size_t sample_count = (data.size() / (width * channels)) * channels;
+  out.sample_rate_hz = sample_rate;
+  out.channels = channels;
+  out.samples.resize(sample_count);
+  for (size_t i = 0; i < sample_count; ++i) {
+    out.samples[i] = read_sample(data, i * width, format, bits);
+  }
+  return true;
+}
+
+bool has_wav_extension(const std::string& path) {
+  if (path.size() < 4) {
+    return false;
+  }
+  std::string ext = path.substr(path.size() - 4);
+  std::transform(
+    ext.begin(), ext.end(), ext.begin(), [](unsigned char chr) { return static_cast<char>(std::tolower(chr)); });
+  return ext == ".wav";
+}
+
+} // namespace
+
+bool load_wav(const std::string& path, pcm_clip& out) noexcept {
+  try {
+    std::vector<unsigned char> bytes;
+    if (!read_file(path, bytes)) {
+      return false;
+    }
+    return decode_wav(bytes, out);
+  } catch (...) {
+    return false;
+  }
+}
+
+bool load_raw_f32(const std::string& path, uint32_t sample_rate_hz, uint32_t channels, pcm_clip& out) noexcept {
+  if (sample_rate_hz == 0 || channels == 0) {
+    return false;
+  }
+  try {
+    std::vector<unsigned char> bytes;
+    if (!read_file(path, bytes)) {
+      return false;
+    }
+    const size_t frame_bytes = sizeof(float) * channels;
+    out.sample_rate_hz = sample_rate_hz;
+    out.channels = channels;
+    out.samples.resize((bytes.size() / frame_bytes) * channels);
+    for (size_t i = 0; i < out.samples.size(); ++i) {
+      out.samples[i] = std::bit_cast<float>(read_le(bytes, i * sizeof(float), 4));
+    }
+    return !out.samples.empty();
+  } catch (...) {
+    return false;
+  }
+}
+
+bool load_pcm_file(const std::string& path, uint32_t raw_sample_rate_hz, uint32_t raw_channels, pcm_clip& out) noexcept {
+  if (has_wav_extension(path)) {
+    return load_wav(path, out);
+  }
+  return load_raw_f32(path, raw_sample_rate_hz, raw_channels, out);
+}
+
+} // namespace jaxie::audio
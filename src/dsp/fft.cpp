@@ -0,0 +1,100 @@
+#include <Jaxie/dsp/fft.hpp>
+
+#include <cmath>
+#include <cstddef>
+#include <numbers>
+#include <span>
+
+namespace jaxie::dsp {
+
+bool real_fft::init(size_t size) noexcept {
+  if (size < 4 || (size & (size - 1)) != 0) {
+    return false;
+  }
+  size_ = size;
+  const size_t half = size / 2;
+
+  try {
+    bit_reverse_.assign(half, 0);
+    twiddle_re_.assign(half, 0.0F);
+    twiddle_im_.assign(half, 0.0F);
+    work_re_.assign(half, 0.0F);
+    work_im_.assign(half, 0.0F);
+  } catch (...) {
+    size_ = 0;
+    return false;
+  }
+
+  size_t log2_half = 0;
+  while ((size_t{ 1 } << log2_half) < half) {
+    ++log2_half;
+  }
+  for (size_t i = 0; i < half; ++i) {
+    size_t reversed = 0;
+    for (size_t bit = 0; bit < log2_half; ++bit) {
+      reversed |= ((i >> bit) & 1U) << (log2_half - 1 - bit);
+    }
+    bit_reverse_[i] = reversed;
+  }
+
+  for (size_t k = 0; k < half; ++k) {
+    const double angle = -2.0 * std::numbers::pi * static_cast<double>(k) / static_cast<double>(size);
+    twiddle_re_[k] = static_cast<float>(std::cos(angle));
+    twiddle_im_[k] = static_cast<float>(std::sin(angle));
+  }
+  return true;
+}
+
+void real_fft::forward(std::span<const float> in, std::span<float> re, std::span<float> im) noexcept {
+  const size_t half = size_ / 2;
+
+  // Pack even/odd samples as one complex signal of half the length, in bit-reversed order.
+  for (size_t i = 0; i < half; ++i) {
+    const size_t src = bit_reverse_[i];
+    work_re_[i] = in[2 * src];
+    work_im_[i] = in[(2 * src) + 1];
+  }
+
+  // Iterative radix-2 butterflies on split real/imaginary arrays, so the inner loop stays unit-stride.
+  for (size_t span_len = 2; span_len <= half; span_len *= 2) {
+    const size_t stride = size_ / span_len; // twiddles are indexed at the full length
+    const size_t mid = span_len / 2;
+    for (size_t base = 0; base < half; base += span_len) {
+      for (size_t j = 0; j < mid; ++j) {
+        const float w_re = twiddle_re_[j * stride];
+        const float w_im = twiddle_im_[j * stride];
+        const size_t top = base + j;
+        const size_t bottom = top + mid;
+        const float t_re = (work_re_[bottom] * w_re) - (work_im_[bottom] * w_im);
+        const float t_im = (work_re_[bottom] * w_im) + (work_im_[bottom] * w_re);
+        work_re_[bottom] = work_re_[top] - t_re;
+        work_im_[bottom] = work_im_[top] - t_im;
+        work_re_[top] += t_re;
+        work_im_[top] += t_im;
+      }
+    }
+  }
+
+  // Split Z into the spectra of the even and odd samples and combine them:
+  // X[k] = (Z[k] + conj(Z[h-k])) / 2 - i e^{-2 pi i k / n} (Z[k] - conj(Z[h-k])) / 2
+  re[0] = work_re_[0] + work_im_[0];
+  im[0] = 0.0F;
+  re[half] = work_re_[0] - work_im_[0];
+  im[half] = 0.0F;
+  for (size_t k = 1; k < half; ++k) {
+    const float z_re = work_re_[k];
+    const float z_im = work_im_[k];
+    const float c_re = work_re_[half - k];
+    const float c_im = -work_im_[half - k];
+    const float even_re = 0.5F * (z_re + c_re);
+    const float even_im = 0.5F * (z_im + c_im);
+    const float odd_re = 0.5F * (z_im - c_im);
+    const float odd_im = -0.5F * (z_re - c_re);
+    const float w_re = twiddle_re_[k];
+    const float w_im = twiddle_im_[k];
+    re[k] = even_re + ((odd_re * w_re) - (odd_im * w_im));
+    im[k] = even_im + ((odd_re * w_im) + (odd_im * w_re));
+  }
+}
+
+} // namespace jaxie::dsp
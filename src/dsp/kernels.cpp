@@ -0,0 +1,313 @@
+#include <Jaxie/dsp/kernels.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define JAXIE_DSP_X86_DISPATCH 1
+#include <immintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define JAXIE_DSP_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace jaxie::dsp {
+namespace {
+
+float dot_scalar(const float* lhs, const float* rhs, size_t count) noexcept {
+  float acc = 0.0F;
+  for (size_t i = 0; i < count; ++i) {
+    acc += lhs[i] * rhs[i];
+  }
+  return acc;
+}
+
+void s16_to_f32_scalar(const int16_t* in, float* out, size_t count) noexcept {
+  constexpr float scale = 1.0F / 32768.0F;
+  for (size_t i = 0; i < count; ++i) {
+    out[i] = static_cast<float>(in[i]) * scale;
+  }
+}
+
+void downmix_scalar(const float* in, uint32_t channels, float* out, size_t frames) noexcept {
+  const float scale = 1.0F / static_cast<float>(channels);
+  for (size_t frame = 0; frame < frames; ++frame) {
+    float acc = 0.0F;
+    for (uint32_t chan = 0; chan < channels; ++chan) {
+      acc += in[(frame * channels) + chan];
+    }
+    out[frame] = acc * scale;
+  }
+}
+
+void multiply_scalar(const float* lhs, const float* rhs, float* out, size_t count) noexcept {
+  for (size_t i = 0; i < count; ++i) {
+    out[i] = lhs[i] * rhs[i];
+  }
+}
+
+void preemphasis_scalar(const float* in, float coeff, float previous, float* out, size_t count) noexcept {
+  for (size_t i = 0; i < count; ++i) {
+    out[i] = in[i] - (coeff * previous);
+    previous = in[i];
+  }
+}
+
+void power_spectrum_scalar(const float* re, const float* im, float* out, size_t count) noexcept {
+  for (size_t i = 0; i < count; ++i) {
+    out[i] = (re[i] * re[i]) + (im[i] * im[i]);
+  }
+}
+
+#if defined(JAXIE_DSP_X86_DISPATCH)
+
+bool cpu_has_avx2() noexcept {
+  static const bool supported = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+  return supported;
+}
+
+__attribute__((target("avx2,fma"))) float dot_avx2(const float* lhs, const float* rhs, size_t count) noexcept {
+  __m256 acc0 = _mm256_setzero_ps();
+  __m256 acc1 = _mm256_setzero_ps();
+  size_t i = 0;
+  for (; i + 16 <= count; i += 16) {
+    acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(lhs + i), _mm256_loadu_ps(rhs + i), acc0);
+    acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(lhs + i + 8), _mm256_loadu_ps(rhs + i + 8), acc1);
+  }
+  for (; i + 8 <= count; i += 8) {
+    acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(lhs + i), _mm256_loadu_ps(rhs + i), acc0);
+  }
+  const __m256 acc = _mm256_add_ps(acc0, acc1);
+  __m128 sum = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+  sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+  sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 0x1));
+  return _mm_cvtss_f32(sum) + dot_scalar(lhs + i, rhs + i, count - i);
+}
+
+__attribute__((target("avx2,fma"))) void s16_to_f32_avx2(const int16_t* in, float* out, size_t count) noexcept {
+  const __m256 scale = _mm256_set1_ps(1.0F / 32768.0F);
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    const __m128i raw = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i)); // NOLINT(*-reinterpret-cast)
+    _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(raw)), scale));
+  }
+  s16_to_f32_scalar(in + i, out + i, count - i);
+}
+
+__attribute__((target("avx2,fma"))) void downmix_stereo_avx2(const float* in, float* out, size_t frames) noexcept {
+  const __m256 half = _mm256_set1_ps(0.5F);
+  size_t frame = 0;
+  for (; frame + 8 <= frames; frame += 8) {
+    // hadd pairs L/R within each 128-bit lane; the permute restores frame order across lanes.
+    const __m256 pairs = _mm256_hadd_ps(_mm256_loadu_ps(in + (frame * 2)), _mm256_loadu_ps(in + (frame * 2) + 8));
+    const __m256 ordered = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(pairs), 0xD8));
+    _mm256_storeu_ps(out + frame, _mm256_mul_ps(ordered, half));
+  }
+  downmix_scalar(in + (frame * 2), 2, out + frame, frames - frame);
+}
+
+__attribute__((target("avx2,fma"))) void multiply_avx2(const float* lhs, const float* rhs, float* out, size_t count) noexcept {
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_loadu_ps(lhs + i), _mm256_loadu_ps(rhs + i)));
+  }
+  multiply_scalar(lhs + i, rhs + i, out + i, count - i);
+}
+
+// Caller handles in[0]; every vector reads its own samples and the ones one step behind.
+__attribute__((target("avx2,fma"))) void preemphasis_avx2(const float* in, float coeff, float* out, size_t count) noexcept {
+  const __m256 neg_coeff = _mm256_set1_ps(-coeff);
+  size_t i = 1;
+  for (; i + 8 <= count; i += 8) {
+    _mm256_storeu_ps(out + i, _mm256_fmadd_ps(_mm256_loadu_ps(in + i - 1), neg_coeff, _mm256_loadu_ps(in + i)));
+  }
+  preemphasis_scalar(in + i, coeff, in[i - 1], out + i, count - i);
+}
+
+__attribute__((target("avx2,fma"))) void power_spectrum_avx2(const float* re, const float* im, float* out, size_t count) noexcept {
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    const __m256 real = _mm256_loadu_ps(re + i);
+    const __m256 imag = _mm256_loadu_ps(im + i);
+    _mm256_storeu_ps(out + i, _mm256_fmadd_ps(real, real, _mm256_mul_ps(imag, imag)));
+  }
+  power_spectrum_scalar(re + i, im + i, out + i, count - i);
+}
+
+#elif defined(JAXIE_DSP_NEON)
+
+float dot_neon(const float* lhs, const float* rhs, size_t count) noexcept {
+  float32x4_t acc0 = vdupq_n_f32(0.0F);
+  float32x4_t acc1 = vdupq_n_f32(0.0F);
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    acc0 = vmlaq_f32(acc0, vld1q_f32(lhs + i), vld1q_f32(rhs + i));
+    acc1 = vmlaq_f32(acc1, vld1q_f32(lhs + i + 4), vld1q_f32(rhs + i + 4));
+  }
+  const float32x4_t acc = vaddq_f32(acc0, acc1);
+  const float32x2_t half = vadd_f32(vget_low_f32(acc), vget_high_f32(acc));
+  return vget_lane_f32(vpadd_f32(half, half), 0) + dot_scalar(lhs + i, rhs + i, count - i);
+}
+
+void s16_to_f32_neon(const int16_t* in, float* out, size_t count) noexcept {
+  const float32x4_t scale = vdupq_n_f32(1.0F / 32768.0F);
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    const int16x8_t raw = vld1q_s16(in + i);
+    vst1q_f32(out + i, vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(raw))), scale));
+    vst1q_f32(out + i + 4, vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(raw))), scale));
+  }
+  s16_to_f32_scalar(in + i, out + i, count - i);
+}
+
+void downmix_stereo_neon(const float* in, float* out, size_t frames) noexcept {
+  const float32x4_t half = vdupq_n_f32(0.5F);
+  size_t frame = 0;
+  for (; frame + 4 <= frames; frame += 4) {
+    const float32x4x2_t lr = vld2q_f32(in + (frame * 2));
+    vst1q_f32(out + frame, vmulq_f32(vaddq_f32(lr.val[0], lr.val[1]), half));
+  }
+  downmix_scalar(in + (frame * 2), 2, out + frame, frames - frame);
+}
+
+void multiply_neon(const float* lhs, const float* rhs, float* out, size_t count) noexcept {
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    vst1q_f32(out + i, vmulq_f32(vld1q_f32(lhs + i), vld1q_f32(rhs + i)));
+  }
+  multiply_scalar(lhs + i, rhs + i, out + i, count - i);
+}
+
+// Caller handles in[0]; every vector reads its own samples and the ones one step behind.
+void preemphasis_neon(const float* in, float coeff, float* out, size_t count) noexcept {
+  size_t i = 1;
+  for (; i + 4 <= count; i += 4) {
+    vst1q_f32(out + i, vmlsq_n_f32(vld1q_f32(in + i), vld1q_f32(in + i - 1), coeff));
+  }
+  preemphasis_scalar(in + i, coeff, in[i - 1], out + i, count - i);
+}
+
+void power_spectrum_neon(const float* re, const float* im, float* out, size_t count) noexcept {
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    const float32x4_t real = vld1q_f32(re + i);
+    const float32x4_t imag = vld1q_f32(im + i);
+    vst1q_f32(out + i, vmlaq_f32(vmulq_f32(imag, imag), real, real));
+  }
+  power_spectrum_scalar(re + i, im + i, out + i, count - i);
+}
+
+#endif
+
+} // namespace
+
+std::string_view simd_backend() noexcept {
+#if defined(JAXIE_DSP_X86_DISPATCH)
+  return cpu_has_avx2() ? "avx2" : "scalar";
+#elif defined(JAXIE_DSP_NEON)
+  return "neon";
+#else
+  return "scalar";
+#endif
+}
+
+float dot(std::span<const float> lhs, std::span<const float> rhs) noexcept {
+  const size_t count = (std::min)(lhs.size(), rhs.size());
+#if defined(JAXIE_DSP_X86_DISPATCH)
+  if (cpu_has_avx2()) {
+    return dot_avx2(lhs.data(), rhs.data(), count);
+  }
+#elif defined(JAXIE_DSP_NEON)
+  return dot_neon(lhs.data(), rhs.data(), count);
+#endif
+  return dot_scalar(lhs.data(), rhs.data(), count);
+}
+
+void s16_to_f32(std::span<const int16_t> in, std::span<float> out) noexcept {
+  const size_t count = (std::min)(in.size(), out.size());
+#if defined(JAXIE_DSP_X86_DISPATCH)
+  if (cpu_has_avx2()) {
+    s16_to_f32_avx2(in.data(), out.data(), count);
+    return;
+  }
+#elif defined(JAXIE_DSP_NEON)
+  s16_to_f32_neon(in.data(), out.data(), count);
+  return;
+#endif
+  s16_to_f32_scalar(in.data(), out.data(), count);
+}
+
+void downmix_to_mono(std::span<const float> interleaved, uint32_t channels, std::span<float> out) noexcept {
+  if (channels == 0) {
+    return;
+  }
+  const size_t frames = (std::min)(interleaved.size() / channels, out.size());
+  if (channels == 1) {
+    std::copy_n(interleaved.begin(), frames, out.begin());
+    return;
+  }
+  if (channels == 2) {
+#if defined(JAXIE_DSP_X86_DISPATCH)
+    if (cpu_has_avx2()) {
+      downmix_stereo_avx2(interleaved.data(), out.data(), frames);
+      return;
+    }
+#elif defined(JAXIE_DSP_NEON)
+    downmix_stereo_neon(interleaved.data(), out.data(), frames);
+    return;
+#endif
+  }
+  downmix_scalar(interleaved.data(), channels, out.data(), frames);
+}
+
+void multiply(std::span<const float> lhs, std::span<const float> rhs, std::span<float> out) noexcept {
+  const size_t count = (std::min)({ lhs.size(), rhs.size(), out.size() });
+#if defined(JAXIE_DSP_X86_DISPATCH)
+  if (cpu_has_avx2()) {
+    multiply_avx2(lhs.data(), rhs.data(), out.data(), count);
+    return;
+  }
+#elif defined(JAXIE_DSP_NEON)
+  multiply_neon(lhs.data(), rhs.data(), out.data(), count);
+  return;
+#endif
+  multiply_scalar(lhs.data(), rhs.data(), out.data(), count);
+}
+
+float preemphasis(std::span<const float> in, float coeff, float previous, std::span<float> out) noexcept {
+  const size_t count = (std::min)(in.size(), out.size());
+  if (count == 0) {
+    return previous;
+  }
+  out[0] = in[0] - (coeff * previous);
+#if defined(JAXIE_DSP_X86_DISPATCH)
+  if (cpu_has_avx2()) {
+    preemphasis_avx2(in.data(), coeff, out.data(), count);
+    return in[count - 1];
+  }
+#elif defined(JAXIE_DSP_NEON)
+  preemphasis_neon(in.data(), coeff, out.data(), count);
+  return in[count - 1];
+#endif
+  preemphasis_scalar(in.data() + 1, coeff, in[0], out.data() + 1, count - 1);
+  return in[count - 1];
+}
+
+void power_spectrum(std::span<const float> re, std::span<const float> im, std::span<float> out) noexcept {
+  const size_t count = (std::min)({ re.size(), im.size(), out.size() });
+#if defined(JAXIE_DSP_X86_DISPATCH)
+  if (cpu_has_avx2()) {
+    power_spectrum_avx2(re.data(), im.data(), out.data(), count);
+    return;
+  }
+#elif defined(JAXIE_DSP_NEON)
+  power_spectrum_neon(re.data(), im.data(), out.data(), count);
+  return;
+#endif
+  power_spectrum_scalar(re.data(), im.data(), out.data(), count);
+}
+
+} // namespace jaxie::dsp
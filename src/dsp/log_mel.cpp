@@ -0,0 +1,162 @@
+#include <Jaxie/dsp/kernels.hpp>
+#include <Jaxie/dsp/log_mel.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <numbers>
+#include <span>
+
+namespace jaxie::dsp {
+namespace {
+
+double hz_to_mel(double hz) noexcept { return 2595.0 * std::log10(1.0 + (hz / 700.0)); }
+
+double mel_to_hz(double mel) noexcept { return 700.0 * (std::pow(10.0, mel / 2595.0) - 1.0); }
+
+} // namespace
+
+bool log_mel_frontend::init(const log_mel_config& config) noexcept {
+  config_ = config;
+  const double nyquist = static_cast<double>(config.sample_rate_hz) / 2.0;
+  const double high_hz = config.high_freq_hz > 0.0F ? static_cast<double>(config.high_freq_hz) : nyquist;
+  if (config.sample_rate_hz == 0 || config.window_frames == 0 || config.hop_frames == 0
+      || config.hop_frames > config.window_frames || config.fft_size < config.window_frames || config.mel_bins == 0
+      || static_cast<double>(config.low_freq_hz) >= high_hz || high_hz > nyquist) {
+    return false;
+  }
+  if (!fft_.init(config.fft_size)) {
+    return false;
+  }
+
+  const size_t bins = fft_.bins();
+  try {
+    window_.assign(config.window_frames, 0.0F);
+    pending_.assign(config.window_frames, 0.0F);
+    frame_.assign(config.fft_size, 0.0F);
+    spectrum_re_.assign(bins, 0.0F);
+    spectrum_im_.assign(bins, 0.0F);
+    power_.assign(bins, 0.0F);
+    filters_.clear();
+    filters_.reserve(config.mel_bins);
+    weights_.clear();
+    weights_.reserve(static_cast<size_t>(config.mel_bins) * bins / 4);
+  } catch (...) {
+    fft_ = real_fft{};
+    return false;
+  }
+
+  for (size_t i = 0; i < window_.size(); ++i) {
+    const double phase = 2.0 * std::numbers::pi * static_cast<double>(i) / static_cast<double>(window_.size());
+    window_[i] = static_cast<float>(0.5 - (0.5 * std::cos(phase)));
+  }
+
+  // Triangular filters with edges evenly spaced on the mel scale; only each filter's nonzero span is kept.
+  const double low_mel = hz_to_mel(static_cast<double>(config.low_freq_hz));
+  const double mel_step = (hz_to_mel(high_hz) - low_mel) / static_cast<double>(config.mel_bins + 1);
+  const double bin_hz = static_cast<double>(config.sample_rate_hz) / static_cast<double>(config.fft_size);
+  try {
+    for (uint32_t m = 0; m < config.mel_bins; ++m) {
+      const double left = mel_to_hz(low_mel + (mel_step * m));
+      const double center = mel_to_hz(low_mel + (mel_step * (m + 1)));
+      const double right = mel_to_hz(low_mel + (mel_step * (m + 2)));
+
+      mel_filter filter{ 0, static_cast<uint32_t>(weights_.size()), 0 };
+      for (uint32_t bin = 0; bin < bins; ++bin) {
+        const double hz = bin_hz * bin;
+        double weight = 0.0;
+        if (hz > left && hz <= center) {
+          weight = (hz - left) / (center - left);
+        } else if (hz > center && hz < right) {
+          weight = (right - hz) / (right - center);
+        }
+        if (weight <= 0.0) {
+          continue;
+        }
+        if (filter.weight_count == 0) {
+          filter.first_bin = bin;
+        }
+        // Bins between first_bin and this one are all inside the triangle, so the span stays contiguous.
+        weights_.push_back(static_cast<float>(weight));
+        ++filter.weight_count;
+      }
+      filters_.push_back(filter);
+    }
+  } catch (...) {
+    fft_ = real_fft{};
+    return false;
+  }
+
+  reset();
+  return true;
+}
+
+void log_mel_frontend::reset() noexcept {
+  std::fill(pending_.begin(), pending_.end(), 0.0F);
+  pending_count_ = 0;
+  last_sample_ = 0.0F;
+  frames_emitted_ = 0;
+  frames_dropped_ = 0;
+}
+
+size_t log_mel_frontend::frames_for(size_t samples) const noexcept {
+  const size_t total = pending_count_ + samples;
+  if (!is_ready() || total < config_.window_frames) {
+    return 0;
+  }
+  return ((total - config_.window_frames) / config_.hop_frames) + 1;
+}
+
+size_t log_mel_frontend::push(std::span<const float> audio, std::span<float> features) noexcept {
+  if (!is_ready()) {
+    return 0;
+  }
+
+  const size_t window = config_.window_frames;
+  const size_t hop = config_.hop_frames;
+  const size_t capacity = features.size() / config_.mel_bins;
+  size_t written = 0;
+
+  while (!audio.empty()) {
+    const size_t take = (std::min)(audio.size(), window - pending_count_);
+    const std::span<float> dest = std::span<float>(pending_).subspan(pending_count_, take);
+    last_sample_ = preemphasis(audio.first(take), config_.preemphasis, last_sample_, dest);
+    pending_count_ += take;
+    audio = audio.subspan(take);
+
+    if (pending_count_ < window) {
+      break;
+    }
+
+    if (written < capacity) {
+      compute_frame(features.subspan(written * config_.mel_bins, config_.mel_bins));
+      ++written;
+      ++frames_emitted_;
+    } else {
+      ++frames_dropped_;
+    }
+
+    // Keep the overlap for the next frame.
+    std::copy(pending_.begin() + static_cast<std::ptrdiff_t>(hop), pending_.end(), pending_.begin());
+    pending_count_ = window - hop;
+  }
+  return written;
+}
+
+void log_mel_frontend::compute_frame(std::span<float> out) noexcept {
+  multiply(pending_, window_, std::span<float>(frame_).first(window_.size()));
+  fft_.forward(frame_, spectrum_re_, spectrum_im_);
+  power_spectrum(spectrum_re_, spectrum_im_, power_);
+
+  const std::span<const float> power(power_);
+  const std::span<const float> weights(weights_);
+  for (size_t m = 0; m < filters_.size(); ++m) {
+    const mel_filter& filter = filters_[m];
+    const float energy = dot(
+      weights.subspan(filter.weight_offset, filter.weight_count), power.subspan(filter.first_bin, filter.weight_count));
+    out[m] = std::log((std::max)(energy, config_.log_floor));
+  }
+}
+
+} // namespace jaxie::dsp
@@ -0,0 +1,239 @@
+#include <Jaxie/dsp/kernels.hpp>
+#include <Jaxie/dsp/resampler.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <numbers>
+#include <numeric>
+#include <span>
+
+namespace jaxie::dsp {
+namespace {
+
+struct filter_shape {
+  uint32_t taps;
+  double passband; // fraction of the narrower Nyquist band kept
+  double kaiser_beta;
+};
+
+filter_shape shape_for(resample_quality quality) noexcept {
+  switch (quality) {
+  case resample_quality::fast:
+    return { 16, 0.85, 6.0 };
+  case resample_quality::high:
+    return { 64, 0.95, 10.0 };
+  case resample_quality::balanced:
+  default:
+    return { 32, 0.90, 8.0 };
+  }
+}
+
+// Zeroth-order modified Bessel function of the first kind, by its power series.
+double bessel_i0(double x) noexcept {
+  double sum = 1.0;
+  double term = 1.0;
+  const double half_sq = (x * x) / 4.0;
+  for (int k = 1; k < 50 && term > sum * 1e-12; ++k) {
+    term *= half_sq / static_cast<double>(k * k);
+    sum += term;
+  }
+  return sum;
+}
+
+} // namespace
+
+bool polyphase_resampler::init(
+  uint32_t in_rate_hz,
+  uint32_t out_rate_hz,
+  resample_quality quality,
+  size_t max_block_frames) noexcept {
+  if (in_rate_hz == 0 || out_rate_hz == 0 || max_block_frames == 0) {
+    return false;
+  }
+
+  const uint32_t common = std::gcd(in_rate_hz, out_rate_hz);
+  up_ = out_rate_hz / common;
+  down_ = in_rate_hz / common;
+  const filter_shape shape = shape_for(quality);
+  taps_ = shape.taps;
+  max_block_frames_ = max_block_frames;
+
+  // Kaiser-windowed sinc prototype at the upsampled rate, cut off below the narrower of the two Nyquists.
+  const size_t length = static_cast<size_t>(up_) * taps_;
+  const double cutoff = (0.5 * shape.passband) / static_cast<double>((std::max)(up_, down_));
+  const double center = static_cast<double>(length - 1) / 2.0;
+  const double window_norm = bessel_i0(shape.kaiser_beta);
+
+  try {
+    coeffs_.assign(length, 0.0F);
+    buffer_.assign((taps_ - 1) + max_block_frames, 0.0F);
+  } catch (...) {
+    return false;
+  }
+
+  for (size_t j = 0; j < length; ++j) {
+    const double offset = static_cast<double>(j) - center;
+    const double arg = 2.0 * cutoff * offset;
+    const double sinc = arg == 0.0 ? 1.0 : std::sin(std::numbers::pi * arg) / (std::numbers::pi * arg);
+    const double ratio = offset / center;
+    const double window = bessel_i0(shape.kaiser_beta * std::sqrt((std::max)(0.0, 1.0 - (ratio * ratio)))) / window_norm;
+    // Gain of up_ compensates for the energy lost to zero-stuffing.
+    const double tap = static_cast<double>(up_) * 2.0 * cutoff * sinc * window;
+
+    const size_t phase = j % up_;
+    const size_t branch_tap = j / up_;
+    coeffs_[(phase * taps_) + (taps_ - 1 - branch_tap)] = static_cast<float>(tap);
+  }
+
+  reset();
+  return true;
+}
+
+void polyphase_resampler::reset() noexcept {
+  std::fill(buffer_.begin(), buffer_.end(), 0.0F);
+  phase_ = 0;
+  next_input_ = 0;
+}
+
+size_t polyphase_resampler::max_output_frames(size_t in_frames) const noexcept {
+  return ((in_frames * up_) / down_) + 2;
+}
+
+size_t polyphase_resampler::process(std::span<const float> in, std::span<float> out) noexcept {
+  const size_t history = taps_ - 1;
+  size_t produced = 0;
+
+  while (!in.empty()) {
+    const size_t block = (std::min)(in.size(), max_block_frames_);
+    std::copy_n(in.begin(), block, buffer_.begin() + static_cast<std::ptrdiff_t>(history));
+
+    const std::span<const float> window(buffer_);
+    while (next_input_ < block && produced < out.size()) {
+      const auto branch = std::span<const float>(coeffs_).subspan(static_cast<size_t>(phase_) * taps_, taps_);
+      out[produced++] = dot(branch, window.subspan(next_input_, taps_));
+      phase_ += down_;
+      next_input_ += phase_ / up_;
+      phase_ %= up_;
+    }
+
+    // Slide the newest taps_ - 1 samples down to become the next block's history.
+    std::copy_n(buffer_.begin() + static_cast<std::ptrdiff_t>(block), history, buffer_.begin());
+    next_input_ -= (std::min)(next_input_, block);
+    in = in.subspan(block);
+  }
+  return produced;
+}
+
+bool stream_converter::init(const converter_config& config) noexcept {
+  config_ = config;
+  passthrough_ = true;
+  resample_ = false;
+  if (config.in_rate_hz == 0 || config.out_rate_hz == 0 || config.in_channels == 0 || config.out_channels == 0
+      || config.max_block_frames == 0) {
+    return false;
+  }
+
+  resample_ = config.in_rate_hz != config.out_rate_hz;
+  const bool downmix = config.in_channels != config.out_channels;
+  if ((downmix || resample_) && config.out_channels != 1) {
+    return false;
+  }
+  passthrough_ = !downmix && !resample_;
+
+  try {
+    s16_scratch_.assign(static_cast<size_t>(config.max_block_frames) * config.in_channels, 0.0F);
+    mono_scratch_.assign(config.max_block_frames, 0.0F);
+  } catch (...) {
+    return false;
+  }
+
+  if (resample_ && !resampler_.init(config.in_rate_hz, config.out_rate_hz, config.quality, config.max_block_frames)) {
+    return false;
+  }
+  return true;
+}
+
+void stream_converter::reset() noexcept {
+  if (resample_) {
+    resampler_.reset();
+  }
+}
+
+size_t stream_converter::max_output_frames(size_t in_frames) const noexcept {
+  if (!resample_) {
+    return in_frames;
+  }
+  // Blocks are resampled independently, so allow the rounding slack once per block.
+  const size_t blocks = (in_frames / config_.max_block_frames) + 1;
+  return ((in_frames * config_.out_rate_hz) / config_.in_rate_hz) + (2 * blocks);
+}
+
+size_t stream_converter::process(std::span<const float> interleaved, std::span<float> out) noexcept {
+  const size_t block_samples = static_cast<size_t>(config_.max_block_frames) * config_.in_channels;
+  size_t produced = 0;
+  while (!interleaved.empty()) {
+    const size_t take = (std::min)(interleaved.size(), block_samples);
+    produced += process_block(interleaved.first(take), out.subspan(produced * config_.out_channels));
+    interleaved = interleaved.subspan(take);
+  }
+  return produced;
+}
+
+size_t stream_converter::process(std::span<const int16_t> interleaved, std::span<float> out) noexcept {
+  const size_t block_samples = s16_scratch_.size();
+  size_t produced = 0;
+  while (!interleaved.empty()) {
+    const size_t take = (std::min)(interleaved.size(), block_samples);
+    const std::span<float> converted(s16_scratch_.data(), take);
+    s16_to_f32(interleaved.first(take), converted);
+    produced += process_block(converted, out.subspan(produced * config_.out_channels));
+    interleaved = interleaved.subspan(take);
+  }
+  return produced;
+}
+
+size_t stream_converter::flush(std::span<float> out) noexcept {
+  if (!resample_) {
+    return 0;
+  }
+  size_t produced = 0;
+  for (size_t remaining = resampler_.taps_per_phase() - 1; remaining != 0;) {
+    const size_t take = (std::min)(remaining, mono_scratch_.size());
+    const std::span<float> silence(mono_scratch_.data(), take);
+    std::fill(silence.begin(), silence.end(), 0.0F);
+    produced += resampler_.process(silence, out.subspan(produced));
+    remaining -= take;
+  }
+  return produced;
+}
+
+size_t stream_converter::flush_frames() const noexcept {
+  return resample_ ? max_output_frames(resampler_.taps_per_phase() - 1) : 0;
+}
+
+size_t stream_converter::process_block(std::span<const float> interleaved, std::span<float> out) noexcept {
+  const size_t frames = interleaved.size() / config_.in_channels;
+  if (passthrough_) {
+    const size_t count = (std::min)(interleaved.size(), out.size());
+    std::copy_n(interleaved.begin(), count, out.begin());
+    return count / config_.out_channels;
+  }
+
+  std::span<const float> mono = interleaved.first(frames);
+  if (config_.in_channels != 1) {
+    const std::span<float> mixed(mono_scratch_.data(), frames);
+    downmix_to_mono(interleaved, config_.in_channels, mixed);
+    mono = mixed;
+  }
+
+  if (!resample_) {
+    const size_t count = (std::min)(mono.size(), out.size());
+    std::copy_n(mono.begin(), count, out.begin());
+    return count;
+  }
+  return resampler_.process(mono, out);
+}
+
+} // namespace jaxie::dsp
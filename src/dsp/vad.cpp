@@ -0,0 +1,92 @@
+#include <Jaxie/dsp/kernels.hpp>
+#include <Jaxie/dsp/vad.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <span>
+
+namespace jaxie::dsp {
+
+bool energy_vad::init(const energy_vad_config& config) noexcept {
+  config_ = config;
+  const float nyquist = static_cast<float>(config.sample_rate_hz) / 2.0F;
+  if (config.sample_rate_hz == 0 || config.max_period_frames == 0 || config.band_low_hz >= config.band_high_hz
+      || config.band_high_hz > nyquist) {
+    return false;
+  }
+
+  size_t fft_size = 4;
+  while (fft_size < config.max_period_frames) {
+    fft_size *= 2;
+  }
+  if (!fft_.init(fft_size)) {
+    return false;
+  }
+
+  try {
+    frame_.assign(fft_size, 0.0F);
+    spectrum_re_.assign(fft_.bins(), 0.0F);
+    spectrum_im_.assign(fft_.bins(), 0.0F);
+    power_.assign(fft_.bins(), 0.0F);
+  } catch (...) {
+    fft_ = real_fft{};
+    return false;
+  }
+
+  const float bin_hz = static_cast<float>(config.sample_rate_hz) / static_cast<float>(fft_size);
+  band_first_ = (std::max)(size_t{ 1 }, static_cast<size_t>(config.band_low_hz / bin_hz));
+  band_last_ = (std::min)(fft_.bins() - 1, static_cast<size_t>(config.band_high_hz / bin_hz));
+  reset();
+  return true;
+}
+
+void energy_vad::reset() noexcept {
+  noise_floor_db_ = 0.0F;
+  primed_ = false;
+}
+
+vad_decision energy_vad::process(std::span<const float> period) noexcept {
+  vad_decision decision{};
+  if (period.empty() || fft_.size() == 0) {
+    return decision;
+  }
+
+  const float mean_square = dot(period, period) / static_cast<float>(period.size());
+  decision.energy_db = 10.0F * std::log10((std::max)(mean_square, 1e-12F));
+
+  // Flatness of the trailing samples' power spectrum over the speech band; a zero pad keeps short periods valid.
+  const auto tail = period.last((std::min)(period.size(), frame_.size()));
+  std::copy(tail.begin(), tail.end(), frame_.begin());
+  std::fill(frame_.begin() + static_cast<std::ptrdiff_t>(tail.size()), frame_.end(), 0.0F);
+  fft_.forward(frame_, spectrum_re_, spectrum_im_);
+  power_spectrum(spectrum_re_, spectrum_im_, power_);
+  double log_sum = 0.0;
+  double sum = 0.0;
+  for (size_t bin = band_first_; bin <= band_last_; ++bin) {
+    const double value = static_cast<double>(power_[bin]) + 1e-20;
+    log_sum += std::log(value);
+    sum += value;
+  }
+  const auto bins = static_cast<double>(band_last_ - band_first_ + 1);
+  decision.flatness = static_cast<float>(std::exp(log_sum / bins) / (sum / bins));
+
+  if (!primed_) {
+    noise_floor_db_ = decision.energy_db;
+    primed_ = true;
+  }
+
+  decision.speech = decision.energy_db > (std::max)(noise_floor_db_ + config_.threshold_db, config_.absolute_floor_db)
+                    && decision.flatness < config_.max_flatness;
+
+  if (decision.energy_db < noise_floor_db_) {
+    noise_floor_db_ += config_.noise_fall * (decision.energy_db - noise_floor_db_);
+  } else if (!decision.speech) {
+    const float seconds = static_cast<float>(period.size()) / static_cast<float>(config_.sample_rate_hz);
+    noise_floor_db_ = (std::min)(decision.energy_db, noise_floor_db_ + (config_.noise_rise_db_per_s * seconds));
+  }
+  decision.noise_floor_db = noise_floor_db_;
+  return decision;
+}
+
+} // namespace jaxie::dsp
@@ -0,0 +1,60 @@
+#pragma once
+
+// Internal content hash for model bytes: the optimized-model cache key and the bundle checksum.
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+namespace jaxie::onnx::detail {
+
+// FNV-1a over 64-bit words in four lanes, so a large encoder hashes at memory speed rather than one multiply per
+// byte. Input may arrive in pieces; every piece but the last must be a whole number of words.
+class content_hasher {
+public:
+  void update(std::span<const std::byte> bytes) noexcept {
+    const size_t words = bytes.size() / sizeof(uint64_t);
+    for (size_t w = 0; w < words; ++w, ++words_) {
+      uint64_t word = 0;
+      std::memcpy(&word, bytes.data() + (w * sizeof(uint64_t)), sizeof(word));
+      auto& lane = lanes_[words_ % lanes_.size()];
+      lane = (lane ^ word) * prime;
+    }
+    for (size_t b = words * sizeof(uint64_t); b < bytes.size(); ++b) {
+      lanes_[0] = (lanes_[0] ^ static_cast<uint64_t>(bytes[b])) * prime;
+    }
+    total_ += bytes.size();
+  }
+
+  uint64_t finish() const noexcept {
+    uint64_t hash = mix(total_);
+    for (const uint64_t lane : lanes_) {
+      hash = mix(hash ^ lane);
+    }
+    return hash;
+  }
+
+  static constexpr uint64_t offset = 0xCBF29CE484222325ULL;
+  static constexpr uint64_t prime = 0x100000001B3ULL;
+
+  static constexpr uint64_t mix(uint64_t x) noexcept {
+    x = (x ^ (x >> 30U)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27U)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31U);
+  }
+
+private:
+  std::array<uint64_t, 4> lanes_{ offset, offset + 1, offset + 2, offset + 3 };
+  uint64_t words_{0};
+  uint64_t total_{0};
+};
+
+inline uint64_t content_hash(std::span<const std::byte> bytes) noexcept {
+  content_hasher hasher;
+  hasher.update(bytes);
+  return hasher.finish();
+}
+
+} // namespace jaxie::onnx::detail
@@ -0,0 +1,409 @@
+#include <Jaxie/onnx/model_bundle.hpp>
+
+#include "content_hash.hpp"
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(JAXIE_USE_ONNXRUNTIME)
+#include "ort_tensors.hpp"
+
+#include <onnxruntime_cxx_api.h>
+#endif
+
+namespace jaxie::onnx {
+namespace {
+
+constexpr std::string_view magic = "JXBUNDLE";
+constexpr uint32_t version = 1;
+constexpr size_t header_bytes = 32; // magic, version, count, checksum, file size
+constexpr size_t entry_bytes = 32;  // kind, flags, offset, size, hash
+constexpr size_t section_alignment = 4096;
+constexpr uint32_t flag_ort_format = 1U;
+constexpr std::array<bundle_section, 3> graphs{ bundle_section::encoder, bundle_section::predictor, bundle_section::joint };
+
+uint64_t read_le(std::span<const std::byte> bytes, size_t offset, size_t width) noexcept {
+  uint64_t value = 0;
+  for (size_t i = 0; i < width; ++i) {
+    value |= static_cast<uint64_t>(bytes[offset + i]) << (8U * i);
+  }
+  return value;
+}
+
+void write_le(std::vector<std::byte>& out, uint64_t value, size_t width) {
+  for (size_t i = 0; i < width; ++i) {
+    out.push_back(static_cast<std::byte>((value >> (8U * i)) & 0xFFU));
+  }
+}
+
+bool read_file(const std::string& path, std::vector<std::byte>& bytes) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in) {
+    return false;
+  }
+  const std::vector<char> raw{ std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>() };
+  if (in.bad()) {
+    return false;
+  }
+  const auto view = std::as_bytes(std::span(raw));
+  bytes.assign(view.begin(), view.end());
+  return true;
+}
+
+// ORT-format models carry the flatbuffer file identifier "ORTM" after the root offset.
+bool looks_like_ort_format(std::span<const std::byte> bytes) noexcept {
+  return bytes.size() >= 8 && std::memcmp(bytes.subspan(4).data(), "ORTM", 4) == 0;
+}
+
+std::string_view as_text(std::span<const std::byte> bytes) noexcept {
+  return { reinterpret_cast<const char*>(bytes.data()), bytes.size() }; // NOLINT(*-reinterpret-cast)
+}
+
+// "piece" or "piece<TAB>score" per line, as SentencePiece writes its .vocab files.
+std::string vocab_lines(std::string_view text) {
+  std::string out;
+  out.reserve(text.size());
+  while (!text.empty()) {
+    const size_t end = (std::min)(text.find('\n'), text.size());
+    std::string_view line = text.substr(0, end);
+    line = line.substr(0, (std::min)(line.find('\t'), line.size()));
+    if (line.ends_with('\r')) {
+      line.remove_suffix(1);
+    }
+    out.append(line);
+    out.push_back('\n');
+    text.remove_prefix((std::min)(end + 1, text.size()));
+  }
+  return out;
+}
+
+#if defined(JAXIE_USE_ONNXRUNTIME)
+// "<graph>\t<in|out>\t<element type>\t<name>\t<dim,dim,...>" per port.
+void describe_graph(std::span<const std::byte> model, uint32_t graph, std::string& out) {
+  Ort::SessionOptions options{};
+  options.SetGraphOptimizationLevel(ORT_DISABLE_ALL);
+  const Ort::Session session(detail::shared_env(), model.data(), model.size(), options);
+  for (const bool inputs : { true, false }) {
+    for (const auto& port : inputs ? detail::session_inputs(session) : detail::session_outputs(session)) {
+      out += std::to_string(graph) + (inputs ? "\tin\t" : "\tout\t") + std::to_string(static_cast<int>(port.type)) + '\t'
+             + port.name + '\t';
+      for (size_t d = 0; d < port.shape.size(); ++d) {
+        out += (d == 0 ? "" : ",") + std::to_string(port.shape[d]);
+      }
+      out += '\n';
+    }
+  }
+}
+#endif
+
+template <typename T>
+bool parse_number(std::string_view text, T& value) noexcept {
+  const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+  return error == std::errc{} && end == text.data() + text.size();
+}
+
+} // namespace
+
+model_bundle::~model_bundle() { close(); }
+
+model_bundle::model_bundle(model_bundle&& other) noexcept
+  : path_(std::move(other.path_)),
+    mapping_(std::exchange(other.mapping_, nullptr)),
+    heap_(std::move(other.heap_)),
+    data_(std::exchange(other.data_, nullptr)),
+    size_(std::exchange(other.size_, 0)),
+    checksum_(std::exchange(other.checksum_, 0)),
+    entries_(std::move(other.entries_)),
+    io_(std::move(other.io_)),
+    vocab_(std::move(other.vocab_)) {}
+
+model_bundle& model_bundle::operator=(model_bundle&& other) noexcept {
+  if (this != &other) {
+    close();
+    path_ = std::move(other.path_);
+    mapping_ = std::exchange(other.mapping_, nullptr);
+    heap_ = std::move(other.heap_);
+    data_ = std::exchange(other.data_, nullptr);
+    size_ = std::exchange(other.size_, 0);
+    checksum_ = std::exchange(other.checksum_, 0);
+    entries_ = std::move(other.entries_);
+    io_ = std::move(other.io_);
+    vocab_ = std::move(other.vocab_);
+  }
+  return *this;
+}
+
+bool model_bundle::open(const std::string& path, bool verify) noexcept {
+  close();
+  try {
+    path_ = path;
+#if defined(__linux__)
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC); // NOLINT(*-vararg)
+    if (fd >= 0) {
+      struct stat info {};
+      if (fstat(fd, &info) == 0 && info.st_size > 0) {
+        void* mapped = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_SHARED, fd, 0);
+        if (mapped != MAP_FAILED) {
+          mapping_ = mapped;
+          data_ = static_cast<const std::byte*>(mapped);
+          size_ = static_cast<size_t>(info.st_size);
+        }
+      }
+      ::close(fd);
+    }
+#endif
+    if (data_ == nullptr) {
+      if (!read_file(path, heap_)) {
+        close();
+        return false;
+      }
+      data_ = heap_.data();
+      size_ = heap_.size();
+    }
+    if (!parse(verify)) {
+      close();
+      return false;
+    }
+  } catch (...) {
+    close();
+    return false;
+  }
+  return true;
+}
+
+void model_bundle::close() noexcept {
+#if defined(__linux__)
+  if (mapping_ != nullptr) {
+    munmap(mapping_, size_);
+  }
+#endif
+  mapping_ = nullptr;
+  heap_.clear();
+  heap_.shrink_to_fit();
+  data_ = nullptr;
+  size_ = 0;
+  checksum_ = 0;
+  entries_.clear();
+  io_.clear();
+  vocab_.clear();
+}
+
+bool model_bundle::parse(bool verify) {
+  const std::span<const std::byte> file(data_, size_);
+  if (size_ < header_bytes || as_text(file.first(magic.size())) != magic || read_le(file, 8, 4) != version) {
+    return false;
+  }
+  const uint64_t count = read_le(file, 12, 4);
+  checksum_ = read_le(file, 16, 8);
+  if (read_le(file, 24, 8) != size_ || count > (size_ - header_bytes) / entry_bytes) {
+    return false;
+  }
+  const auto table = file.subspan(header_bytes, count * entry_bytes);
+  if (verify && detail::content_hash(table) != checksum_) {
+    return false;
+  }
+
+  entries_.resize(count);
+  for (size_t i = 0; i < count; ++i) {
+    const size_t at = i * entry_bytes;
+    auto& e = entries_[i];
+    e.kind = static_cast<bundle_section>(read_le(table, at, 4));
+    e.flags = static_cast<uint32_t>(read_le(table, at + 4, 4));
+    e.offset = read_le(table, at + 8, 8);
+    e.size = read_le(table, at + 16, 8);
+    e.hash = read_le(table, at + 24, 8);
+    if (e.offset > size_ || e.size > size_ - e.offset) {
+      return false;
+    }
+    if (verify && detail::content_hash(file.subspan(e.offset, e.size)) != e.hash) {
+      return false;
+    }
+  }
+  if (std::any_of(graphs.begin(), graphs.end(), [&](bundle_section kind) { return find(kind) == nullptr; })) {
+    return false;
+  }
+
+  io_.assign(graphs.size(), {});
+  if (!parse_io(as_text(section(bundle_section::io)))) {
+    return false;
+  }
+  std::string_view pieces = as_text(section(bundle_section::vocab));
+  while (!pieces.empty()) {
+    const size_t end = (std::min)(pieces.find('\n'), pieces.size());
+    vocab_.push_back(pieces.substr(0, end));
+    pieces.remove_prefix((std::min)(end + 1, pieces.size()));
+  }
+  return true;
+}
+
+bool model_bundle::parse_io(std::string_view text) {
+  while (!text.empty()) {
+    const size_t end = (std::min)(text.find('\n'), text.size());
+    std::string_view line = text.substr(0, end);
+    text.remove_prefix((std::min)(end + 1, text.size()));
+
+    std::array<std::string_view, 5> fields{};
+    for (auto& field : fields) {
+      const size_t tab = (std::min)(line.find('\t'), line.size());
+      field = line.substr(0, tab);
+      line.remove_prefix((std::min)(tab + 1, line.size()));
+    }
+    uint32_t graph = 0;
+    bundle_port port{};
+    if (!parse_number(fields[0], graph) || graph == 0 || graph > io_.size() || !parse_number(fields[2], port.element_type)
+        || (fields[1] != "in" && fields[1] != "out")) {
+      return false;
+    }
+    port.name = std::string(fields[3]);
+    for (std::string_view dims = fields[4]; !dims.empty();) {
+      const size_t comma = (std::min)(dims.find(','), dims.size());
+      int64_t dim = 0;
+      if (!parse_number(dims.substr(0, comma), dim)) {
+        return false;
+      }
+      port.shape.push_back(dim);
+      dims.remove_prefix((std::min)(comma + 1, dims.size()));
+    }
+    auto& ports = fields[1] == "in" ? io_[graph - 1].inputs : io_[graph - 1].outputs;
+    ports.push_back(std::move(port));
+  }
+  return true;
+}
+
+const model_bundle::entry* model_bundle::find(bundle_section kind) const noexcept {
+  const auto it = std::find_if(entries_.begin(), entries_.end(), [&](const entry& e) { return e.kind == kind; });
+  return it == entries_.end() ? nullptr : &*it;
+}
+
+std::span<const std::byte> model_bundle::section(bundle_section kind) const noexcept {
+  const entry* e = find(kind);
+  return e == nullptr ? std::span<const std::byte>{} : std::span(data_ + e->offset, e->size);
+}
+
+uint64_t model_bundle::section_hash(bundle_section kind) const noexcept {
+  const entry* e = find(kind);
+  return e == nullptr ? 0 : e->hash;
+}
+
+bool model_bundle::is_ort_format(bundle_section kind) const noexcept {
+  const entry* e = find(kind);
+  return e != nullptr && (e->flags & flag_ort_format) != 0;
+}
+
+const bundle_io& model_bundle::io(bundle_section graph) const noexcept {
+  static const bundle_io none{};
+  const auto index = static_cast<size_t>(graph) - 1;
+  return index < io_.size() ? io_[index] : none;
+}
+
+void model_bundle::release_pages(bundle_section kind) const noexcept {
+#if defined(__linux__)
+  const auto bytes = section(kind);
+  if (mapping_ == nullptr || bytes.empty()) {
+    return;
+  }
+  const auto page = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+  const auto first = reinterpret_cast<uintptr_t>(bytes.data()) & ~(page - 1); // NOLINT(*-reinterpret-cast)
+  const auto last = reinterpret_cast<uintptr_t>(bytes.data() + bytes.size()); // NOLINT(*-reinterpret-cast)
+  madvise(reinterpret_cast<void*>(first), last - first, MADV_DONTNEED); // NOLINT(*-reinterpret-cast, performance-no-int-to-ptr)
+#else
+  static_cast<void>(kind);
+#endif
+}
+
+bool write_model_bundle(const std::string& path, const rnnt_model_paths& graphs_in, const std::string& vocab_path) noexcept {
+  try {
+    std::array<std::vector<std::byte>, 5> sections{};
+    const std::array<const std::string*, 3> sources{ &graphs_in.encoder, &graphs_in.predictor, &graphs_in.joint };
+    for (size_t g = 0; g < sources.size(); ++g) {
+      if (!read_file(*sources[g], sections[g])) {
+        return false;
+      }
+    }
+    std::string io;
+#if defined(JAXIE_USE_ONNXRUNTIME)
+    for (size_t g = 0; g < sources.size(); ++g) {
+      describe_graph(sections[g], static_cast<uint32_t>(g + 1), io);
+    }
+#endif
+    const auto io_bytes = std::as_bytes(std::span(io));
+    sections[3].assign(io_bytes.begin(), io_bytes.end());
+    if (!vocab_path.empty()) {
+      std::vector<std::byte> raw;
+      if (!read_file(vocab_path, raw)) {
+        return false;
+      }
+      const std::string pieces = vocab_lines(as_text(raw));
+      const auto piece_bytes = std::as_bytes(std::span(pieces));
+      sections[4].assign(piece_bytes.begin(), piece_bytes.end());
+    }
+
+    std::vector<std::byte> table;
+    uint64_t offset = header_bytes + (sections.size() * entry_bytes);
+    std::array<uint64_t, 5> offsets{};
+    for (size_t s = 0; s < sections.size(); ++s) {
+      offset = (offset + section_alignment - 1) / section_alignment * section_alignment;
+      offsets[s] = offset;
+      write_le(table, s + 1, 4); // bundle_section values follow the array order
+      write_le(table, s < graphs.size() && looks_like_ort_format(sections[s]) ? flag_ort_format : 0U, 4);
+      write_le(table, offset, 8);
+      write_le(table, sections[s].size(), 8);
+      write_le(table, detail::content_hash(sections[s]), 8);
+      offset += sections[s].size();
+    }
+
+    std::vector<std::byte> header;
+    const auto magic_bytes = std::as_bytes(std::span(magic));
+    header.assign(magic_bytes.begin(), magic_bytes.end());
+    write_le(header, version, 4);
+    write_le(header, sections.size(), 4);
+    write_le(header, detail::content_hash(table), 8);
+    write_le(header, offset, 8);
+
+    // Written under a temporary name and renamed, so a reader never maps half a bundle.
+    const std::string partial = path + ".partial";
+    {
+      std::ofstream out(partial, std::ios::binary | std::ios::trunc);
+      const auto put = [&](std::span<const std::byte> bytes) {
+        out.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size())); // NOLINT(*-reinterpret-cast)
+      };
+      put(header);
+      put(table);
+      uint64_t written = header.size() + table.size();
+      const std::vector<std::byte> padding(section_alignment);
+      for (size_t s = 0; s < sections.size(); ++s) {
+        put(std::span(padding).first(offsets[s] - written));
+        put(sections[s]);
+        written = offsets[s] + sections[s].size();
+      }
+      if (!out.flush()) {
+        return false;
+      }
+    }
+    return std::rename(partial.c_str(), path.c_str()) == 0;
+  } catch (...) {
+    return false;
+  }
+}
+
+} // namespace jaxie::onnx
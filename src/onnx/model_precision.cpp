@@ -0,0 +1,139 @@
+#include <Jaxie/onnx/model_precision.hpp>
+
+#include <algorithm>
+#include <array>
+#include <filesystem>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#if defined(JAXIE_USE_ONNXRUNTIME)
+#include "ort_tensors.hpp"
+
+#include <onnxruntime_cxx_api.h>
+#endif
+
+namespace jaxie::onnx {
+namespace {
+
+std::string& variant_slot(precision_variants& variants, model_precision precision) noexcept {
+  switch (precision) {
+  case model_precision::fp16:
+    return variants.fp16;
+  case model_precision::int8:
+    return variants.int8;
+  case model_precision::fp32:
+    break;
+  }
+  return variants.fp32;
+}
+
+// The wanted precision, then fp32, then whatever exists.
+bool pick(const precision_variants& variants, model_precision wanted, std::string& path, model_precision& chosen) {
+  for (const auto candidate : { wanted, model_precision::fp32, model_precision::fp16, model_precision::int8 }) {
+    if (!variants.path(candidate).empty()) {
+      path = variants.path(candidate);
+      chosen = candidate;
+      return true;
+    }
+  }
+  return false;
+}
+
+std::string first_available_provider(const ep_prefs& prefs) {
+#if defined(JAXIE_USE_ONNXRUNTIME)
+  const std::vector<std::string> available = Ort::GetAvailableProviders();
+  for (const auto& provider : prefs.providers) {
+    const auto name = detail::ort_provider_name(provider);
+    if (!name.empty() && std::find(available.begin(), available.end(), name) != available.end()) {
+      return provider;
+    }
+  }
+#else
+  static_cast<void>(prefs);
+#endif
+  return "CPU";
+}
+
+} // namespace
+
+const char* precision_name(model_precision precision) noexcept {
+  switch (precision) {
+  case model_precision::fp16:
+    return "fp16";
+  case model_precision::int8:
+    return "int8";
+  case model_precision::fp32:
+    break;
+  }
+  return "fp32";
+}
+
+bool precision_choice::all_fp32() const noexcept {
+  return encoder == model_precision::fp32 && predictor == model_precision::fp32 && joint == model_precision::fp32;
+}
+
+std::string describe_precision(const precision_choice& choice) {
+  return std::string("encoder ") + precision_name(choice.encoder) + ", predictor " + precision_name(choice.predictor)
+         + ", joint " + precision_name(choice.joint);
+}
+
+const std::string& precision_variants::path(model_precision precision) const noexcept {
+  switch (precision) {
+  case model_precision::fp16:
+    return fp16;
+  case model_precision::int8:
+    return int8;
+  case model_precision::fp32:
+    break;
+  }
+  return fp32;
+}
+
+rnnt_model_variants find_model_variants(const std::string& dir) {
+  rnnt_model_variants out{};
+  const std::filesystem::path root(dir);
+  for (auto [component, name] : { std::pair{ &out.encoder, "encoder" }, std::pair{ &out.predictor, "predictor" },
+                                  std::pair{ &out.joint, "joint" } }) {
+    for (const auto precision : { model_precision::fp32, model_precision::fp16, model_precision::int8 }) {
+      const std::string suffix = precision == model_precision::fp32 ? "" : std::string(".") + precision_name(precision);
+      const auto file = root / (std::string(name) + suffix + ".onnx");
+      std::error_code error;
+      if (std::filesystem::is_regular_file(file, error)) {
+        variant_slot(*component, precision) = file.string();
+      }
+    }
+  }
+  return out;
+}
+
+bool select_precision(
+  const rnnt_model_variants& variants,
+  const ep_prefs& prefs,
+  const precision_policy& policy,
+  rnnt_model_paths& out,
+  precision_choice* choice) noexcept {
+  try {
+    precision_choice chosen{};
+    chosen.provider = first_available_provider(prefs);
+    chosen.gpu = chosen.provider != "CPU" && chosen.provider != "Cpu";
+    const auto wanted = [&](const component_precision& component) { return chosen.gpu ? component.gpu : component.cpu; };
+
+    rnnt_model_paths paths{};
+    if (!pick(variants.encoder, wanted(policy.encoder), paths.encoder, chosen.encoder)
+        || !pick(variants.predictor, wanted(policy.predictor), paths.predictor, chosen.predictor)
+        || !pick(variants.joint, wanted(policy.joint), paths.joint, chosen.joint)) {
+      return false;
+    }
+    out = std::move(paths);
+    if (choice != nullptr) {
+      *choice = std::move(chosen);
+    }
+  } catch (...) {
+    return false;
+  }
+  return true;
+}
+
+} // namespace jaxie::onnx
@@ -0,0 +1,271 @@
+#include <Jaxie/onnx/ort_profile.hpp>
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace jaxie::onnx {
+namespace {
+
+constexpr std::string_view kernel_suffix = "_kernel_time";
+
+// Just enough JSON for ORT's trace: an array of flat event objects whose "args" object holds strings.
+class json_cursor {
+public:
+  explicit json_cursor(std::string_view text) noexcept : text_(text) {}
+
+  bool consume(char c) noexcept {
+    skip_space();
+    if (at_ < text_.size() && text_[at_] == c) {
+      ++at_;
+      return true;
+    }
+    return false;
+  }
+
+  bool next_is(char c) noexcept {
+    skip_space();
+    return at_ < text_.size() && text_[at_] == c;
+  }
+
+  bool string(std::string& out) {
+    out.clear();
+    if (!consume('"')) {
+      return false;
+    }
+    while (at_ < text_.size()) {
+      const char c = text_[at_++];
+      if (c == '"') {
+        return true;
+      }
+      if (c == '\\' && at_ < text_.size()) {
+        const char escaped = text_[at_++];
+        switch (escaped) {
+        case 'n':
+          out.push_back('\n');
+          break;
+        case 't':
+          out.push_back('\t');
+          break;
+        case 'u': // node names are ASCII; keep anything else as written
+          out.append("\\u");
+          break;
+        default:
+          out.push_back(escaped);
+          break;
+        }
+        continue;
+      }
+      out.push_back(c);
+    }
+    return false;
+  }
+
+  bool number(double& out) noexcept {
+    skip_space();
+    const char* first = text_.data() + at_;
+    const auto [end, error] = std::from_chars(first, text_.data() + text_.size(), out);
+    if (error != std::errc{}) {
+      return false;
+    }
+    at_ += static_cast<size_t>(end - first);
+    return true;
+  }
+
+  // Any value, nested or not, without recursion.
+  bool skip() noexcept {
+    skip_space();
+    size_t depth = 0;
+    while (at_ < text_.size()) {
+      const char c = text_[at_];
+      if (c == '"') {
+        ++at_;
+        while (at_ < text_.size() && text_[at_] != '"') {
+          at_ += text_[at_] == '\\' ? 2U : 1U;
+        }
+        ++at_;
+        if (depth == 0) {
+          return at_ <= text_.size();
+        }
+      } else if (c == '{' || c == '[') {
+        ++depth;
+        ++at_;
+      } else if (c == '}' || c == ']') {
+        if (depth == 0) {
+          return true; // a scalar ended by its container
+        }
+        ++at_;
+        if (--depth == 0) {
+          return true;
+        }
+      } else if (c == ',' && depth == 0) {
+        return true;
+      } else {
+        ++at_;
+      }
+    }
+    return false;
+  }
+
+private:
+  void skip_space() noexcept {
+    while (at_ < text_.size() && std::string_view(" \t\r\n").find(text_[at_]) != std::string_view::npos) {
+      ++at_;
+    }
+  }
+
+  std::string_view text_;
+  size_t at_{0};
+};
+
+struct trace_event {
+  std::string cat;
+  std::string name;
+  std::string op;
+  std::string provider;
+  double dur{0.0};
+};
+
+// Calls fn(key) for each member of the object at the cursor; fn consumes the value.
+template <typename Fn>
+bool read_object(json_cursor& json, std::string& key, Fn&& fn) {
+  if (!json.consume('{')) {
+    return false;
+  }
+  if (json.consume('}')) {
+    return true;
+  }
+  do {
+    if (!json.string(key) || !json.consume(':') || !fn(key)) {
+      return false;
+    }
+  } while (json.consume(','));
+  return json.consume('}');
+}
+
+bool read_event(json_cursor& json, trace_event& event, std::string& key, std::string& inner) {
+  event.cat.clear();
+  event.name.clear();
+  event.op.clear();
+  event.provider.clear();
+  event.dur = 0.0;
+  return read_object(json, key, [&](const std::string& name) {
+    if (name == "cat") {
+      return json.string(event.cat);
+    }
+    if (name == "name") {
+      return json.string(event.name);
+    }
+    if (name == "dur") {
+      return json.number(event.dur);
+    }
+    if (name == "args" && json.next_is('{')) {
+      return read_object(json, inner, [&](const std::string& arg) {
+        if (arg == "op_name") {
+          return json.string(event.op);
+        }
+        if (arg == "provider") {
+          return json.string(event.provider);
+        }
+        return json.skip();
+      });
+    }
+    return json.skip();
+  });
+}
+
+struct provider_nodes {
+  std::string provider;
+  std::unordered_set<std::string> names;
+};
+
+void add_event(const trace_event& event, session_profile& out, std::vector<provider_nodes>& nodes) {
+  const auto us = static_cast<uint64_t>((std::max)(event.dur, 0.0));
+  if (event.cat == "Session" && event.name == "model_run") {
+    ++out.runs;
+    out.run_us += us;
+    return;
+  }
+  if (event.cat != "Node" || !event.name.ends_with(kernel_suffix)) {
+    return;
+  }
+  out.kernel_us += us;
+  auto op = std::find_if(out.ops.begin(), out.ops.end(), [&](const op_timing& timing) {
+    return timing.op == event.op && timing.provider == event.provider;
+  });
+  if (op == out.ops.end()) {
+    op = out.ops.insert(out.ops.end(), op_timing{ .op = event.op, .provider = event.provider });
+  }
+  ++op->calls;
+  op->total_us += us;
+
+  auto placed = std::find_if(nodes.begin(), nodes.end(), [&](const provider_nodes& entry) {
+    return entry.provider == event.provider;
+  });
+  if (placed == nodes.end()) {
+    placed = nodes.insert(nodes.end(), provider_nodes{ .provider = event.provider, .names = {} });
+  }
+  placed->names.emplace(std::string_view(event.name).substr(0, event.name.size() - kernel_suffix.size()));
+}
+
+} // namespace
+
+bool summarize_profile(std::string_view trace, session_profile& out) noexcept {
+  out = {};
+  try {
+    json_cursor json(trace);
+    if (!json.consume('[')) {
+      return false;
+    }
+    trace_event event;
+    std::string key;
+    std::string inner;
+    std::vector<provider_nodes> nodes;
+    // ORT closes the array when profiling ends; a trace cut short still counts up to its last whole event.
+    while (json.next_is('{')) {
+      if (!read_event(json, event, key, inner)) {
+        break;
+      }
+      add_event(event, out, nodes);
+      if (!json.consume(',')) {
+        break;
+      }
+    }
+    std::sort(out.ops.begin(), out.ops.end(), [](const op_timing& lhs, const op_timing& rhs) {
+      return lhs.total_us > rhs.total_us;
+    });
+    for (const auto& entry : nodes) {
+      out.nodes.push_back({ .provider = entry.provider, .nodes = static_cast<uint32_t>(entry.names.size()) });
+    }
+    std::sort(out.nodes.begin(), out.nodes.end(), [](const ep_node_count& lhs, const ep_node_count& rhs) {
+      return lhs.nodes > rhs.nodes;
+    });
+  } catch (...) {
+    out = {};
+    return false;
+  }
+  return true;
+}
+
+bool load_profile(const std::string& path, session_profile& out) noexcept {
+  out = {};
+  try {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+      return false;
+    }
+    const std::string trace((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    return summarize_profile(trace, out);
+  } catch (...) {
+    return false;
+  }
+}
+
+} // namespace jaxie::onnx
@@ -0,0 +1,685 @@
+#include "ort_tensors.hpp"
+
+#if defined(JAXIE_USE_ONNXRUNTIME)
+
+#include "content_hash.hpp"
+
+#include <Jaxie/onnx/model_bundle.hpp>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace jaxie::onnx::detail {
+namespace {
+
+struct shared_runtime {
+  explicit shared_runtime(const runtime_config& config)
+    : env(threading(config), ORT_LOGGING_LEVEL_WARNING, "jaxie") {}
+
+  static Ort::ThreadingOptions threading(const runtime_config& config) {
+    Ort::ThreadingOptions options;
+    if (config.intra_op_threads != 0) {
+      options.SetGlobalIntraOpNumThreads(static_cast<int>(config.intra_op_threads));
+    }
+    if (config.inter_op_threads != 0) {
+      options.SetGlobalInterOpNumThreads(static_cast<int>(config.inter_op_threads));
+    }
+    options.SetGlobalSpinControl(config.allow_spinning ? 1 : 0);
+    return options;
+  }
+
+  Ort::Env env;
+  Ort::PrepackedWeightsContainer prepacked;
+};
+
+std::mutex runtime_mutex;
+runtime_config runtime_settings{};
+// Never destroyed: sessions owned by static objects may outlive any exit-time destructor order.
+shared_runtime* runtime_instance = nullptr;
+
+shared_runtime& runtime() {
+  const std::lock_guard lock(runtime_mutex);
+  if (runtime_instance == nullptr) {
+    runtime_instance = new shared_runtime(runtime_settings); // NOLINT(*-owning-memory)
+  }
+  return *runtime_instance;
+}
+
+std::vector<io_port> describe_ports(const Ort::Session& session, bool inputs) {
+  Ort::AllocatorWithDefaultOptions allocator;
+  const size_t count = inputs ? session.GetInputCount() : session.GetOutputCount();
+  std::vector<io_port> ports(count);
+  for (size_t i = 0; i < count; ++i) {
+    auto& port = ports[i];
+    port.name = inputs ? session.GetInputNameAllocated(i, allocator).get() : session.GetOutputNameAllocated(i, allocator).get();
+    const auto info = (inputs ? session.GetInputTypeInfo(i) : session.GetOutputTypeInfo(i)).GetTensorTypeAndShapeInfo();
+    port.type = info.GetElementType();
+    port.shape = info.GetShape();
+  }
+  return ports;
+}
+
+std::string strip_state_affixes(std::string_view name) {
+  static constexpr std::array<std::string_view, 6> affixes{ "_next", "next_", "_new", "new_", "_out", "out_" };
+  std::string out(name);
+  for (const auto affix : affixes) {
+    for (size_t at = out.find(affix); at != std::string::npos; at = out.find(affix)) {
+      out.erase(at, affix.size());
+    }
+  }
+  return out;
+}
+
+constexpr uint64_t fnv_offset = content_hasher::offset;
+constexpr uint64_t fnv_prime = content_hasher::prime;
+
+uint64_t hash_text(uint64_t hash, std::string_view text) noexcept {
+  for (const char c : text) {
+    hash = (hash ^ static_cast<unsigned char>(c)) * fnv_prime;
+  }
+  return (hash ^ 0xFFU) * fnv_prime; // terminator, so {"ab", "c"} and {"a", "bc"} differ
+}
+
+uint64_t hash_file(const std::filesystem::path& path) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in) {
+    throw std::runtime_error("cannot read " + path.string());
+  }
+  std::vector<char> buffer(size_t{ 1 } << 20U);
+  content_hasher hasher;
+  while (in) {
+    in.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    hasher.update(std::as_bytes(std::span(buffer).first(static_cast<size_t>(in.gcount()))));
+  }
+  return hasher.finish();
+}
+
+std::string hex(uint64_t value, size_t digits) {
+  static constexpr std::string_view alphabet = "0123456789abcdef";
+  std::string out(digits, '0');
+  for (size_t i = digits; i > 0; --i, value >>= 4U) {
+    out[i - 1] = alphabet[value & 0xFU];
+  }
+  return out;
+}
+
+// Tells apart files written by concurrent loaders.
+uint64_t unique_stamp() noexcept {
+  return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count())
+         ^ std::hash<std::thread::id>{}(std::this_thread::get_id());
+}
+
+bool is_tensorrt(std::string_view provider) noexcept {
+  return provider == "TensorRT" || provider == "Tensorrt" || provider == "TRT";
+}
+
+GraphOptimizationLevel ort_level(graph_optimization level) noexcept {
+  switch (level) {
+  case graph_optimization::none:
+    return ORT_DISABLE_ALL;
+  case graph_optimization::basic:
+    return ORT_ENABLE_BASIC;
+  case graph_optimization::extended:
+    return ORT_ENABLE_EXTENDED;
+  case graph_optimization::all:
+    break;
+  }
+  return ORT_ENABLE_ALL;
+}
+
+void apply_session_config(Ort::SessionOptions& options, const session_config& config) {
+  if (config.global_thread_pools) {
+    options.DisablePerSessionThreads();
+  } else {
+    if (config.intra_op_threads != 0) {
+      options.SetIntraOpNumThreads(static_cast<int>(config.intra_op_threads));
+    }
+    if (config.parallel_execution && config.inter_op_threads != 0) {
+      options.SetInterOpNumThreads(static_cast<int>(config.inter_op_threads));
+    }
+    if (!config.allow_spinning) {
+      options.AddConfigEntry("session.intra_op.allow_spinning", "0");
+      options.AddConfigEntry("session.inter_op.allow_spinning", "0");
+    }
+  }
+  if (config.parallel_execution) {
+    options.SetExecutionMode(ORT_PARALLEL);
+  }
+  options.SetGraphOptimizationLevel(ort_level(config.optimization));
+}
+
+// Appends the providers in prefs' order and records which ORT took and why it refused the others.
+void append_execution_providers(Ort::SessionOptions& options, const ep_prefs& prefs, session_placement& placement) {
+  const auto reject = [&](std::string_view provider, std::string_view reason) {
+    placement.rejected.push_back(std::string(provider).append(": ").append(reason));
+  };
+  for (const auto& provider : prefs.providers) {
+    const std::string_view name = ort_provider_name(provider);
+    if (is_tensorrt(provider)) {
+#if defined(ORT_API_VERSION)
+      try {
+        const OrtApi& api = Ort::GetApi();
+        OrtTensorRTProviderOptionsV2* trt_options = nullptr;
+        Ort::ThrowOnError(api.CreateTensorRTProviderOptions(&trt_options));
+        const std::unique_ptr<OrtTensorRTProviderOptionsV2, void (*)(OrtTensorRTProviderOptionsV2*)> owned(
+          trt_options, api.ReleaseTensorRTProviderOptions);
+        const std::string& cache = prefs.session.cache_dir;
+        if (!cache.empty()) {
+          // Engine builds dominate a TensorRT cold start; the caches turn them into file reads.
+          const std::array<const char*, 4> keys{
+            "trt_engine_cache_enable", "trt_engine_cache_path", "trt_timing_cache_enable", "trt_timing_cache_path"
+          };
+          const std::array<const char*, 4> values{ "1", cache.c_str(), "1", cache.c_str() };
+          Ort::ThrowOnError(api.UpdateTensorRTProviderOptions(trt_options, keys.data(), values.data(), keys.size()));
+        }
+        options.AppendExecutionProvider_TensorRT_V2(*trt_options);
+        placement.registered.emplace_back(name);
+      } catch (const std::exception& error) {
+        // Fall back to the next provider.
+        reject(name, error.what());
+      }
+#else
+      reject(name, "not in this ONNX Runtime build");
+#endif
+    } else if (provider == "CUDA" || provider == "Cuda") {
+      try {
+        OrtCUDAProviderOptions cuda_options{};
+        Ort::ThrowOnError(OrtSessionOptionsAppendExecutionProvider_CUDA(options, &cuda_options));
+        placement.registered.emplace_back(name);
+      } catch (const std::exception& error) {
+        // ONNX Runtime falls back to CPU.
+        reject(name, error.what());
+      }
+    } else if (name.empty()) {
+      reject(provider, "unknown provider");
+    }
+    // CPU is the default provider; nothing to append.
+  }
+  // ORT always ends the chain with CPU, which takes whatever the others do not.
+  placement.registered.emplace_back(ort_provider_name("CPU"));
+}
+
+// "<dir>/jaxie-<model file>-<stamp>", to which ORT appends the trace's start time and ".json".
+std::string profile_prefix(const model_source& model, const session_config& config) {
+  namespace fs = std::filesystem;
+  std::error_code error;
+  const fs::path dir = config.profile_dir.empty() ? fs::temp_directory_path(error) : fs::path(config.profile_dir);
+  fs::create_directories(dir, error);
+  const std::string name = "jaxie-" + fs::path(model.path).filename().string() + '-' + hex(unique_stamp(), 8);
+  return (dir / name).string();
+}
+
+// Cache entries are "<stem>-<path hash>.<key>.onnx": the prefix names one source model, the key one version of
+// it under one configuration.
+std::string cache_prefix(const std::filesystem::path& source) {
+  std::error_code error;
+  const auto absolute = std::filesystem::absolute(source, error);
+  return source.stem().string() + '-' + hex(hash_text(fnv_offset, (error ? source : absolute).string()), 8) + '.';
+}
+
+uint64_t cache_key(uint64_t content, const ep_prefs& prefs) {
+  uint64_t key = content;
+  for (const auto& provider : prefs.providers) {
+    key = hash_text(key, provider);
+  }
+  key = hash_text(key, std::to_string(static_cast<int>(prefs.session.optimization)));
+#if defined(ORT_API_VERSION)
+  key = hash_text(key, std::to_string(ORT_API_VERSION));
+#endif
+  return content_hasher::mix(key);
+}
+
+void remove_stale_entries(const std::filesystem::path& dir, const std::string& prefix, const std::filesystem::path& keep) {
+  std::error_code error;
+  for (const auto& entry : std::filesystem::directory_iterator(dir, error)) {
+    const std::string name = entry.path().filename().string();
+    if (name.starts_with(prefix) && name.ends_with(".onnx") && entry.path() != keep) {
+      std::filesystem::remove(entry.path(), error);
+    }
+  }
+}
+
+} // namespace
+
+std::string_view ort_provider_name(std::string_view preference) noexcept {
+  if (is_tensorrt(preference)) {
+    return "TensorrtExecutionProvider";
+  }
+  if (preference == "CUDA" || preference == "Cuda") {
+    return "CUDAExecutionProvider";
+  }
+  if (preference == "CPU" || preference == "Cpu") {
+    return "CPUExecutionProvider";
+  }
+  return {};
+}
+
+const Ort::Env& shared_env() { return runtime().env; }
+
+bool configure_shared_runtime(const runtime_config& config) noexcept {
+  const std::lock_guard lock(runtime_mutex);
+  if (runtime_instance != nullptr) {
+    return false;
+  }
+  runtime_settings = config;
+  return true;
+}
+
+opened_session open_session(const model_source& model, const ep_prefs& prefs) {
+  namespace fs = std::filesystem;
+  const session_config& config = prefs.session;
+  Ort::SessionOptions options{};
+  apply_session_config(options, config);
+  opened_session out{};
+  append_execution_providers(options, prefs, out.placement);
+  if (config.profiling) {
+    options.EnableProfiling(profile_prefix(model, config).c_str());
+  }
+  if (model.ort_format) {
+    options.AddConfigEntry("session.use_ort_model_bytes_directly", "1");
+    options.AddConfigEntry("session.use_ort_model_bytes_for_initializers", "1");
+  }
+
+  shared_runtime& shared = runtime();
+  const auto create = [&](const std::string& path) {
+    if (config.share_prepacked_weights) {
+      return std::make_unique<Ort::Session>(shared.env, path.c_str(), options, shared.prepacked);
+    }
+    return std::make_unique<Ort::Session>(shared.env, path.c_str(), options);
+  };
+  const auto create_source = [&] {
+    if (model.bytes.empty()) {
+      return create(model.path);
+    }
+    if (config.share_prepacked_weights) {
+      return std::make_unique<Ort::Session>(shared.env, model.bytes.data(), model.bytes.size(), options, shared.prepacked);
+    }
+    return std::make_unique<Ort::Session>(shared.env, model.bytes.data(), model.bytes.size(), options);
+  };
+
+  const bool tensorrt = std::any_of(prefs.providers.begin(), prefs.providers.end(), is_tensorrt);
+  // ORT-format models are already optimized and cannot be saved as ONNX.
+  if (config.cache_dir.empty() || config.optimization == graph_optimization::none || tensorrt || model.ort_format) {
+    out.session = create_source();
+    return out;
+  }
+
+  std::error_code error;
+  const fs::path dir(config.cache_dir);
+  fs::create_directories(dir, error);
+  const fs::path source(model.path);
+  const std::string prefix = cache_prefix(source);
+  const uint64_t content = model.bytes.empty() ? hash_file(source) : model.content_hash;
+  const fs::path cached = dir / (prefix + hex(cache_key(content, prefs), 16) + ".onnx");
+  if (fs::exists(cached, error)) {
+    try {
+      // Already optimized at the configured level.
+      options.SetGraphOptimizationLevel(ORT_DISABLE_ALL);
+      out.session = create(cached.string());
+      out.from_cache = true;
+      return out;
+    } catch (...) {
+      // Unreadable entry: rebuild it from the source model.
+      fs::remove(cached, error);
+      options.SetGraphOptimizationLevel(ort_level(config.optimization));
+    }
+  }
+
+  remove_stale_entries(dir, prefix, cached);
+  // Written under a private name and renamed into place, so a concurrent loader never reads half a model.
+  const std::string partial = cached.string() + ".partial-" + hex(unique_stamp(), 16);
+  options.SetOptimizedModelFilePath(partial.c_str());
+  try {
+    out.session = create_source();
+  } catch (...) {
+    fs::remove(partial, error);
+    throw;
+  }
+  fs::rename(partial, cached, error);
+  if (error) {
+    fs::remove(partial, error);
+  }
+  return out;
+}
+
+std::array<opened_session, 3> open_sessions(const rnnt_model_paths& paths, const ep_prefs& prefs) {
+  static constexpr std::array<std::pair<bundle_section, std::string_view>, 3> graphs{
+    std::pair{ bundle_section::encoder, "encoder" }, std::pair{ bundle_section::predictor, "predictor" },
+    std::pair{ bundle_section::joint, "joint" }
+  };
+  std::array<model_source, 3> sources{ model_source{ .path = paths.encoder }, model_source{ .path = paths.predictor },
+                                       model_source{ .path = paths.joint } };
+  if (paths.bundle) {
+    for (size_t g = 0; g < graphs.size(); ++g) {
+      const auto [kind, name] = graphs[g];
+      sources[g] = model_source{ .path = paths.bundle->path() + '.' + std::string(name),
+                                 .bytes = paths.bundle->section(kind),
+                                 .content_hash = paths.bundle->section_hash(kind),
+                                 .ort_format = paths.bundle->is_ort_format(kind) };
+    }
+  }
+
+  auto encoder = std::async(std::launch::async, [&] { return open_session(sources[0], prefs); });
+  auto predictor = std::async(std::launch::async, [&] { return open_session(sources[1], prefs); });
+  std::array<opened_session, 3> out{};
+  std::exception_ptr failure;
+  try {
+    out[2] = open_session(sources[2], prefs);
+  } catch (...) {
+    failure = std::current_exception();
+  }
+  for (auto [pending, into] : { std::pair{ &encoder, &out[0] }, std::pair{ &predictor, &out[1] } }) {
+    try {
+      *into = pending->get();
+    } catch (...) {
+      if (!failure) {
+        failure = std::current_exception();
+      }
+    }
+  }
+  if (failure) {
+    std::rethrow_exception(failure);
+  }
+  if (paths.bundle) {
+    for (size_t g = 0; g < graphs.size(); ++g) {
+      if (!sources[g].ort_format) {
+        paths.bundle->release_pages(graphs[g].first);
+      }
+    }
+  }
+  return out;
+}
+
+std::string end_profiling(Ort::Session& session, session_profile& out, bool keep_trace) {
+  Ort::AllocatorWithDefaultOptions allocator;
+  const auto file = session.EndProfilingAllocated(allocator);
+  std::string path = file.get() != nullptr ? file.get() : "";
+  if (path.empty()) {
+    return {};
+  }
+  static_cast<void>(load_profile(path, out));
+  if (!keep_trace) {
+    std::error_code error;
+    std::filesystem::remove(path, error);
+    path.clear();
+  }
+  return path;
+}
+
+std::vector<io_port> session_inputs(const Ort::Session& session) { return describe_ports(session, true); }
+std::vector<io_port> session_outputs(const Ort::Session& session) { return describe_ports(session, false); }
+
+size_t element_bytes(ONNXTensorElementDataType type) noexcept {
+  switch (type) {
+  case ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT:
+  case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT32:
+    return 4;
+  case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT64:
+    return 8;
+  case ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT16:
+  case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT16:
+  case ONNX_TENSOR_ELEMENT_DATA_TYPE_UINT16:
+    return 2;
+  case ONNX_TENSOR_ELEMENT_DATA_TYPE_BOOL:
+  case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT8:
+  case ONNX_TENSOR_ELEMENT_DATA_TYPE_UINT8:
+    return 1;
+  default:
+    return 0;
+  }
+}
+
+bool is_integer(ONNXTensorElementDataType type) noexcept {
+  return type == ONNX_TENSOR_ELEMENT_DATA_TYPE_INT32 || type == ONNX_TENSOR_ELEMENT_DATA_TYPE_INT64;
+}
+
+std::vector<int64_t> concrete_shape(std::span<const int64_t> declared, int64_t fill) {
+  std::vector<int64_t> shape(declared.begin(), declared.end());
+  for (auto& dim : shape) {
+    dim = dim < 0 ? fill : dim;
+  }
+  return shape;
+}
+
+size_t element_count(std::span<const int64_t> shape) noexcept {
+  size_t count = 1;
+  for (const int64_t dim : shape) {
+    count *= static_cast<size_t>((std::max)(dim, int64_t{ 0 }));
+  }
+  return count;
+}
+
+bool is_length_port(const io_port& port) noexcept {
+  if (!is_integer(port.type) || port.shape.size() > 1) {
+    return false;
+  }
+  const std::string_view name(port.name);
+  return name.find("len") != std::string_view::npos && name.find("cache") == std::string_view::npos
+         && name.find("state") == std::string_view::npos;
+}
+
+bool match_state_outputs(
+  const std::vector<io_port>& inputs,
+  std::span<const size_t> state_inputs,
+  const std::vector<io_port>& outputs,
+  std::span<const size_t> candidate_outputs,
+  std::vector<size_t>& matched) {
+  matched.assign(state_inputs.size(), outputs.size());
+  std::vector<bool> taken(outputs.size(), false);
+  for (size_t i = 0; i < state_inputs.size(); ++i) {
+    const std::string want = strip_state_affixes(inputs[state_inputs[i]].name);
+    for (const size_t out : candidate_outputs) {
+      if (!taken[out] && strip_state_affixes(outputs[out].name) == want) {
+        matched[i] = out;
+        taken[out] = true;
+        break;
+      }
+    }
+  }
+  // Whatever is left pairs up positionally (e.g. "states.1" -> "states", "onnx::Slice_3" -> "162").
+  auto next = candidate_outputs.begin();
+  for (auto& index : matched) {
+    if (index != outputs.size()) {
+      continue;
+    }
+    while (next != candidate_outputs.end() && taken[*next]) {
+      ++next;
+    }
+    if (next == candidate_outputs.end()) {
+      return false;
+    }
+    index = *next;
+    taken[*next] = true;
+  }
+  for (size_t i = 0; i < state_inputs.size(); ++i) {
+    if (outputs[matched[i]].type != inputs[state_inputs[i]].type) {
+      return false;
+    }
+  }
+  return true;
+}
+
+std::span<std::byte> tensor_arena::allocate(size_t bytes) {
+  const size_t rounded = ((std::max)(bytes, size_t{ 1 }) + alignment - 1) & ~(alignment - 1);
+  if (rounded > remaining_) {
+    const size_t block = (std::max)(min_block_bytes, rounded + alignment);
+    blocks_.push_back(std::make_unique<std::byte[]>(block)); // NOLINT(*-avoid-c-arrays)
+    void* start = blocks_.back().get();
+    size_t space = block;
+    cursor_ = static_cast<std::byte*>(std::align(alignment, rounded, start, space));
+    remaining_ = space;
+    reserved_ += block;
+  }
+  const std::span<std::byte> out(cursor_, bytes);
+  cursor_ += rounded;
+  remaining_ -= rounded;
+  used_ += rounded;
+  return out;
+}
+
+void tensor_arena::release() noexcept {
+  blocks_.clear();
+  cursor_ = nullptr;
+  remaining_ = 0;
+  reserved_ = 0;
+  used_ = 0;
+}
+
+bool tensor_storage::allocate(tensor_arena& arena, ONNXTensorElementDataType type, std::span<const int64_t> shape) noexcept {
+  const size_t width = element_bytes(type);
+  if (width == 0) {
+    return false;
+  }
+  try {
+    shape_.assign(shape.begin(), shape.end());
+    count_ = element_count(shape);
+    bytes_ = arena.allocate(count_ * width);
+  } catch (...) {
+    return false;
+  }
+  type_ = type;
+  zero();
+  return true;
+}
+
+void tensor_storage::zero() noexcept { std::fill(bytes_.begin(), bytes_.end(), std::byte{ 0 }); }
+
+Ort::Value tensor_storage::make_value(const Ort::MemoryInfo& memory) const { return make_value(memory, shape_); }
+
+Ort::Value tensor_storage::make_value(const Ort::MemoryInfo& memory, std::span<const int64_t> shape) const {
+  if (element_count(shape) != count_) {
+    throw Ort::Exception("tensor_storage: shape does not match the storage", ORT_INVALID_ARGUMENT);
+  }
+  return Ort::Value::CreateTensor(
+    memory,
+    bytes_.data(), // a span member does not make its elements const
+    bytes_.size(),
+    shape.data(),
+    shape.size(),
+    type_);
+}
+
+void tensor_storage::set_scalar(int64_t value, size_t index) noexcept {
+  if (type_ == ONNX_TENSOR_ELEMENT_DATA_TYPE_INT32 && index < count_) {
+    const auto narrow = static_cast<int32_t>(value);
+    std::memcpy(bytes_.data() + (index * sizeof(narrow)), &narrow, sizeof(narrow));
+  } else if (type_ == ONNX_TENSOR_ELEMENT_DATA_TYPE_INT64 && index < count_) {
+    std::memcpy(bytes_.data() + (index * sizeof(value)), &value, sizeof(value));
+  }
+}
+
+int64_t tensor_storage::scalar(size_t index) const noexcept {
+  if (type_ == ONNX_TENSOR_ELEMENT_DATA_TYPE_INT32 && index < count_) {
+    int32_t narrow = 0;
+    std::memcpy(&narrow, bytes_.data() + (index * sizeof(narrow)), sizeof(narrow));
+    return narrow;
+  }
+  if (type_ == ONNX_TENSOR_ELEMENT_DATA_TYPE_INT64 && index < count_) {
+    int64_t wide = 0;
+    std::memcpy(&wide, bytes_.data() + (index * sizeof(wide)), sizeof(wide));
+    return wide;
+  }
+  return 0;
+}
+
+size_t batch_axis(std::span<const int64_t> declared) noexcept {
+  for (size_t axis = 0; axis < declared.size(); ++axis) {
+    if (declared[axis] < 0) {
+      return axis;
+    }
+  }
+  return no_axis;
+}
+
+batch_layout describe_rows(const tensor_storage& storage, size_t axis) noexcept {
+  const auto& shape = storage.shape();
+  if (axis >= shape.size() || shape[axis] <= 0) {
+    return { 1, storage.bytes().size() };
+  }
+  const auto before = std::span<const int64_t>(shape).first(axis);
+  const auto rows = static_cast<size_t>(shape[axis]);
+  const size_t outer = element_count(before);
+  if (outer == 0) {
+    return { 1, storage.bytes().size() };
+  }
+  return { outer, storage.bytes().size() / (outer * rows) };
+}
+
+void gather_row(const batch_layout& layout, size_t row, std::span<const std::byte> from, tensor_storage& batched) noexcept {
+  if (layout.row_bytes == 0) {
+    return;
+  }
+  const auto to = batched.bytes();
+  const size_t rows = to.size() / (layout.outer * layout.row_bytes);
+  for (size_t o = 0; o < layout.outer; ++o) {
+    std::copy_n(
+      from.begin() + static_cast<std::ptrdiff_t>(o * layout.row_bytes),
+      layout.row_bytes,
+      to.begin() + static_cast<std::ptrdiff_t>(((o * rows) + row) * layout.row_bytes));
+  }
+}
+
+void scatter_row(const batch_layout& layout, size_t row, const tensor_storage& batched, std::span<std::byte> into) noexcept {
+  if (layout.row_bytes == 0) {
+    return;
+  }
+  const auto from = batched.bytes();
+  const size_t rows = from.size() / (layout.outer * layout.row_bytes);
+  for (size_t o = 0; o < layout.outer; ++o) {
+    std::copy_n(
+      from.begin() + static_cast<std::ptrdiff_t>(((o * rows) + row) * layout.row_bytes),
+      layout.row_bytes,
+      into.begin() + static_cast<std::ptrdiff_t>(o * layout.row_bytes));
+  }
+}
+
+bool adopt(const Ort::Value& from, tensor_arena& arena, tensor_storage& into) noexcept {
+  try {
+    const auto info = from.GetTensorTypeAndShapeInfo();
+    const auto shape = info.GetShape();
+    if (!into.allocate(arena, info.GetElementType(), shape)) {
+      return false;
+    }
+    const auto* source = from.GetTensorData<std::byte>();
+    std::copy_n(source, into.bytes().size(), into.bytes().begin());
+  } catch (...) {
+    return false;
+  }
+  return true;
+}
+
+bool assign(const Ort::Value& from, tensor_storage& into) noexcept {
+  try {
+    const auto info = from.GetTensorTypeAndShapeInfo();
+    if (info.GetElementType() != into.type() || info.GetElementCount() != into.count()) {
+      return false;
+    }
+    const auto* source = from.GetTensorData<std::byte>();
+    std::copy_n(source, into.bytes().size(), into.bytes().begin());
+  } catch (...) {
+    return false;
+  }
+  return true;
+}
+
+} // namespace jaxie::onnx::detail
+
+#endif // defined(JAXIE_USE_ONNXRUNTIME)
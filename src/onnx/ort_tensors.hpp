@@ -0,0 +1,168 @@
+#pragma once
+
+// Internal helpers shared by the ONNX Runtime backends. Only meaningful when ORT is enabled.
+#if defined(JAXIE_USE_ONNXRUNTIME)
+
+#include <Jaxie/onnx/streaming_rnnt.hpp>
+
+#include <onnxruntime_cxx_api.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace jaxie::onnx::detail {
+
+// Name, element type and declared shape of one session input or output; dynamic dims are negative.
+struct io_port {
+  std::string name;
+  ONNXTensorElementDataType type{ONNX_TENSOR_ELEMENT_DATA_TYPE_UNDEFINED};
+  std::vector<int64_t> shape;
+};
+
+// A session, whether it came from the optimized-model cache and which providers it was given.
+struct opened_session {
+  std::unique_ptr<Ort::Session> session;
+  bool from_cache{false};
+  session_placement placement{};
+};
+
+// The process-wide Env every session is created in, made on first use with the configure_runtime() settings.
+const Ort::Env& shared_env();
+bool configure_shared_runtime(const runtime_config& config) noexcept;
+
+// ORT's name for an ep_prefs provider ("CUDA" -> "CUDAExecutionProvider"); empty for names it does not know.
+std::string_view ort_provider_name(std::string_view preference) noexcept;
+
+// A model file, or model bytes that stay valid for the session's life (a mapped bundle section).
+struct model_source {
+  std::string path; // the file, or the name of the bytes in cache entries
+  std::span<const std::byte> bytes{};
+  uint64_t content_hash{0}; // of bytes; files are hashed when the cache needs it
+  bool ort_format{false};   // ORT-format bytes: the session reads initializers in place instead of copying them
+};
+
+// Opens `model` in the shared Env with the EP order and session_config in `prefs`, going through the
+// optimized-model cache when prefs.session.cache_dir is set (see session_config) and with ORT's profiler on when
+// prefs.session.profiling is. Throws what Ort::Session throws.
+opened_session open_session(const model_source& model, const ep_prefs& prefs);
+
+// Encoder, predictor and joint from their files or from paths.bundle, opened concurrently: graph optimization
+// and weight prepacking of the three overlap instead of adding up. Bundle sections ORT has copied are dropped
+// from the resident set afterwards. Throws the first failure once all three have finished.
+std::array<opened_session, 3> open_sessions(const rnnt_model_paths& paths, const ep_prefs& prefs);
+
+// Ends profiling of a session opened with session_config::profiling and summarizes its trace, which is removed
+// unless keep_trace. Returns the path of the kept trace.
+std::string end_profiling(Ort::Session& session, session_profile& out, bool keep_trace);
+
+std::vector<io_port> session_inputs(const Ort::Session& session);
+std::vector<io_port> session_outputs(const Ort::Session& session);
+
+size_t element_bytes(ONNXTensorElementDataType type) noexcept;
+bool is_integer(ONNXTensorElementDataType type) noexcept;
+
+// Declared shape with every dynamic dim replaced by `fill` (batch, and the U/T axes of single-step models).
+std::vector<int64_t> concrete_shape(std::span<const int64_t> declared, int64_t fill = 1);
+size_t element_count(std::span<const int64_t> shape) noexcept;
+
+// A sequence-length input or output ("length", "encoded_lengths"), as opposed to a cache length that is state.
+bool is_length_port(const io_port& port) noexcept;
+
+// For each state input, the index into `outputs` of the tensor that replaces it after Run(). Outputs are
+// matched by name once "_next"/"next_"/"_new"/"new_"/"_out"/"out_" are ignored
+// (cache_last_channel_len <- cache_last_channel_next_len), otherwise in order. Returns false if any is unmatched.
+bool match_state_outputs(
+  const std::vector<io_port>& inputs,
+  std::span<const size_t> state_inputs,
+  const std::vector<io_port>& outputs,
+  std::span<const size_t> candidate_outputs,
+  std::vector<size_t>& matched);
+
+// Bump allocator for the tensors of one session or one encoder plan: a few large blocks instead of one heap
+// allocation per tensor, 64-byte aligned, released all at once.
+class tensor_arena {
+public:
+  std::span<std::byte> allocate(size_t bytes); // zero-filled; throws std::bad_alloc
+  void release() noexcept;
+
+  size_t reserved_bytes() const noexcept { return reserved_; }
+  size_t used_bytes() const noexcept { return used_; }
+
+private:
+  static constexpr size_t alignment = 64;
+  static constexpr size_t min_block_bytes = 64U * 1024U;
+
+  std::vector<std::unique_ptr<std::byte[]>> blocks_; // NOLINT(*-avoid-c-arrays)
+  std::byte* cursor_{nullptr};
+  size_t remaining_{0};
+  size_t reserved_{0};
+  size_t used_{0};
+};
+
+// One tensor of fixed shape in arena memory, so Run() reads and writes it in place. Ort::Values over it are
+// created when bindings are built, never per call.
+class tensor_storage {
+public:
+  bool allocate(tensor_arena& arena, ONNXTensorElementDataType type, std::span<const int64_t> shape) noexcept;
+  void zero() noexcept;
+
+  // Wraps the storage, optionally under a different shape of the same element count.
+  Ort::Value make_value(const Ort::MemoryInfo& memory) const;
+  Ort::Value make_value(const Ort::MemoryInfo& memory, std::span<const int64_t> shape) const;
+
+  template <typename T>
+  std::span<T> as() noexcept {
+    return { reinterpret_cast<T*>(bytes_.data()), bytes_.size() / sizeof(T) }; // NOLINT(*-reinterpret-cast)
+  }
+  template <typename T>
+  std::span<const T> as() const noexcept {
+    return { reinterpret_cast<const T*>(bytes_.data()), bytes_.size() / sizeof(T) }; // NOLINT(*-reinterpret-cast)
+  }
+
+  // Writes an integer into element `index` in the storage's own integer type.
+  void set_scalar(int64_t value, size_t index = 0) noexcept;
+  int64_t scalar(size_t index = 0) const noexcept;
+
+  std::span<std::byte> bytes() noexcept { return bytes_; }
+  std::span<const std::byte> bytes() const noexcept { return bytes_; }
+  const std::vector<int64_t>& shape() const noexcept { return shape_; }
+  ONNXTensorElementDataType type() const noexcept { return type_; }
+  size_t count() const noexcept { return count_; }
+
+private:
+  std::span<std::byte> bytes_;
+  std::vector<int64_t> shape_;
+  ONNXTensorElementDataType type_{ONNX_TENSOR_ELEMENT_DATA_TYPE_UNDEFINED};
+  size_t count_{0};
+};
+
+// A batched tensor as `outer` blocks, each holding one contiguous `row_bytes` row per batch entry: the dims
+// before the batch axis are outer, the ones after it make up a row ([L, B, H] LSTM states have outer = L).
+struct batch_layout {
+  size_t outer{1};
+  size_t row_bytes{0};
+};
+
+// The batch axis of a declared shape is its first dynamic dim; a fully static shape has none (no_axis).
+inline constexpr size_t no_axis = static_cast<size_t>(-1);
+size_t batch_axis(std::span<const int64_t> declared) noexcept;
+// Layout of `storage`, whose shape holds the batch at `axis` (no_axis: one row of everything).
+batch_layout describe_rows(const tensor_storage& storage, size_t axis) noexcept;
+// Row `row` of a batched tensor to or from one unbatched tensor of row_bytes * outer bytes.
+void gather_row(const batch_layout& layout, size_t row, std::span<const std::byte> from, tensor_storage& batched) noexcept;
+void scatter_row(const batch_layout& layout, size_t row, const tensor_storage& batched, std::span<std::byte> into) noexcept;
+
+// Copies `from` into arena storage of the same type and actual shape (used to adopt probe-run outputs).
+bool adopt(const Ort::Value& from, tensor_arena& arena, tensor_storage& into) noexcept;
+// Copies `from` into existing storage of the same type and element count.
+bool assign(const Ort::Value& from, tensor_storage& into) noexcept;
+
+} // namespace jaxie::onnx::detail
+
+#endif // defined(JAXIE_USE_ONNXRUNTIME)
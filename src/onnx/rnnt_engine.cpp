@@ -0,0 +1,1142 @@
+#include <Jaxie/onnx/rnnt_engine.hpp>
+
+#include <Jaxie/dsp/log_mel.hpp>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(JAXIE_USE_ONNXRUNTIME)
+#include "ort_tensors.hpp"
+
+#include <onnxruntime_cxx_api.h>
+#endif
+
+namespace jaxie::onnx {
+namespace detail {
+
+template <typename Backend>
+class engine_impl {
+public:
+  engine_impl() = default;
+  ~engine_impl() { shutdown(); }
+
+  engine_impl(const engine_impl&) = delete;
+  engine_impl& operator=(const engine_impl&) = delete;
+  engine_impl(engine_impl&&) = delete;
+  engine_impl& operator=(engine_impl&&) = delete;
+
+  bool load(
+    const rnnt_model_paths& paths,
+    const ep_prefs& prefs,
+    const engine_options& options,
+    stream_tokens_callback on_tokens) noexcept {
+    shutdown();
+    if (options.max_streams == 0 || options.max_batch == 0 || options.max_backlog_chunks == 0
+        || options.rnnt.max_step_frames == 0 || options.rnnt.features.hop_frames == 0
+        || options.rnnt.decoding != decode_mode::greedy) {
+      return false;
+    }
+    if (!backend_.load(paths, prefs, options)) {
+      return false;
+    }
+
+    try {
+      chunk_frames_ = backend_.chunk_frames();
+      batch_limit_ = backend_.batch_limit();
+      mel_bins_ = options.rnnt.features.mel_bins;
+      max_step_frames_ = options.rnnt.max_step_frames;
+      max_wait_ = std::chrono::microseconds(options.max_wait_us);
+
+      // At most window - 1 samples are carried over, so a slice never yields more than max / hop + 1 frames.
+      const size_t scratch_frames = (max_step_frames_ / options.rnnt.features.hop_frames) + 1;
+      streams_ = std::vector<stream>(options.max_streams);
+      for (auto& entry : streams_) {
+        if (!entry.frontend.init(options.rnnt.features)) {
+          streams_.clear();
+          backend_.unload();
+          return false;
+        }
+        entry.scratch.assign(scratch_frames * mel_bins_, 0.0F);
+        entry.backlog.assign(size_t{ options.max_backlog_chunks } * chunk_frames_ * mel_bins_, 0.0F);
+      }
+      candidates_.reserve(streams_.size());
+      batch_slots_.reserve(batch_limit_);
+      batch_features_.assign(size_t{ batch_limit_ } * chunk_frames_ * mel_bins_, 0.0F);
+      batch_tokens_.assign(batch_limit_, {});
+      for (auto& tokens : batch_tokens_) {
+        tokens.reserve(chunk_frames_ * (std::max)(options.rnnt.max_symbols_per_frame, 1U));
+      }
+      on_tokens_ = std::move(on_tokens);
+      stats_ = {};
+      stopping_ = false;
+      worker_ = std::thread([this] { run_loop(); });
+    } catch (...) {
+      streams_.clear();
+      backend_.unload();
+      return false;
+    }
+    return true;
+  }
+
+  void shutdown() noexcept {
+    {
+      const std::lock_guard lock(mutex_);
+      stopping_ = true;
+    }
+    wake_.notify_all();
+    if (worker_.joinable()) {
+      worker_.join();
+    }
+    backend_.unload();
+    streams_.clear();
+    on_tokens_ = {};
+  }
+
+  bool open_stream(uint32_t& id) noexcept {
+    const std::lock_guard batch(batch_mutex_);
+    const std::lock_guard lock(mutex_);
+    for (size_t i = 0; i < streams_.size(); ++i) {
+      if (!streams_[i].open) {
+        id = static_cast<uint32_t>(i);
+        clear_stream(id);
+        streams_[i].open = true;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void close_stream(uint32_t id) noexcept {
+    const std::lock_guard batch(batch_mutex_);
+    const std::lock_guard lock(mutex_);
+    if (id < streams_.size() && streams_[id].open) {
+      clear_stream(id);
+      streams_[id].open = false;
+    }
+  }
+
+  void reset_stream(uint32_t id) noexcept {
+    const std::lock_guard batch(batch_mutex_);
+    const std::lock_guard lock(mutex_);
+    if (id < streams_.size() && streams_[id].open) {
+      clear_stream(id);
+    }
+  }
+
+  bool push(uint32_t id, std::span<const float> audio) noexcept {
+    if (id >= streams_.size()) {
+      return false;
+    }
+    auto& entry = streams_[id];
+    {
+      const std::lock_guard lock(mutex_);
+      if (!entry.open || stopping_) {
+        return false;
+      }
+    }
+    bool ready = false;
+    while (!audio.empty()) {
+      const auto slice = audio.first((std::min)(audio.size(), size_t{ max_step_frames_ }));
+      audio = audio.subspan(slice.size());
+      // The frontend belongs to the stream's producer, so it runs outside the lock.
+      const size_t frames = entry.frontend.push(slice, entry.scratch);
+      if (frames == 0) {
+        continue;
+      }
+      const std::lock_guard lock(mutex_);
+      ready = enqueue(entry, std::span<const float>(entry.scratch).first(frames * mel_bins_)) || ready;
+    }
+    if (ready) {
+      wake_.notify_one();
+    }
+    return true;
+  }
+
+  engine_stats stats() const noexcept {
+    const std::lock_guard lock(mutex_);
+    engine_stats out = stats_;
+    out.batch_limit = batch_limit_;
+    out.open_streams = static_cast<uint32_t>(
+      std::count_if(streams_.begin(), streams_.end(), [](const stream& entry) { return entry.open; }));
+    return out;
+  }
+
+private:
+  using clock = std::chrono::steady_clock;
+
+  struct stream {
+    bool open{false};
+    dsp::log_mel_frontend frontend{};
+    std::vector<float> scratch; // frontend output for one push slice
+    std::vector<float> backlog; // ring of queued feature frames, frames x mel_bins_
+    size_t head{0};             // first queued frame
+    size_t queued{0};
+    clock::time_point ready_since{}; // when a chunk completed with none queued before it
+  };
+
+  // Caller holds mutex_ (and batch_mutex_ when the slot's decoder state is touched).
+  void clear_stream(uint32_t id) noexcept {
+    auto& entry = streams_[id];
+    entry.frontend.reset();
+    entry.head = 0;
+    entry.queued = 0;
+    backend_.reset_slot(id);
+  }
+
+  // Caller holds mutex_. Returns true when the stream just completed a chunk.
+  bool enqueue(stream& entry, std::span<const float> rows) noexcept {
+    const size_t capacity = entry.backlog.size() / mel_bins_;
+    const bool was_ready = entry.queued >= chunk_frames_;
+    for (size_t offset = 0; offset < rows.size(); offset += mel_bins_) {
+      if (entry.queued == capacity) {
+        entry.head = (entry.head + 1) % capacity;
+        --entry.queued;
+        ++stats_.dropped_frames;
+      }
+      const size_t at = (entry.head + entry.queued) % capacity;
+      std::copy_n(
+        rows.begin() + static_cast<std::ptrdiff_t>(offset),
+        mel_bins_,
+        entry.backlog.begin() + static_cast<std::ptrdiff_t>(at * mel_bins_));
+      ++entry.queued;
+    }
+    if (!was_ready && entry.queued >= chunk_frames_) {
+      entry.ready_since = clock::now();
+      return true;
+    }
+    return false;
+  }
+
+  void run_loop() noexcept {
+    std::unique_lock lock(mutex_);
+    while (!stopping_) {
+      size_t ready = 0;
+      auto oldest = clock::time_point::max();
+      for (const auto& entry : streams_) {
+        if (entry.open && entry.queued >= chunk_frames_) {
+          ++ready;
+          oldest = (std::min)(oldest, entry.ready_since);
+        }
+      }
+      if (ready == 0) {
+        wake_.wait(lock);
+        continue;
+      }
+      if (ready < batch_limit_ && clock::now() < oldest + max_wait_) {
+        wake_.wait_until(lock, oldest + max_wait_);
+        continue;
+      }
+      lock.unlock();
+      run_batch();
+      deliver();
+      lock.lock();
+    }
+  }
+
+  void run_batch() noexcept {
+    const std::lock_guard batch(batch_mutex_);
+    {
+      const std::lock_guard lock(mutex_);
+      take_ready();
+    }
+    if (batch_slots_.empty()) {
+      return;
+    }
+    for (auto& tokens : batch_tokens_) {
+      tokens.clear();
+    }
+    const size_t rows = batch_slots_.size();
+    const bool ok = backend_.run(
+      batch_slots_, std::span<const float>(batch_features_).first(rows * chunk_frames_ * mel_bins_), batch_tokens_);
+
+    const auto counters = backend_.counters();
+    const std::lock_guard lock(mutex_);
+    ++stats_.batches;
+    stats_.chunks += rows;
+    stats_.full_batches += rows == batch_limit_ ? 1 : 0;
+    stats_.failed_batches += ok ? 0 : 1;
+    stats_.encoder_runs = counters.encoder_runs;
+    stats_.predictor_runs = counters.predictor_runs;
+    stats_.joint_runs = counters.joint_runs;
+  }
+
+  // Caller holds both locks. Oldest ready streams first, one chunk each.
+  void take_ready() noexcept {
+    batch_slots_.clear();
+    candidates_.clear();
+    for (size_t i = 0; i < streams_.size(); ++i) {
+      if (streams_[i].open && streams_[i].queued >= chunk_frames_) {
+        candidates_.push_back(static_cast<uint32_t>(i));
+      }
+    }
+    const size_t rows = (std::min)(candidates_.size(), size_t{ batch_limit_ });
+    std::partial_sort(candidates_.begin(), candidates_.begin() + static_cast<std::ptrdiff_t>(rows), candidates_.end(),
+      [this](uint32_t lhs, uint32_t rhs) { return streams_[lhs].ready_since < streams_[rhs].ready_since; });
+
+    const auto now = clock::now();
+    for (size_t row = 0; row < rows; ++row) {
+      const uint32_t id = candidates_[row];
+      auto& entry = streams_[id];
+      if (row == 0) {
+        const auto waited = std::chrono::duration_cast<std::chrono::nanoseconds>(now - entry.ready_since).count();
+        stats_.wait_last_ns = static_cast<uint64_t>((std::max)(waited, std::chrono::nanoseconds::rep{ 0 }));
+        stats_.wait_max_ns = (std::max)(stats_.wait_max_ns, stats_.wait_last_ns);
+        stats_.wait_total_ns += stats_.wait_last_ns;
+      }
+      const size_t capacity = entry.backlog.size() / mel_bins_;
+      auto out = batch_features_.begin() + static_cast<std::ptrdiff_t>(row * chunk_frames_ * mel_bins_);
+      for (size_t frame = 0; frame < chunk_frames_; ++frame) {
+        const size_t at = (entry.head + frame) % capacity;
+        out = std::copy_n(entry.backlog.begin() + static_cast<std::ptrdiff_t>(at * mel_bins_), mel_bins_, out);
+      }
+      entry.head = (entry.head + chunk_frames_) % capacity;
+      entry.queued -= chunk_frames_;
+      // A stream that is a chunk or more behind keeps its stamp: it is overdue and ready again at once. One that
+      // ran dry is restamped by enqueue() when its next chunk completes.
+      batch_slots_.push_back(id);
+    }
+  }
+
+  void deliver() noexcept {
+    if (!on_tokens_) {
+      return;
+    }
+    for (size_t row = 0; row < batch_slots_.size(); ++row) {
+      if (!batch_tokens_[row].empty()) {
+        try {
+          on_tokens_(batch_slots_[row], batch_tokens_[row]);
+        } catch (...) {
+          // A throwing consumer must not take the engine thread down.
+        }
+      }
+    }
+  }
+
+  Backend backend_{};
+  std::vector<stream> streams_;
+  stream_tokens_callback on_tokens_{};
+  size_t chunk_frames_{0};
+  uint32_t batch_limit_{1};
+  uint32_t mel_bins_{0};
+  uint32_t max_step_frames_{0};
+  std::chrono::microseconds max_wait_{0};
+
+  mutable std::mutex mutex_; // stream table, backlogs and stats_
+  std::condition_variable wake_;
+  std::mutex batch_mutex_; // held while the backend runs; taken before mutex_ to touch decoder state
+  std::thread worker_;
+  bool stopping_{false};
+  engine_stats stats_{};
+
+  // Engine-thread scratch, sized in load().
+  std::vector<uint32_t> candidates_;
+  std::vector<uint32_t> batch_slots_;
+  std::vector<float> batch_features_; // rows x chunk_frames_ x mel_bins_
+  std::vector<std::vector<int32_t>> batch_tokens_;
+};
+
+struct null_batch_backend {
+  bool load(const rnnt_model_paths& paths, const ep_prefs& prefs, const engine_options& options) noexcept {
+    static_cast<void>(paths);
+    static_cast<void>(prefs);
+    static_cast<void>(options);
+    return false;
+  }
+
+  size_t chunk_frames() const noexcept { return 0; }
+  uint32_t batch_limit() const noexcept { return 1; }
+
+  bool run(
+    std::span<const uint32_t> slots,
+    std::span<const float> features,
+    std::vector<std::vector<int32_t>>& tokens) noexcept {
+    static_cast<void>(slots);
+    static_cast<void>(features);
+    static_cast<void>(tokens);
+    return false;
+  }
+
+  void reset_slot(uint32_t slot) noexcept { static_cast<void>(slot); }
+  void unload() noexcept {}
+  engine_stats counters() const noexcept { return {}; }
+};
+
+#if defined(JAXIE_USE_ONNXRUNTIME)
+
+// Batched counterpart of the streaming_rnnt ORT backend, with the same model IO conventions. Every input
+// carries the batch on its first dynamic dim (dim 0 for features and most tensors, dim 1 for [L, B, H] LSTM
+// states); if any input has none, batches are limited to one stream.
+//
+// Per-stream state lives in slots. A batch gathers the rows of its streams into one tensor per input and
+// scatters the updated caches and states back afterwards; predictor state is double-buffered per slot, so
+// committing an emitted token's state is a side flip. Each model keeps one IoBinding-bound plan per batch
+// size, built by a probe run the first time that size is seen.
+class onnx_batch_backend {
+public:
+  onnx_batch_backend();
+  ~onnx_batch_backend();
+
+  onnx_batch_backend(const onnx_batch_backend&) = delete;
+  onnx_batch_backend& operator=(const onnx_batch_backend&) = delete;
+  onnx_batch_backend(onnx_batch_backend&&) = delete;
+  onnx_batch_backend& operator=(onnx_batch_backend&&) = delete;
+
+  bool load(const rnnt_model_paths& paths, const ep_prefs& prefs, const engine_options& options) noexcept;
+  size_t chunk_frames() const noexcept { return chunk_frames_; }
+  uint32_t batch_limit() const noexcept { return batch_limit_; }
+  // features holds one chunk (chunk_frames() x mel_bins frames) per slot; tokens[row] receives slots[row]'s.
+  bool run(
+    std::span<const uint32_t> slots,
+    std::span<const float> features,
+    std::vector<std::vector<int32_t>>& tokens) noexcept;
+  void reset_slot(uint32_t slot) noexcept;
+  void unload() noexcept;
+  engine_stats counters() const noexcept;
+
+private:
+  static constexpr size_t no_port = static_cast<size_t>(-1);
+
+  struct model {
+    std::unique_ptr<Ort::Session> session{};
+    std::vector<io_port> in_ports;
+    std::vector<io_port> out_ports;
+    std::vector<const char*> in_names;
+    std::vector<const char*> out_names;
+    std::vector<size_t> in_axes; // batch axis per input, no_axis if static
+    std::vector<size_t> out_axes;
+    std::vector<std::vector<int64_t>> row_shapes; // one batch row of each input
+  };
+
+  // Tensors and binding for one call of `rows` streams.
+  struct batch_plan {
+    tensor_arena arena;
+    size_t rows{0};
+    std::vector<tensor_storage> inputs;
+    std::vector<tensor_storage> outputs;
+    std::vector<batch_layout> input_rows;
+    std::vector<batch_layout> output_rows;
+    Ort::IoBinding binding{nullptr};
+    bool bound{false}; // false until the probe run has fixed the outputs
+  };
+
+  struct slot_state {
+    std::vector<tensor_storage> caches;                // one per encoder cache, batch of one
+    std::array<std::vector<tensor_storage>, 2> states; // predictor state, [side]
+    size_t side{0};                                    // committed state; the other side holds the candidate
+    tensor_storage prediction;                         // predictor output for the last emitted token
+  };
+
+  void describe(model& target) const;
+  bool prepare_encoder();
+  bool prepare_predictor();
+  bool prepare_joint();
+  bool prime();
+
+  batch_plan& plan_for(model& target, std::vector<batch_plan>& plans, size_t rows);
+  void run_plan(model& target, batch_plan& plan);
+  void encode(std::span<const uint32_t> slots, std::span<const float> features);
+  void store_caches(std::span<const uint32_t> slots, const batch_plan& plan);
+  bool decode(std::span<const uint32_t> slots, std::vector<std::vector<int32_t>>& tokens);
+  void advance_predictor(std::span<const uint32_t> slots);
+
+  std::shared_ptr<const model_bundle> bundle_{};
+  Ort::MemoryInfo memory_{nullptr};
+  Ort::RunOptions run_options_{nullptr};
+  uint32_t mel_bins_{0};
+  uint32_t max_symbols_{1};
+  uint32_t batch_limit_{1};
+  int64_t blank_id_{0};
+  int64_t blank_option_{-1};
+
+  model encoder_;
+  size_t feature_input_{no_port};
+  size_t length_input_{no_port};
+  size_t encoded_length_output_{no_port};
+  bool channels_first_{false};
+  size_t chunk_frames_{0};
+  std::vector<size_t> cache_inputs_;
+  std::vector<size_t> cache_outputs_;
+  std::vector<batch_plan> encoder_plans_; // [rows - 1]
+  bool encoder_plans_stale_{false};       // caches were resized under them
+
+  model predictor_;
+  size_t token_input_{no_port};
+  std::vector<size_t> pred_length_inputs_;
+  std::vector<size_t> pred_state_inputs_;
+  std::vector<size_t> pred_state_outputs_;
+  std::vector<batch_plan> predictor_plans_;
+
+  model joint_;
+  size_t joint_encoder_side_{0};
+  size_t encoder_width_{0}; // D
+  std::vector<batch_plan> joint_plans_;
+
+  tensor_arena slot_arena_;  // predictor state and predictions of every slot
+  tensor_arena cache_arena_; // encoder caches of every slot, reallocated when a probe reveals their size
+  std::vector<slot_state> slots_;
+  std::vector<std::byte> primed_prediction_; // after the start-of-sequence (blank) token
+  std::vector<std::vector<std::byte>> primed_states_;
+
+  // Decode scratch, sized in load().
+  std::vector<size_t> valid_frames_;
+  std::vector<uint32_t> active_;     // rows still decoding the current frame
+  std::vector<uint32_t> emitters_;   // rows that emitted on this symbol step
+  std::vector<int64_t> emitted_;     // their tokens
+  std::vector<uint32_t> row_slots_;  // slots of the rows in a predictor call
+  std::vector<float> frame_;         // one encoder frame, D floats
+  std::vector<float> scores_;        // one row of logits
+
+  uint64_t encoder_runs_{0};
+  uint64_t predictor_runs_{0};
+  uint64_t joint_runs_{0};
+};
+
+onnx_batch_backend::onnx_batch_backend() = default;
+
+onnx_batch_backend::~onnx_batch_backend() { unload(); }
+
+bool onnx_batch_backend::load(const rnnt_model_paths& paths, const ep_prefs& prefs, const engine_options& options) noexcept {
+  unload();
+  mel_bins_ = options.rnnt.features.mel_bins;
+  max_symbols_ = (std::max)(options.rnnt.max_symbols_per_frame, 1U);
+  chunk_frames_ = options.rnnt.encoder_chunk_frames;
+  blank_option_ = options.rnnt.blank_id;
+
+  try {
+    bundle_ = paths.bundle;
+    auto opened = open_sessions(paths, prefs);
+    encoder_.session = std::move(opened[0].session);
+    predictor_.session = std::move(opened[1].session);
+    joint_.session = std::move(opened[2].session);
+    memory_ = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
+    run_options_ = Ort::RunOptions{};
+    describe(encoder_);
+    describe(predictor_);
+    describe(joint_);
+
+    batch_limit_ = (std::min)(options.max_batch, options.max_streams);
+    for (const model* target : { &encoder_, &predictor_, &joint_ }) {
+      if (std::find(target->in_axes.begin(), target->in_axes.end(), no_axis) != target->in_axes.end()) {
+        batch_limit_ = 1;
+      }
+    }
+    encoder_plans_.resize(batch_limit_);
+    predictor_plans_.resize(batch_limit_);
+    joint_plans_.resize(batch_limit_);
+    slots_.resize(options.max_streams);
+
+    if (!prepare_encoder() || !prepare_predictor() || !prepare_joint() || !prime()) {
+      unload();
+      return false;
+    }
+
+    valid_frames_.assign(batch_limit_, 0);
+    active_.reserve(batch_limit_);
+    emitters_.reserve(batch_limit_);
+    emitted_.reserve(batch_limit_);
+    row_slots_.reserve(batch_limit_);
+    for (uint32_t slot = 0; slot < slots_.size(); ++slot) {
+      reset_slot(slot);
+    }
+  } catch (...) {
+    unload();
+    return false;
+  }
+
+  return true;
+}
+
+void onnx_batch_backend::describe(model& target) const {
+  target.in_ports = session_inputs(*target.session);
+  target.out_ports = session_outputs(*target.session);
+  for (const auto& port : target.in_ports) {
+    target.in_names.push_back(port.name.c_str());
+    target.in_axes.push_back(batch_axis(port.shape));
+    target.row_shapes.push_back(concrete_shape(port.shape));
+  }
+  for (const auto& port : target.out_ports) {
+    target.out_names.push_back(port.name.c_str());
+    target.out_axes.push_back(batch_axis(port.shape));
+  }
+}
+
+bool onnx_batch_backend::prepare_encoder() {
+  const auto& inputs = encoder_.in_ports;
+  const auto& outputs = encoder_.out_ports;
+  for (size_t i = 0; i < inputs.size() && feature_input_ == no_port; ++i) {
+    if (inputs[i].type == ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT && inputs[i].shape.size() == 3) {
+      feature_input_ = i;
+    }
+  }
+  if (feature_input_ == no_port || outputs.empty() || outputs[0].type != ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT
+      || (batch_limit_ > 1 && encoder_.out_axes[0] != 0)) {
+    return false;
+  }
+
+  const auto& shape = inputs[feature_input_].shape;
+  int64_t time_dim = 0;
+  if (shape[1] == mel_bins_) {
+    channels_first_ = true;
+    time_dim = shape[2];
+  } else if (shape[2] == mel_bins_) {
+    time_dim = shape[1];
+  } else {
+    return false;
+  }
+  if (time_dim > 0) {
+    chunk_frames_ = static_cast<size_t>(time_dim);
+  }
+  if (chunk_frames_ == 0) {
+    return false;
+  }
+  encoder_.row_shapes[feature_input_][channels_first_ ? 2 : 1] = static_cast<int64_t>(chunk_frames_);
+
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    if (i == feature_input_) {
+      continue;
+    }
+    if (length_input_ == no_port && is_length_port(inputs[i])) {
+      length_input_ = i;
+    } else {
+      cache_inputs_.push_back(i);
+    }
+  }
+  std::vector<size_t> candidates;
+  for (size_t i = 1; i < outputs.size(); ++i) {
+    if (encoded_length_output_ == no_port && is_length_port(outputs[i])) {
+      encoded_length_output_ = i;
+    } else {
+      candidates.push_back(i);
+    }
+  }
+  if (!match_state_outputs(inputs, cache_inputs_, outputs, candidates, cache_outputs_)) {
+    return false;
+  }
+
+  for (auto& slot : slots_) {
+    slot.caches.resize(cache_inputs_.size());
+    for (size_t c = 0; c < cache_inputs_.size(); ++c) {
+      const size_t input = cache_inputs_[c];
+      if (!slot.caches[c].allocate(cache_arena_, inputs[input].type, encoder_.row_shapes[input])) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+bool onnx_batch_backend::prepare_predictor() {
+  const auto& inputs = predictor_.in_ports;
+  if (predictor_.out_ports.empty() || predictor_.out_ports[0].type != ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT) {
+    return false;
+  }
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    if (is_length_port(inputs[i])) {
+      pred_length_inputs_.push_back(i);
+    } else if (token_input_ == no_port && is_integer(inputs[i].type)) {
+      token_input_ = i;
+    } else {
+      pred_state_inputs_.push_back(i);
+    }
+  }
+  if (token_input_ == no_port) {
+    return false;
+  }
+  std::vector<size_t> candidates;
+  for (size_t i = 1; i < predictor_.out_ports.size(); ++i) {
+    if (!is_length_port(predictor_.out_ports[i])) {
+      candidates.push_back(i);
+    }
+  }
+  if (!match_state_outputs(inputs, pred_state_inputs_, predictor_.out_ports, candidates, pred_state_outputs_)) {
+    return false;
+  }
+
+  for (auto& slot : slots_) {
+    for (auto& side : slot.states) {
+      side.resize(pred_state_inputs_.size());
+      for (size_t s = 0; s < pred_state_inputs_.size(); ++s) {
+        const size_t input = pred_state_inputs_[s];
+        if (!side[s].allocate(slot_arena_, inputs[input].type, predictor_.row_shapes[input])) {
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+
+bool onnx_batch_backend::prepare_joint() {
+  if (joint_.in_ports.size() != 2 || joint_.out_ports.empty()) {
+    return false;
+  }
+  joint_encoder_side_ = joint_.in_ports[1].name.find("enc") != std::string::npos ? 1 : 0;
+  encoder_width_ = element_count(joint_.row_shapes[joint_encoder_side_]);
+  frame_.assign(encoder_width_, 0.0F);
+  return joint_.in_ports[joint_encoder_side_].type == ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT;
+}
+
+// A one-row predictor call on the start-of-sequence token fixes the prediction size and yields the state every
+// slot starts from; a one-row joint call fixes the vocabulary.
+bool onnx_batch_backend::prime() {
+  auto& predictor = plan_for(predictor_, predictor_plans_, 1);
+  for (const size_t input : pred_length_inputs_) {
+    predictor.inputs[input].set_scalar(1);
+  }
+  run_plan(predictor_, predictor);
+  const auto& prediction = predictor.outputs[0];
+  for (auto& slot : slots_) {
+    if (!slot.prediction.allocate(slot_arena_, prediction.type(), prediction.shape())) {
+      return false;
+    }
+  }
+
+  auto& joint = plan_for(joint_, joint_plans_, 1);
+  const size_t decoder_side = 1 - joint_encoder_side_;
+  if (joint.inputs[decoder_side].bytes().size() != prediction.bytes().size()
+      || joint.inputs[joint_encoder_side_].count() != encoder_width_) {
+    return false;
+  }
+  run_plan(joint_, joint);
+  const auto& logits = joint.outputs[0];
+  if (logits.type() != ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT) {
+    return false;
+  }
+  const auto vocabulary = static_cast<int64_t>(logits.count());
+  blank_id_ = blank_option_ < 0 ? vocabulary - 1 : blank_option_;
+  if (blank_id_ >= vocabulary) {
+    return false;
+  }
+  scores_.assign(logits.count(), 0.0F);
+
+  predictor.inputs[token_input_].set_scalar(blank_id_);
+  run_plan(predictor_, predictor);
+  primed_prediction_.assign(prediction.bytes().begin(), prediction.bytes().end());
+  for (size_t s = 0; s < pred_state_outputs_.size(); ++s) {
+    const auto& state = predictor.outputs[pred_state_outputs_[s]];
+    if (state.bytes().size() != slots_[0].states[0][s].bytes().size()) {
+      return false;
+    }
+    primed_states_.emplace_back(state.bytes().begin(), state.bytes().end());
+  }
+  return true;
+}
+
+onnx_batch_backend::batch_plan& onnx_batch_backend::plan_for(model& target, std::vector<batch_plan>& plans, size_t rows) {
+  auto& plan = plans[rows - 1];
+  if (plan.rows == rows) {
+    return plan;
+  }
+  plan = batch_plan{};
+  plan.inputs.resize(target.in_ports.size());
+  for (size_t i = 0; i < target.in_ports.size(); ++i) {
+    auto shape = target.row_shapes[i];
+    if (target.in_axes[i] != no_axis) {
+      shape[target.in_axes[i]] = static_cast<int64_t>(rows);
+    }
+    if (!plan.inputs[i].allocate(plan.arena, target.in_ports[i].type, shape)) {
+      throw Ort::Exception("batch plan: out of memory", ORT_FAIL);
+    }
+    plan.input_rows.push_back(describe_rows(plan.inputs[i], target.in_axes[i]));
+  }
+  plan.rows = rows;
+  return plan;
+}
+
+void onnx_batch_backend::run_plan(model& target, batch_plan& plan) {
+  if (plan.bound) {
+    target.session->Run(run_options_, plan.binding);
+    return;
+  }
+
+  std::vector<Ort::Value> values;
+  for (const auto& input : plan.inputs) {
+    values.push_back(input.make_value(memory_));
+  }
+  auto probe = target.session->Run(
+    run_options_,
+    target.in_names.data(),
+    values.data(),
+    values.size(),
+    target.out_names.data(),
+    target.out_names.size());
+  plan.outputs.resize(probe.size());
+  for (size_t o = 0; o < probe.size(); ++o) {
+    if (!adopt(probe[o], plan.arena, plan.outputs[o])) {
+      throw Ort::Exception("batch plan: cannot adopt output", ORT_FAIL);
+    }
+    plan.output_rows.push_back(describe_rows(plan.outputs[o], target.out_axes[o]));
+  }
+  plan.binding = Ort::IoBinding(*target.session);
+  for (size_t i = 0; i < plan.inputs.size(); ++i) {
+    plan.binding.BindInput(target.in_names[i], values[i]);
+  }
+  for (size_t o = 0; o < plan.outputs.size(); ++o) {
+    plan.binding.BindOutput(target.out_names[o], plan.outputs[o].make_value(memory_));
+  }
+  plan.bound = true;
+}
+
+bool onnx_batch_backend::run(
+  std::span<const uint32_t> slots,
+  std::span<const float> features,
+  std::vector<std::vector<int32_t>>& tokens) noexcept {
+  if (encoder_.session == nullptr || slots.empty() || slots.size() > batch_limit_ || tokens.size() < slots.size()
+      || features.size() != slots.size() * chunk_frames_ * mel_bins_) {
+    return false;
+  }
+  try {
+    encode(slots, features);
+    return decode(slots, tokens);
+  } catch (...) {
+    return false;
+  }
+}
+
+void onnx_batch_backend::encode(std::span<const uint32_t> slots, std::span<const float> features) {
+  if (encoder_plans_stale_) {
+    for (auto& plan : encoder_plans_) {
+      plan = batch_plan{};
+    }
+    encoder_plans_stale_ = false;
+  }
+  auto& plan = plan_for(encoder_, encoder_plans_, slots.size());
+
+  const auto staged = plan.inputs[feature_input_].as<float>();
+  const size_t row_floats = chunk_frames_ * mel_bins_;
+  for (size_t row = 0; row < slots.size(); ++row) {
+    const auto rows = features.subspan(row * row_floats, row_floats);
+    const auto dst = staged.subspan(row * row_floats, row_floats);
+    if (!channels_first_) {
+      std::copy(rows.begin(), rows.end(), dst.begin());
+    } else {
+      for (size_t t = 0; t < chunk_frames_; ++t) {
+        for (size_t m = 0; m < mel_bins_; ++m) {
+          dst[(m * chunk_frames_) + t] = rows[(t * mel_bins_) + m];
+        }
+      }
+    }
+    if (length_input_ != no_port) {
+      plan.inputs[length_input_].set_scalar(static_cast<int64_t>(chunk_frames_), row);
+    }
+    for (size_t c = 0; c < cache_inputs_.size(); ++c) {
+      const size_t input = cache_inputs_[c];
+      gather_row(plan.input_rows[input], row, slots_[slots[row]].caches[c].bytes(), plan.inputs[input]);
+    }
+  }
+
+  run_plan(encoder_, plan);
+  ++encoder_runs_;
+  store_caches(slots, plan);
+}
+
+void onnx_batch_backend::store_caches(std::span<const uint32_t> slots, const batch_plan& plan) {
+  // Caches with dynamic dims learn their real size from the first call: every slot is reallocated (none has
+  // state yet) and plans bound to the old size are rebuilt on the next call.
+  bool resized = false;
+  for (size_t c = 0; c < cache_outputs_.size(); ++c) {
+    const auto& rows = plan.output_rows[cache_outputs_[c]];
+    resized = resized || rows.outer * rows.row_bytes != slots_[0].caches[c].bytes().size();
+  }
+  if (resized) {
+    cache_arena_.release();
+    for (size_t c = 0; c < cache_outputs_.size(); ++c) {
+      const size_t output = cache_outputs_[c];
+      auto shape = plan.outputs[output].shape();
+      if (encoder_.out_axes[output] < shape.size()) {
+        shape[encoder_.out_axes[output]] = 1;
+      }
+      encoder_.row_shapes[cache_inputs_[c]] = shape;
+      for (auto& slot : slots_) {
+        if (!slot.caches[c].allocate(cache_arena_, plan.outputs[output].type(), shape)) {
+          throw Ort::Exception("batch plan: out of memory", ORT_FAIL);
+        }
+      }
+    }
+    encoder_plans_stale_ = true;
+  }
+
+  for (size_t row = 0; row < slots.size(); ++row) {
+    for (size_t c = 0; c < cache_outputs_.size(); ++c) {
+      const size_t output = cache_outputs_[c];
+      scatter_row(plan.output_rows[output], row, plan.outputs[output], slots_[slots[row]].caches[c].bytes());
+    }
+  }
+}
+
+bool onnx_batch_backend::decode(std::span<const uint32_t> slots, std::vector<std::vector<int32_t>>& tokens) {
+  const auto& plan = encoder_plans_[slots.size() - 1];
+  const auto& encoded = plan.outputs[0];
+  const size_t width = encoder_width_;
+  if (encoded.shape().size() != 3) {
+    return false;
+  }
+  const auto dim1 = static_cast<size_t>(encoded.shape()[1]);
+  const auto dim2 = static_cast<size_t>(encoded.shape()[2]);
+  bool frames_last = false; // [B, D, T']
+  size_t out_frames = 0;
+  if (dim1 == width && (dim2 != width || channels_first_)) {
+    frames_last = true;
+    out_frames = dim2;
+  } else if (dim2 == width) {
+    out_frames = dim1;
+  } else {
+    return false;
+  }
+
+  size_t longest = 0;
+  for (size_t row = 0; row < slots.size(); ++row) {
+    valid_frames_[row] = out_frames;
+    if (encoded_length_output_ != no_port) {
+      const int64_t length = plan.outputs[encoded_length_output_].scalar(row);
+      valid_frames_[row] = (std::min)(out_frames, static_cast<size_t>((std::max)(length, int64_t{ 0 })));
+    }
+    longest = (std::max)(longest, valid_frames_[row]);
+  }
+
+  const auto data = encoded.as<const float>();
+  const size_t decoder_side = 1 - joint_encoder_side_;
+  for (size_t t = 0; t < longest; ++t) {
+    active_.clear();
+    for (size_t row = 0; row < slots.size(); ++row) {
+      if (t < valid_frames_[row]) {
+        active_.push_back(static_cast<uint32_t>(row));
+      }
+    }
+    for (uint32_t symbol = 0; symbol < max_symbols_ && !active_.empty(); ++symbol) {
+      auto& joint = plan_for(joint_, joint_plans_, active_.size());
+      for (size_t i = 0; i < active_.size(); ++i) {
+        const size_t row = active_[i];
+        const size_t base = row * width * out_frames;
+        for (size_t d = 0; d < width; ++d) {
+          frame_[d] = frames_last ? data[base + (d * out_frames) + t] : data[base + (t * width) + d];
+        }
+        gather_row(joint.input_rows[joint_encoder_side_], i, std::as_bytes(std::span<const float>(frame_)), joint.inputs[joint_encoder_side_]);
+        gather_row(joint.input_rows[decoder_side], i, slots_[slots[row]].prediction.bytes(), joint.inputs[decoder_side]);
+      }
+      run_plan(joint_, joint);
+      ++joint_runs_;
+
+      emitters_.clear();
+      emitted_.clear();
+      row_slots_.clear();
+      for (size_t i = 0; i < active_.size(); ++i) {
+        scatter_row(joint.output_rows[0], i, joint.outputs[0], std::as_writable_bytes(std::span<float>(scores_)));
+        const int64_t token = std::max_element(scores_.begin(), scores_.end()) - scores_.begin();
+        if (token == blank_id_) {
+          continue;
+        }
+        tokens[active_[i]].push_back(static_cast<int32_t>(token));
+        emitters_.push_back(active_[i]);
+        emitted_.push_back(token);
+        row_slots_.push_back(slots[active_[i]]);
+      }
+      if (emitters_.empty()) {
+        break;
+      }
+      advance_predictor(row_slots_);
+      active_.swap(emitters_);
+    }
+  }
+  return true;
+}
+
+// Commits each slot's candidate state (a side flip) and runs the predictor on its emitted token.
+void onnx_batch_backend::advance_predictor(std::span<const uint32_t> slots) {
+  auto& plan = plan_for(predictor_, predictor_plans_, slots.size());
+  for (size_t row = 0; row < slots.size(); ++row) {
+    auto& slot = slots_[slots[row]];
+    slot.side = 1 - slot.side;
+    plan.inputs[token_input_].set_scalar(emitted_[row], row);
+    for (const size_t input : pred_length_inputs_) {
+      plan.inputs[input].set_scalar(1, row);
+    }
+    for (size_t s = 0; s < pred_state_inputs_.size(); ++s) {
+      const size_t input = pred_state_inputs_[s];
+      gather_row(plan.input_rows[input], row, slot.states[slot.side][s].bytes(), plan.inputs[input]);
+    }
+  }
+  run_plan(predictor_, plan);
+  ++predictor_runs_;
+  for (size_t row = 0; row < slots.size(); ++row) {
+    auto& slot = slots_[slots[row]];
+    scatter_row(plan.output_rows[0], row, plan.outputs[0], slot.prediction.bytes());
+    for (size_t s = 0; s < pred_state_outputs_.size(); ++s) {
+      const size_t output = pred_state_outputs_[s];
+      scatter_row(plan.output_rows[output], row, plan.outputs[output], slot.states[1 - slot.side][s].bytes());
+    }
+  }
+}
+
+void onnx_batch_backend::reset_slot(uint32_t slot) noexcept {
+  if (slot >= slots_.size()) {
+    return;
+  }
+  auto& state = slots_[slot];
+  for (auto& cache : state.caches) {
+    cache.zero();
+  }
+  state.side = 0;
+  for (auto& tensor : state.states[0]) {
+    tensor.zero();
+  }
+  for (size_t s = 0; s < primed_states_.size() && s < state.states[1].size(); ++s) {
+    std::copy(primed_states_[s].begin(), primed_states_[s].end(), state.states[1][s].bytes().begin());
+  }
+  if (primed_prediction_.size() == state.prediction.bytes().size()) {
+    std::copy(primed_prediction_.begin(), primed_prediction_.end(), state.prediction.bytes().begin());
+  }
+}
+
+void onnx_batch_backend::unload() noexcept {
+  // Plans first: their bindings refer to arena memory.
+  encoder_plans_.clear();
+  predictor_plans_.clear();
+  joint_plans_.clear();
+  slots_.clear();
+  slot_arena_.release();
+  cache_arena_.release();
+  primed_prediction_.clear();
+  primed_states_.clear();
+  for (model* target : { &encoder_, &predictor_, &joint_ }) {
+    *target = model{};
+  }
+  bundle_.reset(); // after the sessions, which may read initializers from its mapping
+  feature_input_ = no_port;
+  length_input_ = no_port;
+  encoded_length_output_ = no_port;
+  token_input_ = no_port;
+  channels_first_ = false;
+  encoder_plans_stale_ = false;
+  cache_inputs_.clear();
+  cache_outputs_.clear();
+  pred_length_inputs_.clear();
+  pred_state_inputs_.clear();
+  pred_state_outputs_.clear();
+  batch_limit_ = 1;
+  encoder_runs_ = 0;
+  predictor_runs_ = 0;
+  joint_runs_ = 0;
+}
+
+engine_stats onnx_batch_backend::counters() const noexcept {
+  engine_stats out{};
+  out.encoder_runs = encoder_runs_;
+  out.predictor_runs = predictor_runs_;
+  out.joint_runs = joint_runs_;
+  return out;
+}
+
+#endif // defined(JAXIE_USE_ONNXRUNTIME)
+
+#if defined(JAXIE_USE_ONNXRUNTIME)
+using selected_batch_backend = onnx_batch_backend;
+#else
+using selected_batch_backend = null_batch_backend;
+#endif
+
+} // namespace detail
+
+struct rnnt_engine::impl : detail::engine_impl<detail::selected_batch_backend> {
+  using base = detail::engine_impl<detail::selected_batch_backend>;
+  using base::base;
+};
+
+rnnt_engine::rnnt_engine() = default;
+rnnt_engine::~rnnt_engine() = default;
+
+rnnt_engine::rnnt_engine(rnnt_engine&& other) noexcept
+  : pimpl_(std::move(other.pimpl_)), loaded_(other.loaded_) {
+  other.loaded_ = false;
+}
+
+rnnt_engine& rnnt_engine::operator=(rnnt_engine&& other) noexcept {
+  if (this == &other) {
+    return *this;
+  }
+
+  pimpl_ = std::move(other.pimpl_);
+  loaded_ = other.loaded_;
+  other.loaded_ = false;
+  return *this;
+}
+
+bool rnnt_engine::load(
+  const rnnt_model_paths& paths,
+  const ep_prefs& prefs,
+  const engine_options& options,
+  stream_tokens_callback on_tokens) noexcept {
+  if (!pimpl_) {
+    try {
+      pimpl_ = std::make_unique<impl>();
+    } catch (...) {
+      loaded_ = false;
+      return false;
+    }
+  }
+
+  loaded_ = pimpl_->load(paths, prefs, options, std::move(on_tokens));
+  return loaded_;
+}
+
+void rnnt_engine::shutdown() noexcept {
+  if (!pimpl_) {
+    return;
+  }
+
+  pimpl_->shutdown();
+  loaded_ = false;
+}
+
+bool rnnt_engine::open_stream(uint32_t& id) noexcept {
+  if (!loaded_ || !pimpl_) {
+    return false;
+  }
+
+  return pimpl_->open_stream(id);
+}
+
+void rnnt_engine::close_stream(uint32_t id) noexcept {
+  if (!pimpl_) {
+    return;
+  }
+
+  pimpl_->close_stream(id);
+}
+
+void rnnt_engine::reset_stream(uint32_t id) noexcept {
+  if (!pimpl_) {
+    return;
+  }
+
+  pimpl_->reset_stream(id);
+}
+
+bool rnnt_engine::push(uint32_t id, std::span<const float> audio) noexcept {
+  if (!loaded_ || !pimpl_) {
+    return false;
+  }
+
+  return pimpl_->push(id, audio);
+}
+
+engine_stats rnnt_engine::stats() const noexcept {
+  if (!pimpl_) {
+    return {};
+  }
+
+  return pimpl_->stats();
+}
+
+} // namespace jaxie::onnx
@@ -0,0 +1,68 @@
+#pragma once
+
+// Internal single-producer / single-consumer queue of reusable slots, linking the pipeline stages.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace jaxie::onnx::detail {
+
+// A ring of `capacity` slots that are filled in place and handed over by index: the producer writes the slot at
+// its tail and publishes it, the consumer reads the slot at its head and releases it. Slots keep their buffers
+// across laps, so nothing is allocated once they have grown to their working size. Positions only increase;
+// only the producer stores tail_ and only the consumer stores head_. The blocking waits park on the other
+// side's position (std::atomic::wait), so stopping a stage is a slot sent through the queue.
+template <typename T>
+class spsc_slots {
+public:
+  void init(size_t capacity) {
+    slots_ = std::vector<T>(capacity);
+    head_.store(0, std::memory_order_relaxed);
+    tail_.store(0, std::memory_order_relaxed);
+  }
+
+  std::vector<T>& slots() noexcept { return slots_; } // for sizing buffers before the stages start
+  size_t capacity() const noexcept { return slots_.size(); }
+
+  // Producer side.
+  size_t free_slots() const noexcept {
+    const uint64_t used = tail_.load(std::memory_order_relaxed) - head_.load(std::memory_order_acquire);
+    return slots_.size() - used;
+  }
+  T& producer_slot() noexcept { return slots_[tail_.load(std::memory_order_relaxed) % slots_.size()]; }
+  // Blocks until producer_slot() is free.
+  void wait_for_space() const noexcept {
+    const uint64_t tail = tail_.load(std::memory_order_relaxed);
+    for (uint64_t head = head_.load(std::memory_order_acquire); tail - head == slots_.size();
+         head = head_.load(std::memory_order_acquire)) {
+      head_.wait(head, std::memory_order_acquire);
+    }
+  }
+  void publish() noexcept {
+    tail_.fetch_add(1, std::memory_order_release);
+    tail_.notify_one();
+  }
+
+  // Consumer side.
+  // Blocks until consumer_slot() holds a published slot.
+  T& wait_for_slot() noexcept {
+    const uint64_t head = head_.load(std::memory_order_relaxed);
+    for (uint64_t tail = tail_.load(std::memory_order_acquire); tail == head; tail = tail_.load(std::memory_order_acquire)) {
+      tail_.wait(tail, std::memory_order_acquire);
+    }
+    return slots_[head % slots_.size()];
+  }
+  void release() noexcept {
+    head_.fetch_add(1, std::memory_order_release);
+    head_.notify_one();
+  }
+
+private:
+  std::vector<T> slots_;
+  alignas(64) std::atomic<uint64_t> head_{0};
+  alignas(64) std::atomic<uint64_t> tail_{0};
+};
+
+} // namespace jaxie::onnx::detail
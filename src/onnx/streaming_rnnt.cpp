@@ -1,168 +1,2085 @@
 #include <Jaxie/onnx/streaming_rnnt.hpp>
+#include <Jaxie/realtime/latency_trace.hpp>
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstddef>
 #include <cstdint>
 #include <memory>
+#include <mutex>
 #include <span>
+#include <string>
+#include <thread>
+#include <tuple>
 #include <utility>
 #include <vector>
 
+#include "spsc_slots.hpp"
+
 #if defined(JAXIE_USE_ONNXRUNTIME)
+#include "ort_tensors.hpp"
+
 #include <onnxruntime_cxx_api.h>
 #endif
 
 namespace jaxie::onnx {
 namespace detail {
 
+// Context frames at either end of a step_window() input, in feature frames.
+struct window_context {
+  size_t left_frames{0};
+  size_t right_frames{0};
+};
+
 template <typename Backend>
 class rnnt_impl {
 public:
   rnnt_impl() = default;
-  ~rnnt_impl() { backend_.unload(); }
+  ~rnnt_impl() {
+    stop_pipeline();
+    backend_.unload();
+  }
 
   rnnt_impl(const rnnt_impl&) = delete;
   rnnt_impl& operator=(const rnnt_impl&) = delete;
   rnnt_impl(rnnt_impl&&) = delete;
   rnnt_impl& operator=(rnnt_impl&&) = delete;
 
-  bool load(const rnnt_model_paths& paths, const ep_prefs& prefs) noexcept {
-    backend_.unload();
-    loaded_ = backend_.load(paths, prefs);
-    return loaded_;
+  bool load(const rnnt_model_paths& paths, const ep_prefs& prefs, const rnnt_options& options) noexcept {
+    stop_pipeline();
+    backend_.unload();
+    loaded_ = prepare(options) && backend_.load(paths, prefs, options);
+    return loaded_;
+  }
+
+  // Another stream over source's sessions; see streaming_rnnt::load_shared().
+  bool share(const rnnt_impl& source, const rnnt_options& options) noexcept {
+    stop_pipeline();
+    backend_.unload();
+    loaded_ = source.loaded_ && prepare(options) && backend_.share(source.backend_, options);
+    return loaded_;
+  }
+
+  bool step(std::span<const float> audio_chunk, std::vector<int32_t>& emitted_tokens) const noexcept {
+    if (!loaded_ || pipelined_) {
+      return false;
+    }
+    const step_scope scope(*this);
+    emitted_tokens.clear();
+    token_frames_.clear();
+    const uint64_t origin = realtime::tracing() ? realtime::trace_origin() : realtime::no_trace_sample;
+    const uint64_t stream_start = stream_samples_;
+    const size_t samples = audio_chunk.size();
+    stream_samples_ += samples;
+    while (!audio_chunk.empty()) {
+      const auto slice = audio_chunk.first((std::min)(audio_chunk.size(), size_t{ max_step_frames_ }));
+      audio_chunk = audio_chunk.subspan(slice.size());
+      const size_t frames = frontend_.push(slice, features_);
+      if (frames == 0) {
+        continue;
+      }
+      const size_t mel_bins = frontend_.config().mel_bins;
+      const auto features = std::span<const float>(features_).first(frames * mel_bins);
+      if (!backend_.step(features, {}, emitted_tokens, token_frames_)) {
+        return false;
+      }
+    }
+    if (origin != realtime::no_trace_sample && samples != 0) {
+      trace_tokens(emitted_tokens, origin - stream_start, origin + samples - 1);
+    }
+    return true;
+  }
+
+  bool step_window(
+    std::span<const float> window,
+    uint32_t left_frames,
+    uint32_t right_frames,
+    std::vector<int32_t>& emitted_tokens) const noexcept {
+    emitted_tokens.clear();
+    token_frames_.clear();
+    if (!loaded_ || pipelined_ || window.size() > max_window_frames_
+        || size_t{ left_frames } + right_frames >= window.size()) {
+      return false;
+    }
+    const step_scope scope(*this);
+
+    window_frontend_.reset();
+    const size_t frames = window_frontend_.push(window, window_features_);
+    const uint32_t hop = window_frontend_.config().hop_frames;
+    // Frames that straddle a boundary are counted as chunk frames.
+    const window_context context{ left_frames / hop, right_frames / hop };
+    if (context.left_frames + context.right_frames >= frames) {
+      return false;
+    }
+    const size_t mel_bins = window_frontend_.config().mel_bins;
+    const auto features = std::span<const float>(window_features_).first(frames * mel_bins);
+    const uint64_t chunk_start = window_stream_frames_;
+    if (!backend_.step(features, context, emitted_tokens, token_frames_)) {
+      return false;
+    }
+    window_stream_frames_ += frames - context.left_frames - context.right_frames;
+    const uint64_t origin = realtime::tracing() ? realtime::trace_origin() : realtime::no_trace_sample;
+    if (origin != realtime::no_trace_sample) {
+      // Token frames count chunk frames since the reset; this window's first chunk frame is chunk_start.
+      trace_tokens(emitted_tokens, origin + ((context.left_frames - chunk_start) * hop), origin + window.size() - 1);
+    }
+    return true;
+  }
+
+  bool finish(std::vector<int32_t>& emitted_tokens) const noexcept {
+    emitted_tokens.clear();
+    token_frames_.clear();
+    return loaded_ && !pipelined_ && backend_.finish(emitted_tokens, token_frames_);
+  }
+
+  std::span<const uint32_t> token_frames() const noexcept { return token_frames_; }
+
+  rnnt_partial partial() const noexcept {
+    partial_tokens_.clear();
+    partial_frames_.clear();
+    if (loaded_ && !pipelined_) {
+      backend_.partial(partial_tokens_, partial_frames_);
+    }
+    return { partial_tokens_, partial_frames_ };
+  }
+
+  void reset() noexcept {
+    if (pipelined_) {
+      return;
+    }
+    frontend_.reset();
+    backend_.reset();
+    token_frames_.clear();
+    stream_samples_ = 0;
+    window_stream_frames_ = 0;
+  }
+
+  void unload() noexcept {
+    stop_pipeline();
+    backend_.unload();
+    loaded_ = false;
+  }
+
+  bool start_pipeline(rnnt_tokens_callback on_tokens, const rnnt_pipeline_options& options) noexcept {
+    if (!loaded_ || pipelined_ || options.audio_slots == 0 || options.frame_slots == 0) {
+      return false;
+    }
+    try {
+      audio_queue_.init(options.audio_slots);
+      for (auto& block : audio_queue_.slots()) {
+        block.audio.reserve(max_step_frames_);
+      }
+      // Encoder frames are subsampled feature frames; a block's chunks can also finish frames queued by the
+      // blocks before it, hence the slack. Larger outputs grow the buffer once.
+      const size_t block_frames = 2 * (features_.size() / frontend_.config().mel_bins);
+      frame_queue_.init(options.frame_slots);
+      for (auto& block : frame_queue_.slots()) {
+        block.frames.reserve(block_frames * backend_.frame_width());
+      }
+      pipeline_tokens_.reserve(block_frames);
+      pipeline_frames_.reserve(block_frames);
+      on_pipeline_tokens_ = std::move(on_tokens);
+    } catch (...) {
+      return false;
+    }
+    frontend_.reset();
+    backend_.reset();
+    pipeline_failed_.store(false, std::memory_order_relaxed);
+    rejected_submits_ = 0;
+    for (auto* counter : { &blocks_, &latency_last_ns_, &latency_max_ns_, &latency_total_ns_, &latency_blocks_,
+                           &encoder_busy_ns_, &decoder_busy_ns_ }) {
+      counter->store(0, std::memory_order_relaxed);
+    }
+    try {
+      decoder_ = std::thread([this] { decoder_loop(); });
+    } catch (...) {
+      on_pipeline_tokens_ = {};
+      return false;
+    }
+    try {
+      encoder_ = std::thread([this] { encoder_loop(); });
+    } catch (...) {
+      // Only this thread feeds the frame queue until the encoder stage exists.
+      frame_queue_.producer_slot().kind = block_kind::stop;
+      frame_queue_.publish();
+      decoder_.join();
+      on_pipeline_tokens_ = {};
+      return false;
+    }
+    pipelined_ = true;
+    return true;
+  }
+
+  bool submit(std::span<const float> audio) noexcept {
+    if (!pipelined_ || pipeline_failed_.load(std::memory_order_relaxed)) {
+      return false;
+    }
+    const size_t blocks = (audio.size() + max_step_frames_ - 1) / max_step_frames_;
+    if (audio_queue_.free_slots() < blocks) {
+      ++rejected_submits_;
+      return false;
+    }
+    const auto now = clock::now();
+    uint64_t origin = realtime::tracing() ? realtime::trace_origin() : realtime::no_trace_sample;
+    while (!audio.empty()) {
+      auto& block = audio_queue_.producer_slot();
+      const auto slice = audio.first((std::min)(audio.size(), size_t{ max_step_frames_ }));
+      block.kind = block_kind::audio;
+      block.audio.assign(slice.begin(), slice.end()); // within the reserved capacity
+      block.submitted = now;
+      block.origin = origin;
+      audio_queue_.publish();
+      audio = audio.subspan(slice.size());
+      if (origin != realtime::no_trace_sample) {
+        origin += slice.size();
+      }
+    }
+    return true;
+  }
+
+  bool submit_boundary() noexcept {
+    if (!pipelined_) {
+      return false;
+    }
+    if (audio_queue_.free_slots() == 0) {
+      ++rejected_submits_;
+      return false;
+    }
+    send(block_kind::boundary);
+    return true;
+  }
+
+  void stop_pipeline() noexcept {
+    if (!pipelined_) {
+      return;
+    }
+    audio_queue_.wait_for_space();
+    send(block_kind::stop);
+    encoder_.join();
+    decoder_.join();
+    on_pipeline_tokens_ = {};
+    pipelined_ = false;
+  }
+
+  rnnt_pipeline_stats pipeline_stats() const noexcept {
+    rnnt_pipeline_stats out{};
+    out.blocks = blocks_.load(std::memory_order_relaxed);
+    out.rejected_submits = rejected_submits_;
+    out.latency_last_ns = latency_last_ns_.load(std::memory_order_relaxed);
+    out.latency_max_ns = latency_max_ns_.load(std::memory_order_relaxed);
+    out.latency_total_ns = latency_total_ns_.load(std::memory_order_relaxed);
+    out.latency_blocks = latency_blocks_.load(std::memory_order_relaxed);
+    out.encoder_busy_ns = encoder_busy_ns_.load(std::memory_order_relaxed);
+    out.decoder_busy_ns = decoder_busy_ns_.load(std::memory_order_relaxed);
+    out.failed = pipeline_failed_.load(std::memory_order_relaxed);
+    return out;
+  }
+
+  bool is_loaded() const noexcept { return loaded_; }
+  bool is_pipelined() const noexcept { return pipelined_; }
+
+  const rnnt_placement& placement() const noexcept { return backend_.placement(); }
+
+  bool collect_profile(rnnt_profile& out) noexcept {
+    out = {};
+    if (!loaded_ || pipelined_) {
+      return false;
+    }
+    out.steps = steps_ - load_steps_;
+    return backend_.collect_profile(out);
+  }
+
+  rnnt_stats stats() const noexcept {
+    rnnt_stats out = backend_.stats();
+    out.steps = steps_;
+    out.last_step_bytes_allocated = last_allocated_;
+    out.last_step_bytes_copied = last_copied_;
+    return out;
+  }
+
+private:
+  using clock = std::chrono::steady_clock;
+
+  static constexpr size_t token_reserve = 256;
+
+  enum class block_kind : uint8_t { audio, boundary, stop };
+
+  struct audio_block {
+    block_kind kind{block_kind::audio};
+    std::vector<float> audio; // at most max_step_frames_ samples
+    clock::time_point submitted{};
+    uint64_t origin{realtime::no_trace_sample}; // capture frame of audio[0] (see realtime::trace_origin())
+  };
+
+  struct frame_block {
+    block_kind kind{block_kind::audio};
+    std::vector<float> frames; // encoder frames, frame_width() floats each
+    clock::time_point submitted{};
+    uint64_t origin{realtime::no_trace_sample};
+    size_t samples{0}; // audio the frames were encoded from
+  };
+
+  static uint64_t elapsed_ns(clock::time_point since) noexcept {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - since).count());
+  }
+
+  // Submitting thread, with a free slot.
+  void send(block_kind kind) noexcept {
+    auto& block = audio_queue_.producer_slot();
+    block.kind = kind;
+    block.audio.clear();
+    block.submitted = clock::now();
+    block.origin = realtime::no_trace_sample;
+    audio_queue_.publish();
+  }
+
+  void encoder_loop() noexcept {
+    for (;;) {
+      auto& in = audio_queue_.wait_for_slot();
+      const block_kind kind = in.kind;
+      frame_queue_.wait_for_space(); // backpressure: a slow decoder stalls the encoder, then submit()
+      auto& out = frame_queue_.producer_slot();
+      out.kind = kind;
+      out.submitted = in.submitted;
+      out.origin = in.origin;
+      out.samples = in.audio.size();
+      out.frames.clear();
+      if (kind == block_kind::audio && !pipeline_failed_.load(std::memory_order_relaxed)) {
+        realtime::set_trace_origin(in.origin);
+        const auto started = clock::now();
+        const size_t frames = frontend_.push(in.audio, features_);
+        const size_t mel_bins = frontend_.config().mel_bins;
+        if (frames != 0 && !backend_.encode_frames(std::span<const float>(features_).first(frames * mel_bins), out.frames)) {
+          pipeline_failed_.store(true, std::memory_order_relaxed);
+        }
+        encoder_busy_ns_.fetch_add(elapsed_ns(started), std::memory_order_relaxed);
+      } else if (kind == block_kind::boundary) {
+        frontend_.reset();
+        backend_.reset_encoder();
+      }
+      audio_queue_.release();
+      frame_queue_.publish();
+      if (kind == block_kind::stop) {
+        return;
+      }
+    }
+  }
+
+  void decoder_loop() noexcept {
+    for (;;) {
+      auto& in = frame_queue_.wait_for_slot();
+      const block_kind kind = in.kind;
+      const auto submitted = in.submitted;
+      const bool encoded = kind == block_kind::audio && !in.frames.empty();
+      // The pipeline keeps no per-token frames: its tokens are attributed to the block's last sample.
+      const uint64_t last_sample = in.origin != realtime::no_trace_sample && in.samples != 0
+                                     ? in.origin + in.samples - 1
+                                     : realtime::no_trace_sample;
+      pipeline_tokens_.clear();
+      if (encoded && !pipeline_failed_.load(std::memory_order_relaxed)) {
+        const auto started = clock::now();
+        const realtime::trace_span span(realtime::trace_point::decode, in.origin);
+        if (!backend_.decode_frames(in.frames, pipeline_tokens_)) {
+          pipeline_failed_.store(true, std::memory_order_relaxed);
+        }
+        decoder_busy_ns_.fetch_add(elapsed_ns(started), std::memory_order_relaxed);
+      } else if (kind == block_kind::boundary) {
+        pipeline_frames_.clear();
+        static_cast<void>(backend_.finish(pipeline_tokens_, pipeline_frames_));
+        backend_.reset_decoder();
+      }
+      frame_queue_.release();
+
+      if (last_sample != realtime::no_trace_sample) {
+        for (const int32_t token : pipeline_tokens_) {
+          realtime::trace(realtime::trace_point::token_emit,
+            realtime::trace_phase::instant,
+            last_sample,
+            static_cast<uint32_t>(token));
+        }
+      }
+      if (!pipeline_tokens_.empty() && on_pipeline_tokens_) {
+        try {
+          on_pipeline_tokens_(pipeline_tokens_);
+        } catch (...) {
+          // A throwing consumer must not take the decoder stage down.
+        }
+      }
+      if (kind == block_kind::audio) {
+        blocks_.fetch_add(1, std::memory_order_relaxed);
+      }
+      if (encoded) {
+        const uint64_t latency = elapsed_ns(submitted);
+        latency_last_ns_.store(latency, std::memory_order_relaxed);
+        latency_max_ns_.store((std::max)(latency_max_ns_.load(std::memory_order_relaxed), latency), std::memory_order_relaxed);
+        latency_total_ns_.fetch_add(latency, std::memory_order_relaxed);
+        latency_blocks_.fetch_add(1, std::memory_order_relaxed);
+      }
+      if (kind == block_kind::stop) {
+        return;
+      }
+    }
+  }
+
+  // Frontends and per-stream buffers for a load() or share().
+  bool prepare(const rnnt_options& options) noexcept {
+    if (options.max_step_frames == 0 || (options.decoding == decode_mode::modified_beam && options.beam_size == 0)
+        || !frontend_.init(options.features) || !window_frontend_.init(options.features)) {
+      return false;
+    }
+    max_step_frames_ = options.max_step_frames;
+    max_window_frames_ = options.max_window_frames;
+    try {
+      // At most window - 1 samples are carried over, so a slice never yields more than max / hop + 1 frames.
+      const size_t max_frames = (max_step_frames_ / options.features.hop_frames) + 1;
+      features_.assign(max_frames * options.features.mel_bins, 0.0F);
+      window_features_.assign(window_frontend_.frames_for(max_window_frames_) * options.features.mel_bins, 0.0F);
+      token_frames_.reserve(token_reserve);
+      partial_tokens_.reserve(token_reserve);
+      partial_frames_.reserve(token_reserve);
+    } catch (...) {
+      return false;
+    }
+    load_steps_ = steps_;
+    stream_samples_ = 0;
+    window_stream_frames_ = 0;
+    return true;
+  }
+
+  // Records a token_emit per token of the last call: frame f of token_frames_ started at capture frame
+  // frame_zero + f * hop, and the token is stamped with that frame's last sample, at most `last`. Unsigned
+  // wrap-around keeps this right when frame_zero itself would be negative.
+  void trace_tokens(std::span<const int32_t> tokens, uint64_t frame_zero, uint64_t last) const noexcept {
+    const uint32_t hop = frontend_.config().hop_frames;
+    const uint32_t window = frontend_.config().window_frames;
+    const size_t count = (std::min)(tokens.size(), token_frames_.size());
+    for (size_t i = 0; i < count; ++i) {
+      const uint64_t sample = frame_zero + (uint64_t{ token_frames_[i] } * hop) + window - 1;
+      realtime::trace(realtime::trace_point::token_emit,
+        realtime::trace_phase::instant,
+        (std::min)(sample, last),
+        static_cast<uint32_t>(tokens[i]));
+    }
+  }
+
+  // Attributes the backend's allocation/copy counters to one public step call.
+  class step_scope {
+  public:
+    explicit step_scope(const rnnt_impl& owner) noexcept
+      : owner_(owner), before_(owner.backend_.stats()) {}
+    ~step_scope() {
+      const rnnt_stats after = owner_.backend_.stats();
+      ++owner_.steps_;
+      owner_.last_allocated_ = after.bytes_allocated - before_.bytes_allocated;
+      owner_.last_copied_ = after.bytes_copied - before_.bytes_copied;
+    }
+
+    step_scope(const step_scope&) = delete;
+    step_scope& operator=(const step_scope&) = delete;
+    step_scope(step_scope&&) = delete;
+    step_scope& operator=(step_scope&&) = delete;
+
+  private:
+    const rnnt_impl& owner_;
+    rnnt_stats before_;
+  };
+
+  mutable Backend backend_{};
+  mutable dsp::log_mel_frontend frontend_{};
+  mutable std::vector<float> features_; // frames x mel_bins, sized in load()
+  mutable dsp::log_mel_frontend window_frontend_{};
+  mutable std::vector<float> window_features_;
+  mutable std::vector<uint32_t> token_frames_; // parallel to the last call's emitted tokens
+  mutable std::vector<int32_t> partial_tokens_;
+  mutable std::vector<uint32_t> partial_frames_;
+  uint32_t max_step_frames_{0};
+  uint32_t max_window_frames_{0};
+  mutable uint64_t steps_{0};
+  uint64_t load_steps_{0};
+  mutable uint64_t last_allocated_{0};
+  mutable uint64_t last_copied_{0};
+  mutable uint64_t stream_samples_{0};       // audio step() was given since the reset, for tracing
+  mutable uint64_t window_stream_frames_{0}; // chunk frames step_window() was given since the reset
+  bool loaded_{false};
+
+  // Pipeline. The encoder stage owns frontend_, features_ and the backend's encoder half, the decoder stage
+  // the decoder half, pipeline_tokens_ and pipeline_frames_.
+  bool pipelined_{false};
+  spsc_slots<audio_block> audio_queue_;
+  spsc_slots<frame_block> frame_queue_;
+  std::thread encoder_;
+  std::thread decoder_;
+  rnnt_tokens_callback on_pipeline_tokens_{};
+  std::vector<int32_t> pipeline_tokens_;
+  std::vector<uint32_t> pipeline_frames_; // finish() fills it; the callback only takes tokens
+  std::atomic<bool> pipeline_failed_{false};
+  uint64_t rejected_submits_{0};
+  std::atomic<uint64_t> blocks_{0};
+  std::atomic<uint64_t> latency_last_ns_{0};
+  std::atomic<uint64_t> latency_max_ns_{0};
+  std::atomic<uint64_t> latency_total_ns_{0};
+  std::atomic<uint64_t> latency_blocks_{0};
+  std::atomic<uint64_t> encoder_busy_ns_{0};
+  std::atomic<uint64_t> decoder_busy_ns_{0};
+};
+
+struct null_rnnt_backend {
+  bool load(const rnnt_model_paths& paths, const ep_prefs& prefs, const rnnt_options& options) noexcept {
+    static_cast<void>(paths);
+    static_cast<void>(prefs);
+    static_cast<void>(options);
+    load_attempted_ = true;
+    return false;
+  }
+
+  bool share(const null_rnnt_backend& source, const rnnt_options& options) noexcept {
+    static_cast<void>(source);
+    static_cast<void>(options);
+    load_attempted_ = true;
+    return false;
+  }
+
+  bool step(
+    std::span<const float> features,
+    const window_context& context,
+    std::vector<int32_t>& emitted_tokens,
+    std::vector<uint32_t>& token_frames) const noexcept {
+    static_cast<void>(features);
+    static_cast<void>(context);
+    static_cast<void>(emitted_tokens);
+    static_cast<void>(token_frames);
+    if (load_attempted_) {
+      return false;
+    }
+    return false;
+  }
+
+  bool finish(std::vector<int32_t>& emitted_tokens, std::vector<uint32_t>& token_frames) const noexcept {
+    static_cast<void>(emitted_tokens);
+    static_cast<void>(token_frames);
+    return false;
+  }
+
+  void partial(std::vector<int32_t>& tokens, std::vector<uint32_t>& frames) const noexcept {
+    static_cast<void>(tokens);
+    static_cast<void>(frames);
+  }
+
+  void reset() noexcept { load_attempted_ = false; }
+
+  void unload() noexcept { load_attempted_ = false; }
+
+  rnnt_stats stats() const noexcept { return {}; }
+
+  const rnnt_placement& placement() const noexcept { return placement_; }
+
+  bool collect_profile(rnnt_profile& out) noexcept {
+    static_cast<void>(out);
+    return false;
+  }
+
+  bool encode_frames(std::span<const float> features, std::vector<float>& frames) const noexcept {
+    static_cast<void>(features);
+    static_cast<void>(frames);
+    return false;
+  }
+
+  bool decode_frames(std::span<const float> frames, std::vector<int32_t>& emitted_tokens) const noexcept {
+    static_cast<void>(frames);
+    static_cast<void>(emitted_tokens);
+    return false;
+  }
+
+  size_t frame_width() const noexcept { return 0; }
+  void reset_encoder() noexcept {}
+  void reset_decoder() noexcept {}
+
+private:
+  mutable bool load_attempted_{false};
+  rnnt_placement placement_{};
+};
+
+#if defined(JAXIE_USE_ONNXRUNTIME)
+
+constexpr uint64_t root_prefix_hash = 0x6A09E667F3BCC909ULL;
+
+// Hash of a token prefix extended by one token (splitmix64 finalizer over the combined value).
+constexpr uint64_t extend_prefix_hash(uint64_t prefix, int64_t token) noexcept {
+  uint64_t x = prefix ^ (static_cast<uint64_t>(token) + 0x9E3779B97F4A7C15ULL + (prefix << 6U) + (prefix >> 2U));
+  x = (x ^ (x >> 30U)) * 0xBF58476D1CE4E5B9ULL;
+  x = (x ^ (x >> 27U)) * 0x94D049BB133111EBULL;
+  return x ^ (x >> 31U);
+}
+
+float log_add(float lhs, float rhs) noexcept {
+  const float high = (std::max)(lhs, rhs);
+  return high + std::log1p(std::exp((std::min)(lhs, rhs) - high));
+}
+
+void log_softmax(std::span<float> scores) noexcept {
+  const float peak = *std::max_element(scores.begin(), scores.end());
+  float sum = 0.0F;
+  for (const float score : scores) {
+    sum += std::exp(score - peak);
+  }
+  const float shift = peak + std::log(sum);
+  for (float& score : scores) {
+    score -= shift;
+  }
+}
+
+// Model IO conventions (a NeMo-style three-part RNNT export; names only tell ports apart):
+//   encoder    in:  features [B, mel, T] or [B, T, mel] (first float rank-3 input), optional length [B];
+//                   every other input is a cache, fed back from its matching output after each call
+//              out: encoded [B, D, T'] or [B, T', D] (output 0), optional encoded length, cache updates
+//   predictor  in:  previous token [B, 1] (first integer input), optional target length [B], states
+//              out: prediction (output 0), optional length, state updates
+//   joint      in:  one encoder frame and one prediction (an input named "enc..." is the encoder side)
+//              out: scores over the vocabulary plus blank (output 0)
+// Batch is 1. Every tensor lives in an arena and is pre-bound through Ort::IoBinding, so a steady-state call
+// is Run() plus the feature copy. Encoder caches and predictor states are double-buffered: a call reads side
+// s and writes side 1 - s, and handing its outputs to the next call is a flip of the side index. Only the
+// first encoder call of a new frame count builds a plan (a probe run that fixes the output shapes).
+class onnx_rnnt_backend {
+public:
+  onnx_rnnt_backend();
+  ~onnx_rnnt_backend();
+
+  onnx_rnnt_backend(const onnx_rnnt_backend&) = delete;
+  onnx_rnnt_backend& operator=(const onnx_rnnt_backend&) = delete;
+  onnx_rnnt_backend(onnx_rnnt_backend&&) = delete;
+  onnx_rnnt_backend& operator=(onnx_rnnt_backend&&) = delete;
+
+  bool load(const rnnt_model_paths& paths, const ep_prefs& prefs, const rnnt_options& options) noexcept;
+  // Takes source's sessions (ORT sessions may Run concurrently) and builds only this stream's tensors, bindings
+  // and decoder state. The sessions live until every backend holding them unloads. No profiling.
+  bool share(const onnx_rnnt_backend& source, const rnnt_options& options) noexcept;
+  // features holds whole log-mel frames of mel_bins_ floats, the first and last context.*_frames of which are
+  // encoder context only; tokens are appended to emitted_tokens and the log-mel frame each was emitted at, counted
+  // from reset_encoder(), to token_frames.
+  bool step(
+    std::span<const float> features,
+    const window_context& context,
+    std::vector<int32_t>& emitted_tokens,
+    std::vector<uint32_t>& token_frames) const noexcept;
+  bool finish(std::vector<int32_t>& emitted_tokens, std::vector<uint32_t>& token_frames) const noexcept;
+  // Tokens that may still change: beam search's best hypothesis past the agreed prefix, or greedy decoding's
+  // lookahead over the last window's right context.
+  void partial(std::vector<int32_t>& tokens, std::vector<uint32_t>& frames) const noexcept;
+  void reset() noexcept;
+  void unload() noexcept;
+  rnnt_stats stats() const noexcept;
+  const rnnt_placement& placement() const noexcept { return placement_; }
+  bool collect_profile(rnnt_profile& out) noexcept;
+
+  // Pipeline stages. encode_frames() runs step()'s encoder half and appends the encoder frames (frame_width()
+  // floats each) instead of decoding them; decode_frames() decodes such frames. Each stage only touches its own
+  // state, so the two may run on different threads, as may reset_encoder() and reset_decoder().
+  bool encode_frames(std::span<const float> features, std::vector<float>& frames) const noexcept;
+  bool decode_frames(std::span<const float> frames, std::vector<int32_t>& emitted_tokens) const noexcept;
+  size_t frame_width() const noexcept { return joint_frame_.count(); }
+  void reset_encoder() noexcept;
+  void reset_decoder() noexcept;
+
+private:
+  static constexpr size_t no_port = static_cast<size_t>(-1);
+  static constexpr size_t max_encoder_plans = 4; // streaming uses one; a windowed stream a few while left fills
+  static constexpr uint32_t no_entry = static_cast<uint32_t>(-1);
+  static constexpr size_t entries_per_beam = 16; // predictor cache capacity, in beams
+
+  // Tensors and bindings for one encoder call of a given frame count. Cache outputs are not stored here: they
+  // are bound straight to the other side's cache buffers.
+  struct encoder_plan {
+    tensor_arena arena; // released with the plan
+    size_t frames{0};
+    uint64_t last_used{0};
+    tensor_storage features;
+    tensor_storage length;
+    std::vector<tensor_storage> outputs; // one per encoder output
+    std::vector<Ort::IoBinding> bindings; // [cache side]
+  };
+
+  bool prepare_encoder();
+  bool prepare_predictor();
+  bool prepare_joint();
+  void bind_predictor();
+
+  // Where encoder frames go: decoded into tokens, or copied out for a separate decode stage.
+  struct frame_output {
+    std::vector<int32_t>* tokens{nullptr};
+    std::vector<float>* frames{nullptr};
+    std::vector<uint32_t>* token_frames{nullptr};
+  };
+
+  bool prepare(const rnnt_options& options, std::chrono::steady_clock::time_point started) noexcept;
+  bool push_frames(std::span<const float> rows, const frame_output& out) const;
+  bool encode(std::span<const float> rows, const window_context& context, const frame_output& out) const;
+  encoder_plan* find_plan(size_t frames) const noexcept;
+  encoder_plan* build_plan(size_t frames, std::span<const float> rows) const;
+  void resize_caches(const std::vector<Ort::Value>& probe) const;
+  Ort::Value encoder_input(const encoder_plan& plan, size_t input, size_t side) const;
+  void bind_encoder(encoder_plan& plan) const;
+  void fill_features(encoder_plan& plan, std::span<const float> rows) const noexcept;
+  bool decode(const encoder_plan& plan, const window_context& context, const frame_output& out) const;
+  // The frame in joint_frame_, at log-mel frame `at`; token_frames may be null.
+  void decode_frame(std::vector<int32_t>& emitted_tokens, std::vector<uint32_t>* token_frames, uint32_t at) const;
+  void save_decoder() const noexcept;
+  void restore_decoder() const noexcept;
+  void advance_predictor(int64_t token) const;
+  void run_predictor(int64_t token) const;
+  int64_t run_joint() const;
+
+  // Modified beam search. Each hypothesis holds the tokens past the prefix all of them share (which has been
+  // emitted) and a hash of its whole prefix; predictor outputs are cached by that hash, so hypotheses that
+  // reach the same prefix share one predictor run. The joint scores every hypothesis in one batched call.
+  struct hypothesis {
+    std::vector<int32_t> tokens;
+    std::vector<uint32_t> frames; // log-mel frame of each token
+    uint64_t hash{0};
+    float score{0.0F}; // log probability
+    uint32_t entry{0}; // prediction_entry of the prefix
+  };
+  struct prediction_entry {
+    uint64_t hash{0};
+    std::span<std::byte> prediction; // predictor output 0 after the prefix's last token
+    std::span<std::byte> state;      // candidate state after it, pred_state_inputs_ order
+  };
+  struct beam_candidate {
+    float score{0.0F};
+    uint32_t hypothesis{0};
+    int64_t token{0};
+  };
+
+  bool prepare_beam(uint32_t beam_size);
+  void reset_beam() const noexcept;
+  void beam_frame(std::vector<int32_t>& emitted_tokens, std::vector<uint32_t>* token_frames, uint32_t at) const;
+  void score_hypotheses() const;
+  uint32_t find_entry(uint64_t hash) const noexcept;
+  void insert_entry(uint32_t entry) const noexcept;
+  uint32_t extend_entry(uint32_t parent, uint64_t hash, int64_t token) const;
+  void compact_entries() const noexcept;
+  void emit_common_prefix(std::vector<int32_t>& emitted_tokens, std::vector<uint32_t>* token_frames) const;
+
+  std::shared_ptr<const model_bundle> bundle_{};
+  std::shared_ptr<Ort::Session> encoder_{}; // shared with the backends of load_shared() streams
+  std::shared_ptr<Ort::Session> predictor_{};
+  std::shared_ptr<Ort::Session> joint_{};
+  Ort::MemoryInfo memory_{nullptr};
+  Ort::RunOptions run_options_{nullptr};
+  uint32_t mel_bins_{0};
+  uint32_t max_symbols_{1};
+  int64_t blank_id_{0};
+  tensor_arena arena_;               // predictor and joint tensors, for the life of the session
+  mutable tensor_arena cache_arena_; // encoder caches, reallocated when a probe reveals their real size
+
+  std::vector<io_port> enc_in_ports_;
+  std::vector<io_port> enc_out_ports_;
+  std::vector<const char*> enc_input_names_;
+  std::vector<const char*> enc_output_names_;
+  size_t feature_input_{no_port};
+  size_t length_input_{no_port};
+  size_t encoded_length_output_{no_port};
+  bool channels_first_{false}; // features are [B, mel, T]
+  bool fixed_frames_{false};   // the model's time axis is static
+  size_t chunk_frames_{0};     // feature frames per streaming encoder call
+  std::vector<size_t> cache_inputs_;
+  std::vector<size_t> cache_outputs_;
+  mutable std::array<std::vector<tensor_storage>, 2> caches_; // [side][cache_inputs_ order]
+  mutable std::vector<std::vector<int64_t>> cache_output_shapes_;
+  mutable size_t cache_side_{0}; // side holding the current caches
+  mutable std::vector<encoder_plan> plans_;
+  mutable uint64_t plan_clock_{0};
+  mutable std::vector<float> pending_; // streaming frames waiting for a full chunk, frames x mel_bins_
+  mutable size_t pending_frames_{0};
+  mutable uint64_t stream_frames_{0}; // log-mel frames encoded past their context since reset_encoder()
+
+  // A predictor call reads the committed state on pred_side_ and leaves the candidate state for its token on
+  // the other side; emitting a token commits the candidate by flipping the side.
+  std::vector<io_port> pred_in_ports_;
+  std::vector<io_port> pred_out_ports_;
+  std::vector<const char*> pred_input_names_;
+  std::vector<const char*> pred_output_names_;
+  size_t token_input_{no_port};
+  std::vector<size_t> pred_state_inputs_;
+  std::vector<size_t> pred_state_outputs_;
+  mutable std::vector<tensor_storage> pred_inputs_;  // token and length; state slots stay empty
+  mutable std::vector<tensor_storage> pred_outputs_; // prediction and length; state slots stay empty
+  mutable std::array<std::vector<tensor_storage>, 2> pred_states_; // [side][pred_state_inputs_ order]
+  std::vector<std::vector<int64_t>> pred_state_shapes_;   // as the predictor outputs them
+  std::vector<Ort::IoBinding> pred_bindings_;             // [side]
+  mutable size_t pred_side_{0};
+  // Outputs and candidate state after the start-of-sequence (blank) token, for reset().
+  std::vector<std::vector<std::byte>> primed_outputs_;
+  std::vector<std::vector<std::byte>> primed_states_;
+
+  // Greedy lookahead: step_window() also decodes the right-context frames from a snapshot of the decoder state,
+  // which is restored afterwards; the tokens are the partial() tail until the next window decodes those frames.
+  bool lookahead_{false};
+  mutable std::vector<std::byte> lookahead_state_; // pred_states_ both sides, then pred_outputs_
+  mutable size_t lookahead_side_{0};
+  mutable std::vector<int32_t> lookahead_tokens_;
+  mutable std::vector<uint32_t> lookahead_frames_;
+
+  // The joint reads the prediction straight from the predictor's output tensor.
+  std::vector<io_port> joint_in_ports_;
+  std::vector<io_port> joint_out_ports_;
+  std::vector<const char*> joint_input_names_;
+  std::vector<const char*> joint_output_names_;
+  mutable tensor_storage joint_frame_; // one encoder frame, D floats
+  tensor_storage logits_;
+  Ort::IoBinding joint_binding_{nullptr};
+
+  bool beam_{false};
+  uint32_t beam_size_{1};
+  size_t beam_rows_{1}; // hypotheses per joint call: beam_size_, or 1 when the joint has a static batch
+  tensor_arena beam_arena_;
+  mutable tensor_storage beam_frames_; // joint encoder side, beam_rows_ rows
+  mutable tensor_storage beam_predictions_; // joint decoder side
+  tensor_storage beam_logits_;
+  batch_layout beam_frame_rows_{};
+  batch_layout beam_prediction_rows_{};
+  batch_layout beam_logit_rows_{};
+  Ort::IoBinding beam_binding_{nullptr};
+  mutable std::vector<prediction_entry> entries_;
+  mutable std::vector<uint32_t> entry_table_; // open addressing by hash: entry index + 1, 0 when empty
+  mutable std::vector<uint32_t> free_entries_;
+  mutable std::vector<uint8_t> entry_live_;
+  mutable std::vector<hypothesis> hyps_; // beam_size_ of them, hyp_count_ in use
+  mutable std::vector<hypothesis> next_hyps_;
+  mutable size_t hyp_count_{0};
+  mutable std::vector<beam_candidate> candidates_;
+  mutable std::vector<float> log_probs_; // beam_size_ x vocabulary
+
+  mutable uint64_t encoder_runs_{0};
+  mutable uint64_t predictor_runs_{0};
+  mutable uint64_t joint_runs_{0};
+  mutable uint64_t cache_hits_{0};
+  mutable uint64_t cache_misses_{0};
+  uint64_t load_ns_{0};
+  uint32_t cached_sessions_{0};
+  rnnt_placement placement_{};
+  bool profiling_{false}; // the sessions' profilers are on until collect_profile()
+  bool keep_traces_{false};
+  // Written by both pipeline stages.
+  mutable std::atomic<uint64_t> bytes_allocated_{0};
+  mutable std::atomic<uint64_t> bytes_copied_{0};
+};
+
+onnx_rnnt_backend::onnx_rnnt_backend() = default;
+
+onnx_rnnt_backend::~onnx_rnnt_backend() { unload(); }
+
+bool onnx_rnnt_backend::load(const rnnt_model_paths& paths, const ep_prefs& prefs, const rnnt_options& options) noexcept {
+  unload();
+  const auto started = std::chrono::steady_clock::now();
+  try {
+    bundle_ = paths.bundle;
+    auto opened = open_sessions(paths, prefs);
+    for (auto [session, from] : { std::pair{ &encoder_, &opened[0] }, std::pair{ &predictor_, &opened[1] },
+                                  std::pair{ &joint_, &opened[2] } }) {
+      *session = std::move(from->session);
+      cached_sessions_ += from->from_cache ? 1U : 0U;
+    }
+    placement_ = { .encoder = std::move(opened[0].placement),
+                   .predictor = std::move(opened[1].placement),
+                   .joint = std::move(opened[2].placement) };
+    profiling_ = prefs.session.profiling;
+    keep_traces_ = !prefs.session.profile_dir.empty();
+  } catch (...) {
+    unload();
+    return false;
+  }
+  return prepare(options, started);
+}
+
+bool onnx_rnnt_backend::share(const onnx_rnnt_backend& source, const rnnt_options& options) noexcept {
+  if (&source == this || source.encoder_ == nullptr || source.predictor_ == nullptr || source.joint_ == nullptr) {
+    return false;
+  }
+  unload();
+  const auto started = std::chrono::steady_clock::now();
+  try {
+    bundle_ = source.bundle_;
+    encoder_ = source.encoder_;
+    predictor_ = source.predictor_;
+    joint_ = source.joint_;
+    placement_ = source.placement_;
+  } catch (...) {
+    unload();
+    return false;
+  }
+  return prepare(options, started);
+}
+
+// The per-stream half of a load: ports, tensors, bindings and the primed decoder state.
+bool onnx_rnnt_backend::prepare(const rnnt_options& options, std::chrono::steady_clock::time_point started) noexcept {
+  mel_bins_ = options.features.mel_bins;
+  max_symbols_ = (std::max)(options.max_symbols_per_frame, 1U);
+  chunk_frames_ = options.encoder_chunk_frames;
+  lookahead_ = options.decode_lookahead && options.decoding == decode_mode::greedy;
+  try {
+    memory_ = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
+    run_options_ = Ort::RunOptions{};
+
+    if (!prepare_encoder() || !prepare_predictor() || !prepare_joint()) {
+      unload();
+      return false;
+    }
+
+    const auto vocabulary = static_cast<int64_t>(logits_.count());
+    blank_id_ = options.blank_id < 0 ? vocabulary - 1 : options.blank_id;
+    if (blank_id_ >= vocabulary) {
+      unload();
+      return false;
+    }
+    // Blank doubles as the start-of-sequence token; its prediction is what reset() returns to.
+    run_predictor(blank_id_);
+    for (const auto& output : pred_outputs_) {
+      primed_outputs_.emplace_back(output.bytes().begin(), output.bytes().end());
+    }
+    for (const auto& state : pred_states_[1]) {
+      primed_states_.emplace_back(state.bytes().begin(), state.bytes().end());
+    }
+    if (options.decoding == decode_mode::modified_beam && !prepare_beam(options.beam_size)) {
+      unload();
+      return false;
+    }
+
+    if (lookahead_) {
+      size_t state_bytes = 0;
+      for (const auto& side : pred_states_) {
+        for (const auto& state : side) {
+          state_bytes += state.bytes().size();
+        }
+      }
+      for (const auto& output : pred_outputs_) {
+        state_bytes += output.bytes().size();
+      }
+      lookahead_state_.resize(state_bytes);
+      lookahead_tokens_.reserve(64);
+      lookahead_frames_.reserve(64);
+    }
+    pending_.assign(chunk_frames_ * mel_bins_, 0.0F);
+    plans_.reserve(max_encoder_plans);
+    bytes_allocated_ += arena_.reserved_bytes() + cache_arena_.reserved_bytes() + beam_arena_.reserved_bytes();
+  } catch (...) {
+    unload();
+    return false;
+  }
+  load_ns_ = static_cast<uint64_t>(
+    std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - started).count());
+  return true;
+}
+
+bool onnx_rnnt_backend::prepare_encoder() {
+  enc_in_ports_ = session_inputs(*encoder_);
+  enc_out_ports_ = session_outputs(*encoder_);
+  for (size_t i = 0; i < enc_in_ports_.size() && feature_input_ == no_port; ++i) {
+    if (enc_in_ports_[i].type == ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT && enc_in_ports_[i].shape.size() == 3) {
+      feature_input_ = i;
+    }
+  }
+  if (feature_input_ == no_port || enc_out_ports_.empty() || enc_out_ports_[0].type != ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT) {
+    return false;
+  }
+
+  const auto& shape = enc_in_ports_[feature_input_].shape;
+  int64_t time_dim = 0;
+  if (shape[1] == mel_bins_) {
+    channels_first_ = true;
+    time_dim = shape[2];
+  } else if (shape[2] == mel_bins_) {
+    time_dim = shape[1];
+  } else {
+    return false;
+  }
+  if (time_dim > 0) {
+    fixed_frames_ = true;
+    chunk_frames_ = static_cast<size_t>(time_dim);
+  }
+  if (chunk_frames_ == 0) {
+    return false;
+  }
+
+  for (size_t i = 0; i < enc_in_ports_.size(); ++i) {
+    if (i == feature_input_) {
+      continue;
+    }
+    if (length_input_ == no_port && is_length_port(enc_in_ports_[i])) {
+      length_input_ = i;
+    } else {
+      cache_inputs_.push_back(i);
+    }
+  }
+  std::vector<size_t> candidates;
+  for (size_t i = 1; i < enc_out_ports_.size(); ++i) {
+    if (encoded_length_output_ == no_port && is_length_port(enc_out_ports_[i])) {
+      encoded_length_output_ = i;
+    } else {
+      candidates.push_back(i);
+    }
+  }
+  if (!match_state_outputs(enc_in_ports_, cache_inputs_, enc_out_ports_, candidates, cache_outputs_)) {
+    return false;
+  }
+
+  for (auto& side : caches_) {
+    side.resize(cache_inputs_.size());
+    for (size_t c = 0; c < cache_inputs_.size(); ++c) {
+      const auto& port = enc_in_ports_[cache_inputs_[c]];
+      if (!side[c].allocate(cache_arena_, port.type, concrete_shape(port.shape))) {
+        return false;
+      }
+    }
+  }
+  for (const size_t output : cache_outputs_) {
+    cache_output_shapes_.push_back(concrete_shape(enc_out_ports_[output].shape));
+  }
+  for (const auto& port : enc_in_ports_) {
+    enc_input_names_.push_back(port.name.c_str());
+  }
+  for (const auto& port : enc_out_ports_) {
+    enc_output_names_.push_back(port.name.c_str());
+  }
+  return true;
+}
+
+bool onnx_rnnt_backend::prepare_predictor() {
+  pred_in_ports_ = session_inputs(*predictor_);
+  pred_out_ports_ = session_outputs(*predictor_);
+  if (pred_out_ports_.empty() || pred_out_ports_[0].type != ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT) {
+    return false;
+  }
+
+  pred_inputs_.resize(pred_in_ports_.size());
+  for (size_t i = 0; i < pred_in_ports_.size(); ++i) {
+    const auto& port = pred_in_ports_[i];
+    pred_input_names_.push_back(port.name.c_str());
+    if (is_length_port(port)) {
+      if (!pred_inputs_[i].allocate(arena_, port.type, concrete_shape(port.shape))) {
+        return false;
+      }
+      pred_inputs_[i].set_scalar(1);
+    } else if (token_input_ == no_port && is_integer(port.type)) {
+      if (!pred_inputs_[i].allocate(arena_, port.type, concrete_shape(port.shape))) {
+        return false;
+      }
+      token_input_ = i;
+    } else {
+      pred_state_inputs_.push_back(i);
+    }
+  }
+  if (token_input_ == no_port) {
+    return false;
+  }
+  for (auto& side : pred_states_) {
+    side.resize(pred_state_inputs_.size());
+    for (size_t s = 0; s < pred_state_inputs_.size(); ++s) {
+      const auto& port = pred_in_ports_[pred_state_inputs_[s]];
+      if (!side[s].allocate(arena_, port.type, concrete_shape(port.shape))) {
+        return false;
+      }
+    }
+  }
+
+  std::vector<size_t> candidates;
+  for (size_t i = 1; i < pred_out_ports_.size(); ++i) {
+    if (!is_length_port(pred_out_ports_[i])) {
+      candidates.push_back(i);
+    }
+  }
+  if (!match_state_outputs(pred_in_ports_, pred_state_inputs_, pred_out_ports_, candidates, pred_state_outputs_)) {
+    return false;
+  }
+  for (const auto& port : pred_out_ports_) {
+    pred_output_names_.push_back(port.name.c_str());
+  }
+
+  // One probe run with ORT-allocated outputs fixes their real shapes; from then on they are ours.
+  std::vector<Ort::Value> inputs;
+  for (size_t i = 0; i < pred_in_ports_.size(); ++i) {
+    const auto state = std::find(pred_state_inputs_.begin(), pred_state_inputs_.end(), i);
+    inputs.push_back(
+      state == pred_state_inputs_.end()
+        ? pred_inputs_[i].make_value(memory_)
+        : pred_states_[0][static_cast<size_t>(state - pred_state_inputs_.begin())].make_value(memory_));
+  }
+  auto probe = predictor_->Run(
+    run_options_,
+    pred_input_names_.data(),
+    inputs.data(),
+    inputs.size(),
+    pred_output_names_.data(),
+    pred_output_names_.size());
+  ++predictor_runs_;
+  pred_outputs_.resize(probe.size());
+  for (size_t i = 0; i < probe.size(); ++i) {
+    const auto state = std::find(pred_state_outputs_.begin(), pred_state_outputs_.end(), i);
+    if (state != pred_state_outputs_.end()) {
+      const auto info = probe[i].GetTensorTypeAndShapeInfo();
+      if (info.GetElementCount() != pred_states_[0][static_cast<size_t>(state - pred_state_outputs_.begin())].count()) {
+        return false;
+      }
+      continue;
+    }
+    if (!adopt(probe[i], arena_, pred_outputs_[i])) {
+      return false;
+    }
+    bytes_copied_ += pred_outputs_[i].bytes().size();
+  }
+  for (const size_t output : pred_state_outputs_) {
+    pred_state_shapes_.push_back(probe[output].GetTensorTypeAndShapeInfo().GetShape());
+  }
+  bind_predictor();
+  return true;
+}
+
+void onnx_rnnt_backend::bind_predictor() {
+  pred_bindings_.clear();
+  for (size_t side = 0; side < 2; ++side) {
+    auto& binding = pred_bindings_.emplace_back(*predictor_);
+    for (size_t i = 0; i < pred_in_ports_.size(); ++i) {
+      const auto state = std::find(pred_state_inputs_.begin(), pred_state_inputs_.end(), i);
+      binding.BindInput(
+        pred_input_names_[i],
+        state == pred_state_inputs_.end()
+          ? pred_inputs_[i].make_value(memory_)
+          : pred_states_[side][static_cast<size_t>(state - pred_state_inputs_.begin())].make_value(memory_));
+    }
+    for (size_t i = 0; i < pred_out_ports_.size(); ++i) {
+      const auto state = std::find(pred_state_outputs_.begin(), pred_state_outputs_.end(), i);
+      if (state == pred_state_outputs_.end()) {
+        binding.BindOutput(pred_output_names_[i], pred_outputs_[i].make_value(memory_));
+        continue;
+      }
+      const auto s = static_cast<size_t>(state - pred_state_outputs_.begin());
+      binding.BindOutput(pred_output_names_[i], pred_states_[1 - side][s].make_value(memory_, pred_state_shapes_[s]));
+    }
+  }
+}
+
+bool onnx_rnnt_backend::prepare_joint() {
+  joint_in_ports_ = session_inputs(*joint_);
+  joint_out_ports_ = session_outputs(*joint_);
+  if (joint_in_ports_.size() != 2 || joint_out_ports_.empty()) {
+    return false;
+  }
+  const size_t encoder_side = joint_in_ports_[1].name.find("enc") != std::string::npos ? 1 : 0;
+  const size_t decoder_side = 1 - encoder_side;
+
+  if (!joint_frame_.allocate(arena_, ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT, concrete_shape(joint_in_ports_[encoder_side].shape))) {
+    return false;
+  }
+  std::array<Ort::Value, 2> inputs{ Ort::Value{ nullptr }, Ort::Value{ nullptr } };
+  inputs[encoder_side] = joint_frame_.make_value(memory_);
+  // Same bytes as the predictor's output, viewed in the joint's layout.
+  inputs[decoder_side] = pred_outputs_[0].make_value(memory_, concrete_shape(joint_in_ports_[decoder_side].shape));
+  for (const auto& port : joint_in_ports_) {
+    joint_input_names_.push_back(port.name.c_str());
+  }
+  joint_output_names_.push_back(joint_out_ports_[0].name.c_str());
+
+  auto probe = joint_->Run(
+    run_options_,
+    joint_input_names_.data(),
+    inputs.data(),
+    inputs.size(),
+    joint_output_names_.data(),
+    joint_output_names_.size());
+  ++joint_runs_;
+  if (probe.empty() || !adopt(probe[0], arena_, logits_) || logits_.type() != ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT) {
+    return false;
+  }
+  bytes_copied_ += logits_.bytes().size();
+
+  joint_binding_ = Ort::IoBinding(*joint_);
+  joint_binding_.BindInput(joint_input_names_[0], inputs[0]);
+  joint_binding_.BindInput(joint_input_names_[1], inputs[1]);
+  joint_binding_.BindOutput(joint_output_names_[0], logits_.make_value(memory_));
+  return true;
+}
+
+bool onnx_rnnt_backend::step(
+  std::span<const float> features,
+  const window_context& context,
+  std::vector<int32_t>& emitted_tokens,
+  std::vector<uint32_t>& token_frames) const noexcept {
+  if (encoder_ == nullptr || predictor_ == nullptr || joint_ == nullptr || mel_bins_ == 0
+      || features.size() % mel_bins_ != 0) {
+    return false;
+  }
+
+  try {
+    lookahead_tokens_.clear();
+    lookahead_frames_.clear();
+    const frame_output out{ &emitted_tokens, nullptr, &token_frames };
+    if (context.left_frames == 0 && context.right_frames == 0) {
+      return push_frames(features, out);
+    }
+    const size_t frames = features.size() / mel_bins_;
+    if (!cache_inputs_.empty() || fixed_frames_) {
+      // A cache-aware encoder already carries its left context and a fixed-size one only takes whole chunks:
+      // both get just the chunk frames, in stream order.
+      const size_t chunk = frames - context.left_frames - context.right_frames;
+      return push_frames(features.subspan(context.left_frames * mel_bins_, chunk * mel_bins_), out);
+    }
+    return encode(features, context, out);
+  } catch (...) {
+    return false;
+  }
+}
+
+bool onnx_rnnt_backend::encode_frames(std::span<const float> features, std::vector<float>& frames) const noexcept {
+  if (encoder_ == nullptr || mel_bins_ == 0 || features.size() % mel_bins_ != 0) {
+    return false;
+  }
+  try {
+    return push_frames(features, { nullptr, &frames, nullptr });
+  } catch (...) {
+    return false;
+  }
+}
+
+bool onnx_rnnt_backend::decode_frames(std::span<const float> frames, std::vector<int32_t>& emitted_tokens) const noexcept {
+  const size_t width = joint_frame_.count();
+  if (predictor_ == nullptr || joint_ == nullptr || width == 0 || frames.size() % width != 0) {
+    return false;
+  }
+  try {
+    const auto frame = joint_frame_.as<float>();
+    for (; !frames.empty(); frames = frames.subspan(width)) {
+      std::copy_n(frames.begin(), width, frame.begin());
+      decode_frame(emitted_tokens, nullptr, 0);
+    }
+  } catch (...) {
+    return false;
+  }
+  return true;
+}
+
+bool onnx_rnnt_backend::push_frames(std::span<const float> rows, const frame_output& out) const {
+  while (!rows.empty()) {
+    const size_t take = (std::min)(rows.size() / mel_bins_, chunk_frames_ - pending_frames_);
+    std::copy_n(rows.begin(), take * mel_bins_, pending_.begin() + static_cast<std::ptrdiff_t>(pending_frames_ * mel_bins_));
+    pending_frames_ += take;
+    rows = rows.subspan(take * mel_bins_);
+    if (pending_frames_ == chunk_frames_) {
+      pending_frames_ = 0;
+      if (!encode(pending_, {}, out)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+bool onnx_rnnt_backend::encode(std::span<const float> rows, const window_context& context, const frame_output& out) const {
+  const size_t frames = rows.size() / mel_bins_;
+  if (fixed_frames_ && frames != chunk_frames_) {
+    return false;
+  }
+
+  encoder_plan* plan = find_plan(frames);
+  {
+    const auto encoder_frames = static_cast<uint32_t>(frames);
+    const realtime::trace_span span(realtime::trace_point::encoder, realtime::trace_origin(), encoder_frames);
+    if (plan != nullptr) {
+      fill_features(*plan, rows);
+      encoder_->Run(run_options_, plan->bindings[cache_side_]);
+      ++encoder_runs_;
+      plan->last_used = ++plan_clock_;
+    } else {
+      plan = build_plan(frames, rows);
+    }
+  }
+  // The caches this call wrote are the next call's inputs.
+  cache_side_ = 1 - cache_side_;
+  if (out.tokens == nullptr) {
+    return decode(*plan, context, out); // the pipeline's encoder stage: frames are only copied out
+  }
+  const realtime::trace_span span(realtime::trace_point::decode, realtime::trace_origin());
+  return decode(*plan, context, out);
+}
+
+onnx_rnnt_backend::encoder_plan* onnx_rnnt_backend::find_plan(size_t frames) const noexcept {
+  for (auto& plan : plans_) {
+    if (plan.frames == frames) {
+      return &plan;
+    }
+  }
+  return nullptr;
+}
+
+onnx_rnnt_backend::encoder_plan* onnx_rnnt_backend::build_plan(size_t frames, std::span<const float> rows) const {
+  encoder_plan* plan = nullptr;
+  if (plans_.size() < max_encoder_plans) {
+    plan = &plans_.emplace_back();
+  } else {
+    plan = &*std::min_element(plans_.begin(), plans_.end(), [](const auto& lhs, const auto& rhs) {
+      return lhs.last_used < rhs.last_used;
+    });
+    *plan = encoder_plan{};
+  }
+  plan->frames = frames;
+
+  auto shape = concrete_shape(enc_in_ports_[feature_input_].shape);
+  shape[channels_first_ ? 2 : 1] = static_cast<int64_t>(frames);
+  if (!plan->features.allocate(plan->arena, ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT, shape)) {
+    throw Ort::Exception("encoder plan: out of memory", ORT_FAIL);
+  }
+  if (length_input_ != no_port) {
+    const auto& port = enc_in_ports_[length_input_];
+    if (!plan->length.allocate(plan->arena, port.type, concrete_shape(port.shape))) {
+      throw Ort::Exception("encoder plan: out of memory", ORT_FAIL);
+    }
+    plan->length.set_scalar(static_cast<int64_t>(frames));
+  }
+  fill_features(*plan, rows);
+
+  std::vector<Ort::Value> inputs;
+  for (size_t i = 0; i < enc_in_ports_.size(); ++i) {
+    inputs.push_back(encoder_input(*plan, i, cache_side_));
+  }
+  auto probe = encoder_->Run(
+    run_options_,
+    enc_input_names_.data(),
+    inputs.data(),
+    inputs.size(),
+    enc_output_names_.data(),
+    enc_output_names_.size());
+  ++encoder_runs_;
+  plan->outputs.resize(probe.size());
+  for (size_t i = 0; i < probe.size(); ++i) {
+    if (std::find(cache_outputs_.begin(), cache_outputs_.end(), i) != cache_outputs_.end()) {
+      continue;
+    }
+    if (!adopt(probe[i], plan->arena, plan->outputs[i])) {
+      throw Ort::Exception("encoder plan: cannot adopt output", ORT_FAIL);
+    }
+    bytes_copied_ += plan->outputs[i].bytes().size();
+  }
+  bytes_allocated_ += plan->arena.reserved_bytes();
+
+  // Caches with dynamic dims learn their real size from the first call; plans bound to the old buffers go.
+  bool resized = false;
+  for (size_t c = 0; c < cache_outputs_.size(); ++c) {
+    const auto info = probe[cache_outputs_[c]].GetTensorTypeAndShapeInfo();
+    resized = resized || info.GetElementCount() != caches_[0][c].count();
+    cache_output_shapes_[c] = info.GetShape();
+  }
+  if (resized) {
+    resize_caches(probe);
+    for (auto& other : plans_) {
+      if (&other != plan) {
+        other = encoder_plan{};
+      }
+    }
+  }
+  auto& written = caches_[1 - cache_side_];
+  for (size_t c = 0; c < cache_outputs_.size(); ++c) {
+    if (!assign(probe[cache_outputs_[c]], written[c])) {
+      throw Ort::Exception("encoder plan: cache output does not match its input", ORT_FAIL);
+    }
+    bytes_copied_ += written[c].bytes().size();
+  }
+
+  bind_encoder(*plan);
+  plan->last_used = ++plan_clock_;
+  return plan;
+}
+
+void onnx_rnnt_backend::resize_caches(const std::vector<Ort::Value>& probe) const {
+  cache_arena_.release();
+  for (auto& side : caches_) {
+    for (size_t c = 0; c < cache_outputs_.size(); ++c) {
+      const auto info = probe[cache_outputs_[c]].GetTensorTypeAndShapeInfo();
+      if (!side[c].allocate(cache_arena_, info.GetElementType(), info.GetShape())) {
+        throw Ort::Exception("encoder plan: out of memory", ORT_FAIL);
+      }
+    }
+  }
+  bytes_allocated_ += cache_arena_.reserved_bytes();
+}
+
+Ort::Value onnx_rnnt_backend::encoder_input(const encoder_plan& plan, size_t input, size_t side) const {
+  if (input == feature_input_) {
+    return plan.features.make_value(memory_);
+  }
+  if (input == length_input_) {
+    return plan.length.make_value(memory_);
+  }
+  const auto cache = std::find(cache_inputs_.begin(), cache_inputs_.end(), input) - cache_inputs_.begin();
+  return caches_[side][static_cast<size_t>(cache)].make_value(memory_);
+}
+
+void onnx_rnnt_backend::bind_encoder(encoder_plan& plan) const {
+  plan.bindings.clear();
+  for (size_t side = 0; side < 2; ++side) {
+    auto& binding = plan.bindings.emplace_back(*encoder_);
+    for (size_t i = 0; i < enc_in_ports_.size(); ++i) {
+      binding.BindInput(enc_input_names_[i], encoder_input(plan, i, side));
+    }
+    for (size_t i = 0; i < enc_out_ports_.size(); ++i) {
+      const auto cache = std::find(cache_outputs_.begin(), cache_outputs_.end(), i);
+      if (cache == cache_outputs_.end()) {
+        binding.BindOutput(enc_output_names_[i], plan.outputs[i].make_value(memory_));
+        continue;
+      }
+      const auto c = static_cast<size_t>(cache - cache_outputs_.begin());
+      binding.BindOutput(enc_output_names_[i], caches_[1 - side][c].make_value(memory_, cache_output_shapes_[c]));
+    }
+  }
+}
+
+void onnx_rnnt_backend::fill_features(encoder_plan& plan, std::span<const float> rows) const noexcept {
+  const auto dst = plan.features.as<float>();
+  if (!channels_first_) {
+    std::copy(rows.begin(), rows.end(), dst.begin());
+    return;
+  }
+  const size_t frames = plan.frames;
+  for (size_t t = 0; t < frames; ++t) {
+    for (size_t m = 0; m < mel_bins_; ++m) {
+      dst[(m * frames) + t] = rows[(t * mel_bins_) + m];
+    }
+  }
+}
+
+bool onnx_rnnt_backend::decode(const encoder_plan& plan, const window_context& context, const frame_output& out) const {
+  const auto& encoded = plan.outputs[0];
+  const size_t width = joint_frame_.count();
+  if (encoded.shape().size() != 3) {
+    return false;
+  }
+  const auto rows = static_cast<size_t>(encoded.shape()[1]);
+  const auto cols = static_cast<size_t>(encoded.shape()[2]);
+  bool frames_last = false; // [B, D, T']
+  size_t out_frames = 0;
+  if (rows == width && (cols != width || channels_first_)) {
+    frames_last = true;
+    out_frames = cols;
+  } else if (cols == width) {
+    out_frames = rows;
+  } else {
+    return false;
+  }
+
+  size_t valid = out_frames;
+  if (encoded_length_output_ != no_port) {
+    valid = (std::min)(valid, static_cast<size_t>((std::max)(plan.outputs[encoded_length_output_].scalar(), int64_t{ 0 })));
+  }
+  // Context maps onto encoder frames by the subsampling ratio.
+  const size_t first = (context.left_frames * out_frames) / plan.frames;
+  const size_t trailing = (context.right_frames * out_frames) / plan.frames;
+  const size_t last = (std::min)(valid, out_frames - (std::min)(out_frames, trailing));
+
+  const auto data = encoded.as<float>();
+  const auto read_frame = [&](size_t t, std::span<float> frame) {
+    if (frames_last) {
+      for (size_t d = 0; d < width; ++d) {
+        frame[d] = data[(d * out_frames) + t];
+      }
+    } else {
+      std::copy_n(data.begin() + static_cast<std::ptrdiff_t>(t * width), width, frame.begin());
+    }
+  };
+  const auto log_mel_frame = [&](size_t t) {
+    return static_cast<uint32_t>(stream_frames_ + (((t - first) * plan.frames) / out_frames));
+  };
+  for (size_t t = first; t < last; ++t) {
+    std::span<float> frame = joint_frame_.as<float>();
+    if (out.frames != nullptr) {
+      out.frames->resize(out.frames->size() + width);
+      frame = std::span<float>(*out.frames).last(width);
+    }
+    read_frame(t, frame);
+    if (out.tokens != nullptr) {
+      decode_frame(*out.tokens, out.token_frames, log_mel_frame(t));
+    }
+  }
+  const size_t lookahead_end = (std::min)(valid, out_frames);
+  if (lookahead_ && out.tokens != nullptr && last < lookahead_end) {
+    save_decoder();
+    for (size_t t = last; t < lookahead_end; ++t) {
+      read_frame(t, joint_frame_.as<float>());
+      decode_frame(lookahead_tokens_, &lookahead_frames_, log_mel_frame(t));
+    }
+    restore_decoder();
+  }
+  stream_frames_ += plan.frames - context.left_frames - context.right_frames;
+  return true;
+}
+
+void onnx_rnnt_backend::save_decoder() const noexcept {
+  auto to = lookahead_state_.begin();
+  for (const auto& side : pred_states_) {
+    for (const auto& state : side) {
+      to = std::copy(state.bytes().begin(), state.bytes().end(), to);
+    }
+  }
+  for (const auto& output : pred_outputs_) {
+    to = std::copy(output.bytes().begin(), output.bytes().end(), to);
+  }
+  lookahead_side_ = pred_side_;
+  bytes_copied_ += lookahead_state_.size();
+}
+
+void onnx_rnnt_backend::restore_decoder() const noexcept {
+  auto from = lookahead_state_.begin();
+  const auto restore = [&from](tensor_storage& tensor) {
+    const auto bytes = tensor.bytes();
+    std::copy_n(from, bytes.size(), bytes.begin());
+    from += static_cast<std::ptrdiff_t>(bytes.size());
+  };
+  for (auto& side : pred_states_) {
+    for (auto& state : side) {
+      restore(state);
+    }
+  }
+  for (auto& output : pred_outputs_) {
+    restore(output);
+  }
+  pred_side_ = lookahead_side_;
+  bytes_copied_ += lookahead_state_.size();
+}
+
+void onnx_rnnt_backend::decode_frame(
+  std::vector<int32_t>& emitted_tokens,
+  std::vector<uint32_t>* token_frames,
+  uint32_t at) const {
+  if (beam_) {
+    beam_frame(emitted_tokens, token_frames, at);
+    return;
+  }
+  for (uint32_t symbol = 0; symbol < max_symbols_; ++symbol) {
+    const int64_t token = run_joint();
+    if (token == blank_id_) {
+      break;
+    }
+    emitted_tokens.push_back(static_cast<int32_t>(token));
+    if (token_frames != nullptr) {
+      token_frames->push_back(at);
+    }
+    advance_predictor(token);
+  }
+}
+
+void onnx_rnnt_backend::advance_predictor(int64_t token) const {
+  pred_side_ = 1 - pred_side_;
+  run_predictor(token);
+}
+
+void onnx_rnnt_backend::run_predictor(int64_t token) const {
+  pred_inputs_[token_input_].set_scalar(token);
+  predictor_->Run(run_options_, pred_bindings_[pred_side_]);
+  ++predictor_runs_;
+}
+
+int64_t onnx_rnnt_backend::run_joint() const {
+  joint_->Run(run_options_, joint_binding_);
+  ++joint_runs_;
+  const auto scores = logits_.as<const float>();
+  return std::max_element(scores.begin(), scores.end()) - scores.begin();
+}
+
+bool onnx_rnnt_backend::prepare_beam(uint32_t beam_size) {
+  if (beam_size == 0) {
+    return false;
+  }
+  beam_ = true;
+  beam_size_ = beam_size;
+
+  const size_t encoder_side = joint_in_ports_[1].name.find("enc") != std::string::npos ? 1 : 0;
+  const size_t decoder_side = 1 - encoder_side;
+  const size_t frame_axis = batch_axis(joint_in_ports_[encoder_side].shape);
+  const size_t prediction_axis = batch_axis(joint_in_ports_[decoder_side].shape);
+  beam_rows_ = frame_axis != no_axis && prediction_axis != no_axis ? beam_size_ : 1;
+
+  auto frame_shape = concrete_shape(joint_in_ports_[encoder_side].shape);
+  auto prediction_shape = concrete_shape(joint_in_ports_[decoder_side].shape);
+  if (beam_rows_ > 1) {
+    frame_shape[frame_axis] = static_cast<int64_t>(beam_rows_);
+    prediction_shape[prediction_axis] = static_cast<int64_t>(beam_rows_);
+  }
+  if (!beam_frames_.allocate(beam_arena_, ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT, frame_shape)
+      || !beam_predictions_.allocate(beam_arena_, pred_outputs_[0].type(), prediction_shape)
+      || beam_predictions_.bytes().size() != beam_rows_ * pred_outputs_[0].bytes().size()) {
+    return false;
+  }
+  beam_frame_rows_ = describe_rows(beam_frames_, beam_rows_ > 1 ? frame_axis : no_axis);
+  beam_prediction_rows_ = describe_rows(beam_predictions_, beam_rows_ > 1 ? prediction_axis : no_axis);
+
+  std::array<Ort::Value, 2> inputs{ Ort::Value{ nullptr }, Ort::Value{ nullptr } };
+  inputs[encoder_side] = beam_frames_.make_value(memory_);
+  inputs[decoder_side] = beam_predictions_.make_value(memory_);
+  auto probe = joint_->Run(
+    run_options_,
+    joint_input_names_.data(),
+    inputs.data(),
+    inputs.size(),
+    joint_output_names_.data(),
+    joint_output_names_.size());
+  ++joint_runs_;
+  if (probe.empty() || !adopt(probe[0], beam_arena_, beam_logits_) || beam_logits_.count() != beam_rows_ * logits_.count()) {
+    return false;
+  }
+  bytes_copied_ += beam_logits_.bytes().size();
+  beam_logit_rows_ = describe_rows(beam_logits_, beam_rows_ > 1 ? batch_axis(joint_out_ports_[0].shape) : no_axis);
+  beam_binding_ = Ort::IoBinding(*joint_);
+  beam_binding_.BindInput(joint_input_names_[0], inputs[0]);
+  beam_binding_.BindInput(joint_input_names_[1], inputs[1]);
+  beam_binding_.BindOutput(joint_output_names_[0], beam_logits_.make_value(memory_));
+
+  size_t state_bytes = 0;
+  for (const auto& state : pred_states_[0]) {
+    state_bytes += state.bytes().size();
   }
+  const size_t capacity = entries_per_beam * beam_size_;
+  entries_.resize(capacity);
+  for (auto& entry : entries_) {
+    entry.prediction = beam_arena_.allocate(pred_outputs_[0].bytes().size());
+    entry.state = beam_arena_.allocate(state_bytes);
+  }
+  entry_table_.assign(std::bit_ceil(2 * capacity), 0);
+  entry_live_.assign(capacity, 0);
+  free_entries_.reserve(capacity);
 
-  bool step(std::span<const float> audio_chunk, std::vector<int32_t>& emitted_tokens) const noexcept {
-    if (!loaded_) {
-      return false;
+  hyps_.resize(beam_size_);
+  next_hyps_.resize(beam_size_);
+  for (auto* hyps : { &hyps_, &next_hyps_ }) {
+    for (auto& hyp : *hyps) {
+      hyp.tokens.reserve(256);
+      hyp.frames.reserve(256);
     }
-    return backend_.step(audio_chunk, emitted_tokens);
   }
+  candidates_.reserve(size_t{ beam_size_ } * beam_size_);
+  log_probs_.assign(beam_size_ * logits_.count(), 0.0F);
+  reset_beam();
+  return true;
+}
 
-  void reset() noexcept { backend_.reset(); }
-
-  void unload() noexcept {
-    backend_.unload();
-    loaded_ = false;
+void onnx_rnnt_backend::reset_beam() const noexcept {
+  std::fill(entry_table_.begin(), entry_table_.end(), 0U);
+  free_entries_.clear();
+  for (auto entry = static_cast<uint32_t>(entries_.size()); entry > 1; --entry) {
+    free_entries_.push_back(entry - 1);
   }
 
-  bool is_loaded() const noexcept { return loaded_; }
+  // Entry 0 is the start of sequence: the blank-primed prediction and state.
+  auto& root = entries_[0];
+  root.hash = root_prefix_hash;
+  if (!primed_outputs_.empty() && primed_outputs_[0].size() == root.prediction.size()) {
+    std::copy(primed_outputs_[0].begin(), primed_outputs_[0].end(), root.prediction.begin());
+  }
+  auto state = root.state.begin();
+  for (const auto& primed : primed_states_) {
+    state = std::copy(primed.begin(), primed.end(), state);
+  }
+  insert_entry(0);
 
-private:
-  mutable Backend backend_{};
-  bool loaded_{false};
-};
+  hyp_count_ = 1;
+  hyps_[0].tokens.clear();
+  hyps_[0].frames.clear();
+  hyps_[0].hash = root_prefix_hash;
+  hyps_[0].score = 0.0F;
+  hyps_[0].entry = 0;
+}
 
-struct null_rnnt_backend {
-  bool load(const rnnt_model_paths& paths, const ep_prefs& prefs) noexcept {
-    static_cast<void>(paths);
-    static_cast<void>(prefs);
-    load_attempted_ = true;
-    return false;
+void onnx_rnnt_backend::beam_frame(
+  std::vector<int32_t>& emitted_tokens,
+  std::vector<uint32_t>* token_frames,
+  uint32_t at) const {
+  if (free_entries_.size() < beam_size_) {
+    compact_entries();
   }
+  score_hypotheses();
 
-  bool step(std::span<const float> audio_chunk, std::vector<int32_t>& emitted_tokens) const noexcept {
-    static_cast<void>(audio_chunk);
-    static_cast<void>(emitted_tokens);
-    if (load_attempted_) {
-      return false;
+  // Only the beam_size_ best tokens of each hypothesis can make the next beam.
+  const size_t vocabulary = logits_.count();
+  candidates_.clear();
+  for (uint32_t h = 0; h < hyp_count_; ++h) {
+    const auto scores = std::span<float>(log_probs_).subspan(h * vocabulary, vocabulary);
+    log_softmax(scores);
+    const size_t first = candidates_.size();
+    for (size_t k = 0; k < vocabulary; ++k) {
+      const beam_candidate candidate{ hyps_[h].score + scores[k], h, static_cast<int64_t>(k) };
+      if (candidates_.size() - first < beam_size_) {
+        candidates_.push_back(candidate);
+        continue;
+      }
+      const auto worst = std::min_element(
+        candidates_.begin() + static_cast<std::ptrdiff_t>(first), candidates_.end(), [](const auto& lhs, const auto& rhs) {
+          return lhs.score < rhs.score;
+        });
+      if (candidate.score > worst->score) {
+        *worst = candidate;
+      }
     }
-    return false;
   }
+  const size_t keep = (std::min)(candidates_.size(), size_t{ beam_size_ });
+  std::partial_sort(candidates_.begin(), candidates_.begin() + static_cast<std::ptrdiff_t>(keep), candidates_.end(),
+    [](const auto& lhs, const auto& rhs) { return lhs.score > rhs.score; });
 
-  void reset() noexcept { load_attempted_ = false; }
-
-  void unload() noexcept { load_attempted_ = false; }
-
-private:
-  mutable bool load_attempted_{false};
-};
-
-#if defined(JAXIE_USE_ONNXRUNTIME)
+  size_t next = 0;
+  for (size_t i = 0; i < keep; ++i) {
+    const auto& candidate = candidates_[i];
+    const auto& parent = hyps_[candidate.hypothesis];
+    const bool blank = candidate.token == blank_id_;
+    const uint64_t hash = blank ? parent.hash : extend_prefix_hash(parent.hash, candidate.token);
+    // Different paths to the same prefix are one hypothesis.
+    const auto same = std::find_if(next_hyps_.begin(), next_hyps_.begin() + static_cast<std::ptrdiff_t>(next),
+      [hash](const hypothesis& hyp) { return hyp.hash == hash; });
+    if (same != next_hyps_.begin() + static_cast<std::ptrdiff_t>(next)) {
+      same->score = log_add(same->score, candidate.score);
+      continue;
+    }
+    auto& hyp = next_hyps_[next++];
+    hyp.tokens.assign(parent.tokens.begin(), parent.tokens.end());
+    hyp.frames.assign(parent.frames.begin(), parent.frames.end());
+    hyp.hash = hash;
+    hyp.score = candidate.score;
+    hyp.entry = parent.entry;
+    if (!blank) {
+      hyp.tokens.push_back(static_cast<int32_t>(candidate.token));
+      hyp.frames.push_back(at);
+      hyp.entry = extend_entry(parent.entry, hash, candidate.token);
+    }
+  }
+  hyps_.swap(next_hyps_);
+  hyp_count_ = next;
+  emit_common_prefix(emitted_tokens, token_frames);
+}
 
-class onnx_rnnt_backend {
-public:
-  onnx_rnnt_backend();
-  ~onnx_rnnt_backend();
+// Log-probabilities of every hypothesis into log_probs_, beam_rows_ hypotheses per joint call.
+void onnx_rnnt_backend::score_hypotheses() const {
+  const size_t vocabulary = logits_.count();
+  const auto frame = std::as_bytes(joint_frame_.as<const float>());
+  for (size_t first = 0; first < hyp_count_; first += beam_rows_) {
+    const size_t rows = (std::min)(beam_rows_, hyp_count_ - first);
+    for (size_t row = 0; row < rows; ++row) {
+      gather_row(beam_frame_rows_, row, frame, beam_frames_);
+      gather_row(beam_prediction_rows_, row, entries_[hyps_[first + row].entry].prediction, beam_predictions_);
+    }
+    joint_->Run(run_options_, beam_binding_);
+    ++joint_runs_;
+    for (size_t row = 0; row < rows; ++row) {
+      const auto scores = std::span<float>(log_probs_).subspan((first + row) * vocabulary, vocabulary);
+      scatter_row(beam_logit_rows_, row, beam_logits_, std::as_writable_bytes(scores));
+    }
+  }
+}
 
-  bool load(const rnnt_model_paths& paths, const ep_prefs& prefs) noexcept;
-  bool step(std::span<const float> audio_chunk, std::vector<int32_t>& emitted_tokens) const noexcept;
-  void reset() noexcept;
-  void unload() noexcept;
+uint32_t onnx_rnnt_backend::find_entry(uint64_t hash) const noexcept {
+  const size_t mask = entry_table_.size() - 1;
+  for (size_t at = hash & mask; entry_table_[at] != 0; at = (at + 1) & mask) {
+    const uint32_t entry = entry_table_[at] - 1;
+    if (entries_[entry].hash == hash) {
+      return entry;
+    }
+  }
+  return no_entry;
+}
 
-private:
-  void append_execution_providers(Ort::SessionOptions& options, const ep_prefs& prefs);
+void onnx_rnnt_backend::insert_entry(uint32_t entry) const noexcept {
+  const size_t mask = entry_table_.size() - 1;
+  size_t at = entries_[entry].hash & mask;
+  while (entry_table_[at] != 0) {
+    at = (at + 1) & mask;
+  }
+  entry_table_[at] = entry + 1;
+}
 
-  Ort::Env env_;
-  std::unique_ptr<Ort::Session> encoder_{};
-  std::unique_ptr<Ort::Session> predictor_{};
-  std::unique_ptr<Ort::Session> joint_{};
-};
+// The prediction after `token` following the parent's prefix: cached, or one predictor run from the parent's
+// candidate state.
+uint32_t onnx_rnnt_backend::extend_entry(uint32_t parent, uint64_t hash, int64_t token) const {
+  if (const uint32_t cached = find_entry(hash); cached != no_entry) {
+    ++cache_hits_;
+    return cached;
+  }
+  ++cache_misses_;
+  const uint32_t entry = free_entries_.back();
+  free_entries_.pop_back();
 
-onnx_rnnt_backend::onnx_rnnt_backend()
-  : env_(ORT_LOGGING_LEVEL_WARNING, "jaxie") {}
+  auto from = entries_[parent].state.begin();
+  for (auto& state : pred_states_[0]) {
+    const auto bytes = state.bytes();
+    std::copy_n(from, bytes.size(), bytes.begin());
+    from += static_cast<std::ptrdiff_t>(bytes.size());
+  }
+  pred_side_ = 0;
+  run_predictor(token);
 
-onnx_rnnt_backend::~onnx_rnnt_backend() { unload(); }
+  auto& target = entries_[entry];
+  const auto prediction = pred_outputs_[0].bytes();
+  std::copy(prediction.begin(), prediction.end(), target.prediction.begin());
+  auto to = target.state.begin();
+  for (const auto& state : pred_states_[1]) {
+    to = std::copy(state.bytes().begin(), state.bytes().end(), to);
+  }
+  bytes_copied_ += (2 * target.state.size()) + target.prediction.size();
+  target.hash = hash;
+  insert_entry(entry);
+  return entry;
+}
 
-bool onnx_rnnt_backend::load(const rnnt_model_paths& paths, const ep_prefs& prefs) noexcept {
-  unload();
+// Frees every entry no live hypothesis points at.
+void onnx_rnnt_backend::compact_entries() const noexcept {
+  std::fill(entry_live_.begin(), entry_live_.end(), uint8_t{ 0 });
+  for (size_t h = 0; h < hyp_count_; ++h) {
+    entry_live_[hyps_[h].entry] = 1;
+  }
+  std::fill(entry_table_.begin(), entry_table_.end(), 0U);
+  free_entries_.clear();
+  for (auto entry = static_cast<uint32_t>(entries_.size()); entry > 0; --entry) {
+    if (entry_live_[entry - 1] != 0) {
+      insert_entry(entry - 1);
+    } else {
+      free_entries_.push_back(entry - 1);
+    }
+  }
+}
 
-  Ort::SessionOptions options{};
-  append_execution_providers(options, prefs);
+// Tokens every hypothesis agrees on can no longer change: emit them and drop them from the hypotheses.
+void onnx_rnnt_backend::emit_common_prefix(
+  std::vector<int32_t>& emitted_tokens,
+  std::vector<uint32_t>* token_frames) const {
+  size_t common = hyps_[0].tokens.size();
+  for (size_t h = 1; h < hyp_count_; ++h) {
+    const auto& tokens = hyps_[h].tokens;
+    const auto first = hyps_[0].tokens.begin();
+    common = static_cast<size_t>(
+      std::mismatch(first, first + static_cast<std::ptrdiff_t>(common), tokens.begin(), tokens.end()).first - first);
+  }
+  if (common == 0) {
+    return;
+  }
+  const auto count = static_cast<std::ptrdiff_t>(common);
+  emitted_tokens.insert(emitted_tokens.end(), hyps_[0].tokens.begin(), hyps_[0].tokens.begin() + count);
+  if (token_frames != nullptr) {
+    // Different paths may have placed a shared token on different frames; the leading hypothesis decides.
+    token_frames->insert(token_frames->end(), hyps_[0].frames.begin(), hyps_[0].frames.begin() + count);
+  }
+  for (size_t h = 0; h < hyp_count_; ++h) {
+    hyps_[h].tokens.erase(hyps_[h].tokens.begin(), hyps_[h].tokens.begin() + count);
+    hyps_[h].frames.erase(hyps_[h].frames.begin(), hyps_[h].frames.begin() + count);
+  }
+}
 
+bool onnx_rnnt_backend::finish(
+  std::vector<int32_t>& emitted_tokens,
+  std::vector<uint32_t>& token_frames) const noexcept {
+  lookahead_tokens_.clear();
+  lookahead_frames_.clear();
+  if (!beam_ || hyp_count_ == 0) {
+    return true;
+  }
   try {
-    encoder_ = std::make_unique<Ort::Session>(env_, paths.encoder.c_str(), options);
-    predictor_ = std::make_unique<Ort::Session>(env_, paths.predictor.c_str(), options);
-    joint_ = std::make_unique<Ort::Session>(env_, paths.joint.c_str(), options);
+    const auto best = std::max_element(hyps_.begin(), hyps_.begin() + static_cast<std::ptrdiff_t>(hyp_count_),
+      [](const hypothesis& lhs, const hypothesis& rhs) { return lhs.score < rhs.score; });
+    emitted_tokens.insert(emitted_tokens.end(), best->tokens.begin(), best->tokens.end());
+    token_frames.insert(token_frames.end(), best->frames.begin(), best->frames.end());
+    std::swap(hyps_[0], *best);
   } catch (...) {
-    unload();
     return false;
   }
-
+  hyps_[0].tokens.clear();
+  hyps_[0].frames.clear();
+  hyps_[0].score = 0.0F;
+  hyp_count_ = 1;
   return true;
 }
 
-bool onnx_rnnt_backend::step(std::span<const float> audio_chunk, std::vector<int32_t>& emitted_tokens) const noexcept {
-  static_cast<void>(audio_chunk);
-  if (encoder_ == nullptr || predictor_ == nullptr || joint_ == nullptr) {
-    return false;
+void onnx_rnnt_backend::partial(std::vector<int32_t>& tokens, std::vector<uint32_t>& frames) const noexcept {
+  try {
+    if (!beam_) {
+      tokens.assign(lookahead_tokens_.begin(), lookahead_tokens_.end());
+      frames.assign(lookahead_frames_.begin(), lookahead_frames_.end());
+      return;
+    }
+    if (hyp_count_ == 0) {
+      return;
+    }
+    const auto best = std::max_element(hyps_.begin(), hyps_.begin() + static_cast<std::ptrdiff_t>(hyp_count_),
+      [](const hypothesis& lhs, const hypothesis& rhs) { return lhs.score < rhs.score; });
+    tokens.assign(best->tokens.begin(), best->tokens.end());
+    frames.assign(best->frames.begin(), best->frames.end());
+  } catch (...) {
+    tokens.clear();
+    frames.clear();
   }
-
-  // TODO: Implement RNNT step once model IOs are finalized.
-  emitted_tokens.clear();
-  return true;
 }
 
 void onnx_rnnt_backend::reset() noexcept {
-  // TODO: reset internal caches when RNNT state handling is implemented.
+  reset_encoder();
+  reset_decoder();
+}
+
+void onnx_rnnt_backend::reset_encoder() noexcept {
+  for (auto& side : caches_) {
+    for (auto& cache : side) {
+      cache.zero();
+    }
+  }
+  cache_side_ = 0;
+  pending_frames_ = 0;
+  stream_frames_ = 0;
+}
+
+void onnx_rnnt_backend::reset_decoder() noexcept {
+  for (auto& state : pred_states_[0]) {
+    state.zero();
+  }
+  for (size_t i = 0; i < primed_outputs_.size() && i < pred_outputs_.size(); ++i) {
+    std::copy(primed_outputs_[i].begin(), primed_outputs_[i].end(), pred_outputs_[i].bytes().begin());
+  }
+  for (size_t s = 0; s < primed_states_.size() && s < pred_states_[1].size(); ++s) {
+    std::copy(primed_states_[s].begin(), primed_states_[s].end(), pred_states_[1][s].bytes().begin());
+  }
+  pred_side_ = 0;
+  lookahead_tokens_.clear();
+  lookahead_frames_.clear();
+  if (beam_) {
+    reset_beam();
+  }
 }
 
 void onnx_rnnt_backend::unload() noexcept {
+  if (profiling_) {
+    // Otherwise ORT writes the trace when the session goes, and nobody removes it.
+    rnnt_profile unused;
+    static_cast<void>(collect_profile(unused));
+  }
+  placement_ = {};
+  // Bindings first: they refer to arena memory.
+  plans_.clear();
+  pred_bindings_.clear();
+  joint_binding_ = Ort::IoBinding{nullptr};
+  beam_binding_ = Ort::IoBinding{nullptr};
+  entries_.clear();
+  entry_table_.clear();
+  free_entries_.clear();
+  entry_live_.clear();
+  hyps_.clear();
+  next_hyps_.clear();
+  hyp_count_ = 0;
+  candidates_.clear();
+  log_probs_.clear();
+  beam_frames_ = {};
+  beam_predictions_ = {};
+  beam_logits_ = {};
+  beam_arena_.release();
+  beam_ = false;
+  beam_size_ = 1;
+  beam_rows_ = 1;
+  for (auto& side : caches_) {
+    side.clear();
+  }
+  for (auto& side : pred_states_) {
+    side.clear();
+  }
+  cache_output_shapes_.clear();
+  pred_state_shapes_.clear();
+  pred_inputs_.clear();
+  pred_outputs_.clear();
+  primed_outputs_.clear();
+  primed_states_.clear();
+  joint_frame_ = {};
+  logits_ = {};
+  arena_.release();
+  cache_arena_.release();
+  pending_.clear();
+  pending_frames_ = 0;
+  stream_frames_ = 0;
+  lookahead_ = false;
+  lookahead_state_.clear();
+  lookahead_side_ = 0;
+  lookahead_tokens_.clear();
+  lookahead_frames_.clear();
+  cache_side_ = 0;
+  pred_side_ = 0;
+  enc_in_ports_.clear();
+  enc_out_ports_.clear();
+  enc_input_names_.clear();
+  enc_output_names_.clear();
+  pred_in_ports_.clear();
+  pred_out_ports_.clear();
+  pred_input_names_.clear();
+  pred_output_names_.clear();
+  joint_in_ports_.clear();
+  joint_out_ports_.clear();
+  joint_input_names_.clear();
+  joint_output_names_.clear();
+  cache_inputs_.clear();
+  cache_outputs_.clear();
+  pred_state_inputs_.clear();
+  pred_state_outputs_.clear();
+  feature_input_ = no_port;
+  length_input_ = no_port;
+  encoded_length_output_ = no_port;
+  token_input_ = no_port;
+  channels_first_ = false;
+  fixed_frames_ = false;
+  encoder_runs_ = 0;
+  predictor_runs_ = 0;
+  joint_runs_ = 0;
+  cache_hits_ = 0;
+  cache_misses_ = 0;
+  load_ns_ = 0;
+  cached_sessions_ = 0;
+  bytes_allocated_ = 0;
+  bytes_copied_ = 0;
   encoder_.reset();
   predictor_.reset();
   joint_.reset();
+  bundle_.reset(); // after the sessions, which may read initializers from its mapping
 }
 
-void onnx_rnnt_backend::append_execution_providers(Ort::SessionOptions& options, const ep_prefs& prefs) {
-  for (const auto& provider : prefs.providers) {
-    if (provider == "TensorRT" || provider == "Tensorrt" || provider == "TRT") {
-#if defined(ORT_API_VERSION)
-      try {
-        OrtTensorRTProviderOptionsV2 trt_options{};
-        Ort::ThrowOnError(OrtSessionOptionsAppendExecutionProvider_TensorRT_V2(options, &trt_options));
-      } catch (...) {
-        // Ignore failures and fall back to next provider.
-      }
-#endif
-    } else if (provider == "CUDA" || provider == "Cuda") {
-      try {
-        OrtCUDAProviderOptions cuda_options{};
-        Ort::ThrowOnError(OrtSessionOptionsAppendExecutionProvider_CUDA(options, &cuda_options));
-      } catch (...) {
-        // Ignore failures; ONNX Runtime will fall back to CPU.
+bool onnx_rnnt_backend::collect_profile(rnnt_profile& out) noexcept {
+  if (!profiling_) {
+    return false;
+  }
+  profiling_ = false;
+  const std::array<std::tuple<Ort::Session*, session_profile*, session_placement*>, 3> sessions{
+    std::tuple{ encoder_.get(), &out.encoder, &placement_.encoder },
+    std::tuple{ predictor_.get(), &out.predictor, &placement_.predictor },
+    std::tuple{ joint_.get(), &out.joint, &placement_.joint }
+  };
+  bool complete = true;
+  for (const auto& [session, profile, placement] : sessions) {
+    try {
+      const std::string trace = end_profiling(*session, *profile, keep_traces_);
+      placement->nodes = profile->nodes;
+      if (!trace.empty()) {
+        out.files.push_back(trace);
       }
-    } else if (provider == "CPU" || provider == "Cpu") {
-      // CPU is the default provider; nothing to append.
+    } catch (...) {
+      complete = false;
     }
   }
+  return complete;
+}
+
+rnnt_stats onnx_rnnt_backend::stats() const noexcept {
+  rnnt_stats out{};
+  out.encoder_runs = encoder_runs_;
+  out.predictor_runs = predictor_runs_;
+  out.joint_runs = joint_runs_;
+  out.predictor_cache_hits = cache_hits_;
+  out.predictor_cache_misses = cache_misses_;
+  out.arena_bytes = arena_.reserved_bytes() + cache_arena_.reserved_bytes() + beam_arena_.reserved_bytes();
+  for (const auto& plan : plans_) {
+    out.arena_bytes += plan.arena.reserved_bytes();
+  }
+  out.bytes_allocated = bytes_allocated_;
+  out.bytes_copied = bytes_copied_;
+  out.load_ns = load_ns_;
+  out.cached_sessions = cached_sessions_;
+  return out;
 }
 
 #endif // defined(JAXIE_USE_ONNXRUNTIME)
@@ -180,11 +2097,125 @@ struct streaming_rnnt::impl : detail::rnnt_impl<detail::selected_backend> {
   using base::base;
 };
 
-streaming_rnnt::streaming_rnnt() = default;
+// One background thread per prepared swap: it loads the replacement, hands it over under mutex_ and, once
+// commit_swap() has exchanged it for the serving model, destroys the retired one. A cancel only flags the
+// worker, which drops its replacement itself once the load returns.
+struct streaming_rnnt::swapper {
+  swapper() = default;
+  ~swapper() { stop(); }
+
+  swapper(const swapper&) = delete;
+  swapper& operator=(const swapper&) = delete;
+  swapper(swapper&&) = delete;
+  swapper& operator=(swapper&&) = delete;
+
+  // Any thread; never waits.
+  void cancel() noexcept {
+    {
+      const std::lock_guard lock(mutex_);
+      cancelled_ = true;
+      state_.store(swap_state::idle, std::memory_order_release);
+    }
+    wake_.notify_all();
+  }
+
+  // Cancels and waits for the worker, which may still be loading.
+  void stop() noexcept {
+    const std::lock_guard control(control_mutex_);
+    join();
+  }
+
+  bool start(const rnnt_model_paths& paths, const ep_prefs& prefs, const rnnt_options& options) {
+    const std::lock_guard control(control_mutex_);
+    join();
+    {
+      const std::lock_guard lock(mutex_);
+      cancelled_ = false;
+      committed_ = false;
+      state_.store(swap_state::loading, std::memory_order_release);
+    }
+    try {
+      launch(paths, prefs, options);
+    } catch (...) {
+      state_.store(swap_state::failed, std::memory_order_release);
+      return false;
+    }
+    return true;
+  }
+
+  // Stepping thread. Never blocks: a worker holding the lock means the swap is not ready yet.
+  bool commit(std::unique_ptr<impl>& serving) noexcept {
+    if (state_.load(std::memory_order_acquire) != swap_state::ready) {
+      return false;
+    }
+    std::unique_lock lock(mutex_, std::try_to_lock);
+    if (!lock.owns_lock() || next_ == nullptr || committed_ || cancelled_) {
+      return false;
+    }
+    serving.swap(next_);
+    committed_ = true;
+    lock.unlock();
+    wake_.notify_one();
+    return true;
+  }
+
+  swap_state state() const noexcept { return state_.load(std::memory_order_acquire); }
+
+private:
+  // Callers hold control_mutex_.
+  void join() noexcept {
+    cancel();
+    if (worker_.joinable()) {
+      worker_.join();
+    }
+  }
+
+  void launch(const rnnt_model_paths& paths, const ep_prefs& prefs, const rnnt_options& options) {
+    worker_ = std::thread([this, paths, prefs, options] {
+      std::unique_ptr<impl> replacement;
+      bool loaded = false;
+      try {
+        replacement = std::make_unique<impl>();
+        loaded = replacement->load(paths, prefs, options);
+      } catch (...) {
+        loaded = false;
+      }
+      std::unique_lock lock(mutex_);
+      if (!loaded || cancelled_) {
+        if (!cancelled_) {
+          state_.store(swap_state::failed, std::memory_order_release);
+        }
+        lock.unlock();
+        return; // replacement goes here, on this thread
+      }
+      next_ = std::move(replacement);
+      state_.store(swap_state::ready, std::memory_order_release);
+      wake_.wait(lock, [this] { return committed_ || cancelled_; });
+      // The retired model after a commit, the unused replacement after a cancel.
+      std::unique_ptr<impl> retired = std::move(next_);
+      state_.store(swap_state::idle, std::memory_order_release);
+      lock.unlock();
+      retired.reset();
+    });
+  }
+
+  std::mutex control_mutex_; // serializes start() and stop(), which own worker_
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::thread worker_;
+  std::unique_ptr<impl> next_{}; // guarded by mutex_
+  bool committed_{false};        // guarded by mutex_
+  bool cancelled_{false};        // guarded by mutex_
+  std::atomic<swap_state> state_{swap_state::idle};
+};
+
+// The swapper lives as long as the stream, so commit_swap() and cancel_swap() on other threads never see it
+// being created.
+streaming_rnnt::streaming_rnnt() : swap_(std::make_unique<swapper>()) {}
 streaming_rnnt::~streaming_rnnt() = default;
 
 streaming_rnnt::streaming_rnnt(streaming_rnnt&& other) noexcept
-  : pimpl_(std::move(other.pimpl_)), loaded_(other.loaded_) {
+  : pimpl_(std::move(other.pimpl_)), swap_(std::move(other.swap_)), loaded_(other.loaded_) {
   other.loaded_ = false;
 }
 
@@ -193,13 +2224,14 @@ streaming_rnnt& streaming_rnnt::operator=(streaming_rnnt&& other) noexcept {
     return *this;
   }
 
+  swap_ = std::move(other.swap_);
   pimpl_ = std::move(other.pimpl_);
   loaded_ = other.loaded_;
   other.loaded_ = false;
   return *this;
 }
 
-bool streaming_rnnt::load(const rnnt_model_paths& paths, const ep_prefs& prefs) noexcept {
+bool streaming_rnnt::load(const rnnt_model_paths& paths, const ep_prefs& prefs, const rnnt_options& options) noexcept {
   if (!pimpl_) {
     try {
       pimpl_ = std::make_unique<impl>();
@@ -209,7 +2241,7 @@ bool streaming_rnnt::load(const rnnt_model_paths& paths, const ep_prefs& prefs)
     }
   }
 
-  if (!pimpl_->load(paths, prefs)) {
+  if (!pimpl_->load(paths, prefs, options)) {
     loaded_ = false;
     return false;
   }
@@ -218,6 +2250,23 @@ bool streaming_rnnt::load(const rnnt_model_paths& paths, const ep_prefs& prefs)
   return true;
 }
 
+bool streaming_rnnt::load_shared(const streaming_rnnt& source, const rnnt_options& options) noexcept {
+  if (&source == this || !source.loaded_ || !source.pimpl_) {
+    return false;
+  }
+  if (!pimpl_) {
+    try {
+      pimpl_ = std::make_unique<impl>();
+    } catch (...) {
+      loaded_ = false;
+      return false;
+    }
+  }
+
+  loaded_ = pimpl_->share(*source.pimpl_, options);
+  return loaded_;
+}
+
 bool streaming_rnnt::step(std::span<const float> audio_chunk, std::vector<int32_t>& emitted_tokens) const noexcept {
   if (!loaded_ || !pimpl_) {
     return false;
@@ -226,6 +2275,42 @@ bool streaming_rnnt::step(std::span<const float> audio_chunk, std::vector<int32_
   return pimpl_->step(audio_chunk, emitted_tokens);
 }
 
+bool streaming_rnnt::step_window(
+  std::span<const float> window,
+  uint32_t left_frames,
+  uint32_t right_frames,
+  std::vector<int32_t>& emitted_tokens) const noexcept {
+  if (!loaded_ || !pimpl_) {
+    return false;
+  }
+
+  return pimpl_->step_window(window, left_frames, right_frames, emitted_tokens);
+}
+
+bool streaming_rnnt::finish(std::vector<int32_t>& emitted_tokens) const noexcept {
+  if (!loaded_ || !pimpl_) {
+    return false;
+  }
+
+  return pimpl_->finish(emitted_tokens);
+}
+
+std::span<const uint32_t> streaming_rnnt::token_frames() const noexcept {
+  if (!pimpl_) {
+    return {};
+  }
+
+  return pimpl_->token_frames();
+}
+
+rnnt_partial streaming_rnnt::partial() const noexcept {
+  if (!loaded_ || !pimpl_) {
+    return {};
+  }
+
+  return pimpl_->partial();
+}
+
 void streaming_rnnt::reset_state() noexcept {
   if (!pimpl_) {
     return;
@@ -234,4 +2319,121 @@ void streaming_rnnt::reset_state() noexcept {
   pimpl_->reset();
 }
 
+rnnt_stats streaming_rnnt::stats() const noexcept {
+  if (!pimpl_) {
+    return {};
+  }
+
+  return pimpl_->stats();
+}
+
+const rnnt_placement& streaming_rnnt::placement() const noexcept {
+  static const rnnt_placement none{};
+  if (!pimpl_) {
+    return none;
+  }
+
+  return pimpl_->placement();
+}
+
+bool streaming_rnnt::collect_profile(rnnt_profile& out) noexcept {
+  if (!pimpl_) {
+    out = {};
+    return false;
+  }
+
+  return pimpl_->collect_profile(out);
+}
+
+bool streaming_rnnt::start_pipeline(rnnt_tokens_callback on_tokens, const rnnt_pipeline_options& options) noexcept {
+  if (!loaded_ || !pimpl_) {
+    return false;
+  }
+
+  return pimpl_->start_pipeline(std::move(on_tokens), options);
+}
+
+bool streaming_rnnt::submit(std::span<const float> audio) noexcept {
+  if (!loaded_ || !pimpl_) {
+    return false;
+  }
+
+  return pimpl_->submit(audio);
+}
+
+bool streaming_rnnt::submit_boundary() noexcept {
+  if (!loaded_ || !pimpl_) {
+    return false;
+  }
+
+  return pimpl_->submit_boundary();
+}
+
+void streaming_rnnt::stop_pipeline() noexcept {
+  if (!pimpl_) {
+    return;
+  }
+
+  pimpl_->stop_pipeline();
+}
+
+rnnt_pipeline_stats streaming_rnnt::pipeline_stats() const noexcept {
+  if (!pimpl_) {
+    return {};
+  }
+
+  return pimpl_->pipeline_stats();
+}
+
+bool streaming_rnnt::prepare_swap(
+  const rnnt_model_paths& paths,
+  const ep_prefs& prefs,
+  const rnnt_options& options) noexcept {
+  if (!swap_) {
+    return false; // moved from
+  }
+  try {
+    return swap_->start(paths, prefs, options);
+  } catch (...) {
+    return false;
+  }
+}
+
+bool streaming_rnnt::commit_swap() noexcept {
+  if (!swap_ || (pimpl_ && pimpl_->is_pipelined())) {
+    return false;
+  }
+
+  if (!swap_->commit(pimpl_)) {
+    return false;
+  }
+  loaded_ = true;
+  return true;
+}
+
+void streaming_rnnt::cancel_swap() noexcept {
+  if (!swap_) {
+    return;
+  }
+
+  swap_->cancel();
+}
+
+swap_state streaming_rnnt::swap_status() const noexcept {
+  if (!swap_) {
+    return swap_state::idle;
+  }
+
+  return swap_->state();
+}
+
+bool configure_runtime(const runtime_config& config) noexcept {
+#if defined(JAXIE_USE_ONNXRUNTIME)
+  return detail::configure_shared_runtime(config);
+#else
+  static_cast<void>(config);
+  return false;
+#endif
+}
+
 } // namespace jaxie::onnx
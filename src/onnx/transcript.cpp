@@ -0,0 +1,261 @@
+#include <Jaxie/onnx/transcript.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <utility>
+
+namespace jaxie::onnx {
+namespace {
+
+constexpr std::string_view word_marker = "\xE2\x96\x81"; // U+2581, SentencePiece's word boundary
+
+int hex_digit(char c) noexcept {
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  }
+  if (c >= 'A' && c <= 'F') {
+    return c - 'A' + 10;
+  }
+  if (c >= 'a' && c <= 'f') {
+    return c - 'a' + 10;
+  }
+  return -1;
+}
+
+void render_piece(std::string_view piece, std::string& out) {
+  if (piece.size() == 6 && piece.starts_with("<0x") && piece.ends_with('>')) {
+    const int high = hex_digit(piece[3]);
+    const int low = hex_digit(piece[4]);
+    if (high >= 0 && low >= 0) {
+      out.push_back(static_cast<char>((high * 16) + low));
+      return;
+    }
+  }
+  if (piece.size() > 2 && piece.starts_with('<') && piece.ends_with('>')) {
+    return; // control and special tokens
+  }
+  while (!piece.empty()) {
+    const size_t marker = piece.find(word_marker);
+    out.append(piece.substr(0, marker));
+    if (marker == std::string_view::npos) {
+      return;
+    }
+    out.push_back(' ');
+    piece.remove_prefix(marker + word_marker.size());
+  }
+}
+
+} // namespace
+
+bool detokenizer::load(std::span<const std::string_view> pieces) noexcept {
+  text_.clear();
+  offsets_.clear();
+  try {
+    offsets_.reserve(pieces.size() + 1);
+    offsets_.push_back(0);
+    for (const auto piece : pieces) {
+      render_piece(piece, text_);
+      offsets_.push_back(static_cast<uint32_t>(text_.size()));
+    }
+  } catch (...) {
+    text_.clear();
+    offsets_.clear();
+    return false;
+  }
+  return !pieces.empty();
+}
+
+bool detokenizer::load_file(const std::string& path) noexcept {
+  try {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+      return false;
+    }
+    const std::string contents((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    std::vector<std::string_view> pieces;
+    std::string_view text = contents;
+    while (!text.empty()) {
+      const size_t end = (std::min)(text.find('\n'), text.size());
+      std::string_view line = text.substr(0, end);
+      line = line.substr(0, (std::min)(line.find('\t'), line.size()));
+      if (line.ends_with('\r')) {
+        line.remove_suffix(1);
+      }
+      pieces.push_back(line);
+      text.remove_prefix((std::min)(end + 1, text.size()));
+    }
+    return load(pieces);
+  } catch (...) {
+    return false;
+  }
+}
+
+std::string_view detokenizer::piece(int32_t id) const noexcept {
+  if (id < 0 || static_cast<size_t>(id) >= size()) {
+    return {};
+  }
+  const auto index = static_cast<size_t>(id);
+  return std::string_view(text_).substr(offsets_[index], offsets_[index + 1] - offsets_[index]);
+}
+
+void detokenizer::append(std::span<const int32_t> tokens, std::string& out) const {
+  for (const int32_t token : tokens) {
+    std::string_view text = piece(token);
+    if (out.empty() && text.starts_with(' ')) {
+      text.remove_prefix(1);
+    }
+    out.append(text);
+  }
+}
+
+bool transcript_stabilizer::init(const detokenizer& vocab, const transcript_options& options) noexcept {
+  if (vocab.size() == 0 || options.features.sample_rate_hz == 0) {
+    return false;
+  }
+  vocab_ = &vocab;
+  options_ = options;
+  try {
+    stable_.reserve(options.reserve_tokens);
+    pending_.reserve(options.reserve_tokens);
+    display_.reserve(options.reserve_bytes);
+    tail_.reserve(options.reserve_bytes);
+  } catch (...) {
+    vocab_ = nullptr;
+    return false;
+  }
+  stats_ = {};
+  reset();
+  return true;
+}
+
+const transcript_update& transcript_stabilizer::update(
+  std::span<const int32_t> tokens,
+  std::span<const uint32_t> frames,
+  const rnnt_partial& partial) noexcept {
+  return apply(tokens, frames, partial, false);
+}
+
+const transcript_update& transcript_stabilizer::update(
+  const streaming_rnnt& rnnt,
+  std::span<const int32_t> tokens) noexcept {
+  return apply(tokens, rnnt.token_frames(), rnnt.partial(), false);
+}
+
+const transcript_update& transcript_stabilizer::finish(
+  std::span<const int32_t> tokens,
+  std::span<const uint32_t> frames) noexcept {
+  return apply(tokens, frames, {}, true);
+}
+
+void transcript_stabilizer::reset() noexcept {
+  stable_.clear();
+  pending_.clear();
+  display_.clear();
+  tail_.clear();
+  stable_bytes_ = 0;
+  update_ = {};
+  stats_.first_partial_ns = 0;
+  started_ = std::chrono::steady_clock::now();
+}
+
+timed_token transcript_stabilizer::timed(int32_t id, uint32_t frame) const noexcept {
+  const uint64_t ms = (uint64_t{ frame } * options_.features.hop_frames * 1000U) / options_.features.sample_rate_hz;
+  return { id, frame, static_cast<uint32_t>(ms) };
+}
+
+void transcript_stabilizer::render(std::span<const timed_token> tokens, bool at_start) {
+  for (const auto& token : tokens) {
+    std::string_view text = vocab_->piece(token.id);
+    if (at_start && tail_.empty() && text.starts_with(' ')) {
+      text.remove_prefix(1);
+    }
+    tail_.append(text);
+  }
+}
+
+const transcript_update& transcript_stabilizer::apply(
+  std::span<const int32_t> tokens,
+  std::span<const uint32_t> frames,
+  const rnnt_partial& partial,
+  bool final) noexcept {
+  if (vocab_ == nullptr) {
+    update_ = {};
+    return update_;
+  }
+  const auto capacities = [this] {
+    return std::array{ stable_.capacity(), pending_.capacity(), display_.capacity(), tail_.capacity() };
+  };
+  const auto before = capacities();
+  const size_t old_stable_tokens = stable_.size();
+  const size_t old_stable_bytes = stable_bytes_;
+  const size_t old_pending = pending_.size();
+  try {
+    for (size_t i = 0; i < tokens.size(); ++i) {
+      stable_.push_back(timed(tokens[i], i < frames.size() ? frames[i] : 0));
+    }
+    // Pending tokens that neither became stable nor are still pending were withdrawn.
+    const auto next_id = [&](size_t i) {
+      return i < tokens.size() ? tokens[i] : partial.tokens[i - tokens.size()];
+    };
+    size_t kept = 0;
+    while (kept < old_pending && kept < tokens.size() + partial.tokens.size() && pending_[kept].id == next_id(kept)) {
+      ++kept;
+    }
+    stats_.withdrawn_tokens += old_pending - kept;
+    pending_.clear();
+    for (size_t i = 0; i < partial.tokens.size(); ++i) {
+      pending_.push_back(timed(partial.tokens[i], i < partial.frames.size() ? partial.frames[i] : 0));
+    }
+
+    // Everything past the old stable prefix is rebuilt in tail_ and diffed against what is displayed.
+    tail_.clear();
+    const bool at_start = old_stable_bytes == 0;
+    render(std::span<const timed_token>(stable_).subspan(old_stable_tokens), at_start);
+    stable_bytes_ = old_stable_bytes + tail_.size();
+    render(pending_, at_start);
+    const std::string_view old_tail = std::string_view(display_).substr(old_stable_bytes);
+    size_t common = static_cast<size_t>(
+      std::mismatch(old_tail.begin(), old_tail.end(), tail_.begin(), tail_.end()).first - old_tail.begin());
+    // Pieces that start with the same lead byte diverge inside a character; diff from its first byte instead.
+    const auto continues = [](std::string_view text, size_t at) {
+      return at < text.size() && (static_cast<unsigned char>(text[at]) & 0xC0U) == 0x80U;
+    };
+    while (common > 0 && (continues(old_tail, common) || continues(tail_, common))) {
+      --common;
+    }
+    update_.erase = old_tail.size() - common;
+    display_.resize(old_stable_bytes + common);
+    display_.append(std::string_view(tail_).substr(common));
+    update_.append = std::string_view(display_).substr(old_stable_bytes + common);
+  } catch (...) {
+    stable_.resize(old_stable_tokens);
+    pending_.clear();
+    stable_bytes_ = (std::min)(old_stable_bytes, display_.size());
+    update_ = {};
+    return update_;
+  }
+  update_.stable_bytes = stable_bytes_;
+  update_.stabilized = std::span<const timed_token>(stable_).subspan(old_stable_tokens);
+  update_.pending = pending_;
+  update_.final = final;
+
+  ++stats_.updates;
+  stats_.stable_tokens += tokens.size();
+  if (stats_.first_partial_ns == 0 && !display_.empty()) {
+    stats_.first_partial_ns = static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - started_).count());
+  }
+  const auto after = capacities();
+  stats_.last_update_allocations = 0;
+  for (size_t i = 0; i < after.size(); ++i) {
+    stats_.last_update_allocations += after[i] != before[i] ? 1U : 0U;
+  }
+  stats_.allocations += stats_.last_update_allocations;
+  return update_;
+}
+
+} // namespace jaxie::onnx
@@ -0,0 +1,204 @@
+#include <Jaxie/onnx/vad_gate.hpp>
+#include <Jaxie/realtime/latency_trace.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <utility>
+
+namespace jaxie::onnx {
+
+bool vad_gate::init(const vad_gate_config& config, speech_callback on_speech, boundary_callback on_utterance_end) noexcept {
+  if (!on_speech || !detector_.init(config.detector)) {
+    return false;
+  }
+  config_ = config;
+  on_speech_ = std::move(on_speech);
+  on_utterance_end_ = std::move(on_utterance_end);
+
+  const uint64_t rate = config.detector.sample_rate_hz;
+  onset_samples_ = (rate * config.onset_ms) / 1000;
+  hangover_samples_ = (rate * config.hangover_ms) / 1000;
+  // The periods that triggered the onset are always part of the replay.
+  const uint64_t pre_roll = (std::max)((rate * config.pre_roll_ms) / 1000, onset_samples_ + config.detector.max_period_frames);
+
+  if (!config.model_path.empty()) {
+    if (config.model_window_frames == 0
+        || !model_.load(config.model_path, config.model_prefs, config.detector.sample_rate_hz)) {
+      return false;
+    }
+  }
+
+  try {
+    pre_roll_.assign(static_cast<size_t>(pre_roll), 0.0F);
+    model_window_.assign(config.model_path.empty() ? 0 : config.model_window_frames, 0.0F);
+  } catch (...) {
+    return false;
+  }
+
+  reset();
+  return true;
+}
+
+bool vad_gate::init(const vad_gate_config& config, streaming_rnnt& rnnt, token_callback on_tokens) noexcept {
+  try {
+    tokens_.reserve(64);
+    auto on_speech = [this, &rnnt, on_tokens](std::span<const float> audio) {
+      if (rnnt.step(audio, tokens_) && !tokens_.empty() && on_tokens) {
+        on_tokens(tokens_);
+      }
+    };
+    // Beam search holds back its undecided tail until the utterance ends.
+    auto on_boundary = [this, &rnnt, on_tokens = std::move(on_tokens)]() {
+      if (rnnt.finish(tokens_) && !tokens_.empty() && on_tokens) {
+        on_tokens(tokens_);
+      }
+      rnnt.reset_state();
+      // A replacement prepared with prepare_swap() takes over between utterances.
+      static_cast<void>(rnnt.commit_swap());
+    };
+    return init(config, std::move(on_speech), std::move(on_boundary));
+  } catch (...) {
+    return false;
+  }
+}
+
+void vad_gate::reset() noexcept {
+  detector_.reset();
+  model_.reset_state();
+  pre_roll_head_ = 0;
+  pre_roll_count_ = 0;
+  model_fill_ = 0;
+  model_window_voiced_ = false;
+  model_probability_ = 0.0F;
+  onset_run_ = 0;
+  silence_run_ = 0;
+  active_ = false;
+  stats_ = {};
+}
+
+void vad_gate::process(std::span<const float> period) noexcept {
+  if (!on_speech_ || period.empty()) {
+    return;
+  }
+
+  const bool speech = is_speech(period);
+  ++stats_.periods;
+  stats_.total_frames += period.size();
+  if (speech) {
+    ++stats_.speech_periods;
+  }
+
+  if (!active_) {
+    push_pre_roll(period);
+    onset_run_ = speech ? onset_run_ + period.size() : 0;
+    if (onset_run_ >= onset_samples_) {
+      active_ = true;
+      silence_run_ = 0;
+      flush_pre_roll(period.size());
+    }
+    return;
+  }
+
+  forward(period);
+  silence_run_ = speech ? 0 : silence_run_ + period.size();
+  if (silence_run_ >= hangover_samples_) {
+    close_utterance();
+  }
+}
+
+bool vad_gate::is_speech(std::span<const float> period) noexcept {
+  const bool energetic = detector_.process(period).speech;
+  if (!model_.is_loaded()) {
+    return energetic;
+  }
+
+  // The model only runs on windows in which the energy detector fired, so idle rooms cost no inference.
+  model_window_voiced_ = model_window_voiced_ || energetic;
+  while (!period.empty()) {
+    const size_t take = (std::min)(period.size(), model_window_.size() - model_fill_);
+    std::copy_n(period.begin(), take, model_window_.begin() + static_cast<std::ptrdiff_t>(model_fill_));
+    model_fill_ += take;
+    period = period.subspan(take);
+    if (model_fill_ < model_window_.size()) {
+      break;
+    }
+    if (model_window_voiced_) {
+      ++stats_.model_calls;
+      model_probability_ = (std::max)(model_.score(model_window_), 0.0F);
+    } else {
+      model_probability_ = 0.0F;
+    }
+    model_fill_ = 0;
+    model_window_voiced_ = energetic;
+  }
+  return energetic && model_probability_ >= config_.model_threshold;
+}
+
+void vad_gate::push_pre_roll(std::span<const float> period) noexcept {
+  const size_t capacity = pre_roll_.size();
+  if (period.size() > capacity) {
+    period = period.last(capacity);
+  }
+  for (const float sample : period) {
+    pre_roll_[(pre_roll_head_ + pre_roll_count_) % capacity] = sample;
+    if (pre_roll_count_ < capacity) {
+      ++pre_roll_count_;
+    } else {
+      pre_roll_head_ = (pre_roll_head_ + 1) % capacity;
+    }
+  }
+}
+
+void vad_gate::flush_pre_roll(size_t period_frames) noexcept {
+  const size_t capacity = pre_roll_.size();
+  const size_t first = (std::min)(pre_roll_count_, capacity - pre_roll_head_);
+  const std::span<const float> ring(pre_roll_);
+  // The pre-roll ends with the current period, so when it is traced its replay starts pre_roll_count_ samples
+  // before that period's end.
+  const uint64_t origin = realtime::trace_origin();
+  const bool traced = origin != realtime::no_trace_sample;
+  if (traced) {
+    realtime::set_trace_origin(origin + period_frames - pre_roll_count_);
+  }
+  forward(ring.subspan(pre_roll_head_, first));
+  if (pre_roll_count_ > first) {
+    if (traced) {
+      realtime::set_trace_origin(origin + period_frames - pre_roll_count_ + first);
+    }
+    forward(ring.first(pre_roll_count_ - first));
+  }
+  realtime::set_trace_origin(origin);
+  pre_roll_head_ = 0;
+  pre_roll_count_ = 0;
+}
+
+void vad_gate::forward(std::span<const float> audio) noexcept {
+  if (audio.empty()) {
+    return;
+  }
+  stats_.forwarded_frames += audio.size();
+  try {
+    on_speech_(audio);
+  } catch (...) {
+    // The recognizer must not take down the capture thread.
+  }
+}
+
+void vad_gate::close_utterance() noexcept {
+  active_ = false;
+  onset_run_ = 0;
+  silence_run_ = 0;
+  ++stats_.utterances;
+  model_.reset_state();
+  if (on_utterance_end_) {
+    try {
+      on_utterance_end_();
+    } catch (...) {
+      // See forward().
+    }
+  }
+}
+
+} // namespace jaxie::onnx
@@ -0,0 +1,216 @@
+#include <Jaxie/onnx/vad_model.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(JAXIE_USE_ONNXRUNTIME)
+#include "ort_tensors.hpp"
+
+#include <onnxruntime_cxx_api.h>
+#endif
+
+namespace jaxie::onnx {
+namespace detail {
+
+struct null_vad_backend {
+  bool load(const std::string& path, const ep_prefs& prefs, uint32_t sample_rate_hz) noexcept {
+    static_cast<void>(path);
+    static_cast<void>(prefs);
+    static_cast<void>(sample_rate_hz);
+    return false;
+  }
+
+  float score(std::span<const float> window) noexcept {
+    static_cast<void>(window);
+    return -1.0F;
+  }
+
+  void reset() noexcept {}
+};
+
+#if defined(JAXIE_USE_ONNXRUNTIME)
+
+class onnx_vad_backend {
+public:
+  bool load(const std::string& path, const ep_prefs& prefs, uint32_t sample_rate_hz) noexcept {
+    static_cast<void>(prefs); // the model is tiny; CPU avoids a device round trip per 10 ms period
+    session_.reset();
+    states_.clear();
+    sample_rate_input_ = 0;
+    try {
+      Ort::SessionOptions options{};
+      options.SetIntraOpNumThreads(1);
+      options.SetInterOpNumThreads(1);
+      session_ = std::make_unique<Ort::Session>(shared_env(), path.c_str(), options);
+
+      Ort::AllocatorWithDefaultOptions allocator;
+      const size_t inputs = session_->GetInputCount();
+      const size_t outputs = session_->GetOutputCount();
+      input_names_.clear();
+      output_names_.clear();
+      for (size_t i = 0; i < inputs; ++i) {
+        input_names_.emplace_back(session_->GetInputNameAllocated(i, allocator).get());
+      }
+      for (size_t i = 0; i < outputs; ++i) {
+        output_names_.emplace_back(session_->GetOutputNameAllocated(i, allocator).get());
+      }
+
+      for (size_t i = 1; i < inputs; ++i) {
+        const auto info = session_->GetInputTypeInfo(i).GetTensorTypeAndShapeInfo();
+        if (info.GetElementType() == ONNX_TENSOR_ELEMENT_DATA_TYPE_INT64) {
+          sample_rate_input_ = i;
+          continue;
+        }
+        recurrent_state state{};
+        state.shape = info.GetShape();
+        size_t count = 1;
+        for (auto& dim : state.shape) {
+          dim = dim < 0 ? 1 : dim; // batch and other dynamic dims are 1 for a single stream
+          count *= static_cast<size_t>(dim);
+        }
+        state.values.assign(count, 0.0F);
+        states_.push_back(std::move(state));
+      }
+      if (outputs < states_.size() + 1) {
+        session_.reset();
+        return false;
+      }
+      input_ptrs_.clear();
+      output_ptrs_.clear();
+      for (const auto& name : input_names_) {
+        input_ptrs_.push_back(name.c_str());
+      }
+      for (size_t i = 0; i <= states_.size(); ++i) {
+        output_ptrs_.push_back(output_names_[i].c_str());
+      }
+    } catch (...) {
+      session_.reset();
+      return false;
+    }
+    sample_rate_ = sample_rate_hz;
+    return true;
+  }
+
+  float score(std::span<const float> window) noexcept {
+    if (session_ == nullptr) {
+      return -1.0F;
+    }
+    try {
+      const Ort::MemoryInfo memory = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
+      std::vector<Ort::Value> inputs;
+      inputs.reserve(input_ptrs_.size());
+      const std::array<int64_t, 2> audio_shape{ 1, static_cast<int64_t>(window.size()) };
+      inputs.push_back(Ort::Value::CreateTensor<float>(
+        memory, const_cast<float*>(window.data()), window.size(), audio_shape.data(), audio_shape.size())); // NOLINT(*-const-cast)
+
+      size_t next_state = 0;
+      for (size_t i = 1; i < input_ptrs_.size(); ++i) {
+        if (i == sample_rate_input_) {
+          inputs.push_back(Ort::Value::CreateTensor<int64_t>(memory, &sample_rate_, 1, nullptr, 0));
+        } else {
+          auto& state = states_[next_state++];
+          inputs.push_back(Ort::Value::CreateTensor<float>(
+            memory, state.values.data(), state.values.size(), state.shape.data(), state.shape.size()));
+        }
+      }
+
+      auto outputs = session_->Run(
+        Ort::RunOptions{ nullptr }, input_ptrs_.data(), inputs.data(), inputs.size(), output_ptrs_.data(), output_ptrs_.size());
+      for (size_t i = 0; i < states_.size(); ++i) {
+        const float* updated = outputs[i + 1].GetTensorData<float>();
+        std::copy_n(updated, states_[i].values.size(), states_[i].values.begin());
+      }
+      return std::clamp(outputs[0].GetTensorData<float>()[0], 0.0F, 1.0F);
+    } catch (...) {
+      return -1.0F;
+    }
+  }
+
+  void reset() noexcept {
+    for (auto& state : states_) {
+      std::fill(state.values.begin(), state.values.end(), 0.0F);
+    }
+  }
+
+private:
+  struct recurrent_state {
+    std::vector<int64_t> shape;
+    std::vector<float> values;
+  };
+
+  std::unique_ptr<Ort::Session> session_{};
+  std::vector<std::string> input_names_;
+  std::vector<std::string> output_names_;
+  std::vector<const char*> input_ptrs_;
+  std::vector<const char*> output_ptrs_;
+  std::vector<recurrent_state> states_;
+  size_t sample_rate_input_{0}; // 0 means the model has no sample-rate input
+  int64_t sample_rate_{16000};
+};
+
+using selected_vad_backend = onnx_vad_backend;
+#else
+using selected_vad_backend = null_vad_backend;
+#endif
+
+} // namespace detail
+
+struct vad_model::impl {
+  detail::selected_vad_backend backend{};
+};
+
+vad_model::vad_model() = default;
+vad_model::~vad_model() = default;
+
+vad_model::vad_model(vad_model&& other) noexcept
+  : pimpl_(std::move(other.pimpl_)), loaded_(other.loaded_) {
+  other.loaded_ = false;
+}
+
+vad_model& vad_model::operator=(vad_model&& other) noexcept {
+  if (this == &other) {
+    return *this;
+  }
+
+  pimpl_ = std::move(other.pimpl_);
+  loaded_ = other.loaded_;
+  other.loaded_ = false;
+  return *this;
+}
+
+bool vad_model::load(const std::string& path, const ep_prefs& prefs, uint32_t sample_rate_hz) noexcept {
+  loaded_ = false;
+  if (!pimpl_) {
+    try {
+      pimpl_ = std::make_unique<impl>();
+    } catch (...) {
+      return false;
+    }
+  }
+
+  loaded_ = pimpl_->backend.load(path, prefs, sample_rate_hz);
+  return loaded_;
+}
+
+float vad_model::score(std::span<const float> window) noexcept {
+  if (!loaded_ || !pimpl_) {
+    return -1.0F;
+  }
+  return pimpl_->backend.score(window);
+}
+
+void vad_model::reset_state() noexcept {
+  if (!pimpl_) {
+    return;
+  }
+  pimpl_->backend.reset();
+}
+
+} // namespace jaxie::onnx
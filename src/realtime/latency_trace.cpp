@@ -0,0 +1,399 @@
+#include <Jaxie/realtime/latency_trace.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+namespace jaxie::realtime {
+namespace detail {
+  std::atomic<bool> tracing_on{false};
+} // namespace detail
+
+namespace {
+
+// One thread's events. Only the bound thread writes and advances `written`; drain_trace() advances `read` under
+// the registry mutex, so each side's counter has a single writer.
+struct thread_buffer {
+  enum class state : uint8_t { spare, bound, retired };
+
+  thread_buffer(uint32_t events, uint32_t thread)
+    : ring(std::make_unique<trace_event[]>(events)), capacity(events), id(thread) {} // NOLINT(*-avoid-c-arrays)
+
+  std::unique_ptr<trace_event[]> ring; // NOLINT(*-avoid-c-arrays)
+  uint32_t capacity;
+  uint32_t id;
+  alignas(64) std::atomic<uint64_t> written{0};
+  std::atomic<uint64_t> dropped{0};
+  std::atomic<uint32_t> writers{0};  // record() calls between their session check and their last write
+  std::atomic<uint64_t> session{0};  // the tracing session it was bound in
+  std::atomic<state> status{state::spare};
+  alignas(64) std::atomic<uint64_t> read{0};
+};
+
+constexpr size_t max_spare_buffers = 16;
+
+struct registry {
+  std::mutex mutex;
+  std::vector<std::unique_ptr<thread_buffer>> buffers;
+  // Reserved buffers not yet bound to a thread; a thread's first event in a session takes one with an exchange.
+  std::array<std::atomic<thread_buffer*>, max_spare_buffers> spares{};
+  std::atomic<uint32_t> events_per_thread{default_trace_events};
+  std::atomic<uint64_t> unbound_dropped{0}; // events of threads that found no spare
+  uint64_t retired_dropped{0};
+};
+
+registry& trace_registry() {
+  static registry instance;
+  return instance;
+}
+
+// Each enable_tracing() starts a session. A thread's binding lasts for the session it was made in, so buffers of
+// threads that have exited are reclaimed at the next enable_tracing() without a thread-exit hook.
+std::atomic<uint64_t> trace_session{1}; // NOLINT(*-avoid-non-const-global-variables)
+
+// A drained retired buffer, else a new one. Caller holds reg.mutex.
+thread_buffer* reuse_or_allocate(registry& reg, uint32_t events) {
+  for (auto& buffer : reg.buffers) {
+    if (buffer->status.load(std::memory_order_relaxed) == thread_buffer::state::retired && buffer->capacity == events
+        && buffer->read.load(std::memory_order_relaxed) == buffer->written.load(std::memory_order_acquire)) {
+      reg.retired_dropped += buffer->dropped.exchange(0, std::memory_order_relaxed);
+      buffer->status.store(thread_buffer::state::spare, std::memory_order_relaxed);
+      return buffer.get();
+    }
+  }
+  reg.buffers.push_back(std::make_unique<thread_buffer>(events, static_cast<uint32_t>(reg.buffers.size())));
+  return reg.buffers.back().get();
+}
+
+// Retires the buffers bound in earlier sessions that no record() is writing to. Caller holds reg.mutex and has
+// just advanced trace_session: a record() that raised `writers` before this load sees it raised and keeps its
+// buffer; one that raises it after re-reads the session, finds its binding stale and does not write.
+void retire_stale(registry& reg, uint64_t session) noexcept {
+  for (auto& buffer : reg.buffers) {
+    if (buffer->status.load(std::memory_order_seq_cst) == thread_buffer::state::bound
+        && buffer->session.load(std::memory_order_relaxed) != session
+        && buffer->writers.load(std::memory_order_seq_cst) == 0) {
+      buffer->status.store(thread_buffer::state::retired, std::memory_order_relaxed);
+    }
+  }
+}
+
+// Lock- and allocation-free: a buffer reserve_trace_buffers() set aside, or nullptr.
+thread_buffer* take_spare() noexcept {
+  for (auto& spare : trace_registry().spares) {
+    if (spare.load(std::memory_order_relaxed) != nullptr) {
+      if (thread_buffer* buffer = spare.exchange(nullptr, std::memory_order_acquire); buffer != nullptr) {
+        return buffer;
+      }
+    }
+  }
+  return nullptr;
+}
+
+// Trivially destructible, so a thread's first event registers no thread-exit destructor (which allocates).
+thread_local thread_buffer* bound_buffer{nullptr};    // NOLINT(*-avoid-non-const-global-variables)
+thread_local uint64_t bound_session{0};               // NOLINT(*-avoid-non-const-global-variables)
+thread_local uint64_t origin_sample{no_trace_sample}; // NOLINT(*-avoid-non-const-global-variables)
+
+uint64_t percentile(const std::vector<uint64_t>& sorted, double fraction) noexcept {
+  const auto rank = static_cast<size_t>(std::ceil(fraction * static_cast<double>(sorted.size())));
+  return sorted[(std::clamp)(rank, size_t{ 1 }, sorted.size()) - 1];
+}
+
+stage_latency reduce(std::string name, std::vector<uint64_t>& samples) {
+  stage_latency out{ .name = std::move(name) };
+  out.count = samples.size();
+  std::sort(samples.begin(), samples.end());
+  out.p50_ns = percentile(samples, 0.50);
+  out.p95_ns = percentile(samples, 0.95);
+  out.p99_ns = percentile(samples, 0.99);
+  out.max_ns = samples.back();
+  for (const uint64_t ns : samples) {
+    const auto bucket = static_cast<size_t>(64 - std::countl_zero(ns / 1000U)); // bit width of the microseconds
+    ++out.histogram[(std::min)(bucket, out.histogram.size() - 1)];
+  }
+  return out;
+}
+
+struct commit_record {
+  uint64_t sample;
+  uint64_t frames;
+  uint64_t time_ns;
+  uint64_t arrived_ns; // its device_callback, or 0
+};
+
+// The commit whose frames include `sample`; commits are sorted by sample and do not overlap.
+const commit_record* find_commit(const std::vector<commit_record>& commits, uint64_t sample) noexcept {
+  auto next = std::upper_bound(commits.begin(), commits.end(), sample, [](uint64_t s, const commit_record& c) {
+    return s < c.sample;
+  });
+  if (next == commits.begin()) {
+    return nullptr;
+  }
+  const commit_record& commit = *std::prev(next);
+  return sample < commit.sample + commit.frames ? &commit : nullptr;
+}
+
+} // namespace
+
+namespace detail {
+  void record(trace_point point, trace_phase phase, uint64_t sample, uint32_t value, uint64_t time_ns) noexcept {
+    thread_buffer* buffer = bound_buffer;
+    if (buffer == nullptr || bound_session != trace_session.load(std::memory_order_acquire)) {
+      buffer = take_spare();
+      bound_buffer = buffer;
+      if (buffer == nullptr) {
+        // Never lock or allocate here: reserve_trace_buffers() is how a thread gets a buffer.
+        trace_registry().unbound_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+      }
+      bound_session = trace_session.load(std::memory_order_seq_cst);
+      buffer->session.store(bound_session, std::memory_order_relaxed);
+      buffer->status.store(thread_buffer::state::bound, std::memory_order_seq_cst);
+    }
+    buffer->writers.fetch_add(1, std::memory_order_seq_cst);
+    if (bound_session != trace_session.load(std::memory_order_seq_cst)) {
+      // A new session began since the check above and may have retired the buffer: the next event rebinds.
+      buffer->writers.fetch_sub(1, std::memory_order_release);
+      trace_registry().unbound_dropped.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    const uint64_t at = buffer->written.load(std::memory_order_relaxed);
+    if (at - buffer->read.load(std::memory_order_acquire) >= buffer->capacity) {
+      buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+    } else {
+      buffer->ring[at % buffer->capacity] = trace_event{
+        .time_ns = time_ns, .sample = sample, .value = value, .thread = buffer->id, .point = point, .phase = phase
+      };
+      buffer->written.store(at + 1, std::memory_order_release);
+    }
+    buffer->writers.fetch_sub(1, std::memory_order_release);
+  }
+} // namespace detail
+
+std::string_view trace_point_name(trace_point point) noexcept {
+  switch (point) {
+  case trace_point::device_callback:
+    return "device_callback";
+  case trace_point::ring_commit:
+    return "ring_commit";
+  case trace_point::consumer_wakeup:
+    return "consumer_wakeup";
+  case trace_point::user_callback:
+    return "user_callback";
+  case trace_point::encoder:
+    return "encoder";
+  case trace_point::decode:
+    return "decode";
+  case trace_point::token_emit:
+    return "token_emit";
+  }
+  return "unknown";
+}
+
+void enable_tracing(uint32_t events_per_thread, uint32_t threads) noexcept {
+  registry& reg = trace_registry();
+  reg.events_per_thread.store((std::max)(events_per_thread, 16U), std::memory_order_relaxed);
+  {
+    const std::scoped_lock lock(reg.mutex);
+    retire_stale(reg, trace_session.fetch_add(1, std::memory_order_seq_cst) + 1);
+  }
+  reserve_trace_buffers(threads);
+  detail::tracing_on.store(true, std::memory_order_release);
+}
+
+void reserve_trace_buffers(uint32_t threads) noexcept {
+  registry& reg = trace_registry();
+  try {
+    const std::scoped_lock lock(reg.mutex);
+    const uint32_t events = reg.events_per_thread.load(std::memory_order_relaxed);
+    size_t spare = 0;
+    for (auto& slot : reg.spares) {
+      thread_buffer* buffer = slot.load(std::memory_order_relaxed);
+      if (buffer != nullptr && buffer->capacity != events) {
+        // Sized for an earlier enable_tracing(): retire it, unless a thread has just taken it.
+        buffer = slot.exchange(nullptr, std::memory_order_acquire);
+        if (buffer != nullptr) {
+          buffer->status.store(thread_buffer::state::retired, std::memory_order_relaxed);
+        }
+      } else if (buffer != nullptr) {
+        ++spare;
+      }
+    }
+    for (auto& slot : reg.spares) {
+      if (spare >= threads) {
+        break;
+      }
+      if (slot.load(std::memory_order_relaxed) == nullptr) {
+        slot.store(reuse_or_allocate(reg, events), std::memory_order_release);
+        ++spare;
+      }
+    }
+  } catch (...) {
+    // Threads without a spare drop their events, counted in dropped_trace_events().
+  }
+}
+
+void disable_tracing() noexcept { detail::tracing_on.store(false, std::memory_order_release); }
+
+uint64_t trace_clock_ns() noexcept {
+  return static_cast<uint64_t>(
+    std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void set_trace_origin(uint64_t sample) noexcept { origin_sample = sample; }
+
+uint64_t trace_origin() noexcept { return origin_sample; }
+
+size_t drain_trace(std::vector<trace_event>& out) {
+  registry& reg = trace_registry();
+  const size_t first = out.size();
+  {
+    const std::scoped_lock lock(reg.mutex);
+    for (auto& buffer : reg.buffers) {
+      const uint64_t from = buffer->read.load(std::memory_order_relaxed);
+      const uint64_t to = buffer->written.load(std::memory_order_acquire);
+      for (uint64_t i = from; i < to; ++i) {
+        out.push_back(buffer->ring[i % buffer->capacity]);
+      }
+      buffer->read.store(to, std::memory_order_release);
+    }
+  }
+  const auto by_time = [](const trace_event& a, const trace_event& b) { return a.time_ns < b.time_ns; };
+  std::stable_sort(out.begin() + static_cast<std::ptrdiff_t>(first), out.end(), by_time);
+  return out.size() - first;
+}
+
+uint64_t dropped_trace_events() noexcept {
+  registry& reg = trace_registry();
+  const std::scoped_lock lock(reg.mutex);
+  uint64_t dropped = reg.retired_dropped + reg.unbound_dropped.load(std::memory_order_relaxed);
+  for (const auto& buffer : reg.buffers) {
+    dropped += buffer->dropped.load(std::memory_order_relaxed);
+  }
+  return dropped;
+}
+
+std::vector<stage_latency> summarize_trace(std::span<const trace_event> events) {
+  std::vector<std::pair<uint64_t, uint64_t>> arrivals; // device_callback sample, time
+  std::vector<commit_record> commits;
+  for (const trace_event& event : events) {
+    if (event.point == trace_point::device_callback) {
+      arrivals.emplace_back(event.sample, event.time_ns);
+    } else if (event.point == trace_point::ring_commit && event.value != 0) {
+      commits.push_back({ .sample = event.sample, .frames = event.value, .time_ns = event.time_ns, .arrived_ns = 0 });
+    }
+  }
+  std::stable_sort(arrivals.begin(), arrivals.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+  std::sort(commits.begin(), commits.end(), [](const commit_record& a, const commit_record& b) {
+    return a.sample < b.sample;
+  });
+
+  std::vector<uint64_t> device_to_commit;
+  for (auto& commit : commits) {
+    // A callback whose frames were all dropped shares its sample with the next one; the last of them delivered.
+    auto arrival = std::upper_bound(arrivals.begin(), arrivals.end(), commit.sample, [](uint64_t s, const auto& a) {
+      return s < a.first;
+    });
+    if (arrival != arrivals.begin() && std::prev(arrival)->first == commit.sample
+        && std::prev(arrival)->second <= commit.time_ns) {
+      commit.arrived_ns = std::prev(arrival)->second;
+      device_to_commit.push_back(commit.time_ns - commit.arrived_ns);
+    }
+  }
+
+  std::vector<uint64_t> commit_to_wakeup;
+  std::vector<uint64_t> audio_to_token;
+  // Open spans per thread and point; spans of one point do not nest on a thread.
+  std::vector<std::array<uint64_t, trace_point_count>> open;
+  std::array<std::vector<uint64_t>, trace_point_count> spans;
+  for (const trace_event& event : events) {
+    const auto point = static_cast<size_t>(event.point);
+    if (event.phase == trace_phase::begin || event.phase == trace_phase::end) {
+      if (open.size() <= event.thread) {
+        open.resize(event.thread + size_t{ 1 }, {});
+      }
+      uint64_t& started = open[event.thread][point];
+      if (event.phase == trace_phase::begin) {
+        started = event.time_ns;
+      } else if (started != 0 && event.time_ns >= started) {
+        spans[point].push_back(event.time_ns - started);
+        started = 0;
+      }
+      continue;
+    }
+    if (event.point == trace_point::consumer_wakeup && event.value != 0) {
+      const commit_record* commit = find_commit(commits, event.sample + event.value - 1);
+      if (commit != nullptr && commit->time_ns <= event.time_ns) {
+        commit_to_wakeup.push_back(event.time_ns - commit->time_ns);
+      }
+    } else if (event.point == trace_point::token_emit) {
+      const commit_record* commit = find_commit(commits, event.sample);
+      if (commit != nullptr && commit->arrived_ns != 0 && commit->arrived_ns <= event.time_ns) {
+        audio_to_token.push_back(event.time_ns - commit->arrived_ns);
+      }
+    }
+  }
+
+  std::vector<stage_latency> out;
+  const auto add = [&out](std::string name, std::vector<uint64_t>& samples) {
+    if (!samples.empty()) {
+      out.push_back(reduce(std::move(name), samples));
+    }
+  };
+  add("device->commit", device_to_commit);
+  add("commit->wakeup", commit_to_wakeup);
+  add("callback", spans[static_cast<size_t>(trace_point::user_callback)]);
+  add("encoder", spans[static_cast<size_t>(trace_point::encoder)]);
+  add("decode", spans[static_cast<size_t>(trace_point::decode)]);
+  add("audio->token", audio_to_token);
+  return out;
+}
+
+bool write_chrome_trace(const std::string& path, std::span<const trace_event> events) noexcept {
+  try {
+    std::ofstream out(path, std::ios::binary);
+    if (!out) {
+      return false;
+    }
+    const uint64_t origin = events.empty() ? 0 : events.front().time_ns;
+    std::array<char, 256> line{};
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    for (size_t i = 0; i < events.size(); ++i) {
+      const trace_event& event = events[i];
+      const char* phase = event.phase == trace_phase::begin ? "B" : event.phase == trace_phase::end ? "E" : "i";
+      const std::string_view name = trace_point_name(event.point);
+      const int written = std::snprintf(
+        line.data(),
+        line.size(),
+        "%s\n{\"name\":\"%.*s\",\"cat\":\"jaxie\",\"ph\":\"%s\",%s\"ts\":%.3f,\"pid\":1,\"tid\":%u,"
+        "\"args\":{\"sample\":%llu,\"value\":%u}}",
+        i == 0 ? "" : ",",
+        static_cast<int>(name.size()),
+        name.data(),
+        phase,
+        event.phase == trace_phase::instant ? "\"s\":\"t\"," : "",
+        static_cast<double>(event.time_ns - origin) / 1000.0,
+        event.thread,
+        static_cast<unsigned long long>(event.sample), // NOLINT(*-runtime-int)
+        event.value);
+      if (written < 0) {
+        return false;
+      }
+      const auto length = (std::min)(static_cast<size_t>(written), line.size() - 1);
+      out.write(line.data(), static_cast<std::streamsize>(length));
+    }
+    out << "\n]}\n";
+    return static_cast<bool>(out);
+  } catch (...) {
+    return false;
+  }
+}
+
+} // namespace jaxie::realtime
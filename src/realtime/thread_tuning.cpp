@@ -0,0 +1,145 @@
+#include <Jaxie/realtime/thread_tuning.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <thread>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#endif
+
+namespace jaxie::realtime {
+namespace {
+
+#if defined(__linux__)
+
+int set_scheduling(pthread_t handle, const thread_tuning& tuning, tuning_report& report) noexcept {
+  if (tuning.policy == sched_policy::inherit) {
+    return 0;
+  }
+  const int policy = tuning.policy == sched_policy::fifo ? SCHED_FIFO : SCHED_RR;
+  sched_param param{};
+  param.sched_priority = std::clamp(tuning.priority, sched_get_priority_min(policy), sched_get_priority_max(policy));
+  const int error = pthread_setschedparam(handle, policy, &param);
+  report.scheduling_applied = error == 0;
+  return error;
+}
+
+int set_affinity(pthread_t handle, const thread_tuning& tuning, tuning_report& report) noexcept {
+  if (tuning.cpu_mask == 0) {
+    return 0;
+  }
+  cpu_set_t cpus;
+  CPU_ZERO(&cpus);
+  for (uint32_t cpu = 0; cpu < 64U; ++cpu) {
+    if ((tuning.cpu_mask >> cpu) & 1U) {
+      CPU_SET(cpu, &cpus);
+    }
+  }
+  const int error = pthread_setaffinity_np(handle, sizeof(cpus), &cpus);
+  report.affinity_applied = error == 0;
+  return error;
+}
+
+tuning_report apply_to_handle(pthread_t handle, const thread_tuning& tuning) noexcept {
+  tuning_report report{};
+  report.scheduling_error = set_scheduling(handle, tuning, report);
+  report.affinity_error = set_affinity(handle, tuning, report);
+  return report;
+}
+
+#else
+
+tuning_report unsupported(const thread_tuning& tuning) noexcept {
+  tuning_report report{};
+  report.scheduling_error = tuning.policy != sched_policy::inherit ? ENOTSUP : 0;
+  report.affinity_error = tuning.cpu_mask != 0 ? ENOTSUP : 0;
+  return report;
+}
+
+#endif
+
+void append_error(std::string& out, const char* what, int error) {
+  if (error == 0) {
+    return;
+  }
+  if (!out.empty()) {
+    out += '\n';
+  }
+  out += what;
+  out += ": ";
+  out += std::strerror(error); // NOLINT(concurrency-mt-unsafe)
+}
+
+} // namespace
+
+tuning_report apply(std::thread& thread, const thread_tuning& tuning) noexcept {
+#if defined(__linux__)
+  if (!thread.joinable()) {
+    return {};
+  }
+  return apply_to_handle(thread.native_handle(), tuning);
+#else
+  static_cast<void>(thread);
+  return unsupported(tuning);
+#endif
+}
+
+tuning_report apply_to_current_thread(const thread_tuning& tuning) noexcept {
+  if (tuning.prefault_stack) {
+    prefault_stack();
+  }
+#if defined(__linux__)
+  return apply_to_handle(pthread_self(), tuning);
+#else
+  return unsupported(tuning);
+#endif
+}
+
+void prefault_stack() noexcept {
+  std::array<unsigned char, stack_prefault_bytes> stack; // NOLINT(*-member-init)
+  volatile unsigned char* bytes = stack.data();
+  for (size_t i = 0; i < stack.size(); i += 4096U) {
+    bytes[i] = 0;
+  }
+}
+
+bool lock_process_memory(tuning_report& report) noexcept {
+#if defined(__linux__)
+  if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+    report.memory_lock_error = errno;
+    return false;
+  }
+  report.memory_locked = true;
+  return true;
+#else
+  report.memory_lock_error = ENOTSUP;
+  return false;
+#endif
+}
+
+void merge(tuning_report& into, const tuning_report& from) noexcept {
+  into.scheduling_error = into.scheduling_error != 0 ? into.scheduling_error : from.scheduling_error;
+  into.affinity_error = into.affinity_error != 0 ? into.affinity_error : from.affinity_error;
+  into.memory_lock_error = into.memory_lock_error != 0 ? into.memory_lock_error : from.memory_lock_error;
+  into.scheduling_applied = into.scheduling_applied || from.scheduling_applied;
+  into.affinity_applied = into.affinity_applied || from.affinity_applied;
+  into.memory_locked = into.memory_locked || from.memory_locked;
+}
+
+std::string describe(const tuning_report& report) {
+  std::string out;
+  append_error(out, "scheduling", report.scheduling_error);
+  append_error(out, "affinity", report.affinity_error);
+  append_error(out, "memory lock", report.memory_lock_error);
+  return out;
+}
+
+} // namespace jaxie::realtime
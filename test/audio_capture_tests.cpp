@@ -1,12 +1,18 @@
 // SPDX-License-Identifier: UNLICENSED
 #include <Jaxie/audio/capture.hpp>
+#include <Jaxie/audio/chunk_assembler.hpp>
 
 #include <atomic>
 #include <chrono>
+#include <cmath>
+#include <cstdint>
 #include <cstdlib>
+#include <filesystem>
+#include <fstream>
 #include <thread>
 #include <string>
 #include <span>
+#include <vector>
 
 #include <catch2/catch_test_macros.hpp>
 
@@ -21,6 +27,34 @@ static bool get_env_flag(const char* name) {
   return (val == "1" || val == "true" || val == "TRUE");
 }
 
+// Writes a 16-bit PCM WAV whose samples are the integers 0, 1, 2, ...
+static std::string write_ramp_wav(const std::string& name, uint32_t rate, uint16_t channels, uint32_t frames) {
+  const auto path = (std::filesystem::temp_directory_path() / name).string();
+  std::ofstream out(path, std::ios::binary);
+  const auto put = [&](uint32_t value, int bytes) {
+    for (int i = 0; i < bytes; ++i) {
+      out.put(static_cast<char>((value >> (8 * i)) & 0xFFU));
+    }
+  };
+  const uint32_t data_bytes = frames * channels * 2U;
+  out.write("RIFF", 4);
+  put(36U + data_bytes, 4);
+  out.write("WAVEfmt ", 8);
+  put(16, 4);
+  put(1, 2);
+  put(channels, 2);
+  put(rate, 4);
+  put(rate * channels * 2U, 4);
+  put(channels * 2U, 2);
+  put(16, 2);
+  out.write("data", 4);
+  put(data_bytes, 4);
+  for (uint32_t i = 0; i < frames * channels; ++i) {
+    put((i / channels) & 0x7FFFU, 2); // every channel carries the frame index
+  }
+  return path;
+}
+
 TEST_CASE("audio_capture init requires callback", "[audio]") {
   jaxie::audio::audio_capture cap;
   const jaxie::audio::capture_config cfg{};
@@ -28,6 +62,14 @@ TEST_CASE("audio_capture init requires callback", "[audio]") {
   REQUIRE_FALSE(init_ok);
 }
 
+TEST_CASE("audio_capture stats are empty before init", "[audio]") {
+  const jaxie::audio::audio_capture cap;
+  const auto stats = cap.stats();
+  REQUIRE(stats.periods_delivered == 0);
+  REQUIRE(stats.wakeups == 0);
+  REQUIRE(stats.wakeup_latency_total_ns == 0);
+}
+
 TEST_CASE("audio_capture lifecycle and optional device smoke", "[audio]") {
   jaxie::audio::audio_capture cap;
   const jaxie::audio::capture_config cfg{}; // 16kHz mono, ~10ms periods by default
@@ -57,9 +99,248 @@ TEST_CASE("audio_capture lifecycle and optional device smoke", "[audio]") {
       std::this_thread::sleep_for(sleep_dur);
     }
     REQUIRE(cb_calls.load(std::memory_order_relaxed) > 0);
+    const auto stats = cap.stats();
+    REQUIRE(stats.periods_delivered > 0);
+    REQUIRE(stats.wakeup_latency_max_ns >= stats.wakeup_latency_last_ns);
   }
 
   // Allow graceful behavior without device: just ensure no crashes and correct state transitions.
   cap.stop();
   cap.shutdown();
 }
+
+TEST_CASE("audio_capture replays a WAV file faster than real time", "[audio][replay]") {
+  constexpr uint32_t frames = 1000;
+  jaxie::audio::capture_config cfg{};
+  cfg.source = jaxie::audio::capture_source::file;
+  cfg.pacing = jaxie::audio::replay_pacing::as_fast_as_possible;
+  cfg.replay_path = write_ramp_wav("jaxie_replay_ramp.wav", cfg.sample_rate_hz, 1, frames);
+
+  std::vector<float> received;
+  jaxie::audio::audio_capture cap;
+  REQUIRE(cap.init(cfg, [&](std::span<const float> period) { received.insert(received.end(), period.begin(), period.end()); }));
+  REQUIRE(cap.start());
+
+  for (int i = 0; i < 200 && !cap.stats().end_of_stream; ++i) {
+    std::this_thread::sleep_for(10ms);
+  }
+  cap.stop();
+
+  // 1000 frames round up to seven 160-frame periods; the tail is zero-padded.
+  const auto stats = cap.stats();
+  REQUIRE(stats.end_of_stream);
+  REQUIRE(stats.periods_delivered == 7);
+  REQUIRE(stats.ring.dropped_frames == 0);
+  // Every push is a whole period, so no wakeup comes up short; draining the backlog is not an underrun either.
+  REQUIRE(stats.ring.underruns == 0);
+  REQUIRE(received.size() == 7U * cfg.period_frames);
+  REQUIRE(received[1] == 1.0F / 32768.0F);
+  REQUIRE(received[999] == 999.0F / 32768.0F);
+  REQUIRE(received[1000] == 0.0F);
+
+  cap.shutdown();
+  std::filesystem::remove(cfg.replay_path);
+}
+
+TEST_CASE("audio_capture replay converts 48 kHz stereo to the pipeline format", "[audio][replay]") {
+  jaxie::audio::capture_config cfg{};
+  cfg.source = jaxie::audio::capture_source::file;
+  cfg.pacing = jaxie::audio::replay_pacing::as_fast_as_possible;
+  cfg.replay_path = write_ramp_wav("jaxie_replay_48k.wav", 48000, 2, 4800);
+
+  std::vector<float> received;
+  jaxie::audio::audio_capture cap;
+  REQUIRE(cap.init(cfg, [&](std::span<const float> period) { received.insert(received.end(), period.begin(), period.end()); }));
+  REQUIRE(cap.start());
+
+  for (int i = 0; i < 200 && !cap.stats().end_of_stream; ++i) {
+    std::this_thread::sleep_for(10ms);
+  }
+  cap.stop();
+
+  // 100 ms at 48 kHz becomes ten 160-frame periods at 16 kHz; the linear-phase filter delays the ramp by
+  // half its length (15.5 input frames).
+  const auto stats = cap.stats();
+  REQUIRE(stats.periods_delivered == 10);
+  REQUIRE(received.size() == 10U * cfg.period_frames);
+  REQUIRE(std::abs(received[800] - ((3.0F * 800.0F) - 15.5F) / 32768.0F) < 1e-3F);
+
+  cap.shutdown();
+  std::filesystem::remove(cfg.replay_path);
+}
+
+TEST_CASE("audio_capture replay waits for room for a whole upsampled block", "[audio][replay]") {
+  // 111 frames at 11.025 kHz make one 160-frame period at 16 kHz, but a block can resample to a few frames more.
+  for (const auto policy : { jaxie::audio::overrun_policy::drop_newest, jaxie::audio::overrun_policy::drop_oldest }) {
+    jaxie::audio::capture_config cfg{};
+    cfg.source = jaxie::audio::capture_source::file;
+    cfg.pacing = jaxie::audio::replay_pacing::as_fast_as_possible;
+    cfg.ring_frames = cfg.period_frames;
+    cfg.ring_storage = jaxie::audio::ring_memory::heap;
+    cfg.on_overrun = policy;
+    cfg.replay_path = write_ramp_wav("jaxie_replay_11k.wav", 11025, 1, 2220);
+
+    size_t received = 0;
+    jaxie::audio::audio_capture cap;
+    REQUIRE(cap.init(cfg, [&](std::span<const float> period) {
+      received += period.size();
+      std::this_thread::sleep_for(1ms);
+    }));
+    REQUIRE(cap.start());
+
+    for (int i = 0; i < 200 && !cap.stats().end_of_stream; ++i) {
+      std::this_thread::sleep_for(10ms);
+    }
+    cap.stop();
+
+    const auto stats = cap.stats();
+    REQUIRE(stats.end_of_stream);
+    REQUIRE(stats.ring.dropped_frames == 0);
+    REQUIRE(stats.periods_delivered == 20);
+    REQUIRE(received == 20U * cfg.period_frames);
+
+    cap.shutdown();
+    std::filesystem::remove(cfg.replay_path);
+  }
+}
+
+TEST_CASE("audio_capture counts no underruns for wakeups that bring no late period", "[audio][replay]") {
+  jaxie::audio::capture_config cfg{};
+  cfg.source = jaxie::audio::capture_source::file;
+  cfg.pacing = jaxie::audio::replay_pacing::realtime;
+  cfg.replay_path = write_ramp_wav("jaxie_replay_paced.wav", cfg.sample_rate_hz, 1, 4800);
+
+  jaxie::audio::audio_capture cap;
+  REQUIRE(cap.init(cfg, [](std::span<const float>) {}));
+  uint32_t subscriber = 0;
+  REQUIRE(cap.add_subscriber([](std::span<const float>) {}, subscriber));
+  REQUIRE(cap.start());
+  // Removing a subscriber wakes the consumer between periods, as stop() does; neither is a late period.
+  std::this_thread::sleep_for(95ms);
+  cap.remove_subscriber(subscriber);
+  for (int i = 0; i < 200 && !cap.stats().end_of_stream; ++i) {
+    std::this_thread::sleep_for(10ms);
+  }
+  cap.stop();
+
+  const auto stats = cap.stats();
+  REQUIRE(stats.end_of_stream);
+  REQUIRE(stats.periods_delivered == 30);
+  REQUIRE(stats.ring.underruns == 0);
+
+  cap.shutdown();
+  std::filesystem::remove(cfg.replay_path);
+}
+
+TEST_CASE("audio_capture subscribers read the same stream without stalling the primary", "[audio][replay]") {
+  jaxie::audio::capture_config cfg{};
+  cfg.source = jaxie::audio::capture_source::file;
+  cfg.pacing = jaxie::audio::replay_pacing::as_fast_as_possible;
+  cfg.replay_path = write_ramp_wav("jaxie_replay_fanout.wav", cfg.sample_rate_hz, 1, 16000);
+
+  std::atomic<uint64_t> primary_periods{0};
+  jaxie::audio::audio_capture cap;
+  uint32_t early = 0;
+  REQUIRE_FALSE(cap.add_reader(early));
+  REQUIRE(cap.init(cfg, [&](std::span<const float>) { primary_periods.fetch_add(1); }));
+
+  uint32_t recorder = 0;
+  uint32_t puller = 0;
+  REQUIRE(cap.add_subscriber([](std::span<const float>) { std::this_thread::sleep_for(5ms); }, recorder));
+  REQUIRE(cap.add_reader(puller));
+  REQUIRE(recorder != puller);
+  REQUIRE(cap.start());
+
+  for (int i = 0; i < 200 && !cap.stats().end_of_stream; ++i) {
+    std::this_thread::sleep_for(10ms);
+  }
+
+  // The puller was never serviced; its first acquire resynchronizes to the oldest intact period.
+  jaxie::audio::pcm_ring::read_view view{};
+  REQUIRE(cap.acquire_period(puller, view));
+  REQUIRE(view.frames == cfg.period_frames);
+  REQUIRE(cap.commit_period(puller, view));
+  cap.stop();
+
+  const auto primary = cap.stats();
+  REQUIRE(primary.end_of_stream);
+  REQUIRE(primary.periods_delivered == 100);
+  REQUIRE(primary_periods.load() == 100);
+  REQUIRE(primary.ring.dropped_frames == 0);
+
+  const auto slow = cap.stats(recorder);
+  REQUIRE(slow.periods_delivered < 100);
+  REQUIRE(slow.ring.overruns > 0);
+
+  const auto pulled = cap.stats(puller);
+  REQUIRE(pulled.periods_delivered == 1);
+  REQUIRE(pulled.ring.overruns == 1);
+  REQUIRE(pulled.ring.max_lag_frames == 16000);
+
+  cap.remove_subscriber(recorder);
+  cap.shutdown();
+  std::filesystem::remove(cfg.replay_path);
+}
+
+TEST_CASE("chunk_assembler hands out left | chunk | right windows at chunk cadence", "[audio][replay]") {
+  jaxie::audio::capture_config cfg{};
+  cfg.source = jaxie::audio::capture_source::file;
+  cfg.pacing = jaxie::audio::replay_pacing::as_fast_as_possible;
+  cfg.replay_path = write_ramp_wav("jaxie_replay_chunks.wav", cfg.sample_rate_hz, 1, 16000);
+
+  jaxie::audio::chunk_assembler assembler;
+  std::vector<jaxie::audio::chunk_window> windows;
+  std::vector<float> chunk_heads;
+  jaxie::audio::audio_capture cap;
+  REQUIRE(cap.init(cfg, [&](std::span<const float>) {
+    assembler.pump([&](const jaxie::audio::chunk_window& window) {
+      windows.push_back(window);
+      chunk_heads.push_back(window.chunk().front());
+    });
+  }));
+
+  // The default ring is far smaller than one window.
+  const jaxie::audio::chunk_config chunks{};
+  REQUIRE_FALSE(assembler.init(cap, chunks));
+  cap.shutdown();
+
+  // One window fits, but not the two the assembler needs.
+  cfg.ring_frames = 16384;
+  REQUIRE(cap.init(cfg, [](std::span<const float>) {}));
+  REQUIRE_FALSE(assembler.init(cap, chunks));
+  cap.shutdown();
+
+  cfg.ring_frames = 32768;
+  REQUIRE(cap.init(cfg, [&](std::span<const float>) {
+    assembler.pump([&](const jaxie::audio::chunk_window& window) {
+      windows.push_back(window);
+      chunk_heads.push_back(window.chunk().front());
+    });
+  }));
+  REQUIRE(assembler.init(cap, chunks));
+  REQUIRE(cap.start());
+  for (int i = 0; i < 200 && !cap.stats().end_of_stream; ++i) {
+    std::this_thread::sleep_for(10ms);
+  }
+  cap.stop();
+
+  // Chunks start every 3200 frames and need 1280 frames of lookahead; the fifth would end past the file.
+  REQUIRE(windows.size() == 4);
+  const std::vector<uint32_t> expected_left{ 0, 3200, 6400, 8000 };
+  for (size_t i = 0; i < windows.size(); ++i) {
+    const uint64_t chunk_start = i * 3200U;
+    REQUIRE(windows[i].left_frames == expected_left[i]);
+    REQUIRE(windows[i].chunk_frames == 3200);
+    REQUIRE(windows[i].right_frames == 1280);
+    REQUIRE(windows[i].first_frame == chunk_start - expected_left[i]);
+    REQUIRE(chunk_heads[i] == static_cast<float>(chunk_start) / 32768.0F);
+  }
+
+  const auto stats = assembler.stats();
+  REQUIRE(stats.ring.overruns == 0);
+  REQUIRE(stats.ring.dropped_frames == 0);
+
+  assembler.shutdown();
+  cap.shutdown();
+  std::filesystem::remove(cfg.replay_path);
+}
@@ -0,0 +1,177 @@
+// SPDX-License-Identifier: UNLICENSED
+#include <Jaxie/dsp/kernels.hpp>
+#include <Jaxie/dsp/resampler.hpp>
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <numbers>
+#include <span>
+#include <vector>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+namespace {
+
+std::vector<float> sine(size_t frames, uint32_t channels, double freq_hz, double rate_hz) {
+  std::vector<float> out(frames * channels);
+  for (size_t i = 0; i < frames; ++i) {
+    const auto value = static_cast<float>(0.5 * std::sin(2.0 * std::numbers::pi * freq_hz * static_cast<double>(i) / rate_hz));
+    for (uint32_t chan = 0; chan < channels; ++chan) {
+      out[(i * channels) + chan] = value;
+    }
+  }
+  return out;
+}
+
+// Amplitude of `freq_hz` in `samples`, by correlation with a quadrature pair.
+double tone_amplitude(std::span<const float> samples, double freq_hz, double rate_hz) {
+  double re = 0.0;
+  double im = 0.0;
+  for (size_t i = 0; i < samples.size(); ++i) {
+    const double phase = 2.0 * std::numbers::pi * freq_hz * static_cast<double>(i) / rate_hz;
+    re += static_cast<double>(samples[i]) * std::cos(phase);
+    im += static_cast<double>(samples[i]) * std::sin(phase);
+  }
+  return 2.0 * std::sqrt((re * re) + (im * im)) / static_cast<double>(samples.size());
+}
+
+} // namespace
+
+TEST_CASE("dsp kernels match their scalar definitions", "[dsp]") {
+  std::vector<float> lhs(37);
+  std::vector<float> rhs(37);
+  float expected = 0.0F;
+  for (size_t i = 0; i < lhs.size(); ++i) {
+    lhs[i] = static_cast<float>(i) * 0.25F;
+    rhs[i] = 1.0F - (static_cast<float>(i) * 0.125F);
+    expected += lhs[i] * rhs[i];
+  }
+  REQUIRE(std::abs(jaxie::dsp::dot(lhs, rhs) - expected) < 1e-3F);
+
+  const std::vector<int16_t> pcm{ 0, 16384, -32768, 32767, -1, 1, 8192, -8192, 100 };
+  std::vector<float> converted(pcm.size());
+  jaxie::dsp::s16_to_f32(pcm, converted);
+  for (size_t i = 0; i < pcm.size(); ++i) {
+    REQUIRE(converted[i] == static_cast<float>(pcm[i]) / 32768.0F);
+  }
+
+  const auto stereo = sine(19, 2, 440.0, 16000.0);
+  std::vector<float> mono(19);
+  jaxie::dsp::downmix_to_mono(stereo, 2, mono);
+  for (size_t i = 0; i < mono.size(); ++i) {
+    REQUIRE(std::abs(mono[i] - stereo[i * 2]) < 1e-6F);
+  }
+}
+
+TEST_CASE("polyphase resampler keeps in-band tones and rejects aliases", "[dsp][resampler]") {
+  jaxie::dsp::polyphase_resampler resampler;
+  REQUIRE(resampler.init(48000, 16000, jaxie::dsp::resample_quality::balanced, 480));
+  REQUIRE(resampler.up_factor() == 1);
+  REQUIRE(resampler.down_factor() == 3);
+
+  const auto in_band = sine(48000, 1, 1000.0, 48000.0);
+  std::vector<float> out(resampler.max_output_frames(in_band.size()));
+  const size_t produced = resampler.process(in_band, out);
+  REQUIRE(produced >= 15999);
+  REQUIRE(produced <= 16001);
+  // Skip the filter's warm-up before measuring.
+  const auto settled = std::span<const float>(out).subspan(1000, 14000);
+  REQUIRE(std::abs(tone_amplitude(settled, 1000.0, 16000.0) - 0.5) < 0.01);
+
+  resampler.reset();
+  const auto above_nyquist = sine(48000, 1, 12000.0, 48000.0);
+  const size_t alias_frames = resampler.process(above_nyquist, out);
+  const auto alias_settled = std::span<const float>(out).first(alias_frames).subspan(1000, 14000);
+  // 12 kHz folds to 4 kHz at 16 kHz output; it must be strongly attenuated.
+  REQUIRE(tone_amplitude(alias_settled, 4000.0, 16000.0) < 0.005);
+}
+
+TEST_CASE("polyphase resampler output does not depend on block size", "[dsp][resampler]") {
+  const auto input = sine(4410, 1, 523.0, 44100.0);
+
+  jaxie::dsp::polyphase_resampler whole;
+  REQUIRE(whole.init(44100, 16000, jaxie::dsp::resample_quality::fast, 4410));
+  std::vector<float> expected(whole.max_output_frames(input.size()));
+  expected.resize(whole.process(input, expected));
+
+  jaxie::dsp::polyphase_resampler chunked;
+  REQUIRE(chunked.init(44100, 16000, jaxie::dsp::resample_quality::fast, 441));
+  std::vector<float> actual;
+  std::vector<float> scratch(chunked.max_output_frames(97));
+  for (size_t offset = 0; offset < input.size(); offset += 97) {
+    const auto chunk = std::span<const float>(input).subspan(offset, std::min<size_t>(97, input.size() - offset));
+    const size_t produced = chunked.process(chunk, scratch);
+    actual.insert(actual.end(), scratch.begin(), scratch.begin() + static_cast<std::ptrdiff_t>(produced));
+  }
+
+  REQUIRE(actual.size() == expected.size());
+  for (size_t i = 0; i < actual.size(); ++i) {
+    REQUIRE(std::abs(actual[i] - expected[i]) < 1e-5F);
+  }
+}
+
+TEST_CASE("stream_converter downmixes and resamples int16 stereo", "[dsp][resampler]") {
+  jaxie::dsp::converter_config cfg{};
+  cfg.in_rate_hz = 48000;
+  cfg.in_channels = 2;
+  cfg.max_block_frames = 480;
+  jaxie::dsp::stream_converter converter;
+  REQUIRE(converter.init(cfg));
+  REQUIRE_FALSE(converter.is_passthrough());
+
+  const std::vector<int16_t> silence(4800 * 2, 0);
+  std::vector<float> out(converter.max_output_frames(4800));
+  REQUIRE(converter.process(std::span<const int16_t>(silence), out) == 1600);
+
+  cfg.out_channels = 2;
+  REQUIRE_FALSE(converter.init(cfg));
+}
+
+TEST_CASE("stream_converter flush brings the resampler's delayed tail out", "[dsp][resampler]") {
+  jaxie::dsp::converter_config cfg{};
+  cfg.in_rate_hz = 48000;
+  cfg.quality = jaxie::dsp::resample_quality::high;
+  cfg.max_block_frames = 16; // smaller than the delay: flush() takes several blocks
+  jaxie::dsp::stream_converter converter;
+  REQUIRE(converter.init(cfg));
+
+  // An impulse on the last input frame is still inside the filter when the input ends.
+  std::vector<float> impulse(4800, 0.0F);
+  impulse.back() = 1.0F;
+  std::vector<float> out(converter.max_output_frames(impulse.size()) + converter.flush_frames());
+  const size_t produced = converter.process(impulse, out);
+  double before = 0.0;
+  for (size_t i = 0; i < produced; ++i) {
+    before += static_cast<double>(out[i]);
+  }
+  const size_t flushed = converter.flush(std::span(out).subspan(produced));
+  REQUIRE(flushed > 0);
+  REQUIRE(flushed <= converter.flush_frames());
+  double after = before;
+  for (size_t i = produced; i < produced + flushed; ++i) {
+    after += static_cast<double>(out[i]);
+  }
+  // Decimating by 3 keeps a third of a unit impulse's area; the unflushed output has almost none of it.
+  REQUIRE(std::abs(before) < 0.05);
+  REQUIRE(std::abs(after - (1.0 / 3.0)) < 0.05);
+
+  cfg.in_rate_hz = cfg.out_rate_hz;
+  REQUIRE(converter.init(cfg));
+  REQUIRE(converter.flush_frames() == 0);
+  REQUIRE(converter.flush(out) == 0);
+}
+
+TEST_CASE("stream_converter throughput", "[dsp][!benchmark]") {
+  jaxie::dsp::converter_config cfg{};
+  cfg.in_rate_hz = 48000;
+  cfg.in_channels = 2;
+  cfg.max_block_frames = 480;
+  jaxie::dsp::stream_converter converter;
+  REQUIRE(converter.init(cfg));
+
+  const auto period = sine(480, 2, 440.0, 48000.0);
+  std::vector<float> out(converter.max_output_frames(480));
+  BENCHMARK("48 kHz stereo -> 16 kHz mono, 10 ms period") { return converter.process(period, out); };
+}
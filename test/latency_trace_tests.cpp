@@ -0,0 +1,360 @@
+// SPDX-License-Identifier: UNLICENSED
+#include <Jaxie/audio/capture.hpp>
+#include <Jaxie/realtime/latency_trace.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <new>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#if defined(__GLIBC__)
+#include <dlfcn.h>
+#endif
+
+using namespace std::chrono_literals;
+using jaxie::realtime::trace_event;
+using jaxie::realtime::trace_phase;
+using jaxie::realtime::trace_point;
+
+namespace {
+thread_local uint64_t thread_allocations = 0; // operator new calls on this thread
+thread_local uint64_t thread_exit_hooks = 0;  // thread_local destructors registered on this thread
+} // namespace
+
+#if defined(__GLIBC__)
+// The first use of a thread_local with a destructor registers it here, which callocs and takes the loader lock.
+extern "C" int __cxa_thread_atexit_impl(void (*destructor)(void*), void* object, void* dso) { // NOLINT
+  ++thread_exit_hooks;
+  using next_impl = int (*)(void (*)(void*), void*, void*);
+  static const auto next = reinterpret_cast<next_impl>(dlsym(RTLD_NEXT, "__cxa_thread_atexit_impl")); // NOLINT
+  return next(destructor, object, dso);
+}
+#endif
+
+// Counts allocations per thread, so a test can check that a trace point allocates nothing. Every unaligned form
+// is replaced, or a sanitizer's own would pair with these deletes.
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+  ++thread_allocations;
+  return std::malloc(size == 0 ? 1 : size); // NOLINT(*-no-malloc)
+}
+void* operator new(std::size_t size) {
+  if (void* block = operator new(size, std::nothrow)) {
+    return block;
+  }
+  throw std::bad_alloc();
+}
+void* operator new[](std::size_t size) { return operator new(size); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return operator new(size, std::nothrow); }
+void operator delete(void* block) noexcept { std::free(block); } // NOLINT(*-no-malloc)
+void operator delete(void* block, std::size_t) noexcept { operator delete(block); }
+void operator delete(void* block, const std::nothrow_t&) noexcept { operator delete(block); }
+void operator delete[](void* block) noexcept { operator delete(block); }
+void operator delete[](void* block, std::size_t) noexcept { operator delete(block); }
+void operator delete[](void* block, const std::nothrow_t&) noexcept { operator delete(block); }
+
+namespace {
+
+// Tracing is process-wide: every test starts from an empty trace and leaves tracing off.
+std::vector<trace_event> fresh_trace() {
+  jaxie::realtime::disable_tracing();
+  std::vector<trace_event> stale;
+  jaxie::realtime::drain_trace(stale);
+  return {};
+}
+
+trace_event make_event(uint64_t time_ns, trace_point point, trace_phase phase, uint64_t sample, uint32_t value = 0) {
+  trace_event event{};
+  event.time_ns = time_ns;
+  event.sample = sample;
+  event.value = value;
+  event.point = point;
+  event.phase = phase;
+  return event;
+}
+
+const jaxie::realtime::stage_latency* find_stage(const std::vector<jaxie::realtime::stage_latency>& stages,
+  const std::string& name) {
+  const auto found = std::find_if(stages.begin(), stages.end(), [&](const auto& stage) { return stage.name == name; });
+  return found == stages.end() ? nullptr : &*found;
+}
+
+// 16-bit mono WAV whose samples are 0, 1, 2, ... so a sample's value is its capture frame.
+std::string write_ramp_wav(const std::string& name, uint32_t rate, uint32_t frames) {
+  const auto path = (std::filesystem::temp_directory_path() / name).string();
+  std::ofstream out(path, std::ios::binary);
+  const auto put = [&](uint32_t value, int bytes) {
+    for (int i = 0; i < bytes; ++i) {
+      out.put(static_cast<char>((value >> (8 * i)) & 0xFFU));
+    }
+  };
+  out.write("RIFF", 4);
+  put(36U + (frames * 2U), 4);
+  out.write("WAVEfmt ", 8);
+  put(16, 4);
+  put(1, 2);
+  put(1, 2);
+  put(rate, 4);
+  put(rate * 2U, 4);
+  put(2, 2);
+  put(16, 2);
+  out.write("data", 4);
+  put(frames * 2U, 4);
+  for (uint32_t i = 0; i < frames; ++i) {
+    put(i & 0x7FFFU, 2);
+  }
+  return path;
+}
+
+} // namespace
+
+TEST_CASE("latency trace records nothing while tracing is off", "[realtime][trace]") {
+  auto events = fresh_trace();
+  REQUIRE_FALSE(jaxie::realtime::tracing());
+  jaxie::realtime::trace(trace_point::token_emit, trace_phase::instant, 42, 7);
+  {
+    const jaxie::realtime::trace_span span(trace_point::encoder, 0);
+  }
+  REQUIRE(jaxie::realtime::drain_trace(events) == 0);
+}
+
+TEST_CASE("latency trace drains every thread's events in time order", "[realtime][trace]") {
+  auto events = fresh_trace();
+  jaxie::realtime::enable_tracing();
+  jaxie::realtime::trace(trace_point::device_callback, trace_phase::instant, 0, 160);
+  std::thread worker([]() {
+    const jaxie::realtime::trace_span span(trace_point::encoder, 160, 16);
+    jaxie::realtime::trace(trace_point::token_emit, trace_phase::instant, 319, 5);
+  });
+  worker.join();
+  jaxie::realtime::trace(trace_point::ring_commit, trace_phase::instant, 0, 160);
+  jaxie::realtime::disable_tracing();
+
+  REQUIRE(jaxie::realtime::drain_trace(events) == 5);
+  REQUIRE(std::is_sorted(events.begin(), events.end(), [](const auto& a, const auto& b) {
+    return a.time_ns < b.time_ns;
+  }));
+  REQUIRE(events.front().point == trace_point::device_callback);
+  REQUIRE(events[1].point == trace_point::encoder);
+  REQUIRE(events[1].phase == trace_phase::begin);
+  REQUIRE(events[1].value == 16);
+  REQUIRE(events[2].point == trace_point::token_emit);
+  REQUIRE(events[2].sample == 319);
+  REQUIRE(events[3].phase == trace_phase::end);
+  REQUIRE(events.back().point == trace_point::ring_commit);
+  REQUIRE(events.front().thread == events.back().thread);
+  REQUIRE(events[1].thread != events.front().thread);
+
+  // Drained events are gone.
+  std::vector<trace_event> again;
+  REQUIRE(jaxie::realtime::drain_trace(again) == 0);
+}
+
+TEST_CASE("latency trace drops and counts events once a thread's buffer is full", "[realtime][trace]") {
+  auto events = fresh_trace();
+  const uint64_t dropped_before = jaxie::realtime::dropped_trace_events();
+  jaxie::realtime::enable_tracing(16);
+  // A new thread, so its buffer is allocated at the requested size.
+  std::thread worker([]() {
+    for (uint32_t i = 0; i < 20; ++i) {
+      jaxie::realtime::trace(trace_point::consumer_wakeup, trace_phase::instant, i * 160ULL, 160);
+    }
+  });
+  worker.join();
+  jaxie::realtime::disable_tracing();
+
+  REQUIRE(jaxie::realtime::drain_trace(events) == 16);
+  REQUIRE(events.back().sample == 15 * 160);
+  REQUIRE(jaxie::realtime::dropped_trace_events() - dropped_before == 4);
+  // Later threads get the default buffer size again.
+  jaxie::realtime::enable_tracing();
+  jaxie::realtime::disable_tracing();
+}
+
+TEST_CASE("latency trace hands reserved buffers to new threads without allocating", "[realtime][trace]") {
+  auto events = fresh_trace();
+  jaxie::realtime::enable_tracing(jaxie::realtime::default_trace_events, 2);
+  std::array<uint64_t, 2> allocations{};
+  std::array<uint64_t, 2> exit_hooks{};
+  std::array<std::thread, 2> workers;
+  for (size_t i = 0; i < workers.size(); ++i) {
+    workers[i] = std::thread([&allocations, &exit_hooks, i]() {
+      const uint64_t allocated = thread_allocations;
+      const uint64_t hooked = thread_exit_hooks;
+      jaxie::realtime::trace(trace_point::device_callback, trace_phase::instant, i * 160ULL, 160);
+      allocations[i] = thread_allocations - allocated;
+      exit_hooks[i] = thread_exit_hooks - hooked;
+    });
+    workers[i].join(); // one at a time: the second must find its own spare
+  }
+  jaxie::realtime::disable_tracing();
+
+  REQUIRE(allocations == std::array<uint64_t, 2>{});
+  REQUIRE(exit_hooks == std::array<uint64_t, 2>{});
+  REQUIRE(jaxie::realtime::drain_trace(events) == 2);
+  REQUIRE(events.front().thread != events.back().thread);
+}
+
+TEST_CASE("latency trace drops the events of threads that find no reserved buffer", "[realtime][trace]") {
+  auto events = fresh_trace();
+  const uint64_t dropped_before = jaxie::realtime::dropped_trace_events();
+  jaxie::realtime::enable_tracing(16, 1);
+  // More threads than there can be spares: the ones left over record nothing and allocate nothing.
+  constexpr size_t threads = 20;
+  uint64_t allocations = 0;
+  for (size_t i = 0; i < threads; ++i) {
+    std::thread([&allocations]() {
+      const uint64_t allocated = thread_allocations;
+      jaxie::realtime::trace(trace_point::token_emit, trace_phase::instant, 0, 1);
+      allocations += thread_allocations - allocated;
+    }).join();
+  }
+  jaxie::realtime::disable_tracing();
+
+  const size_t recorded = jaxie::realtime::drain_trace(events);
+  const uint64_t dropped = jaxie::realtime::dropped_trace_events() - dropped_before;
+  REQUIRE(allocations == 0);
+  REQUIRE(recorded >= 1);
+  REQUIRE(dropped >= 4);
+  REQUIRE(recorded + dropped == threads);
+  jaxie::realtime::enable_tracing();
+  jaxie::realtime::disable_tracing();
+}
+
+TEST_CASE("latency trace reuses drained buffers of earlier sessions", "[realtime][trace]") {
+  auto events = fresh_trace();
+  std::vector<uint32_t> rings;
+  for (int session = 0; session < 8; ++session) {
+    jaxie::realtime::enable_tracing(32, 1);
+    std::thread([]() { jaxie::realtime::trace(trace_point::encoder, trace_phase::instant, 0); }).join();
+    jaxie::realtime::disable_tracing();
+    events.clear();
+    REQUIRE(jaxie::realtime::drain_trace(events) == 1);
+    rings.push_back(events.front().thread);
+  }
+  // Each session's thread has exited; without reuse every session would allocate a ring of its own.
+  std::sort(rings.begin(), rings.end());
+  REQUIRE(std::unique(rings.begin(), rings.end()) - rings.begin() <= 2);
+  jaxie::realtime::enable_tracing();
+  jaxie::realtime::disable_tracing();
+}
+
+TEST_CASE("latency trace origin is per thread", "[realtime][trace]") {
+  jaxie::realtime::set_trace_origin(480);
+  uint64_t seen = 0;
+  std::thread worker([&]() { seen = jaxie::realtime::trace_origin(); });
+  worker.join();
+  REQUIRE(seen == jaxie::realtime::no_trace_sample);
+  REQUIRE(jaxie::realtime::trace_origin() == 480);
+  jaxie::realtime::set_trace_origin(jaxie::realtime::no_trace_sample);
+}
+
+TEST_CASE("latency trace summary matches stages by capture frame", "[realtime][trace]") {
+  // Two 160-frame periods; a token emitted at frame 300 comes from the second device callback.
+  std::vector<trace_event> events{
+    make_event(1'000, trace_point::device_callback, trace_phase::instant, 0, 160),
+    make_event(3'000, trace_point::ring_commit, trace_phase::instant, 0, 160),
+    make_event(10'000, trace_point::consumer_wakeup, trace_phase::instant, 0, 160),
+    make_event(10'000, trace_point::user_callback, trace_phase::begin, 0, 160),
+    make_event(60'000, trace_point::user_callback, trace_phase::end, 0, 160),
+    make_event(100'000, trace_point::device_callback, trace_phase::instant, 160, 160),
+    make_event(104'000, trace_point::ring_commit, trace_phase::instant, 160, 160),
+    make_event(105'000, trace_point::consumer_wakeup, trace_phase::instant, 160, 160),
+    make_event(105'000, trace_point::user_callback, trace_phase::begin, 160, 160),
+    make_event(110'000, trace_point::encoder, trace_phase::begin, 160),
+    make_event(130'000, trace_point::encoder, trace_phase::end, 160),
+    make_event(130'000, trace_point::decode, trace_phase::begin, 160),
+    make_event(150'000, trace_point::decode, trace_phase::end, 160),
+    make_event(151'000, trace_point::token_emit, trace_phase::instant, 300, 9),
+    make_event(155'000, trace_point::user_callback, trace_phase::end, 160, 160),
+  };
+  const auto stages = jaxie::realtime::summarize_trace(events);
+
+  const auto* commit = find_stage(stages, "device->commit");
+  REQUIRE(commit != nullptr);
+  REQUIRE(commit->count == 2);
+  REQUIRE(commit->p50_ns == 2'000);
+  REQUIRE(commit->max_ns == 4'000);
+  REQUIRE(commit->histogram[2] == 1); // 2 us: [2, 4) us
+  REQUIRE(commit->histogram[3] == 1); // 4 us: [4, 8) us
+
+  const auto* wakeup = find_stage(stages, "commit->wakeup");
+  REQUIRE(wakeup != nullptr);
+  REQUIRE(wakeup->count == 2);
+  REQUIRE(wakeup->max_ns == 7'000);
+
+  const auto* callback = find_stage(stages, "callback");
+  REQUIRE(callback != nullptr);
+  REQUIRE(callback->count == 2);
+  REQUIRE(callback->p50_ns == 50'000);
+
+  REQUIRE(find_stage(stages, "encoder")->max_ns == 20'000);
+  REQUIRE(find_stage(stages, "decode")->max_ns == 20'000);
+
+  const auto* token = find_stage(stages, "audio->token");
+  REQUIRE(token != nullptr);
+  REQUIRE(token->count == 1);
+  REQUIRE(token->p99_ns == 51'000);
+
+  const auto path = (std::filesystem::temp_directory_path() / "jaxie_latency_trace.json").string();
+  REQUIRE(jaxie::realtime::write_chrome_trace(path, events));
+  std::ifstream in(path);
+  const std::string json{ std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>() };
+  REQUIRE(json.starts_with("{\"displayTimeUnit\":\"ns\",\"traceEvents\":["));
+  REQUIRE(json.find("{\"name\":\"encoder\",\"cat\":\"jaxie\",\"ph\":\"B\",\"ts\":109.000") != std::string::npos);
+  REQUIRE(json.find("\"name\":\"token_emit\",\"cat\":\"jaxie\",\"ph\":\"i\",\"s\":\"t\"") != std::string::npos);
+  REQUIRE(json.find("\"args\":{\"sample\":300,\"value\":9}") != std::string::npos);
+  in.close();
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("audio_capture traces each period from delivery to callback", "[audio][realtime][trace]") {
+  auto events = fresh_trace();
+  jaxie::audio::capture_config cfg{};
+  cfg.source = jaxie::audio::capture_source::file;
+  cfg.pacing = jaxie::audio::replay_pacing::as_fast_as_possible;
+  cfg.replay_path = write_ramp_wav("jaxie_trace_ramp.wav", cfg.sample_rate_hz, 1600);
+
+  // The ramp's value is the capture frame, so the callback can check the origin it is handed.
+  std::atomic<uint32_t> mismatched{0};
+  jaxie::audio::audio_capture cap;
+  REQUIRE(cap.init(cfg, [&](std::span<const float> period) {
+    if (static_cast<uint64_t>(period.front() * 32768.0F) != jaxie::realtime::trace_origin()) {
+      mismatched.fetch_add(1);
+    }
+  }));
+  jaxie::realtime::enable_tracing();
+  REQUIRE(cap.start());
+  for (int i = 0; i < 200 && !cap.stats().end_of_stream; ++i) {
+    std::this_thread::sleep_for(10ms);
+  }
+  cap.stop();
+  jaxie::realtime::disable_tracing();
+  REQUIRE(jaxie::realtime::trace_origin() == jaxie::realtime::no_trace_sample);
+
+  const auto periods = cap.stats().periods_delivered;
+  REQUIRE(periods == 10);
+  REQUIRE(mismatched.load() == 0);
+  jaxie::realtime::drain_trace(events);
+  const auto stages = jaxie::realtime::summarize_trace(events);
+  REQUIRE(find_stage(stages, "device->commit") != nullptr);
+  REQUIRE(find_stage(stages, "device->commit")->count == periods);
+  REQUIRE(find_stage(stages, "commit->wakeup") != nullptr);
+  REQUIRE(find_stage(stages, "commit->wakeup")->count == periods);
+  REQUIRE(find_stage(stages, "callback") != nullptr);
+  REQUIRE(find_stage(stages, "callback")->count == periods);
+
+  cap.shutdown();
+  std::filesystem::remove(cfg.replay_path);
+}
@@ -0,0 +1,169 @@
+// SPDX-License-Identifier: UNLICENSED
+#include <Jaxie/dsp/fft.hpp>
+#include <Jaxie/dsp/log_mel.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <numbers>
+#include <span>
+#include <vector>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+namespace {
+
+std::vector<float> test_signal(size_t frames) {
+  std::vector<float> out(frames);
+  uint32_t noise = 12345;
+  for (size_t i = 0; i < frames; ++i) {
+    noise = (noise * 1664525U) + 1013904223U;
+    const double t = static_cast<double>(i) / 16000.0;
+    const double tone = (0.3 * std::sin(2.0 * std::numbers::pi * 440.0 * t)) + (0.2 * std::sin(2.0 * std::numbers::pi * 2500.0 * t));
+    out[i] = static_cast<float>(tone + (0.01 * ((static_cast<double>(noise >> 8) / 16777216.0) - 0.5)));
+  }
+  return out;
+}
+
+// Whole-signal reference in double precision with a direct DFT and dense filters.
+std::vector<double> reference_log_mel(std::span<const float> audio, const jaxie::dsp::log_mel_config& cfg) {
+  const auto mel = [](double hz) { return 2595.0 * std::log10(1.0 + (hz / 700.0)); };
+  const auto hz = [](double m) { return 700.0 * (std::pow(10.0, m / 2595.0) - 1.0); };
+  const size_t bins = (cfg.fft_size / 2) + 1;
+  const double rate = cfg.sample_rate_hz;
+  const double fft_size = cfg.fft_size;
+  const double window_frames = cfg.window_frames;
+  const double coeff = cfg.preemphasis;
+  const double low_mel = mel(cfg.low_freq_hz);
+  const double high = cfg.high_freq_hz > 0.0F ? static_cast<double>(cfg.high_freq_hz) : rate / 2.0;
+  const double step = (mel(high) - low_mel) / (cfg.mel_bins + 1.0);
+
+  std::vector<double> emphasized(audio.size());
+  for (size_t i = 0; i < audio.size(); ++i) {
+    const double previous = i == 0 ? 0.0 : static_cast<double>(audio[i - 1]);
+    emphasized[i] = static_cast<double>(audio[i]) - (coeff * previous);
+  }
+
+  std::vector<double> out;
+  for (size_t start = 0; start + cfg.window_frames <= audio.size(); start += cfg.hop_frames) {
+    std::vector<double> power(bins);
+    for (size_t k = 0; k < bins; ++k) {
+      std::complex<double> acc{};
+      for (size_t n = 0; n < cfg.window_frames; ++n) {
+        const auto phase = static_cast<double>(n);
+        const double window = 0.5 - (0.5 * std::cos(2.0 * std::numbers::pi * phase / window_frames));
+        acc += emphasized[start + n] * window * std::polar(1.0, -2.0 * std::numbers::pi * static_cast<double>(k) * phase / fft_size);
+      }
+      power[k] = std::norm(acc);
+    }
+    for (uint32_t m = 0; m < cfg.mel_bins; ++m) {
+      const double left = hz(low_mel + (step * m));
+      const double center = hz(low_mel + (step * (m + 1)));
+      const double right = hz(low_mel + (step * (m + 2)));
+      double energy = 0.0;
+      for (size_t k = 0; k < bins; ++k) {
+        const double f = static_cast<double>(k) * rate / fft_size;
+        if (f > left && f <= center) {
+          energy += power[k] * (f - left) / (center - left);
+        } else if (f > center && f < right) {
+          energy += power[k] * (right - f) / (right - center);
+        }
+      }
+      out.push_back(std::log(std::max(energy, static_cast<double>(cfg.log_floor))));
+    }
+  }
+  return out;
+}
+
+} // namespace
+
+TEST_CASE("real_fft matches a direct DFT", "[dsp][log_mel]") {
+  jaxie::dsp::real_fft fft;
+  REQUIRE_FALSE(fft.init(400));
+  REQUIRE(fft.init(64));
+  REQUIRE(fft.bins() == 33);
+
+  const auto signal = test_signal(64);
+  std::vector<float> re(fft.bins());
+  std::vector<float> im(fft.bins());
+  fft.forward(signal, re, im);
+
+  for (size_t k = 0; k < fft.bins(); ++k) {
+    std::complex<double> expected{};
+    for (size_t n = 0; n < signal.size(); ++n) {
+      expected += static_cast<double>(signal[n]) * std::polar(1.0, -2.0 * std::numbers::pi * static_cast<double>(k * n) / 64.0);
+    }
+    REQUIRE(std::abs(static_cast<double>(re[k]) - expected.real()) < 1e-4);
+    REQUIRE(std::abs(static_cast<double>(im[k]) - expected.imag()) < 1e-4);
+  }
+}
+
+TEST_CASE("log_mel_frontend streamed in 10 ms periods matches the reference", "[dsp][log_mel]") {
+  const jaxie::dsp::log_mel_config cfg{};
+  jaxie::dsp::log_mel_frontend frontend;
+  REQUIRE(frontend.init(cfg));
+
+  const auto audio = test_signal(16000);
+  const auto expected = reference_log_mel(audio, cfg);
+
+  std::vector<float> features;
+  std::vector<float> scratch(static_cast<size_t>(cfg.mel_bins) * 4);
+  for (size_t offset = 0; offset < audio.size(); offset += cfg.hop_frames) {
+    const auto period = std::span<const float>(audio).subspan(offset, cfg.hop_frames);
+    const size_t expected_frames = frontend.frames_for(period.size());
+    const size_t frames = frontend.push(period, scratch);
+    REQUIRE(frames == expected_frames);
+    features.insert(features.end(), scratch.begin(), scratch.begin() + static_cast<std::ptrdiff_t>(frames * cfg.mel_bins));
+  }
+
+  // (16000 - 400) / 160 + 1 frames, the same as framing the whole signal at once.
+  REQUIRE(features.size() == expected.size());
+  REQUIRE(features.size() == 98U * cfg.mel_bins);
+  double worst = 0.0;
+  for (size_t i = 0; i < features.size(); ++i) {
+    worst = std::max(worst, std::abs(static_cast<double>(features[i]) - expected[i]));
+  }
+  // Float accumulation costs a little in the quietest bands (energies ~1e-7), hence the margin.
+  REQUIRE(worst < 5e-3);
+  REQUIRE(frontend.frames_dropped() == 0);
+}
+
+TEST_CASE("log_mel_frontend drops frames that do not fit and resets cleanly", "[dsp][log_mel]") {
+  jaxie::dsp::log_mel_frontend frontend;
+  jaxie::dsp::log_mel_config bad{};
+  bad.fft_size = 256;
+  REQUIRE_FALSE(frontend.init(bad));
+
+  REQUIRE(frontend.init({}));
+  const auto audio = test_signal(1600);
+  std::vector<float> one_frame(80);
+  REQUIRE(frontend.frames_for(audio.size()) == 8);
+  REQUIRE(frontend.push(audio, one_frame) == 1);
+  REQUIRE(frontend.frames_dropped() == 7);
+
+  frontend.reset();
+  REQUIRE(frontend.frames_for(399) == 0);
+  REQUIRE(frontend.frames_for(400) == 1);
+}
+
+TEST_CASE("log_mel_frontend throughput against the reference", "[dsp][log_mel][!benchmark]") {
+  const jaxie::dsp::log_mel_config cfg{};
+  jaxie::dsp::log_mel_frontend frontend;
+  REQUIRE(frontend.init(cfg));
+
+  // One second of audio: 98 frames per iteration, so frames/sec = 98 / mean time.
+  const auto audio = test_signal(16000);
+  std::vector<float> features(static_cast<size_t>(cfg.mel_bins) * 100);
+  BENCHMARK("log_mel_frontend, 1 s in 10 ms periods") {
+    frontend.reset();
+    size_t frames = 0;
+    for (size_t offset = 0; offset < audio.size(); offset += cfg.hop_frames) {
+      frames += frontend.push(std::span<const float>(audio).subspan(offset, cfg.hop_frames), features);
+    }
+    return frames;
+  };
+  BENCHMARK("reference (direct DFT, double), 1 s") { return reference_log_mel(audio, cfg).size(); };
+}
@@ -0,0 +1,79 @@
+// SPDX-License-Identifier: UNLICENSED
+#include <Jaxie/onnx/model_bundle.hpp>
+
+#include "tiny_rnnt.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <system_error>
+
+#include <catch2/catch_test_macros.hpp>
+
+namespace {
+
+void write_text(const std::filesystem::path& path, const std::string& text) {
+  std::ofstream(path, std::ios::binary) << text;
+}
+
+} // namespace
+
+// With ONNX Runtime the bundle is packed from the tiny RNNT, which is only generated alongside it.
+#if !defined(JAXIE_USE_ONNXRUNTIME) || defined(JAXIE_TINY_RNNT_DIR)
+
+TEST_CASE("model_bundle packs graphs and vocabulary and maps them back", "[onnx][bundle]") {
+  const auto dir = std::filesystem::temp_directory_path() / "jaxie_model_bundle_test";
+  std::filesystem::remove_all(dir);
+  std::filesystem::create_directories(dir);
+  write_text(dir / "tokens.vocab", "<unk>\t0\nhello\t-1.5\r\nworld\t-2\n");
+#if defined(JAXIE_USE_ONNXRUNTIME)
+  // Packing loads each graph to record its IO, so it needs real ones.
+  const auto graphs = jaxie::test::tiny_rnnt_paths();
+#else
+  write_text(dir / "encoder.onnx", std::string(5000, 'e'));
+  write_text(dir / "predictor.onnx", "predictor graph");
+  write_text(dir / "joint.onnx", "joint graph");
+  const jaxie::onnx::rnnt_model_paths graphs{
+    (dir / "encoder.onnx").string(), (dir / "predictor.onnx").string(), (dir / "joint.onnx").string()
+  };
+#endif
+  const std::string path = (dir / "model.jxb").string();
+  REQUIRE(jaxie::onnx::write_model_bundle(path, graphs, (dir / "tokens.vocab").string()));
+
+  jaxie::onnx::model_bundle bundle;
+  REQUIRE(bundle.open(path, true));
+  REQUIRE(bundle.section(jaxie::onnx::bundle_section::encoder).size() == std::filesystem::file_size(graphs.encoder));
+  REQUIRE(bundle.section(jaxie::onnx::bundle_section::joint).size() == std::filesystem::file_size(graphs.joint));
+#if defined(JAXIE_USE_ONNXRUNTIME)
+  REQUIRE_FALSE(bundle.io(jaxie::onnx::bundle_section::encoder).inputs.empty());
+#endif
+  REQUIRE_FALSE(bundle.is_ort_format(jaxie::onnx::bundle_section::joint));
+  REQUIRE(bundle.vocab().size() == 3);
+  REQUIRE(bundle.vocab()[1] == "hello");
+  REQUIRE(bundle.vocab()[2] == "world");
+
+  jaxie::onnx::model_bundle moved = std::move(bundle);
+  REQUIRE_FALSE(bundle.is_open()); // NOLINT(bugprone-use-after-move)
+  REQUIRE(moved.vocab()[0] == "<unk>");
+  moved.close();
+
+  // A flipped byte in a graph fails verification; an unverified open (the default) skips the read.
+  {
+    std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+    file.seekp(4096 + 10);
+    file.put('x');
+  }
+  REQUIRE_FALSE(moved.open(path, true));
+  REQUIRE(moved.open(path));
+  moved.close();
+
+  write_text(dir / "short.jxb", "JXBUNDLE");
+  REQUIRE_FALSE(moved.open((dir / "short.jxb").string()));
+  REQUIRE_FALSE(moved.open((dir / "missing.jxb").string()));
+  REQUIRE_FALSE(jaxie::onnx::write_model_bundle(path, { "missing.onnx", "missing.onnx", "missing.onnx" }, ""));
+
+  std::error_code error;
+  std::filesystem::remove_all(dir, error);
+}
+
+#endif
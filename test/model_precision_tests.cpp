@@ -0,0 +1,58 @@
+// SPDX-License-Identifier: UNLICENSED
+#include <Jaxie/onnx/model_precision.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include <catch2/catch_test_macros.hpp>
+
+namespace {
+
+void touch(const std::filesystem::path& path) { std::ofstream(path, std::ios::binary) << "graph"; }
+
+} // namespace
+
+TEST_CASE("select_precision takes the policy's variant and falls back per component", "[onnx][precision]") {
+  const auto dir = std::filesystem::temp_directory_path() / "jaxie_model_precision_test";
+  std::filesystem::remove_all(dir);
+  std::filesystem::create_directories(dir);
+  touch(dir / "encoder.onnx");
+  touch(dir / "encoder.int8.onnx");
+  touch(dir / "encoder.fp16.onnx");
+  touch(dir / "predictor.onnx");
+  touch(dir / "joint.fp16.onnx");
+
+  const auto variants = jaxie::onnx::find_model_variants(dir.string());
+  REQUIRE(variants.encoder.int8 == (dir / "encoder.int8.onnx").string());
+  REQUIRE(variants.predictor.fp16.empty());
+  REQUIRE(variants.joint.fp32.empty());
+
+  // Only CPU is requested, so the CPU column of the policy applies.
+  const jaxie::onnx::ep_prefs prefs{ .providers = { "CPU" }, .session = {} };
+  jaxie::onnx::rnnt_model_paths paths{};
+  jaxie::onnx::precision_choice choice{};
+  REQUIRE(jaxie::onnx::select_precision(variants, prefs, {}, paths, &choice));
+  REQUIRE_FALSE(choice.gpu);
+  REQUIRE(choice.provider == "CPU");
+  REQUIRE(choice.encoder == jaxie::onnx::model_precision::int8);
+  REQUIRE(paths.encoder == variants.encoder.int8);
+  REQUIRE(choice.predictor == jaxie::onnx::model_precision::fp32);
+  REQUIRE(choice.joint == jaxie::onnx::model_precision::fp16);
+  REQUIRE(paths.joint == (dir / "joint.fp16.onnx").string());
+  REQUIRE(jaxie::onnx::describe_precision(choice) == "encoder int8, predictor fp32, joint fp16");
+
+  // With no joint.onnx a uniform fp32 policy still resolves, just not to fp32 throughout.
+  const jaxie::onnx::component_precision fp32{ .gpu = jaxie::onnx::model_precision::fp32,
+                                               .cpu = jaxie::onnx::model_precision::fp32 };
+  REQUIRE(jaxie::onnx::select_precision(variants, prefs, { .encoder = fp32, .predictor = fp32, .joint = fp32 }, paths,
+    &choice));
+  REQUIRE(choice.encoder == jaxie::onnx::model_precision::fp32);
+  REQUIRE_FALSE(choice.all_fp32());
+
+  std::filesystem::remove(dir / "predictor.onnx");
+  jaxie::onnx::rnnt_model_paths untouched{};
+  REQUIRE_FALSE(jaxie::onnx::select_precision(jaxie::onnx::find_model_variants(dir.string()), prefs, {}, untouched));
+  REQUIRE(untouched.encoder.empty());
+  std::filesystem::remove_all(dir);
+}
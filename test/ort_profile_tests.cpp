@@ -0,0 +1,59 @@
+// SPDX-License-Identifier: UNLICENSED
+#include <Jaxie/onnx/ort_profile.hpp>
+
+#include <string_view>
+
+#include <catch2/catch_test_macros.hpp>
+
+namespace {
+
+// Trimmed from an ONNX Runtime trace: session events, fences and kernels with nested args.
+constexpr std::string_view trace = R"([
+{"cat" : "Session","pid" :1,"tid" :1,"dur" :812,"ts" :3,"ph" : "X","name" :"session_initialization","args" : {}},
+{"cat" : "Session","pid" :1,"tid" :1,"dur" :150,"ts" :900,"ph" : "X","name" :"model_run","args" : {}},
+{"cat" : "Node","pid" :1,"tid" :1,"dur" :2,"ts" :901,"ph" : "X","name" :"/enc/MatMul_fence_before","args" : {"op_name" : "MatMul"}},
+{"cat" : "Node","pid" :1,"tid" :1,"dur" :90,"ts" :903,"ph" : "X","name" :"/enc/MatMul_kernel_time","args" : {"thread_scheduling_stats" : {"main_thread" : {"thread_pool_name" : "session-1-intra-op", "block_size" : 1, "sub_threads" : [{"num_run" : 2}]}},"output_type_shape" : [{"float":[1,20,512]}],"output_size" : "40960","parameter_size" : "0","activation_size" : "40960","node_index" : "3","provider" : "CUDAExecutionProvider","op_name" : "MatMul"}},
+{"cat" : "Node","pid" :1,"tid" :1,"dur" :20,"ts" :995,"ph" : "X","name" :"/enc/Add_kernel_time","args" : {"op_name" : "Add","provider" : "CPUExecutionProvider"}},
+{"cat" : "Node","pid" :1,"tid" :1,"dur" :15,"ts" :1016,"ph" : "X","name" :"/enc/Add_1_kernel_time","args" : {"op_name" : "Add","provider" : "CPUExecutionProvider"}},
+{"cat" : "Session","pid" :1,"tid" :1,"dur" :100,"ts" :2000,"ph" : "X","name" :"model_run","args" : {}},
+{"cat" : "Node","pid" :1,"tid" :1,"dur" :60,"ts" :2001,"ph" : "X","name" :"/enc/MatMul_kernel_time","args" : {"op_name" : "MatMul","provider" : "CUDAExecutionProvider"}},
+{"cat" : "Node","pid" :1,"tid" :1,"dur" :10,"ts" :2062,"ph" : "X","name" :"/enc/Add_kernel_time","args" : {"op_name" : "Add","provider" : "CPUExecutionProvider"}}
+]
+)";
+
+} // namespace
+
+TEST_CASE("summarize_profile totals runs, kernels per operator and nodes per provider", "[onnx][profile]") {
+  jaxie::onnx::session_profile profile;
+  REQUIRE(jaxie::onnx::summarize_profile(trace, profile));
+  REQUIRE(profile.runs == 2);
+  REQUIRE(profile.run_us == 250);
+  REQUIRE(profile.kernel_us == 195);
+
+  REQUIRE(profile.ops.size() == 2);
+  REQUIRE(profile.ops[0].op == "MatMul");
+  REQUIRE(profile.ops[0].provider == "CUDAExecutionProvider");
+  REQUIRE(profile.ops[0].calls == 2);
+  REQUIRE(profile.ops[0].total_us == 150);
+  REQUIRE(profile.ops[1].op == "Add");
+  REQUIRE(profile.ops[1].calls == 3);
+  REQUIRE(profile.ops[1].total_us == 45);
+
+  REQUIRE(profile.nodes.size() == 2);
+  REQUIRE(profile.nodes[0].provider == "CPUExecutionProvider");
+  REQUIRE(profile.nodes[0].nodes == 2);
+  REQUIRE(profile.nodes[1].provider == "CUDAExecutionProvider");
+  REQUIRE(profile.nodes[1].nodes == 1);
+}
+
+TEST_CASE("summarize_profile keeps the whole events of a cut-off trace and rejects non-traces", "[onnx][profile]") {
+  jaxie::onnx::session_profile profile;
+  REQUIRE(jaxie::onnx::summarize_profile(trace.substr(0, trace.find("/enc/Add_1_kernel_time")), profile));
+  REQUIRE(profile.runs == 1);
+  REQUIRE(profile.kernel_us == 110);
+
+  REQUIRE_FALSE(jaxie::onnx::summarize_profile(R"({"traceEvents": []})", profile));
+  REQUIRE(profile.runs == 0);
+  REQUIRE(profile.ops.empty());
+  REQUIRE_FALSE(jaxie::onnx::load_profile("missing_profile.json", profile));
+}
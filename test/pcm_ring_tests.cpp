@@ -0,0 +1,170 @@
+// SPDX-License-Identifier: UNLICENSED
+#include <Jaxie/audio/pcm_ring.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+using jaxie::audio::overrun_policy;
+using jaxie::audio::pcm_ring;
+
+static std::vector<float> ramp(size_t count, float start) {
+  std::vector<float> out(count);
+  for (size_t i = 0; i < count; ++i) {
+    out[i] = start + static_cast<float>(i);
+  }
+  return out;
+}
+
+TEST_CASE("pcm_ring round-trips across the wrap point", "[audio][ring]") {
+  pcm_ring ring;
+  REQUIRE(ring.init(8, 1, overrun_policy::drop_newest));
+
+  std::array<float, 6> out{};
+  REQUIRE(ring.write(ramp(6, 0.0F)) == 6);
+  REQUIRE(ring.read(out));
+  REQUIRE(ring.write(ramp(6, 6.0F)) == 6);
+  REQUIRE(ring.read(out));
+  REQUIRE(out[0] == 6.0F);
+  REQUIRE(out[5] == 11.0F);
+
+  const auto stats = ring.stats();
+  REQUIRE(stats.overruns == 0);
+  REQUIRE(stats.high_water_frames == 6);
+}
+
+TEST_CASE("pcm_ring drop_newest keeps the oldest frames", "[audio][ring]") {
+  pcm_ring ring;
+  REQUIRE(ring.init(8, 1, overrun_policy::drop_newest));
+
+  REQUIRE(ring.write(ramp(6, 0.0F)) == 6);
+  REQUIRE(ring.write(ramp(6, 6.0F)) == 2);
+
+  std::array<float, 8> out{};
+  REQUIRE(ring.read(out));
+  REQUIRE(out[0] == 0.0F);
+  REQUIRE(out[7] == 7.0F);
+
+  const auto stats = ring.stats();
+  REQUIRE(stats.overruns == 1);
+  REQUIRE(stats.dropped_frames == 4);
+  REQUIRE(stats.high_water_frames == 8);
+}
+
+TEST_CASE("pcm_ring drop_oldest skips on the consumer side", "[audio][ring]") {
+  pcm_ring ring;
+  REQUIRE(ring.init(16, 1, overrun_policy::drop_oldest));
+
+  // Soft limit is 12 frames; crossing it makes the next read jump ahead.
+  REQUIRE(ring.write(ramp(14, 0.0F)) == 14);
+  std::array<float, 2> out{};
+  REQUIRE(ring.read(out));
+  REQUIRE(out[0] == 8.0F);
+
+  const auto stats = ring.stats();
+  REQUIRE(stats.overruns == 1);
+  REQUIRE(stats.dropped_frames == 8);
+}
+
+TEST_CASE("pcm_ring overwrite lets the reader detect it was lapped", "[audio][ring]") {
+  pcm_ring ring;
+  REQUIRE(ring.init(8, 2, overrun_policy::overwrite));
+
+  REQUIRE(ring.write(ramp(24, 0.0F)) == 12 - 4);
+  REQUIRE(ring.write(ramp(8, 100.0F)) == 4);
+
+  std::array<float, 4> out{};
+  REQUIRE(ring.read(out));
+  REQUIRE(out[0] == 16.0F);
+  REQUIRE(ring.read_position() == 6);
+
+  const auto stats = ring.stats();
+  REQUIRE(stats.dropped_frames == 8);
+}
+
+TEST_CASE("pcm_ring counts underruns without consuming", "[audio][ring]") {
+  pcm_ring ring;
+  REQUIRE(ring.init(8, 1, overrun_policy::drop_oldest));
+  REQUIRE(ring.write(ramp(3, 0.0F)) == 3);
+
+  std::array<float, 4> out{};
+  REQUIRE_FALSE(ring.read(out));
+  REQUIRE(ring.readable_frames() == 3);
+  REQUIRE(ring.stats().underruns == 1);
+}
+
+TEST_CASE("pcm_ring views stay contiguous across the wrap point", "[audio][ring]") {
+  for (const auto memory : { jaxie::audio::ring_memory::heap, jaxie::audio::ring_memory::mirrored }) {
+    pcm_ring ring;
+    REQUIRE(ring.init(8, 1, overrun_policy::drop_newest, memory));
+    const uint32_t capacity = ring.capacity_frames();
+    REQUIRE(capacity >= 8);
+
+    // Park the cursors three frames before the end so the next view straddles the wrap.
+    const auto lead = ramp(capacity - 3, 0.0F);
+    REQUIRE(ring.write(lead) == capacity - 3);
+    std::vector<float> sink(lead.size());
+    REQUIRE(ring.read(sink));
+
+    REQUIRE(ring.write(ramp(6, 100.0F)) == 6);
+    pcm_ring::read_view view{};
+    REQUIRE(ring.acquire_read(6, view));
+    REQUIRE(view.samples.size() == 6);
+    REQUIRE(view.first_frame == capacity - 3);
+    for (size_t i = 0; i < view.samples.size(); ++i) {
+      REQUIRE(view.samples[i] == 100.0F + static_cast<float>(i));
+    }
+    REQUIRE(ring.readable_frames() == 6);
+    REQUIRE(ring.commit_read(view));
+    REQUIRE(ring.readable_frames() == 0);
+  }
+}
+
+TEST_CASE("pcm_ring secondary readers share the stream without holding the producer", "[audio][ring]") {
+  pcm_ring ring;
+  REQUIRE(ring.init(8, 1, overrun_policy::drop_newest));
+  uint32_t fast = 0;
+  uint32_t slow = 0;
+  REQUIRE(ring.attach_reader(fast));
+  REQUIRE(ring.attach_reader(slow));
+  REQUIRE(fast != slow);
+
+  std::array<float, 4> primary{};
+  pcm_ring::read_view view{};
+  for (int round = 0; round < 4; ++round) {
+    REQUIRE(ring.write(ramp(4, static_cast<float>(round * 4))) == 4);
+    REQUIRE(ring.read(primary));
+    REQUIRE(ring.acquire_read(fast, 4, view));
+    // Same memory the primary just read, not a copy.
+    REQUIRE(view.samples[0] == static_cast<float>(round * 4));
+    REQUIRE(ring.commit_read(fast, view));
+  }
+
+  // The slow reader never read: the producer lapped it, and only it pays for that.
+  REQUIRE(ring.readable_frames(slow) == 8);
+  REQUIRE(ring.acquire_read(slow, 4, view));
+  REQUIRE(view.samples[0] == 8.0F);
+  REQUIRE(ring.commit_read(slow, view));
+
+  const auto slow_stats = ring.stats(slow);
+  REQUIRE(slow_stats.overruns == 1);
+  REQUIRE(slow_stats.dropped_frames == 8);
+  REQUIRE(slow_stats.max_lag_frames == 16);
+  REQUIRE(ring.stats(fast).dropped_frames == 0);
+  REQUIRE(ring.stats(fast).delivered_frames == 16);
+  REQUIRE(ring.stats().dropped_frames == 0);
+
+  // A view the producer overwrites while it is held is rejected on commit.
+  REQUIRE(ring.acquire_read(slow, 4, view));
+  REQUIRE(ring.write(ramp(4, 16.0F)) == 4);
+  REQUIRE(ring.read(primary));
+  REQUIRE(ring.write(ramp(4, 20.0F)) == 4);
+  REQUIRE_FALSE(ring.commit_read(slow, view));
+  REQUIRE(ring.stats(slow).overruns == 2);
+
+  ring.detach_reader(slow);
+  REQUIRE_FALSE(ring.acquire_read(slow, 4, view));
+}
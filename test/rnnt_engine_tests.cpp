@@ -0,0 +1,146 @@
+// SPDX-License-Identifier: UNLICENSED
+#include <Jaxie/onnx/rnnt_engine.hpp>
+
+#include "tiny_rnnt.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+TEST_CASE("rnnt_engine refuses streams before a model is loaded", "[onnx][engine]") {
+  jaxie::onnx::rnnt_engine engine;
+  uint32_t id = 0;
+  REQUIRE_FALSE(engine.open_stream(id));
+  const std::vector<float> audio(1600, 0.0F);
+  REQUIRE_FALSE(engine.push(0, audio));
+  engine.reset_stream(0);
+  engine.close_stream(0);
+  engine.shutdown();
+
+  const auto stats = engine.stats();
+  REQUIRE(stats.open_streams == 0);
+  REQUIRE(stats.batches == 0);
+}
+
+TEST_CASE("rnnt_engine load fails cleanly for missing models and bad options", "[onnx][engine]") {
+  jaxie::onnx::rnnt_engine engine;
+  const jaxie::onnx::rnnt_model_paths missing{ "missing_encoder.onnx", "missing_predictor.onnx", "missing_joint.onnx" };
+  const auto ignore = [](uint32_t, std::span<const int32_t>) {};
+  REQUIRE_FALSE(engine.load(missing, {}, {}, ignore));
+  REQUIRE_FALSE(engine.is_loaded());
+
+  jaxie::onnx::engine_options options{};
+  options.max_streams = 0;
+  REQUIRE_FALSE(engine.load(missing, {}, options, ignore));
+  options = {};
+  options.max_batch = 0;
+  REQUIRE_FALSE(engine.load(missing, {}, options, ignore));
+  options = {};
+  options.rnnt.decoding = jaxie::onnx::decode_mode::modified_beam;
+  REQUIRE_FALSE(engine.load(missing, {}, options, ignore));
+
+  uint32_t id = 0;
+  REQUIRE_FALSE(engine.open_stream(id));
+}
+
+#if defined(JAXIE_TINY_RNNT_DIR)
+
+namespace {
+
+// Waits for the engine to have encoded `chunks` chunks, then stops it so every token has been delivered.
+bool drain(jaxie::onnx::rnnt_engine& engine, uint64_t chunks) {
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(20);
+  while (engine.stats().chunks < chunks && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  const bool done = engine.stats().chunks == chunks;
+  engine.shutdown();
+  return done;
+}
+
+} // namespace
+
+TEST_CASE("rnnt_engine decodes each batched stream of the tiny RNNT as a standalone streaming_rnnt", "[onnx][engine]") {
+  constexpr size_t streams = 4;
+  std::array<std::vector<float>, streams> audio;
+  std::array<std::vector<int32_t>, streams> expected;
+  uint64_t chunks = 0;
+  for (size_t i = 0; i < streams; ++i) {
+    audio[i] = jaxie::test::tiny_rnnt_audio(32000, static_cast<uint32_t>(i + 1));
+    // The engine has no finish(): compare against step() alone.
+    jaxie::onnx::streaming_rnnt standalone;
+    REQUIRE(standalone.load(jaxie::test::tiny_rnnt_paths(), {}));
+    std::vector<int32_t> emitted;
+    for (size_t at = 0; at < audio[i].size(); at += 1600) {
+      REQUIRE(standalone.step(std::span<const float>(audio[i]).subspan(at, 1600), emitted));
+      expected[i].insert(expected[i].end(), emitted.begin(), emitted.end());
+    }
+    REQUIRE_FALSE(expected[i].empty());
+    chunks += standalone.stats().encoder_runs;
+  }
+
+  std::array<std::vector<int32_t>, streams> tokens; // appended on the engine thread, read after shutdown()
+  jaxie::onnx::engine_options options{};
+  options.max_batch = streams;
+  options.max_wait_us = 200000; // long enough for every stream's chunk to join the batch
+  options.max_backlog_chunks = 64;
+  jaxie::onnx::rnnt_engine engine;
+  const auto keep = [&tokens](uint32_t id, std::span<const int32_t> out) {
+    tokens.at(id).insert(tokens.at(id).end(), out.begin(), out.end());
+  };
+  REQUIRE(engine.load(jaxie::test::tiny_rnnt_paths(), {}, options, keep));
+  std::array<uint32_t, streams> ids{};
+  for (size_t i = 0; i < streams; ++i) {
+    REQUIRE(engine.open_stream(ids[i]));
+    REQUIRE(ids[i] == i);
+  }
+  for (size_t at = 0; at < audio[0].size(); at += 1600) {
+    for (size_t i = 0; i < streams; ++i) {
+      REQUIRE(engine.push(ids[i], std::span<const float>(audio[i]).subspan(at, 1600)));
+    }
+  }
+  REQUIRE(drain(engine, chunks));
+
+  const auto stats = engine.stats();
+  REQUIRE(stats.batch_limit == streams);
+  REQUIRE(stats.full_batches > 0);
+  REQUIRE(stats.batches < stats.chunks);
+  REQUIRE(stats.failed_batches == 0);
+  REQUIRE(stats.dropped_frames == 0);
+  for (size_t i = 0; i < streams; ++i) {
+    REQUIRE(tokens[i] == expected[i]);
+  }
+}
+
+TEST_CASE("rnnt_engine sends a backlogged stream's chunks without waiting max_wait_us for each", "[onnx][engine]") {
+  const auto audio = jaxie::test::tiny_rnnt_audio(32000);
+  jaxie::onnx::streaming_rnnt standalone;
+  REQUIRE(standalone.load(jaxie::test::tiny_rnnt_paths(), {}));
+  std::vector<int32_t> emitted;
+  REQUIRE(standalone.step(audio, emitted));
+  const uint64_t chunks = standalone.stats().encoder_runs;
+  REQUIRE(chunks > 2);
+
+  jaxie::onnx::engine_options options{};
+  options.max_wait_us = 300000;
+  options.max_backlog_chunks = 64;
+  jaxie::onnx::rnnt_engine engine;
+  REQUIRE(engine.load(jaxie::test::tiny_rnnt_paths(), {}, options, {}));
+  uint32_t id = 0;
+  REQUIRE(engine.open_stream(id));
+
+  // One stream alone never fills a batch: its first chunk waits max_wait_us, the rest of the backlog follows.
+  const auto started = std::chrono::steady_clock::now();
+  REQUIRE(engine.push(id, audio));
+  REQUIRE(drain(engine, chunks));
+  REQUIRE(std::chrono::steady_clock::now() - started < std::chrono::microseconds(3 * options.max_wait_us));
+}
+
+#endif
+
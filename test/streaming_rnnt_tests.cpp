@@ -0,0 +1,477 @@
+// SPDX-License-Identifier: UNLICENSED
+#include <Jaxie/onnx/streaming_rnnt.hpp>
+
+#include "tiny_rnnt.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#if defined(JAXIE_TINY_RNNT_DIR)
+#include <Jaxie/dsp/log_mel.hpp>
+#include <onnxruntime_cxx_api.h>
+#endif
+
+TEST_CASE("streaming_rnnt refuses to step before a model is loaded", "[onnx][rnnt]") {
+  jaxie::onnx::streaming_rnnt rnnt;
+  const std::vector<float> audio(1600, 0.0F);
+  std::vector<int32_t> tokens{ 7 };
+  REQUIRE_FALSE(rnnt.step(audio, tokens));
+  REQUIRE_FALSE(rnnt.step_window(audio, 0, 0, tokens));
+  REQUIRE(rnnt.token_frames().empty());
+  REQUIRE(rnnt.partial().tokens.empty());
+  rnnt.reset_state();
+}
+
+TEST_CASE("streaming_rnnt load fails cleanly for missing models and bad options", "[onnx][rnnt]") {
+  jaxie::onnx::streaming_rnnt rnnt;
+  const jaxie::onnx::rnnt_model_paths missing{ "missing_encoder.onnx", "missing_predictor.onnx", "missing_joint.onnx" };
+  REQUIRE_FALSE(rnnt.load(missing, {}));
+
+  jaxie::onnx::rnnt_options options{};
+  options.max_step_frames = 0;
+  REQUIRE_FALSE(rnnt.load(missing, {}, options));
+
+  const std::vector<float> audio(1600, 0.0F);
+  std::vector<int32_t> tokens;
+  REQUIRE_FALSE(rnnt.step(audio, tokens));
+  REQUIRE(tokens.empty());
+}
+
+TEST_CASE("streaming_rnnt has no placement or profile without a loaded model", "[onnx][rnnt]") {
+  jaxie::onnx::streaming_rnnt rnnt;
+  jaxie::onnx::rnnt_profile profile;
+  REQUIRE_FALSE(rnnt.collect_profile(profile));
+  REQUIRE(rnnt.placement().encoder.registered.empty());
+  REQUIRE(rnnt.placement().joint.rejected.empty());
+  REQUIRE(profile.steps == 0);
+  REQUIRE(profile.files.empty());
+}
+
+TEST_CASE("streaming_rnnt only shares the sessions of a loaded model", "[onnx][rnnt]") {
+  jaxie::onnx::streaming_rnnt source;
+  jaxie::onnx::streaming_rnnt stream;
+  REQUIRE_FALSE(stream.load_shared(source));
+  REQUIRE_FALSE(stream.load_shared(stream));
+
+  const jaxie::onnx::rnnt_model_paths missing{ "missing_encoder.onnx", "missing_predictor.onnx", "missing_joint.onnx" };
+  REQUIRE_FALSE(source.load(missing, {}));
+  REQUIRE_FALSE(stream.load_shared(source));
+
+  const std::vector<float> audio(1600, 0.0F);
+  std::vector<int32_t> tokens;
+  REQUIRE_FALSE(stream.step(audio, tokens));
+}
+
+#if defined(JAXIE_TINY_RNNT_DIR)
+
+namespace {
+
+// Greedy decoding of the tiny RNNT through plain Session::Run() calls whose outputs ORT allocates: no IoBinding,
+// arena or ping-pong state. Same frontend, encoder chunks and decoding rule as streaming_rnnt's defaults; a
+// cache-aware encoder gets each call's cache output back as the next call's input.
+std::vector<int32_t> unbound_greedy(std::span<const float> audio, const jaxie::onnx::rnnt_model_paths& paths) {
+  constexpr int64_t encoder_dim = 128;
+  constexpr int64_t predictor_dim = 64;
+  constexpr int64_t vocabulary = 129;
+  constexpr int32_t blank = vocabulary - 1;
+  const jaxie::onnx::rnnt_options options{};
+  const size_t bins = options.features.mel_bins;
+  const size_t chunk = options.encoder_chunk_frames;
+
+  jaxie::dsp::log_mel_frontend frontend;
+  REQUIRE(frontend.init(options.features));
+  std::vector<float> rows(frontend.frames_for(audio.size()) * bins);
+  rows.resize(frontend.push(audio, rows) * bins);
+
+  const Ort::Env env(ORT_LOGGING_LEVEL_WARNING, "unbound_greedy");
+  Ort::Session encoder(env, paths.encoder.c_str(), Ort::SessionOptions{});
+  Ort::Session predictor(env, paths.predictor.c_str(), Ort::SessionOptions{});
+  Ort::Session joint(env, paths.joint.c_str(), Ort::SessionOptions{});
+  const auto memory = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
+  const Ort::RunOptions run{ nullptr };
+
+  std::vector<float> prediction(predictor_dim);
+  std::vector<float> state(predictor_dim, 0.0F);
+  const auto predict = [&](int32_t token) {
+    int32_t length = 1;
+    const std::array<int64_t, 2> token_shape{ 1, 1 };
+    const std::array<int64_t, 1> length_shape{ 1 };
+    const std::array<int64_t, 3> state_shape{ 1, 1, predictor_dim };
+    const std::array<Ort::Value, 3> inputs{
+      Ort::Value::CreateTensor<int32_t>(memory, &token, 1, token_shape.data(), token_shape.size()),
+      Ort::Value::CreateTensor<int32_t>(memory, &length, 1, length_shape.data(), length_shape.size()),
+      Ort::Value::CreateTensor<float>(memory, state.data(), state.size(), state_shape.data(), state_shape.size()) };
+    const std::array<const char*, 3> input_names{ "targets", "target_length", "state" };
+    const std::array<const char*, 2> output_names{ "outputs", "state_next" };
+    auto outputs = predictor.Run(
+      run, input_names.data(), inputs.data(), inputs.size(), output_names.data(), output_names.size());
+    std::copy_n(outputs[0].GetTensorData<float>(), predictor_dim, prediction.begin());
+    std::copy_n(outputs[1].GetTensorData<float>(), predictor_dim, state.begin());
+  };
+  predict(blank); // blank doubles as start of sequence
+
+  // Like streaming_rnnt, start from a zero cache of one element; the first call reveals the real size.
+  const bool cache_aware = encoder.GetInputCount() == 3;
+  std::vector<float> cache(1, 0.0F);
+  std::vector<int64_t> cache_shape{ 1, 1, 1 };
+
+  std::vector<int32_t> tokens;
+  std::vector<float> features(bins * chunk);
+  std::vector<float> frame(encoder_dim);
+  for (size_t first = 0; first + chunk <= rows.size() / bins; first += chunk) {
+    for (size_t t = 0; t < chunk; ++t) {
+      for (size_t m = 0; m < bins; ++m) {
+        features[(m * chunk) + t] = rows[((first + t) * bins) + m];
+      }
+    }
+    auto frames = static_cast<int64_t>(chunk);
+    const std::array<int64_t, 3> feature_shape{ 1, static_cast<int64_t>(bins), frames };
+    const std::array<int64_t, 1> length_shape{ 1 };
+    std::vector<Ort::Value> inputs;
+    inputs.push_back(
+      Ort::Value::CreateTensor<float>(memory, features.data(), features.size(), feature_shape.data(), 3));
+    inputs.push_back(Ort::Value::CreateTensor<int64_t>(memory, &frames, 1, length_shape.data(), 1));
+    if (cache_aware) {
+      inputs.push_back(
+        Ort::Value::CreateTensor<float>(memory, cache.data(), cache.size(), cache_shape.data(), cache_shape.size()));
+    }
+    const std::array<const char*, 3> input_names{ "audio_signal", "length", "cache_last_channel" };
+    const std::array<const char*, 2> encoder_names{ "outputs", "cache_last_channel_next" };
+    const std::array<const char*, 1> output_names{ "outputs" };
+    auto encoded = encoder.Run(
+      run, input_names.data(), inputs.data(), inputs.size(), encoder_names.data(), cache_aware ? 2 : 1);
+    if (cache_aware) {
+      const auto info = encoded[1].GetTensorTypeAndShapeInfo();
+      cache.assign(encoded[1].GetTensorData<float>(), encoded[1].GetTensorData<float>() + info.GetElementCount());
+      cache_shape = info.GetShape();
+    }
+    const int64_t encoded_frames = encoded[0].GetTensorTypeAndShapeInfo().GetShape()[2];
+    const float* data = encoded[0].GetTensorData<float>();
+
+    for (int64_t t = 0; t < encoded_frames; ++t) {
+      for (int64_t d = 0; d < encoder_dim; ++d) {
+        frame[static_cast<size_t>(d)] = data[(d * encoded_frames) + t];
+      }
+      for (uint32_t symbol = 0; symbol < options.max_symbols_per_frame; ++symbol) {
+        const std::array<int64_t, 3> frame_shape{ 1, encoder_dim, 1 };
+        const std::array<int64_t, 3> prediction_shape{ 1, predictor_dim, 1 };
+        const std::array<Ort::Value, 2> joint_inputs{
+          Ort::Value::CreateTensor<float>(memory, frame.data(), frame.size(), frame_shape.data(), 3),
+          Ort::Value::CreateTensor<float>(memory, prediction.data(), prediction.size(), prediction_shape.data(), 3) };
+        const std::array<const char*, 2> joint_names{ "encoder_outputs", "decoder_outputs" };
+        auto scores = joint.Run(run, joint_names.data(), joint_inputs.data(), 2, output_names.data(), 1);
+        const float* log_probs = scores[0].GetTensorData<float>();
+        const auto token = static_cast<int32_t>(std::max_element(log_probs, log_probs + vocabulary) - log_probs);
+        if (token == blank) {
+          break;
+        }
+        tokens.push_back(token);
+        predict(token);
+      }
+    }
+  }
+  return tokens;
+}
+
+} // namespace
+
+TEST_CASE("streaming_rnnt's bound tensors decode the tiny RNNT as plain Session::Run() calls do", "[onnx][rnnt]") {
+  const auto audio = jaxie::test::tiny_rnnt_audio(32000, 3);
+  for (const auto& paths : { jaxie::test::tiny_rnnt_paths(), jaxie::test::tiny_rnnt_cache_aware_paths() }) {
+    jaxie::onnx::streaming_rnnt rnnt;
+    REQUIRE(rnnt.load(paths, {}));
+    std::vector<int32_t> bound;
+    REQUIRE(jaxie::test::tiny_rnnt_decode(rnnt, audio, bound));
+    REQUIRE_FALSE(bound.empty());
+    REQUIRE(bound == unbound_greedy(audio, paths));
+    // The decoder state and the encoder cache ping-pong between bound buffers instead of being copied back.
+    REQUIRE(rnnt.stats().last_step_bytes_copied == 0);
+
+    // A second pass over reset_state()'s zeroed caches, now at their full size, decodes the same.
+    rnnt.reset_state();
+    REQUIRE(jaxie::test::tiny_rnnt_decode(rnnt, audio, bound));
+    REQUIRE(bound == unbound_greedy(audio, paths));
+  }
+}
+
+TEST_CASE("streaming_rnnt decodes the tiny RNNT deterministically and reset_state() replays it", "[onnx][rnnt]") {
+  const auto audio = jaxie::test::tiny_rnnt_audio(32000);
+  jaxie::onnx::streaming_rnnt rnnt;
+  REQUIRE(rnnt.load(jaxie::test::tiny_rnnt_paths(), {}));
+  std::vector<int32_t> first;
+  REQUIRE(jaxie::test::tiny_rnnt_decode(rnnt, audio, first));
+  REQUIRE_FALSE(first.empty());
+
+  jaxie::onnx::streaming_rnnt again;
+  REQUIRE(again.load(jaxie::test::tiny_rnnt_paths(), {}));
+  std::vector<int32_t> second;
+  REQUIRE(jaxie::test::tiny_rnnt_decode(again, audio, second));
+  REQUIRE(second == first);
+
+  rnnt.reset_state();
+  std::vector<int32_t> replayed;
+  REQUIRE(jaxie::test::tiny_rnnt_decode(rnnt, audio, replayed));
+  REQUIRE(replayed == first);
+
+  // Chunking only moves where tokens come out, not which.
+  rnnt.reset_state();
+  std::vector<int32_t> rechunked;
+  REQUIRE(jaxie::test::tiny_rnnt_decode(rnnt, audio, rechunked, 480));
+  REQUIRE(rechunked == first);
+}
+
+TEST_CASE("streaming_rnnt steps the tiny RNNT without allocating once warmed up", "[onnx][rnnt]") {
+  const auto audio = jaxie::test::tiny_rnnt_audio(48000);
+  // The cache-aware encoder's caches grow to their real size on the first call, inside the warm-up.
+  for (const auto& paths : { jaxie::test::tiny_rnnt_paths(), jaxie::test::tiny_rnnt_cache_aware_paths() }) {
+    jaxie::onnx::streaming_rnnt rnnt;
+    REQUIRE(rnnt.load(paths, {}));
+    std::vector<int32_t> tokens;
+    tokens.reserve(256);
+    const std::span<const float> samples(audio);
+    REQUIRE(rnnt.step(samples.first(16000), tokens));
+    const auto warm = rnnt.stats();
+    REQUIRE(warm.encoder_runs > 0);
+
+    for (size_t at = 16000; at < audio.size(); at += 1600) {
+      REQUIRE(rnnt.step(samples.subspan(at, 1600), tokens));
+      REQUIRE(rnnt.stats().last_step_bytes_allocated == 0);
+    }
+    const auto stats = rnnt.stats();
+    REQUIRE(stats.encoder_runs > warm.encoder_runs);
+    REQUIRE(stats.bytes_allocated == warm.bytes_allocated);
+    REQUIRE(stats.arena_bytes == warm.arena_bytes);
+  }
+}
+
+TEST_CASE("streaming_rnnt beam search of width 1 decodes the tiny RNNT as greedy decoding does", "[onnx][rnnt]") {
+  const auto audio = jaxie::test::tiny_rnnt_audio(32000, 2);
+  jaxie::onnx::rnnt_options options{};
+  options.max_symbols_per_frame = 1; // beam search extends each hypothesis by at most one token per frame
+  jaxie::onnx::streaming_rnnt greedy;
+  REQUIRE(greedy.load(jaxie::test::tiny_rnnt_paths(), {}, options));
+  std::vector<int32_t> expected;
+  REQUIRE(jaxie::test::tiny_rnnt_decode(greedy, audio, expected));
+  REQUIRE_FALSE(expected.empty());
+
+  options.decoding = jaxie::onnx::decode_mode::modified_beam;
+  options.beam_size = 0;
+  jaxie::onnx::streaming_rnnt beam;
+  REQUIRE_FALSE(beam.load(jaxie::test::tiny_rnnt_paths(), {}, options));
+  options.beam_size = 1;
+  REQUIRE(beam.load(jaxie::test::tiny_rnnt_paths(), {}, options));
+  std::vector<int32_t> tokens;
+  REQUIRE(jaxie::test::tiny_rnnt_decode(beam, audio, tokens));
+  REQUIRE(tokens == expected);
+
+  // A wider beam holds back what its hypotheses disagree on until finish() settles on the best one.
+  options.beam_size = 4;
+  REQUIRE(beam.load(jaxie::test::tiny_rnnt_paths(), {}, options));
+  REQUIRE(jaxie::test::tiny_rnnt_decode(beam, audio, tokens));
+  REQUIRE_FALSE(tokens.empty());
+  REQUIRE(beam.partial().tokens.empty());
+  REQUIRE(beam.stats().predictor_cache_hits > 0);
+}
+
+TEST_CASE("streaming_rnnt pipeline decodes the tiny RNNT as step() does, across a boundary", "[onnx][rnnt]") {
+  const auto audio = jaxie::test::tiny_rnnt_audio(32000, 4);
+  jaxie::onnx::streaming_rnnt rnnt;
+  REQUIRE(rnnt.load(jaxie::test::tiny_rnnt_paths(), {}));
+  std::vector<int32_t> expected;
+  REQUIRE(jaxie::test::tiny_rnnt_decode(rnnt, audio, expected));
+  REQUIRE_FALSE(expected.empty());
+
+  std::vector<int32_t> piped; // appended on the decoder stage's thread, read after stop_pipeline()
+  const auto on_tokens = [&piped](std::span<const int32_t> tokens) {
+    piped.insert(piped.end(), tokens.begin(), tokens.end());
+  };
+  // Few slots, so submit() is refused now and then and has to retry.
+  REQUIRE(rnnt.start_pipeline(on_tokens, { .audio_slots = 4, .frame_slots = 2 }));
+  std::vector<int32_t> refused;
+  REQUIRE_FALSE(rnnt.step(audio, refused));
+
+  const std::span<const float> samples(audio);
+  for (int utterance = 0; utterance < 2; ++utterance) {
+    for (size_t at = 0; at < samples.size(); at += 1600) {
+      while (!rnnt.submit(samples.subspan(at, 1600))) {
+        std::this_thread::yield();
+      }
+    }
+    while (!rnnt.submit_boundary()) {
+      std::this_thread::yield();
+    }
+  }
+  rnnt.stop_pipeline();
+
+  const auto stats = rnnt.pipeline_stats();
+  REQUIRE_FALSE(stats.failed);
+  REQUIRE(stats.blocks >= 2 * (audio.size() / 1600));
+  REQUIRE(piped.size() == 2 * expected.size());
+  REQUIRE(std::equal(expected.begin(), expected.end(), piped.begin()));
+  REQUIRE(std::equal(expected.begin(), expected.end(), piped.begin() + static_cast<std::ptrdiff_t>(expected.size())));
+}
+
+TEST_CASE("streaming_rnnt opens the tiny RNNT from the optimized-model cache on the second load", "[onnx][rnnt]") {
+  const auto cache_dir = std::filesystem::temp_directory_path() / "jaxie_model_cache_test";
+  std::filesystem::remove_all(cache_dir);
+  jaxie::onnx::ep_prefs prefs{};
+  prefs.session.cache_dir = cache_dir.string();
+
+  jaxie::onnx::streaming_rnnt missing;
+  const jaxie::onnx::rnnt_model_paths absent{ "missing_encoder.onnx", "missing_predictor.onnx", "missing_joint.onnx" };
+  REQUIRE_FALSE(missing.load(absent, prefs));
+  REQUIRE((!std::filesystem::exists(cache_dir) || std::filesystem::is_empty(cache_dir)));
+
+  const auto audio = jaxie::test::tiny_rnnt_audio(16000, 5);
+  jaxie::onnx::streaming_rnnt cold;
+  REQUIRE(cold.load(jaxie::test::tiny_rnnt_paths(), prefs));
+  REQUIRE(cold.stats().cached_sessions == 0);
+  REQUIRE_FALSE(std::filesystem::is_empty(cache_dir));
+  std::vector<int32_t> expected;
+  REQUIRE(jaxie::test::tiny_rnnt_decode(cold, audio, expected));
+  REQUIRE_FALSE(expected.empty());
+
+  jaxie::onnx::streaming_rnnt warm;
+  REQUIRE(warm.load(jaxie::test::tiny_rnnt_paths(), prefs));
+  REQUIRE(warm.stats().cached_sessions == 3);
+  std::vector<int32_t> tokens;
+  REQUIRE(jaxie::test::tiny_rnnt_decode(warm, audio, tokens));
+  REQUIRE(tokens == expected);
+
+  std::error_code error;
+  std::filesystem::remove_all(cache_dir, error);
+}
+
+TEST_CASE("streaming_rnnt streams over one runtime and shared sessions decode the tiny RNNT alike", "[onnx][rnnt]") {
+  const auto audio = jaxie::test::tiny_rnnt_audio(32000, 6);
+  jaxie::onnx::streaming_rnnt source;
+  REQUIRE(source.load(jaxie::test::tiny_rnnt_paths(), {}));
+  // The load created the process-wide runtime.
+  const jaxie::onnx::runtime_config runtime{ .intra_op_threads = 2, .inter_op_threads = 1, .allow_spinning = false };
+  REQUIRE_FALSE(jaxie::onnx::configure_runtime(runtime));
+  std::vector<int32_t> expected;
+  REQUIRE(jaxie::test::tiny_rnnt_decode(source, audio, expected));
+  REQUIRE_FALSE(expected.empty());
+  source.reset_state();
+
+  // Its own sessions over the shared Env and prepacked weights, and two streams over source's sessions.
+  jaxie::onnx::streaming_rnnt separate;
+  REQUIRE(separate.load(jaxie::test::tiny_rnnt_paths(), {}));
+  std::array<jaxie::onnx::streaming_rnnt, 2> shared;
+  for (auto& stream : shared) {
+    REQUIRE(stream.load_shared(source));
+  }
+
+  const std::array<const jaxie::onnx::streaming_rnnt*, 4> streams{ &source, &separate, &shared[0], &shared[1] };
+  std::array<std::vector<int32_t>, 4> tokens;
+  std::array<bool, 4> decoded{};
+  {
+    std::vector<std::jthread> threads;
+    for (size_t i = 0; i < streams.size(); ++i) {
+      threads.emplace_back([&, i] { decoded[i] = jaxie::test::tiny_rnnt_decode(*streams[i], audio, tokens[i]); });
+    }
+  }
+  for (size_t i = 0; i < streams.size(); ++i) {
+    REQUIRE(decoded[i]);
+    REQUIRE(tokens[i] == expected);
+  }
+}
+
+TEST_CASE("streaming_rnnt hot swap changes the tiny RNNT at a boundary only when committed", "[onnx][rnnt]") {
+  using jaxie::onnx::swap_state;
+  const auto audio = jaxie::test::tiny_rnnt_audio(32000, 7);
+  const auto paths = jaxie::test::tiny_rnnt_paths();
+  jaxie::onnx::rnnt_options replacement{};
+  replacement.max_symbols_per_frame = 1; // same weights, visibly different decoding
+  jaxie::onnx::streaming_rnnt reference;
+  REQUIRE(reference.load(paths, {}, replacement));
+  std::vector<int32_t> swapped;
+  REQUIRE(jaxie::test::tiny_rnnt_decode(reference, audio, swapped));
+
+  jaxie::onnx::streaming_rnnt rnnt;
+  REQUIRE(rnnt.load(paths, {}));
+  std::vector<int32_t> serving;
+  REQUIRE(jaxie::test::tiny_rnnt_decode(rnnt, audio, serving));
+  REQUIRE(serving != swapped);
+  REQUIRE(rnnt.swap_status() == swap_state::idle);
+  REQUIRE_FALSE(rnnt.commit_swap());
+
+  const auto settled = [&rnnt] {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (rnnt.swap_status() == swap_state::loading && std::chrono::steady_clock::now() < deadline) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return rnnt.swap_status();
+  };
+  std::vector<int32_t> tokens;
+
+  // A replacement that does not load leaves the serving model as it was.
+  const jaxie::onnx::rnnt_model_paths missing{ "missing_encoder.onnx", "missing_predictor.onnx", "missing_joint.onnx" };
+  REQUIRE(rnnt.prepare_swap(missing, {}));
+  REQUIRE(settled() == swap_state::failed);
+  REQUIRE_FALSE(rnnt.commit_swap());
+  rnnt.reset_state();
+  REQUIRE(jaxie::test::tiny_rnnt_decode(rnnt, audio, tokens));
+  REQUIRE(tokens == serving);
+
+  // Cancelled when ready: never committed.
+  REQUIRE(rnnt.prepare_swap(paths, {}, replacement));
+  REQUIRE(settled() == swap_state::ready);
+  rnnt.cancel_swap();
+  REQUIRE(rnnt.swap_status() == swap_state::idle);
+  REQUIRE_FALSE(rnnt.commit_swap());
+  rnnt.reset_state();
+  REQUIRE(jaxie::test::tiny_rnnt_decode(rnnt, audio, tokens));
+  REQUIRE(tokens == serving);
+
+  // Ready but not yet committed: the utterance in progress finishes on the serving model, the next one after
+  // the commit decodes on the replacement.
+  REQUIRE(rnnt.prepare_swap(paths, {}, replacement));
+  REQUIRE(settled() == swap_state::ready);
+  rnnt.reset_state();
+  REQUIRE(jaxie::test::tiny_rnnt_decode(rnnt, audio, tokens));
+  REQUIRE(tokens == serving);
+  REQUIRE(rnnt.commit_swap());
+  REQUIRE_FALSE(rnnt.commit_swap());
+  REQUIRE(jaxie::test::tiny_rnnt_decode(rnnt, audio, tokens));
+  REQUIRE(tokens == swapped);
+}
+
+TEST_CASE("streaming_rnnt places the tiny RNNT on the CPU provider and profiles its nodes", "[onnx][rnnt]") {
+  jaxie::onnx::ep_prefs prefs{ .providers = { "Bogus", "CPU" }, .session = {} };
+  prefs.session.profiling = true;
+  jaxie::onnx::streaming_rnnt rnnt;
+  REQUIRE(rnnt.load(jaxie::test::tiny_rnnt_paths(), prefs));
+  const auto& placement = rnnt.placement();
+  for (const auto* session : { &placement.encoder, &placement.predictor, &placement.joint }) {
+    REQUIRE(session->registered == std::vector<std::string>{ "CPUExecutionProvider" });
+    REQUIRE(session->rejected == std::vector<std::string>{ "Bogus: unknown provider" });
+    REQUIRE(session->nodes.empty());
+  }
+
+  std::vector<int32_t> tokens;
+  REQUIRE(jaxie::test::tiny_rnnt_decode(rnnt, jaxie::test::tiny_rnnt_audio(16000), tokens));
+  jaxie::onnx::rnnt_profile profile;
+  REQUIRE(rnnt.collect_profile(profile));
+  REQUIRE(profile.steps == 10);
+  REQUIRE(profile.files.empty());
+  REQUIRE_FALSE(rnnt.collect_profile(profile));
+  for (const auto* session : { &placement.encoder, &placement.predictor, &placement.joint }) {
+    REQUIRE_FALSE(session->nodes.empty());
+    REQUIRE(session->nodes.front().provider == "CPUExecutionProvider");
+    REQUIRE(session->nodes.front().nodes > 0);
+  }
+}
+
+#endif
@@ -0,0 +1,87 @@
+// SPDX-License-Identifier: UNLICENSED
+#include <Jaxie/audio/capture.hpp>
+#include <Jaxie/realtime/thread_tuning.hpp>
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+using namespace std::chrono_literals;
+
+TEST_CASE("thread tuning leaves an untouched thread alone", "[realtime]") {
+  const jaxie::realtime::thread_tuning none{};
+  REQUIRE_FALSE(none.requested());
+  const auto report = jaxie::realtime::apply_to_current_thread(none);
+  REQUIRE(report.ok());
+  REQUIRE_FALSE(report.scheduling_applied);
+  REQUIRE_FALSE(report.affinity_applied);
+  REQUIRE(jaxie::realtime::describe(report).empty());
+}
+
+TEST_CASE("thread tuning reports each failure without throwing", "[realtime]") {
+  jaxie::realtime::tuning_report first{};
+  first.scheduling_error = EPERM;
+  jaxie::realtime::tuning_report second{};
+  second.scheduling_error = EINVAL;
+  second.affinity_applied = true;
+  jaxie::realtime::merge(first, second);
+  REQUIRE(first.scheduling_error == EPERM);
+  REQUIRE(first.affinity_applied);
+  REQUIRE_FALSE(first.ok());
+  REQUIRE(jaxie::realtime::describe(first).starts_with("scheduling: "));
+
+  // Unprivileged runs get EPERM for SCHED_FIFO; either way the request is answered, not ignored.
+  jaxie::realtime::thread_tuning fifo{};
+  fifo.policy = jaxie::realtime::sched_policy::fifo;
+  fifo.priority = 10;
+  fifo.prefault_stack = true;
+  std::thread worker([&]() {
+    const auto report = jaxie::realtime::apply_to_current_thread(fifo);
+    CHECK((report.scheduling_applied || report.scheduling_error != 0));
+  });
+  worker.join();
+}
+
+TEST_CASE("audio_capture applies consumer thread tuning and still starts without privileges", "[audio][realtime]") {
+  jaxie::audio::capture_config cfg{};
+  cfg.source = jaxie::audio::capture_source::file;
+  cfg.pacing = jaxie::audio::replay_pacing::as_fast_as_possible;
+  cfg.consumer_thread.policy = jaxie::realtime::sched_policy::round_robin;
+  cfg.consumer_thread.priority = 50;
+  cfg.consumer_thread.prefault_stack = true;
+  cfg.consumer_thread.cpu_mask = ~uint64_t{ 0 };
+
+  // A headerless float clip of ten periods.
+  const std::vector<float> clip(1600, 0.25F);
+  cfg.replay_path = (std::filesystem::temp_directory_path() / "jaxie_tuning.raw").string();
+  {
+    std::ofstream out(cfg.replay_path, std::ios::binary);
+    out.write(reinterpret_cast<const char*>(clip.data()), static_cast<std::streamsize>(clip.size() * sizeof(float))); // NOLINT(*-reinterpret-cast)
+  }
+
+  std::atomic<uint64_t> periods{0};
+  jaxie::audio::audio_capture cap;
+  REQUIRE(cap.init(cfg, [&](std::span<const float>) { periods.fetch_add(1); }));
+  REQUIRE(cap.start());
+  for (int i = 0; i < 200 && !cap.stats().end_of_stream; ++i) {
+    std::this_thread::sleep_for(10ms);
+  }
+  cap.stop();
+
+  const auto stats = cap.stats();
+  REQUIRE(periods.load() == 10);
+  REQUIRE((stats.tuning.scheduling_applied || stats.tuning.scheduling_error != 0));
+  REQUIRE((stats.tuning.affinity_applied || stats.tuning.affinity_error != 0));
+  REQUIRE_FALSE(stats.tuning.memory_locked);
+
+  cap.shutdown();
+  std::filesystem::remove(cfg.replay_path);
+}
@@ -0,0 +1,81 @@
+// SPDX-License-Identifier: UNLICENSED
+#pragma once
+
+// The tiny RNNT tools/make_tiny_rnnt writes for the decoding tests (JAXIE_TINY_RNNT_DIR, set only when the
+// tests are built with ONNX Runtime). Its weights are random, so any speech-like input decodes to a mix of
+// tokens and blanks: good for comparing decoding paths, meaningless as a transcript.
+
+#include <Jaxie/onnx/streaming_rnnt.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <numbers>
+#include <span>
+#include <vector>
+
+namespace jaxie::test {
+
+inline onnx::rnnt_model_paths tiny_rnnt_paths() {
+#if defined(JAXIE_TINY_RNNT_DIR)
+  const std::filesystem::path dir{ JAXIE_TINY_RNNT_DIR };
+  return { (dir / "encoder.onnx").string(), (dir / "predictor.onnx").string(), (dir / "joint.onnx").string() };
+#else
+  return {};
+#endif
+}
+
+// The same model with cache_aware_encoder.onnx, whose cache streaming_rnnt carries from one encoder call to the next.
+inline onnx::rnnt_model_paths tiny_rnnt_cache_aware_paths() {
+  auto paths = tiny_rnnt_paths();
+  if (!paths.encoder.empty()) {
+    paths.encoder = (std::filesystem::path(paths.encoder).parent_path() / "cache_aware_encoder.onnx").string();
+  }
+  return paths;
+}
+
+// Harmonic bursts whose fundamental glides with the seed, over low noise; 16 kHz.
+inline std::vector<float> tiny_rnnt_audio(size_t samples, uint32_t seed = 1) {
+  std::vector<float> out(samples);
+  uint32_t noise = seed;
+  const double fundamental = 110.0 + (20.0 * (seed % 8));
+  for (size_t i = 0; i < samples; ++i) {
+    noise = (noise * 1664525U) + 1013904223U;
+    const double t = static_cast<double>(i) / 16000.0;
+    double sample = 0.01 * ((static_cast<double>(noise >> 8) / 16777216.0) - 0.5);
+    if (std::fmod(t, 0.5) < 0.35) {
+      const double f0 = fundamental * (1.0 + (0.5 * t));
+      for (int harmonic = 1; harmonic <= 6; ++harmonic) {
+        sample += (0.2 / harmonic) * std::sin(2.0 * std::numbers::pi * f0 * harmonic * t);
+      }
+    }
+    out[i] = static_cast<float>(sample);
+  }
+  return out;
+}
+
+// step() over `audio` in `chunk`-sample calls, then finish(); every emitted token, in order.
+inline bool tiny_rnnt_decode(
+  const onnx::streaming_rnnt& rnnt,
+  std::span<const float> audio,
+  std::vector<int32_t>& tokens,
+  size_t chunk = 1600) {
+  tokens.clear();
+  std::vector<int32_t> emitted;
+  emitted.reserve(256);
+  for (size_t at = 0; at < audio.size(); at += chunk) {
+    if (!rnnt.step(audio.subspan(at, (std::min)(chunk, audio.size() - at)), emitted)) {
+      return false;
+    }
+    tokens.insert(tokens.end(), emitted.begin(), emitted.end());
+  }
+  if (!rnnt.finish(emitted)) {
+    return false;
+  }
+  tokens.insert(tokens.end(), emitted.begin(), emitted.end());
+  return true;
+}
+
+} // namespace jaxie::test
@@ -0,0 +1,93 @@
+// SPDX-License-Identifier: UNLICENSED
+#include "transcribe.hpp"
+
+#include "tiny_rnnt.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <regex>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#if defined(JAXIE_TINY_RNNT_DIR)
+
+namespace {
+
+// 16-bit mono WAV at 16 kHz.
+void write_wav(const std::filesystem::path& path, const std::vector<float>& samples) {
+  std::ofstream out(path, std::ios::binary);
+  const auto put = [&](uint32_t value, int bytes) {
+    for (int i = 0; i < bytes; ++i) {
+      out.put(static_cast<char>((value >> (8 * i)) & 0xFFU));
+    }
+  };
+  const auto data_bytes = static_cast<uint32_t>(samples.size() * 2);
+  out.write("RIFF", 4);
+  put(36U + data_bytes, 4);
+  out.write("WAVEfmt ", 8);
+  put(16, 4);
+  put(1, 2);
+  put(1, 2);
+  put(16000, 4);
+  put(32000, 4);
+  put(2, 2);
+  put(16, 2);
+  out.write("data", 4);
+  put(data_bytes, 4);
+  for (const float sample : samples) {
+    put(static_cast<uint32_t>(static_cast<int16_t>(sample * 32767.0F)), 2);
+  }
+}
+
+// jaxie --transcribe <dir> --workers N --out FILE; the JSONL lines, without the timing fields.
+std::vector<std::string> transcribe(const std::filesystem::path& dir, uint32_t workers) {
+  const auto out = dir / ("workers_" + std::to_string(workers) + ".jsonl");
+  std::vector<std::string> args{
+    "jaxie", "--transcribe", dir.string(), "--workers", std::to_string(workers), "--out", out.string()
+  };
+  std::vector<char*> argv;
+  for (auto& arg : args) {
+    argv.push_back(arg.data());
+  }
+  REQUIRE(jaxie::app::run_transcribe(argv, jaxie::test::tiny_rnnt_paths(), {}) == EXIT_SUCCESS);
+
+  const std::regex timing(R"(,"decode_s":[^,]*,"rtf":[^,]*)");
+  std::vector<std::string> lines;
+  std::ifstream in(out);
+  for (std::string line; std::getline(in, line);) {
+    lines.push_back(std::regex_replace(line, timing, ""));
+  }
+  return lines;
+}
+
+} // namespace
+
+TEST_CASE("transcription on several workers writes a single worker's lines in input order", "[onnx][app]") {
+  const auto dir = std::filesystem::temp_directory_path() / "jaxie_transcribe_tests";
+  std::filesystem::remove_all(dir);
+  std::filesystem::create_directories(dir);
+  constexpr size_t clips = 5;
+  for (size_t i = 0; i < clips; ++i) {
+    const auto audio = jaxie::test::tiny_rnnt_audio(12000 + (4000 * i), static_cast<uint32_t>(i + 1));
+    write_wav(dir / ("clip_" + std::to_string(i) + ".wav"), audio);
+  }
+
+  const auto single = transcribe(dir, 1);
+  REQUIRE(single.size() == clips);
+  for (size_t i = 0; i < clips; ++i) {
+    const auto name = (dir / ("clip_" + std::to_string(i) + ".wav")).string();
+    REQUIRE(single[i].starts_with("{\"file\":\"" + name + "\",\"duration_s\":"));
+    REQUIRE(single[i].find("\"tokens\":[]") == std::string::npos);
+  }
+  REQUIRE(transcribe(dir, 2) == single);
+  REQUIRE(transcribe(dir, 4) == single);
+  std::filesystem::remove_all(dir);
+}
+
+#endif
@@ -0,0 +1,107 @@
+// SPDX-License-Identifier: UNLICENSED
+#include <Jaxie/onnx/transcript.hpp>
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+namespace {
+
+constexpr std::array<std::string_view, 6> pieces{ "<blk>", "\xE2\x96\x81hel", "lo", "\xE2\x96\x81world", "<0x21>",
+                                                  "\xE2\x96\x81" "again" };
+
+} // namespace
+
+TEST_CASE("detokenizer renders word markers, byte fallback and special pieces", "[onnx][transcript]") {
+  jaxie::onnx::detokenizer vocab;
+  REQUIRE(vocab.load(pieces));
+  REQUIRE(vocab.size() == pieces.size());
+  REQUIRE(vocab.piece(3) == " world");
+  REQUIRE(vocab.piece(0).empty());
+  REQUIRE(vocab.piece(99).empty());
+
+  std::string text;
+  const std::vector<int32_t> tokens{ 0, 1, 2, 3, 4 };
+  vocab.append(tokens, text);
+  REQUIRE(text == "hello world!");
+}
+
+TEST_CASE("transcript_stabilizer keeps a stable prefix and diffs the pending suffix", "[onnx][transcript]") {
+  jaxie::onnx::detokenizer vocab;
+  REQUIRE(vocab.load(pieces));
+  jaxie::onnx::transcript_stabilizer transcript;
+  REQUIRE(transcript.init(vocab));
+  std::string shown;
+  const auto apply = [&shown](const jaxie::onnx::transcript_update& update) {
+    shown.resize(shown.size() - update.erase);
+    shown.append(update.append);
+  };
+
+  // Chunk tokens are final; the right-context lookahead is pending.
+  const std::vector<int32_t> first{ 1 };
+  const std::vector<uint32_t> first_frames{ 3 };
+  const std::vector<int32_t> lookahead{ 2 };
+  const std::vector<uint32_t> lookahead_frames{ 5 };
+  const auto& update = transcript.update(first, first_frames, { lookahead, lookahead_frames });
+  apply(update);
+  REQUIRE(shown == "hello");
+  REQUIRE(update.stable_bytes == 3);
+  REQUIRE(update.stabilized.size() == 1);
+  REQUIRE(update.stabilized[0].time_ms == 30);
+  REQUIRE(update.pending.size() == 1);
+  REQUIRE(transcript.stats().first_partial_ns > 0);
+
+  // The next window confirms the lookahead as part of its chunk.
+  const std::vector<int32_t> second{ 2, 3 };
+  const std::vector<uint32_t> second_frames{ 5, 9 };
+  apply(transcript.update(second, second_frames, {}));
+  REQUIRE(shown == "hello world");
+  REQUIRE(transcript.stats().withdrawn_tokens == 0);
+
+  const std::vector<int32_t> bang{ 4 };
+  const std::vector<int32_t> again{ 5 };
+  const std::vector<uint32_t> at{ 14 };
+  apply(transcript.update({}, {}, { bang, at }));
+  REQUIRE(shown == "hello world!");
+  const auto& revised = transcript.update({}, {}, { again, at });
+  REQUIRE(revised.erase == 1);
+  apply(revised);
+  REQUIRE(shown == "hello world again");
+  REQUIRE(transcript.stats().withdrawn_tokens == 1);
+
+  const auto& last = transcript.finish(again, at);
+  apply(last);
+  REQUIRE(last.final);
+  REQUIRE(last.pending.empty());
+  REQUIRE(last.stable_bytes == shown.size());
+  REQUIRE(shown == transcript.text());
+  REQUIRE(transcript.stable_tokens().size() == 4);
+  REQUIRE(transcript.stats().allocations == 0);
+
+  transcript.reset();
+  REQUIRE(transcript.text().empty());
+  REQUIRE(transcript.stats().first_partial_ns == 0);
+}
+
+TEST_CASE("transcript_stabilizer never splits a multi-byte character between erase and append", "[onnx][transcript]") {
+  // "é" and "è" share their lead byte 0xC3.
+  constexpr std::array<std::string_view, 3> accents{ "<blk>", "\xE2\x96\x81" "caf\xC3\xA9",
+                                                     "\xE2\x96\x81" "caf\xC3\xA8" };
+  jaxie::onnx::detokenizer vocab;
+  REQUIRE(vocab.load(accents));
+  jaxie::onnx::transcript_stabilizer transcript;
+  REQUIRE(transcript.init(vocab));
+
+  const std::vector<int32_t> acute{ 1 };
+  const std::vector<int32_t> grave{ 2 };
+  const std::vector<uint32_t> at{ 4 };
+  REQUIRE(transcript.update({}, {}, { acute, at }).append == "caf\xC3\xA9");
+  const auto& revised = transcript.update({}, {}, { grave, at });
+  REQUIRE(revised.erase == 2);
+  REQUIRE(revised.append == "\xC3\xA8");
+  REQUIRE(transcript.text() == "caf\xC3\xA8");
+}
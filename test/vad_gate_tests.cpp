@@ -0,0 +1,92 @@
+// SPDX-License-Identifier: UNLICENSED
+#include <Jaxie/onnx/vad_gate.hpp>
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <numbers>
+#include <span>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+namespace {
+
+// Room noise around -60 dBFS with a voiced-like harmonic burst (150 Hz fundamental) in [speech_begin, speech_end).
+std::vector<float> room_signal(size_t frames, size_t speech_begin, size_t speech_end) {
+  std::vector<float> out(frames);
+  uint32_t noise = 777;
+  for (size_t i = 0; i < frames; ++i) {
+    noise = (noise * 1664525U) + 1013904223U;
+    double sample = 0.002 * ((static_cast<double>(noise >> 8) / 16777216.0) - 0.5);
+    if (i >= speech_begin && i < speech_end) {
+      const double t = static_cast<double>(i) / 16000.0;
+      for (int harmonic = 1; harmonic <= 8; ++harmonic) {
+        sample += (0.1 / harmonic) * std::sin(2.0 * std::numbers::pi * 150.0 * harmonic * t);
+      }
+    }
+    out[i] = static_cast<float>(sample);
+  }
+  return out;
+}
+
+} // namespace
+
+TEST_CASE("vad_gate forwards one utterance with pre-roll and suppresses the rest", "[onnx][vad]") {
+  const jaxie::onnx::vad_gate_config cfg{};
+  const auto audio = room_signal(16000 * 6, 16000 * 3, 16000 * 4);
+
+  size_t forwarded = 0;
+  size_t first_forward_offset = 0;
+  size_t fed = 0;
+  int boundaries = 0;
+  jaxie::onnx::vad_gate gate;
+  REQUIRE(gate.init(
+    cfg,
+    [&](std::span<const float> chunk) {
+      if (forwarded == 0) {
+        first_forward_offset = fed;
+      }
+      forwarded += chunk.size();
+    },
+    [&]() { ++boundaries; }));
+
+  for (size_t offset = 0; offset < audio.size(); offset += 160) {
+    fed = offset;
+    gate.process(std::span<const float>(audio).subspan(offset, 160));
+  }
+
+  const auto& stats = gate.stats();
+  REQUIRE(boundaries == 1);
+  REQUIRE(stats.utterances == 1);
+  REQUIRE_FALSE(gate.in_speech());
+  // The gate opened within the onset time and replayed audio from before the burst started.
+  REQUIRE(first_forward_offset >= 16000 * 3);
+  REQUIRE(first_forward_offset < (16000 * 3) + 800);
+  REQUIRE(forwarded > 16000 + 2000);
+  REQUIRE(stats.forwarded_frames == forwarded);
+  // One second of speech in six keeps the downstream duty cycle near 1/6 plus pre-roll and hangover.
+  REQUIRE(forwarded < 16000 * 2);
+  REQUIRE(stats.total_frames == audio.size());
+}
+
+TEST_CASE("vad_gate stays closed in an idle room", "[onnx][vad]") {
+  const auto audio = room_signal(16000 * 10, 0, 0);
+  size_t forwarded = 0;
+  jaxie::onnx::vad_gate gate;
+  REQUIRE(gate.init({}, [&](std::span<const float> chunk) { forwarded += chunk.size(); }, nullptr));
+  for (size_t offset = 0; offset < audio.size(); offset += 160) {
+    gate.process(std::span<const float>(audio).subspan(offset, 160));
+  }
+  REQUIRE(forwarded == 0);
+  REQUIRE(gate.stats().speech_periods == 0);
+}
+
+TEST_CASE("vad_gate rejects a missing callback or VAD model", "[onnx][vad]") {
+  jaxie::onnx::vad_gate gate;
+  REQUIRE_FALSE(gate.init({}, nullptr, nullptr));
+
+  jaxie::onnx::vad_gate_config cfg{};
+  cfg.model_path = "does-not-exist.onnx";
+  REQUIRE_FALSE(gate.init(cfg, [](std::span<const float>) {}, nullptr));
+}
@@ -0,0 +1,296 @@
+// Writes a tiny random-weight RNNT (encoder.onnx, predictor.onnx, joint.onnx) with the IO layout of a NeMo
+// export, so the ONNX Runtime tests and jaxie_bench can run streaming_rnnt without shipping a real model, plus
+// cache_aware_encoder.onnx, the same encoder carrying a cache between calls. The graphs are serialized straight
+// to protobuf: building them needs neither Python nor the onnx package.
+//
+//   encoder:   audio_signal [B, 80, T], length [B] -> outputs [B, 128, T/4], encoded_lengths [B]
+//   cache-aware encoder: also cache_last_channel [1, B, D] -> cache_last_channel_next [1, B, 128]
+//   predictor: targets [B, 1] int32, target_length [B] int32, state [1, B, 64]
+//              -> outputs [B, 64, 1], prednet_lengths [B], state_next [1, B, 64]
+//   joint:     encoder_outputs [B, 128, 1], decoder_outputs [B, 64, 1] -> outputs [B, 1, 1, 129] (log-probs)
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+namespace {
+
+constexpr int64_t mel_bins = 80;
+constexpr int64_t encoder_dim = 128;
+constexpr int64_t predictor_dim = 64;
+constexpr int64_t joint_dim = 64;
+constexpr int64_t vocabulary = 129; // 128 tokens and blank, last
+constexpr int64_t subsampling = 4;
+constexpr float blank_bias = 1.0F;
+
+// onnx.proto field numbers and enum values used below.
+enum class tensor_type : int32_t { float32 = 1, int32 = 6, int64 = 7 };
+enum attribute_type : int32_t { attr_int = 2, attr_ints = 7 };
+
+class proto {
+public:
+  proto& varint(uint32_t field, uint64_t value) {
+    key(field, 0);
+    put_varint(value);
+    return *this;
+  }
+  proto& bytes(uint32_t field, std::string_view value) {
+    key(field, 2);
+    put_varint(value.size());
+    out_.append(value);
+    return *this;
+  }
+  proto& message(uint32_t field, const proto& value) { return bytes(field, value.out_); }
+
+  const std::string& data() const noexcept { return out_; }
+
+private:
+  void key(uint32_t field, uint32_t wire_type) { put_varint((uint64_t{ field } << 3U) | wire_type); }
+  void put_varint(uint64_t value) {
+    while (value >= 0x80U) {
+      out_.push_back(static_cast<char>((value & 0x7FU) | 0x80U));
+      value >>= 7U;
+    }
+    out_.push_back(static_cast<char>(value));
+  }
+
+  std::string out_;
+};
+
+// A dim is a size or a symbolic name.
+using dim = std::variant<int64_t, std::string_view>;
+
+proto value_info(std::string_view name, tensor_type type, const std::vector<dim>& shape) {
+  proto dims;
+  for (const dim& d : shape) {
+    proto entry;
+    if (const auto* size = std::get_if<int64_t>(&d)) {
+      entry.varint(1, static_cast<uint64_t>(*size));
+    } else {
+      entry.bytes(2, std::get<std::string_view>(d));
+    }
+    dims.message(1, entry);
+  }
+  proto tensor;
+  tensor.varint(1, static_cast<uint64_t>(type)).message(2, dims);
+  proto type_proto;
+  type_proto.message(1, tensor);
+  proto info;
+  info.bytes(1, name).message(2, type_proto);
+  return info;
+}
+
+struct attribute {
+  std::string_view name;
+  std::vector<int64_t> ints;
+  bool list{false};
+};
+
+class graph_builder {
+public:
+  explicit graph_builder(uint64_t seed) : seed_(seed) {}
+
+  void input(std::string_view name, tensor_type type, const std::vector<dim>& shape) {
+    graph_.message(11, value_info(name, type, shape));
+  }
+  void output(std::string_view name, tensor_type type, const std::vector<dim>& shape) {
+    graph_.message(12, value_info(name, type, shape));
+  }
+
+  // Uniform in [-scale, scale], reproducible from the seed.
+  void weights(std::string_view name, const std::vector<int64_t>& shape, float scale) {
+    size_t count = 1;
+    for (const int64_t d : shape) {
+      count *= static_cast<size_t>(d);
+    }
+    std::vector<float> values(count);
+    for (float& v : values) {
+      seed_ = (seed_ * 6364136223846793005ULL) + 1442695040888963407ULL;
+      const auto unit = static_cast<float>(seed_ >> 40U) / static_cast<float>(1ULL << 24U);
+      v = ((2.0F * unit) - 1.0F) * scale;
+    }
+    std::string raw(values.size() * sizeof(float), '\0');
+    std::memcpy(raw.data(), values.data(), raw.size()); // little-endian, as raw_data requires
+    initializer(name, tensor_type::float32, shape, raw);
+  }
+
+  void bias(std::string_view name, const std::vector<float>& values) {
+    std::string raw(values.size() * sizeof(float), '\0');
+    std::memcpy(raw.data(), values.data(), raw.size());
+    initializer(name, tensor_type::float32, { static_cast<int64_t>(values.size()) }, raw);
+  }
+
+  void constant(std::string_view name, const std::vector<int64_t>& values) {
+    std::string raw(values.size() * sizeof(int64_t), '\0');
+    std::memcpy(raw.data(), values.data(), raw.size());
+    initializer(name, tensor_type::int64, { static_cast<int64_t>(values.size()) }, raw);
+  }
+
+  void node(
+    std::string_view op,
+    const std::vector<std::string_view>& inputs,
+    const std::vector<std::string_view>& outputs,
+    const std::vector<attribute>& attributes = {}) {
+    proto entry;
+    for (const auto input : inputs) {
+      entry.bytes(1, input);
+    }
+    for (const auto output : outputs) {
+      entry.bytes(2, output);
+    }
+    entry.bytes(3, std::string(op) + "_" + std::to_string(nodes_++)).bytes(4, op);
+    for (const attribute& attr : attributes) {
+      proto a;
+      a.bytes(1, attr.name);
+      if (attr.list) {
+        for (const int64_t v : attr.ints) {
+          a.varint(8, static_cast<uint64_t>(v));
+        }
+        a.varint(20, attribute_type::attr_ints);
+      } else {
+        a.varint(3, static_cast<uint64_t>(attr.ints.front())).varint(20, attribute_type::attr_int);
+      }
+      entry.message(5, a);
+    }
+    graph_.message(1, entry);
+  }
+
+  bool write(const std::filesystem::path& path, std::string_view name) const {
+    proto graph = graph_;
+    graph.bytes(2, name);
+    proto opset;
+    opset.bytes(1, "").varint(2, 17);
+    proto model;
+    model.varint(1, 8).bytes(2, "jaxie make_tiny_rnnt").message(8, opset).message(7, graph);
+    std::ofstream out(path, std::ios::binary);
+    out.write(model.data().data(), static_cast<std::streamsize>(model.data().size()));
+    return static_cast<bool>(out);
+  }
+
+private:
+  void initializer(std::string_view name, tensor_type type, const std::vector<int64_t>& shape, const std::string& raw) {
+    proto tensor;
+    for (const int64_t d : shape) {
+      tensor.varint(1, static_cast<uint64_t>(d));
+    }
+    tensor.varint(2, static_cast<uint64_t>(type)).bytes(8, name).bytes(9, raw);
+    graph_.message(5, tensor);
+  }
+
+  proto graph_;
+  uint64_t seed_;
+  uint32_t nodes_{0};
+};
+
+// Per-frame projection, tanh, then average pooling over time for the usual 4x subsampling. With a cache, every
+// output frame also gets the cache added, and the next cache is tanh(cache + the call's mean activation): a
+// running summary of everything encoded so far. Its last dim is symbolic, so streaming_rnnt starts from a
+// one-element cache and learns the real size from the first call.
+bool write_encoder(const std::filesystem::path& path, bool cache_aware) {
+  graph_builder g(1);
+  g.input("audio_signal", tensor_type::float32, { "B", mel_bins, "T" });
+  g.input("length", tensor_type::int64, { "B" });
+  if (cache_aware) {
+    g.input("cache_last_channel", tensor_type::float32, { 1, "B", "D" });
+  }
+  g.weights("proj", { encoder_dim, mel_bins }, 0.05F);
+  g.constant("subsampling", { subsampling });
+  g.node("MatMul", { "proj", "audio_signal" }, { "projected" });
+  g.node("Tanh", { "projected" }, { "activated" });
+  const std::vector<attribute> pooling{
+    { "kernel_shape", { subsampling }, true },
+    { "strides", { subsampling }, true },
+  };
+  if (cache_aware) {
+    g.constant("layer_axis", { 0 });
+    g.node("AveragePool", { "activated" }, { "pooled" }, pooling);
+    g.node("Transpose", { "cache_last_channel" }, { "history" }, { { "perm", { 1, 2, 0 }, true } }); // [B, D, 1]
+    g.node("Add", { "pooled", "history" }, { "outputs" });
+    g.node("ReduceMean", { "activated" }, { "summary" }, { { "axes", { 2 }, true }, { "keepdims", { 0 }, false } });
+    g.node("Unsqueeze", { "summary", "layer_axis" }, { "layer_summary" }); // [1, B, 128]
+    g.node("Add", { "cache_last_channel", "layer_summary" }, { "carried" });
+    g.node("Tanh", { "carried" }, { "cache_last_channel_next" });
+  } else {
+    g.node("AveragePool", { "activated" }, { "outputs" }, pooling);
+  }
+  g.node("Div", { "length", "subsampling" }, { "encoded_lengths" });
+  g.output("outputs", tensor_type::float32, { "B", encoder_dim, "T_out" });
+  g.output("encoded_lengths", tensor_type::int64, { "B" });
+  if (cache_aware) {
+    g.output("cache_last_channel_next", tensor_type::float32, { 1, "B", encoder_dim });
+  }
+  return g.write(path, cache_aware ? "tiny_rnnt_cache_aware_encoder" : "tiny_rnnt_encoder");
+}
+
+// One-layer Elman RNN over token embeddings; blank (the last id) doubles as start of sequence.
+bool write_predictor(const std::filesystem::path& path) {
+  graph_builder g(2);
+  g.input("targets", tensor_type::int32, { "B", 1 });
+  g.input("target_length", tensor_type::int32, { "B" });
+  g.input("state", tensor_type::float32, { 1, "B", predictor_dim });
+  g.weights("embedding", { vocabulary, predictor_dim }, 0.5F);
+  g.weights("recurrent", { predictor_dim, predictor_dim }, 0.1F);
+  g.node("Gather", { "embedding", "targets" }, { "embedded" });               // [B, 1, H]
+  g.node("Transpose", { "state" }, { "previous" }, { { "perm", { 1, 0, 2 }, true } }); // [B, 1, H]
+  g.node("MatMul", { "previous", "recurrent" }, { "carried" });
+  g.node("Add", { "embedded", "carried" }, { "summed" });
+  g.node("Tanh", { "summed" }, { "hidden" });
+  g.node("Transpose", { "hidden" }, { "outputs" }, { { "perm", { 0, 2, 1 }, true } });
+  g.node("Transpose", { "hidden" }, { "state_next" }, { { "perm", { 1, 0, 2 }, true } });
+  g.node("Identity", { "target_length" }, { "prednet_lengths" });
+  g.output("outputs", tensor_type::float32, { "B", predictor_dim, 1 });
+  g.output("prednet_lengths", tensor_type::int32, { "B" });
+  g.output("state_next", tensor_type::float32, { 1, "B", predictor_dim });
+  return g.write(path, "tiny_rnnt_predictor");
+}
+
+bool write_joint(const std::filesystem::path& path) {
+  graph_builder g(3);
+  g.input("encoder_outputs", tensor_type::float32, { "B", encoder_dim, 1 });
+  g.input("decoder_outputs", tensor_type::float32, { "B", predictor_dim, 1 });
+  g.weights("enc_proj", { encoder_dim, joint_dim }, 0.1F);
+  g.weights("pred_proj", { predictor_dim, joint_dim }, 0.1F);
+  g.weights("out_proj", { joint_dim, vocabulary }, 0.3F);
+  // Favour blank as a trained joint does, so greedy decoding both emits and skips frames.
+  std::vector<float> out_bias(vocabulary, 0.0F);
+  out_bias.back() = blank_bias;
+  g.bias("out_bias", out_bias);
+  g.constant("token_axis", { 1 });
+  g.node("Transpose", { "encoder_outputs" }, { "enc_frame" }, { { "perm", { 0, 2, 1 }, true } });
+  g.node("Transpose", { "decoder_outputs" }, { "pred_frame" }, { { "perm", { 0, 2, 1 }, true } });
+  g.node("MatMul", { "enc_frame", "enc_proj" }, { "enc_joint" });
+  g.node("MatMul", { "pred_frame", "pred_proj" }, { "pred_joint" });
+  g.node("Add", { "enc_joint", "pred_joint" }, { "joined" });
+  g.node("Relu", { "joined" }, { "activated" });
+  g.node("MatMul", { "activated", "out_proj" }, { "scores" });                  // [B, 1, V]
+  g.node("Add", { "scores", "out_bias" }, { "logits" });
+  g.node("LogSoftmax", { "logits" }, { "log_probs" }, { { "axis", { -1 }, false } });
+  g.node("Unsqueeze", { "log_probs", "token_axis" }, { "outputs" });             // [B, 1, 1, V]
+  g.output("outputs", tensor_type::float32, { "B", 1, 1, vocabulary });
+  return g.write(path, "tiny_rnnt_joint");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  if (argc != 2) {
+    std::cerr << "Usage: make_tiny_rnnt <output dir>\n";
+    return EXIT_FAILURE;
+  }
+  const std::filesystem::path dir(argv[1]); // NOLINT(*-pointer-arithmetic)
+  std::error_code error;
+  std::filesystem::create_directories(dir, error);
+  if (!write_encoder(dir / "encoder.onnx", false) || !write_encoder(dir / "cache_aware_encoder.onnx", true)
+      || !write_predictor(dir / "predictor.onnx") || !write_joint(dir / "joint.onnx")) {
+    std::cerr << "Cannot write the tiny RNNT to " << dir.string() << "\n";
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}